@@ -0,0 +1,111 @@
+/**
+ * @file
+ * @brief Atomic single-bit flags in the Cortex-M3 SRAM bit-band region.
+ *
+ * Every bit of the SRAM data half (.ram2, 0x20000000..0x20007FFF) has a 32-bit alias word at
+ * 0x22000000 + 32 * byte offset + 4 * bit. The bus performs the read-modify-write of an alias store
+ * itself, so setting or clearing one flag is a single STR that an ISR cannot tear, and reading one
+ * is a single LDR. No interrupt masking is needed.
+ *
+ * Test-and-clear needs read and write to be one step; it uses LDREX/STREX on the flag word. The
+ * Cortex-M3 clears the exclusive monitor on exception entry, so an ISR that runs in between makes
+ * the STREX fail and the loop retry. DMA writes do not clear the monitor; keep DMA away from flag
+ * words.
+ *
+ * Usage:
+ * @code
+ *   enum { FLAG_SHUNTDATA, FLAG_SPISETTINGS };
+ *   static BITBAND_FLAGS(appFlags);            // placed in .ram2
+ *
+ *   BITBAND_FLAGS_CHECK(appFlags);             // once at startup, halts if misplaced
+ *   BitBand_Set(appFlags, FLAG_SHUNTDATA);     // ISR
+ *   if (BitBand_TestAndClear(appFlags, FLAG_SHUNTDATA)) ... // main loop
+ * @endcode
+ *
+ * .ram2 must be linked at 0x20000000 (-Wl,--section-start=.ram2=0x20000000 under
+ * Build Settings -> Linker -> Command Line). A variable address is not a compile-time constant in
+ * C, so placement is checked by BITBAND_FLAGS_CHECK() at run time; the region layout, the flag
+ * word type and constant bit numbers are checked at compile time.
+ */
+#ifndef BITBAND_FLAGS_H
+#define BITBAND_FLAGS_H
+
+#include <cytypes.h>
+#include <CyLib.h>
+
+#define BITBAND_SRAM_BASE (0x20000000u)       /**< first bit-band addressable SRAM byte */
+#define BITBAND_SRAM_SIZE (0x00100000u)       /**< 1MB bit-band region */
+#define BITBAND_SRAM_ALIAS_BASE (0x22000000u) /**< alias word of bit 0 of BITBAND_SRAM_BASE */
+#define BITBAND_SECTION ".ram2"
+
+/* The whole .ram2 half must be bit-band addressable. */
+typedef char BitBand_RegionCheck[((CYREG_SRAM_DATA_MBASE >= BITBAND_SRAM_BASE) &&
+                                  ((CYREG_SRAM_DATA_MBASE + CYREG_SRAM_DATA_MSIZE) <=
+                                   (BITBAND_SRAM_BASE + BITBAND_SRAM_SIZE)))
+                                     ? 1
+                                     : -1];
+
+/** A word of up to 32 flags. Only declare it with BITBAND_FLAGS(). */
+typedef struct
+{
+    volatile uint32 bits;
+} BitBand_Flags;
+
+/** Declares a flag word in the bit-band region. */
+#define BITBAND_FLAGS(name) BitBand_Flags name __attribute__((section(BITBAND_SECTION), aligned(4)))
+
+/** Halts in debug builds if @p flags did not land in the bit-band region. */
+#define BITBAND_FLAGS_CHECK(flags)                                                                 \
+    CYASSERT(((uint32)&(flags).bits >= BITBAND_SRAM_BASE) &&                                       \
+             ((uint32)&(flags).bits < (BITBAND_SRAM_BASE + BITBAND_SRAM_SIZE)))
+
+/* Fails to compile for a constant bit number above 31, evaluates to 0. */
+#define BITBAND_BIT_CHECK(bit)                                                                     \
+    (0u * sizeof(char[(!__builtin_constant_p(bit) || ((uint32)(bit) < 32u)) ? 1 : -1]))
+
+/** Alias word of bit @p bit of @p flags; a plain integer has no .bits and does not compile. */
+#define BITBAND_ALIAS(flags, bit)                                                                  \
+    ((volatile uint32 *)(BITBAND_SRAM_ALIAS_BASE +                                                 \
+                         32u * ((uint32)&(flags).bits - BITBAND_SRAM_BASE) + 4u * (uint32)(bit) +  \
+                         BITBAND_BIT_CHECK(bit)))
+
+/* The host emulator routes alias accesses and exclusives through its shim. */
+#ifndef BITBAND_WRITE
+#define BITBAND_WRITE(alias, value) (*(alias) = (value))
+#define BITBAND_READ(alias) (*(alias))
+#define BITBAND_LDREX(addr) __LDREXW(addr)
+#define BITBAND_STREX(value, addr) __STREXW((value), (addr))
+#endif
+
+/** @brief Sets one flag with a single store; safe from ISRs and the main loop. */
+#define BitBand_Set(flags, bit) BITBAND_WRITE(BITBAND_ALIAS(flags, bit), 1u)
+
+/** @brief Clears one flag with a single store. */
+#define BitBand_Clear(flags, bit) BITBAND_WRITE(BITBAND_ALIAS(flags, bit), 0u)
+
+/** @brief Returns 1 when the flag is set, with a single load. */
+#define BitBand_Test(flags, bit) ((uint8)BITBAND_READ(BITBAND_ALIAS(flags, bit)))
+
+/**
+ * @brief Clears one flag and returns its previous state, atomically.
+ *
+ * A set that races with the clear is never lost: it lands either before the LDREX (and is
+ * returned) or after the STREX (and stays pending).
+ */
+static inline uint8 BitBand_TestAndClearWord(volatile uint32 *word, uint32 mask)
+{
+    uint32 value;
+
+    do
+    {
+        value = BITBAND_LDREX(word);
+        if ((value & mask) == 0u)
+            return 0u;
+    } while (BITBAND_STREX(value & ~mask, word) != 0u);
+    return 1u;
+}
+
+#define BitBand_TestAndClear(flags, bit)                                                           \
+    BitBand_TestAndClearWord(&(flags).bits, (1uL << (bit)) + BITBAND_BIT_CHECK(bit))
+
+#endif /* BITBAND_FLAGS_H */
@@ -0,0 +1,98 @@
+/**
+ * @file
+ * @brief Register-level fast path for DMA transaction descriptor (TD) fields.
+ *
+ * CyDmaTdSetAddress() measured 1500nS per call on the CY8CKIT-059 at BUS_CLK 64MHz, a raw
+ * CY_SET_REG16 into TD memory 500nS. These macros write the TD fields directly, skipping the
+ * function call, the handle range check and the CyDmac bookkeeping, and produce exactly the
+ * TD memory bytes the CyDmac API writes:
+ * - TD0[0..1] transfer count (12 bits), TD0[2] next TD, TD0[3] configuration;
+ * - TD1[0..1] source LO16, TD1[2..3] destination LO16.
+ *
+ * The TD handle is not checked. When it is a compile-time constant the register address folds
+ * to a constant and each update is a single store. Handles are known at compile time when the
+ * TDs are allocated in a fixed order right after reset: CyDmacConfigure() builds the free list
+ * from TD 127 downwards, so the n-th CyDmaTdAllocate() returns DMA_TD_FAST_SLOT(n). Check the
+ * assumption once with DMA_TD_FAST_ASSERT_SLOT() after allocating.
+ *
+ * Usage:
+ * @code
+ *   #define LINE_TD DMA_TD_FAST_SLOT(0)
+ *   dmaTd = CyDmaTdAllocate();
+ *   DMA_TD_FAST_ASSERT_SLOT(dmaTd, LINE_TD);
+ *   ...
+ *   DmaTdFast_SetSrc(LINE_TD, LO16((uint32)buffer)); // one STRH to a constant address
+ * @endcode
+ */
+#ifndef DMA_TD_FAST_H
+#define DMA_TD_FAST_H
+
+#include <cytypes.h>
+#include <CyDmac.h>
+
+/** TD handle of the n-th CyDmaTdAllocate() call after reset. */
+#define DMA_TD_FAST_SLOT(n) ((uint8)(CY_DMA_NUMBEROF_TDS - 1u - (n)))
+
+/** Halts in debug builds if a TD was not allocated in the expected slot. */
+#define DMA_TD_FAST_ASSERT_SLOT(td, slot) CYASSERT((td) == (slot))
+
+/** Address of the TD0 (count/next/config) and TD1 (source/destination) words of a TD. */
+#define DMA_TD_FAST_TD0_PTR(td) (CY_DMA_TDMEM_STRUCT_PTR[(td)].TD0)
+#define DMA_TD_FAST_TD1_PTR(td) (CY_DMA_TDMEM_STRUCT_PTR[(td)].TD1)
+
+/* The host emulator charges the measured cost of each TD store, the device needs nothing. */
+#ifndef DMA_TD_FAST_ACCOUNT
+#define DMA_TD_FAST_ACCOUNT() ((void)0)
+#endif
+
+/** Sets the source LO16 of a TD. */
+#define DmaTdFast_SetSrc(td, src)                                                                  \
+    do                                                                                             \
+    {                                                                                              \
+        DMA_TD_FAST_ACCOUNT();                                                                     \
+        CY_SET_REG16(DMA_TD_FAST_TD1_PTR(td), (src));                                              \
+    } while (0)
+
+/** Sets the destination LO16 of a TD. */
+#define DmaTdFast_SetDst(td, dst)                                                                  \
+    do                                                                                             \
+    {                                                                                              \
+        DMA_TD_FAST_ACCOUNT();                                                                     \
+        CY_SET_REG16(DMA_TD_FAST_TD1_PTR(td) + 2u, (dst));                                         \
+    } while (0)
+
+/** Sets source and destination LO16 of a TD with one 32-bit store. */
+#define DmaTdFast_SetAddress(td, src, dst)                                                         \
+    do                                                                                             \
+    {                                                                                              \
+        DMA_TD_FAST_ACCOUNT();                                                                     \
+        CY_SET_REG32(DMA_TD_FAST_TD1_PTR(td), ((uint32)(uint16)(dst) << 16) | (uint16)(src));      \
+    } while (0)
+
+/** Sets the 12-bit transfer count of a TD. */
+#define DmaTdFast_SetCount(td, count)                                                              \
+    do                                                                                             \
+    {                                                                                              \
+        DMA_TD_FAST_ACCOUNT();                                                                     \
+        CY_SET_REG16(DMA_TD_FAST_TD0_PTR(td), (uint16)(count)&0x0FFFu);                            \
+    } while (0)
+
+/** Sets the next TD of a TD (a TD handle, CY_DMA_DISABLE_TD or CY_DMA_END_CHAIN_TD). */
+#define DmaTdFast_SetNext(td, next)                                                                \
+    do                                                                                             \
+    {                                                                                              \
+        DMA_TD_FAST_ACCOUNT();                                                                     \
+        CY_SET_REG8(DMA_TD_FAST_TD0_PTR(td) + 2u, (next));                                         \
+    } while (0)
+
+/** Sets transfer count, next TD and configuration of a TD with one 32-bit store. */
+#define DmaTdFast_SetConfiguration(td, count, next, config)                                        \
+    do                                                                                             \
+    {                                                                                              \
+        DMA_TD_FAST_ACCOUNT();                                                                     \
+        CY_SET_REG32(DMA_TD_FAST_TD0_PTR(td), ((uint32)(uint8)(config) << 24) |                    \
+                                                  ((uint32)(uint8)(next) << 16) |                  \
+                                                  ((uint16)(count)&0x0FFFu));                      \
+    } while (0)
+
+#endif /* DMA_TD_FAST_H */
@@ -0,0 +1,56 @@
+/**
+ * @file
+ * @brief Runtime dispatch of FastCopy() and its DMA channel.
+ */
+#include "FastCopy.h"
+
+typedef void (*FastCopy_Fn)(void *dst, const void *src, size_t n);
+
+uint8 FastCopy_dmaCh = CY_DMA_INVALID_CHANNEL;
+uint8 FastCopy_dmaTd = CY_DMA_INVALID_TD;
+
+/* Backend per [src and dst co-aligned][size class], the ladders of FastCopy.h */
+static const FastCopy_Fn fastCopyTable[2][4] = {
+    {FastCopy_Bytes, FastCopy_Words, FastCopy_Dma, FastCopy_Dma},
+    {FastCopy_Bytes, FastCopy_Words, FastCopy_LdmStm, FastCopy_Dma},
+};
+
+/* Size class boundaries per [co-aligned]; the misaligned ladder has no ldm/stm step, so its
+   last class is empty */
+static const uint16 fastCopyMin[2][3] = {
+    {FAST_COPY_WORDS_MIN, FAST_COPY_DMA_MIN_MISALIGNED, FAST_COPY_DMA_MIN_MISALIGNED},
+    {FAST_COPY_WORDS_MIN, FAST_COPY_LDMSTM_MIN, FAST_COPY_DMA_MIN},
+};
+
+/**
+ * @brief Hands a channel and a TD to the DMA path of FastCopy().
+ *
+ * The channel must be configured for SRAM on both sides, one burst per TD and no request per
+ * burst, e.g. DMA_DmaInitialize(0, 0, HI16(CYDEV_SRAM_BASE), HI16(CYDEV_SRAM_BASE)). It is
+ * enabled here without TD preservation.
+ *
+ * @param chHandle Channel, or CY_DMA_INVALID_CHANNEL to disable the DMA path.
+ * @param tdHandle TD reserved for FastCopy(), from CyDmaTdAllocate().
+ */
+void FastCopy_DmaInit(uint8 chHandle, uint8 tdHandle)
+{
+    FastCopy_dmaCh = chHandle;
+    FastCopy_dmaTd = tdHandle;
+    if (chHandle == CY_DMA_INVALID_CHANNEL)
+        return;
+    DmaTdFast_SetConfiguration(tdHandle, 0u, tdHandle, 0u);
+    (void)CyDmaChSetInitialTd(chHandle, tdHandle);
+    (void)CyDmaChEnable(chHandle, 0u);
+}
+
+/**
+ * @brief FastCopy() for sizes only known at run time.
+ */
+void FastCopy_Dispatch(void *dst, const void *src, size_t n)
+{
+    uint32 co = (uint32)((((uint32)dst ^ (uint32)src) & 3u) == 0u);
+    const uint16 *min = fastCopyMin[co];
+    uint32 cls = (uint32)(n >= min[0]) + (uint32)(n >= min[1]) + (uint32)(n >= min[2]);
+
+    fastCopyTable[co][cls](dst, src, n);
+}
@@ -0,0 +1,244 @@
+/**
+ * @file
+ * @brief FastCopy(dst, src, n): SRAM copy that picks the cheapest strategy for the size.
+ *
+ * Strategies, cheapest first as the size grows (HostEmu/CopyBench fits the thresholds):
+ * - FastCopy_Bytes(): byte loop;
+ * - FastCopy_Words(): 32-bit LDR/STR once dst is aligned, the source may be unaligned;
+ * - FastCopy_LdmStm(): 16-byte LDMIA/STMIA blocks when src and dst share their alignment;
+ * - FastCopy_Dma(): one TD on a channel handed over with FastCopy_DmaInit(), CPU request and a
+ *   poll of the TD count. Without a channel it falls back to FastCopy_LdmStm().
+ *
+ * When n is a compile-time constant the strategy is chosen by the compiler: tiny copies become
+ * unrolled word loads/stores, and the alignment test of the block path disappears when both
+ * pointers are known to be word aligned. Otherwise FastCopy_Dispatch() picks the backend from a
+ * table indexed by size class and relative alignment, without a compare chain.
+ *
+ * Neither buffer may straddle the .ram/.ram2 boundary at 0x20000000 (unaligned word accesses
+ * cannot cross it), and the DMA path only copies SRAM to SRAM.
+ */
+#ifndef FAST_COPY_H
+#define FAST_COPY_H
+
+#include <cytypes.h>
+#include <CyDmac.h>
+#include <stddef.h>
+
+#include "DmaTdFast.h"
+
+/* clang-format off */
+/*
+ * Size thresholds in bytes. Each backend takes one contiguous size range, in ladder order:
+ *   src and dst co-aligned: bytes < WORDS_MIN <= words < LDMSTM_MIN <= ldm/stm < DMA_MIN <= DMA
+ *   the others:             bytes < WORDS_MIN <= words < DMA_MIN_MISALIGNED <= DMA
+ * HostEmu/CopyBench fits them at BUS_CLK == CPU clock: it takes the latency of every backend at
+ * every size up to 4095 on the emulator, for each source and destination alignment and .ram /
+ * .ram2 placement, and splits each ladder where the summed latency over the fastest backend of
+ * each case is least. It fails when the values here differ from its fit.
+ */
+#ifndef FAST_COPY_TINY_MAX
+#define FAST_COPY_TINY_MAX           (16u)   /**< constant n up to this is unrolled inline */
+#endif
+#ifndef FAST_COPY_WORDS_MIN
+#define FAST_COPY_WORDS_MIN          (4u)    /**< bytes -> words */
+#endif
+#ifndef FAST_COPY_LDMSTM_MIN
+#define FAST_COPY_LDMSTM_MIN         (19u)   /**< words -> ldm/stm, co-aligned pairs */
+#endif
+#ifndef FAST_COPY_DMA_MIN
+#define FAST_COPY_DMA_MIN            (329u)  /**< ldm/stm -> DMA, co-aligned pairs */
+#endif
+#ifndef FAST_COPY_DMA_MIN_MISALIGNED
+#define FAST_COPY_DMA_MIN_MISALIGNED (132u)  /**< words -> DMA, src and dst differ modulo 4 */
+#endif
+#define FAST_COPY_DMA_MAX_CHUNK      (4092u) /**< largest word-multiple TD transfer count */
+/* clang-format on */
+
+#if (FAST_COPY_WORDS_MIN > FAST_COPY_LDMSTM_MIN) || (FAST_COPY_LDMSTM_MIN > FAST_COPY_DMA_MIN) ||  \
+    (FAST_COPY_WORDS_MIN > FAST_COPY_DMA_MIN_MISALIGNED)
+#error "FastCopy thresholds have to grow along each ladder"
+#endif
+
+/* The host emulator advances its clock to the end of the transfer, the device needs nothing. */
+#ifndef FAST_COPY_DMA_ACCOUNT
+#define FAST_COPY_DMA_ACCOUNT(ch) ((void)0)
+#endif
+
+#define FAST_COPY_INLINE static inline __attribute__((always_inline))
+
+/** Word and block types that may alias any buffer; FastCopy_UWord may be unaligned. */
+typedef uint32 __attribute__((may_alias)) FastCopy_Word;
+typedef uint32 __attribute__((may_alias, aligned(1))) FastCopy_UWord;
+typedef struct
+{
+    uint32 w[4];
+} __attribute__((may_alias)) FastCopy_Block16;
+
+extern uint8 FastCopy_dmaCh;
+extern uint8 FastCopy_dmaTd;
+
+void FastCopy_DmaInit(uint8 chHandle, uint8 tdHandle);
+void FastCopy_Dispatch(void *dst, const void *src, size_t n);
+
+/** @brief Byte loop, the cheapest for a few bytes. */
+FAST_COPY_INLINE void FastCopy_Bytes(void *dst, const void *src, size_t n)
+{
+    uint8 *d = (uint8 *)dst;
+    const uint8 *s = (const uint8 *)src;
+
+    while (n-- != 0u)
+        *d++ = *s++;
+}
+
+/** @brief Copies whole words while at least 4 bytes are left, dst must be word aligned. */
+FAST_COPY_INLINE void FastCopy_WordLoop(uint8 **d, const uint8 **s, size_t *n)
+{
+    for (; *n >= 4u; *n -= 4u, *s += 4u, *d += 4u)
+        *(FastCopy_Word *)*d = *(const FastCopy_UWord *)*s; // single LDR, unaligned allowed
+}
+
+/** @brief Copies bytes until @p d is word aligned. */
+FAST_COPY_INLINE void FastCopy_AlignDst(uint8 **d, const uint8 **s, size_t *n)
+{
+    while ((*n != 0u) && (((uint32)*d & 3u) != 0u))
+    {
+        *(*d)++ = *(*s)++;
+        (*n)--;
+    }
+}
+
+/** @brief 32-bit LDR/STR once dst is word aligned; the source may have any alignment. */
+FAST_COPY_INLINE void FastCopy_Words(void *dst, const void *src, size_t n)
+{
+    uint8 *d = (uint8 *)dst;
+    const uint8 *s = (const uint8 *)src;
+
+    FastCopy_AlignDst(&d, &s, &n);
+    FastCopy_WordLoop(&d, &s, &n);
+    FastCopy_Bytes(d, s, n);
+}
+
+/** @brief LDMIA/STMIA 16-byte blocks, both pointers must be word aligned. */
+FAST_COPY_INLINE void FastCopy_BlockLoop(uint8 **d, const uint8 **s, size_t *n)
+{
+    for (; *n >= sizeof(FastCopy_Block16); *n -= sizeof(FastCopy_Block16))
+    {
+        *(FastCopy_Block16 *)*d = *(const FastCopy_Block16 *)*s;
+        *s += sizeof(FastCopy_Block16);
+        *d += sizeof(FastCopy_Block16);
+    }
+}
+
+/**
+ * @brief 16-byte LDM/STM blocks, then words, then bytes.
+ *
+ * LDM/STM fault on unaligned addresses, so blocks are only used when src and dst share their
+ * alignment modulo 4; other pairs take the FastCopy_Words() path.
+ */
+FAST_COPY_INLINE void FastCopy_LdmStm(void *dst, const void *src, size_t n)
+{
+    uint8 *d = (uint8 *)dst;
+    const uint8 *s = (const uint8 *)src;
+
+    FastCopy_AlignDst(&d, &s, &n);
+    if (((uint32)s & 3u) == 0u)
+        FastCopy_BlockLoop(&d, &s, &n);
+    FastCopy_WordLoop(&d, &s, &n);
+    FastCopy_Bytes(d, s, n);
+}
+
+/**
+ * @brief Copies through the FastCopy_DmaInit() channel and waits for the data to land.
+ *
+ * The channel does not preserve its TD, so the DMAC writes the count back as 0 when the TD is
+ * done; that is what the CPU polls. Copies above 4095 bytes (12-bit count) go in chunks.
+ */
+FAST_COPY_INLINE void FastCopy_Dma(void *dst, const void *src, size_t n)
+{
+    uint8 td = FastCopy_dmaTd;
+    uint32 d = (uint32)dst;
+    uint32 s = (uint32)src;
+
+    if (FastCopy_dmaCh == CY_DMA_INVALID_CHANNEL)
+    {
+        FastCopy_LdmStm(dst, src, n);
+        return;
+    }
+    while (n != 0u)
+    {
+        uint16 chunk = (uint16)((n > FAST_COPY_DMA_MAX_CHUNK) ? FAST_COPY_DMA_MAX_CHUNK : n);
+
+        DmaTdFast_SetAddress(td, LO16(s), LO16(d));
+        DmaTdFast_SetConfiguration(td, chunk, td, TD_INC_SRC_ADR | TD_INC_DST_ADR);
+        (void)CyDmaChSetRequest(FastCopy_dmaCh, CY_DMA_CPU_REQ);
+        while ((CY_GET_REG16(DMA_TD_FAST_TD0_PTR(td)) & 0x0FFFu) != 0u)
+        {
+        }
+        FAST_COPY_DMA_ACCOUNT(FastCopy_dmaCh);
+        s += chunk;
+        d += chunk;
+        n -= chunk;
+    }
+}
+
+/** Nonzero when @p p is known at compile time to be word aligned. */
+#define FAST_COPY_KNOWN_ALIGNED(p)                                                                 \
+    (__builtin_constant_p((uint32)(p)&3u) && (((uint32)(p)&3u) == 0u))
+
+/**
+ * @brief FastCopy() body for a compile-time constant @p n, every test below folds away.
+ *
+ * @param aligned Nonzero when both pointers are known to be word aligned.
+ */
+FAST_COPY_INLINE void FastCopy_Const(void *dst, const void *src, size_t n, int aligned)
+{
+    if (n == 0u)
+        return;
+    if (n <= FAST_COPY_TINY_MAX)
+    {
+        __builtin_memcpy(dst, src, n); // expanded inline into unrolled LDR/STR pairs
+    }
+    else if (aligned || ((((uint32)dst ^ (uint32)src) & 3u) == 0u))
+    {
+        if (n < FAST_COPY_LDMSTM_MIN)
+        {
+            FastCopy_Words(dst, src, n);
+        }
+        else if (n >= FAST_COPY_DMA_MIN)
+        {
+            FastCopy_Dma(dst, src, n);
+        }
+        else if (aligned)
+        {
+            uint8 *d = (uint8 *)dst;
+            const uint8 *s = (const uint8 *)src;
+
+            FastCopy_BlockLoop(&d, &s, &n);
+            FastCopy_WordLoop(&d, &s, &n);
+            FastCopy_Bytes(d, s, n);
+        }
+        else
+        {
+            FastCopy_LdmStm(dst, src, n); // co-aligned, dst alignment only known at run time
+        }
+    }
+    else if (n < FAST_COPY_DMA_MIN_MISALIGNED)
+    {
+        FastCopy_Words(dst, src, n);
+    }
+    else
+    {
+        FastCopy_Dma(dst, src, n);
+    }
+}
+
+/**
+ * @brief Copies @p n bytes from @p src to @p dst; the buffers must not overlap.
+ */
+#define FastCopy(dst, src, n)                                                                      \
+    (__builtin_constant_p(n)                                                                       \
+         ? FastCopy_Const((dst), (src), (n),                                                       \
+                          FAST_COPY_KNOWN_ALIGNED(dst) && FAST_COPY_KNOWN_ALIGNED(src))            \
+         : FastCopy_Dispatch((dst), (src), (n)))
+
+#endif /* FAST_COPY_H */
@@ -22,8 +22,32 @@
 #define UPPER_SRC_ADDRESS        CYDEV_PERIPH_BASE
 #define UPPER_DEST_ADDRESS       CYDEV_PERIPH_BASE
 
+/* Called once per pass of the main loop. Nothing on the device; the host emulator
+ * charges the time a pass takes there, so the components keep running. */
+#ifndef FILTER_POLL_ACCOUNT
+#define FILTER_POLL_ACCOUNT()    ((void)0)
+#endif
+
+/* Filter channels in use. 1 is the schematic as it is: ADC_DelSig feeds channel A, channel A
+ * feeds VDAC8. 2 filters two inputs, which needs on the schematic:
+ *  - AMux, two inputs ahead of ADC_DelSig, and isr_Mux on the ADC end of conversion;
+ *  - ADC_DelSig in Multi Sample conversion mode, so a conversion does not carry the last input;
+ *  - channel B enabled in the Filter customizer, with its own coefficients;
+ *  - DMA_2 on the Filter channel B DMA request, and VDAC8_1.
+ * Conversions alternate between the inputs, the DMA TD chain writes them to channel A and B in
+ * turn and DMA_1 / DMA_2 take each channel to its VDAC. HostEmu runs this file both ways
+ * (make -C HostEmu filter_adc_vdac01 filter_adc_vdac01_dual).
+ */
+#ifndef FILTER_CHANNELS
+#define FILTER_CHANNELS          (1u)
+#endif
+
 void DMA_Config(void);
 void DMA_1_Config(void);
+#if (FILTER_CHANNELS == 2u)
+void DMA_2_Config(void);
+CY_ISR_PROTO(Mux_Next);
+#endif /* FILTER_CHANNELS == 2u */
 
 
 /*******************************************************************************
@@ -63,14 +87,31 @@ int main()
     /* Start all components used on schematic */
     ADC_DelSig_IRQ_Start();
     ADC_DelSig_Start();
-    ADC_DelSig_StartConvert();
     VDAC8_Start();
     Opamp_Start();
     Filter_Start();
+#if (FILTER_CHANNELS == 2u)
+    VDAC8_1_Start();
+
+    /* The DMA writes the high byte of each staging register only */
+    Filter_SetCoherency(Filter_CHANNEL_A, Filter_KEY_HIGH);
+    Filter_SetCoherency(Filter_CHANNEL_B, Filter_KEY_HIGH);
+
+    /* The first conversion is of input 0, for channel A */
+    AMux_Start();
+    AMux_Select(0u);
+    isr_Mux_StartEx(Mux_Next);
+#endif /* FILTER_CHANNELS == 2u */
 
     /* User-implemented function to set-up DMA */
     DMA_Config();
     DMA_1_Config();
+#if (FILTER_CHANNELS == 2u)
+    DMA_2_Config();
+#endif /* FILTER_CHANNELS == 2u */
+
+    /* Convert once the DMA is there to take the samples to the Filter */
+    ADC_DelSig_StartConvert();
 
     /* Enable Global Interrupts */
     CYGlobalIntEnable;
@@ -78,16 +119,37 @@ int main()
     for(;;)
     {
         //CyPmAltAct(PM_SLEEP_TIME_NONE, PM_SLEEP_SRC_PICU);
+        FILTER_POLL_ACCOUNT();
     }
 } /* End of main */
 
 
+#if (FILTER_CHANNELS == 2u)
+/*******************************************************************************
+* Interrupt
+********************************************************************************
+* Interrupt generated on ADC_DelSig end of conversion. Interrupt handle:Mux_Next
+*
+* Summary:
+*  Switches AMux to the other input for the next conversion. The DMA takes the
+*  sample of the same end of conversion, so the TD chain and AMux stay in step.
+*
+*******************************************************************************/
+CY_ISR(Mux_Next)
+{
+    AMux_Next();
+}
+#endif /* FILTER_CHANNELS == 2u */
+
+
 /*******************************************************************************
 * Function Name: DMA_Config
 ********************************************************************************
 *
 * Summary:
-*  Initializes and sets up DMA for use (generated by DMA Wizard)
+*  Initializes and sets up DMA for use (generated by DMA Wizard). With two
+*  Filter channels a chain of two TDs writes the conversions to channel A and
+*  channel B in turn, one TD per end of conversion.
 *
 * Parameters:
 *  None.
@@ -105,6 +167,9 @@ void DMA_Config(void)
      * Filter Channel.
      */
     uint8 tdChanA;
+#if (FILTER_CHANNELS == 2u)
+    uint8 tdChanB;
+#endif /* FILTER_CHANNELS == 2u */
 
     /* Configure the DMA to Transfer the data in 1 burst with individual trigger
      * for each burst.
@@ -115,8 +180,25 @@ void DMA_Config(void)
     /* This function allocates a TD for use with an initialized DMA channel */
     tdChanA = CyDmaTdAllocate();
 
-    /* Configure the tdChanA to transfer 1 byte with no next TD */
-    CyDmaTdSetConfiguration(tdChanA, 1u, DMA_INVALID_TD, 0u);
+#if (FILTER_CHANNELS == 2u)
+    tdChanB = CyDmaTdAllocate();
+
+    /* Configure the TDs to transfer 1 byte each, tdChanA and tdChanB one
+     * after the other, each waiting for its own end of conversion
+     */
+    CyDmaTdSetConfiguration(tdChanA, 1u, tdChanB, 0u);
+    CyDmaTdSetConfiguration(tdChanB, 1u, tdChanA, 0u);
+
+    /* Set the source address as ADC_DelSig and the destination as
+     * Filter Channel B.
+     */
+    CyDmaTdSetAddress(tdChanB, LO16((uint32)ADC_DelSig_DEC_SAMP_PTR), LO16((uint32)Filter_STAGEBH_PTR));
+#else
+    /* Configure the tdChanA to transfer 1 byte and chain to itself; with no
+     * next TD the channel would stop after the first conversion
+     */
+    CyDmaTdSetConfiguration(tdChanA, 1u, tdChanA, 0u);
+#endif /* FILTER_CHANNELS == 2u */
 
     /* Set the source address as ADC_DelSig and the destination as
      * Filter Channel A.
@@ -151,5 +233,36 @@ CyDmaChSetInitialTd(DMA_1_Chan, DMA_1_TD[0]);
 CyDmaChEnable(DMA_1_Chan, 1);
 }
 
+#if (FILTER_CHANNELS == 2u)
+/*******************************************************************************
+* Function Name: DMA_2_Config
+********************************************************************************
+*
+* Summary:
+*  As DMA_1 for Filter channel B: takes the high byte of its holding register to
+*  VDAC8_1 on each channel B sample ready.
+*
+* Parameters:
+*  None.
+*
+* Return:
+*  None.
+*
+*******************************************************************************/
+void DMA_2_Config(void)
+{
+    uint8 channelHandle;
+    uint8 tdChanB;
+
+    channelHandle = DMA_2_DmaInitialize(BYTES_PER_BURST, REQUEST_PER_BURST,
+                                        HI16(UPPER_SRC_ADDRESS), HI16(UPPER_DEST_ADDRESS));
+    tdChanB = CyDmaTdAllocate();
+    CyDmaTdSetConfiguration(tdChanB, 1u, tdChanB, 0u);
+    CyDmaTdSetAddress(tdChanB, LO16((uint32)Filter_HOLDBH_PTR), LO16((uint32)VDAC8_1_Data_PTR));
+    CyDmaChSetInitialTd(channelHandle, tdChanB);
+    CyDmaChEnable(channelHandle, 1u);
+}
+#endif /* FILTER_CHANNELS == 2u */
+
 
 /* [] END OF FILE */
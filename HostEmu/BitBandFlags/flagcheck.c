@@ -0,0 +1,170 @@
+/**
+ * @file
+ * @brief Host check of Common/BitBandFlags.h and the ISR/main-loop flag protocol.
+ *
+ * Runs the flag operations against the emulator's bit-band shim and fires an emulated interrupt
+ * inside the LDREX/STREX window of BitBand_TestAndClear(), the one place a read-modify-write can
+ * lose an update. Built and run by HostEmu/Makefile (make -C HostEmu flagcheck):
+ *
+ *     flagcheck [iterations]
+ *
+ * The last line is a key=value summary; the process exits nonzero on any failed check.
+ */
+#include "../../Common/BitBandFlags.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum
+{
+    FLAG_RX_DONE,
+    FLAG_TX_DONE,
+    FLAG_ERROR = 31
+};
+
+static BITBAND_FLAGS(checkFlags);
+
+static uint32 checkFailures;
+static uint32 checkCount;
+
+/* Bits the emulated ISR sets, and the per-bit event bookkeeping of the stress run */
+static uint32 isrMask;
+static uint32 produced[32];
+static uint32 consumed[32];
+
+#define CHECK(cond)                                                                                \
+    do                                                                                             \
+    {                                                                                              \
+        checkCount++;                                                                              \
+        if (!(cond))                                                                               \
+        {                                                                                          \
+            checkFailures++;                                                                       \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);                        \
+        }                                                                                          \
+    } while (0)
+
+/** Emulated ISR: sets every bit of isrMask, counting the ones that were clear as new events. */
+static void FlagIsr(void)
+{
+    uint32 bit;
+
+    for (bit = 0u; bit < 32u; bit++)
+    {
+        if (isrMask & (1uL << bit))
+        {
+            if (BitBand_Test(checkFlags, bit) == 0u)
+                produced[bit]++;
+            BitBand_Set(checkFlags, bit);
+        }
+    }
+}
+
+/** Set/Clear/Test map onto exactly one bit of the flag word. */
+static void CheckSingleBits(void)
+{
+    uint32 bit;
+
+    BITBAND_FLAGS_CHECK(checkFlags);
+    CHECK(BITBAND_ALIAS(checkFlags, 0u) ==
+          (volatile uint32 *)(BITBAND_SRAM_ALIAS_BASE +
+                              32u * ((uint32)&checkFlags.bits - BITBAND_SRAM_BASE)));
+
+    for (bit = 0u; bit < 32u; bit++)
+    {
+        checkFlags.bits = 0u;
+        BitBand_Set(checkFlags, bit);
+        CHECK(checkFlags.bits == (1uL << bit));
+        CHECK(BitBand_Test(checkFlags, bit) == 1u);
+
+        checkFlags.bits = 0xFFFFFFFFu;
+        BitBand_Clear(checkFlags, bit);
+        CHECK(checkFlags.bits == (uint32) ~(1uL << bit));
+        CHECK(BitBand_Test(checkFlags, bit) == 0u);
+    }
+
+    checkFlags.bits = 0u;
+    BitBand_Set(checkFlags, FLAG_ERROR);
+    CHECK(BitBand_TestAndClear(checkFlags, FLAG_ERROR) == 1u);
+    CHECK(BitBand_TestAndClear(checkFlags, FLAG_ERROR) == 0u);
+    CHECK(checkFlags.bits == 0u);
+}
+
+/** An ISR inside the LDREX/STREX window of each race the protocol has to survive. */
+static void CheckRaces(void)
+{
+    /* ISR sets another flag of the same word: the clear must not write it back as 0. */
+    checkFlags.bits = 0u;
+    BitBand_Set(checkFlags, FLAG_RX_DONE);
+    isrMask = 1uL << FLAG_TX_DONE;
+    CyEmu_SetPreemptHook(FlagIsr);
+    CHECK(BitBand_TestAndClear(checkFlags, FLAG_RX_DONE) == 1u);
+    CHECK(BitBand_Test(checkFlags, FLAG_TX_DONE) == 1u);
+    CHECK(BitBand_Test(checkFlags, FLAG_RX_DONE) == 0u);
+
+    /* ISR sets the flag just after main saw it clear: it stays pending for the next poll. */
+    checkFlags.bits = 0u;
+    isrMask = 1uL << FLAG_RX_DONE;
+    CyEmu_SetPreemptHook(FlagIsr);
+    CHECK(BitBand_TestAndClear(checkFlags, FLAG_RX_DONE) == 0u);
+    CHECK(BitBand_TestAndClear(checkFlags, FLAG_RX_DONE) == 1u);
+
+    /* ISR sets the flag again while it is pending: one event, reported once. */
+    checkFlags.bits = 0u;
+    BitBand_Set(checkFlags, FLAG_RX_DONE);
+    CyEmu_SetPreemptHook(FlagIsr);
+    CHECK(BitBand_TestAndClear(checkFlags, FLAG_RX_DONE) == 1u);
+    CHECK(BitBand_TestAndClear(checkFlags, FLAG_RX_DONE) == 0u);
+}
+
+/**
+ * Random ISR bursts, in and between the main loop's test-and-clear calls. Every set that found
+ * its flag clear is one event and must be consumed exactly once.
+ */
+static void CheckStress(uint32 iterations)
+{
+    uint32 i;
+    uint32 bit;
+
+    checkFlags.bits = 0u;
+    memset(produced, 0, sizeof(produced));
+    memset(consumed, 0, sizeof(consumed));
+    srand(1u);
+    for (i = 0u; i < iterations; i++)
+    {
+        isrMask = ((uint32)rand() << 16) ^ (uint32)rand();
+        if ((rand() & 1) != 0)
+            CyEmu_SetPreemptHook(FlagIsr);
+        else
+            FlagIsr();
+
+        for (bit = 0u; bit < 32u; bit++)
+            if (BitBand_TestAndClear(checkFlags, bit))
+                consumed[bit]++;
+    }
+    CyEmu_SetPreemptHook(NULL);
+    for (bit = 0u; bit < 32u; bit++)
+        if (BitBand_TestAndClear(checkFlags, bit))
+            consumed[bit]++;
+
+    for (bit = 0u; bit < 32u; bit++)
+        CHECK(produced[bit] == consumed[bit]);
+}
+
+int main(int argc, char **argv)
+{
+    uint32 iterations = (argc > 1) ? (uint32)strtoul(argv[1], NULL, 0) : 100000u;
+    uint32 events = 0u;
+    uint32 bit;
+
+    CyEmu_Init();
+    CheckSingleBits();
+    CheckRaces();
+    CheckStress(iterations);
+
+    for (bit = 0u; bit < 32u; bit++)
+        events += produced[bit];
+    printf("checks=%u failures=%u events=%u\n", (unsigned)checkCount, (unsigned)checkFailures,
+           (unsigned)events);
+    return (checkFailures == 0u) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
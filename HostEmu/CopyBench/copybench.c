@@ -0,0 +1,640 @@
+/**
+ * @file
+ * @brief Copy-strategy benchmark for the CopyWith*() functions of PSOC_SPI_DMA main.c.
+ *
+ * Sweeps size 1..4095 (the 12-bit TD transfer count), source and destination alignment 0..3 and
+ * .ram / .ram2 placement of both buffers, and reports per case which strategy finishes first and
+ * the sizes at which one strategy overtakes the other. Built and run by HostEmu/Makefile
+ * (make -C HostEmu copybench):
+ *
+ *     copybench [--csv]
+ *
+ * The CPU strategies are estimated from the Thumb-2 sequences GCC emits for them at -O3 with the
+ * Cortex-M3 timings of CyEmu.h; the sequence each estimate assumes is listed next to it. memcpy()
+ * is newlib-nano's (the projects link with "Use Newlib Nano"), which is a byte loop. The DMA
+ * strategy is FastCopy_Dma() of Common/FastCopy.h running on the DMAC model: one TD rewritten with
+ * Common/DmaTdFast.h stores, a whole-TD burst, a CPU request and a poll for completion.
+ *
+ * Every run also checks FastCopy(): all backends and the runtime dispatch at every size,
+ * alignment and placement, and the compile-time path at the sizes around its thresholds.
+ *
+ * Two costs are reported: cpu, the clocks the CPU is busy, and latency, the clocks until the
+ * data is in the destination. Winners and crossovers are picked on latency; the DMA crossover on
+ * cpu is listed separately for callers that overlap the transfer with other work.
+ *
+ * The FastCopy.h thresholds come from the ladders: the cases are split into co-aligned source
+ * and destination and the others, and each class gets the one contiguous size range per backend,
+ * in the order FastCopy_Dispatch() steps through them, that adds the least latency over the
+ * fastest backend of every size and case, summed. The per-case crossovers above are noisy around
+ * the DMA switch, the sum is not. The process exits nonzero on any mismatch, or when the
+ * thresholds in FastCopy.h are not the fitted ones (stale_thresholds).
+ */
+#include "CyDmac.h"
+#include "CyEmu.h"
+
+#include "../../Common/FastCopy.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define COPYBENCH_MAX_SIZE (4095u) /**< largest TD transfer count */
+#define COPYBENCH_BUF_SIZE (COPYBENCH_MAX_SIZE + 4u)
+#define COPYBENCH_DMA_CH (0u)
+
+typedef enum
+{
+    COPYBENCH_LOOP,
+    COPYBENCH_MEMCPY,
+    COPYBENCH_WORDS,
+    COPYBENCH_LDMSTM,
+    COPYBENCH_DMA,
+    COPYBENCH_NUM_STRATEGIES
+} CopyBench_Strategy;
+
+static const char *const copyBenchName[COPYBENCH_NUM_STRATEGIES] = {"loop", "memcpy", "words",
+                                                                    "ldmstm", "dma"};
+
+static uint8 ramSrc[COPYBENCH_BUF_SIZE] __attribute__((aligned(4)));
+static uint8 ramDst[COPYBENCH_BUF_SIZE] __attribute__((aligned(4)));
+static uint8 ram2Src[COPYBENCH_BUF_SIZE] __attribute__((aligned(4), section(".ram2")));
+static uint8 ram2Dst[COPYBENCH_BUF_SIZE] __attribute__((aligned(4), section(".ram2")));
+
+typedef struct
+{
+    const char *name;
+    uint8 *src;
+    uint8 *dst;
+} CopyBench_Placement;
+
+static const CopyBench_Placement copyBenchPlacement[] = {
+    {"ram->ram", ramSrc, ramDst},
+    {"ram->ram2", ramSrc, ram2Dst},
+    {"ram2->ram", ram2Src, ramDst},
+    {"ram2->ram2", ram2Src, ram2Dst},
+};
+#define COPYBENCH_NUM_PLACEMENTS (sizeof(copyBenchPlacement) / sizeof(copyBenchPlacement[0]))
+
+/* Costs of one (placement, alignment) case, indexed by size. Heap allocated: .bss is the
+   emulated 32KB .ram half. */
+typedef uint32 CopyBench_Costs[COPYBENCH_MAX_SIZE + 1u];
+static CopyBench_Costs *copyBenchCpu;
+static CopyBench_Costs *copyBenchLatency;
+
+static uint32 copyBenchMismatches;
+
+/* The backends FastCopy_Dispatch() steps through as the size grows, per class: [0] src and dst
+   co-aligned, [1] the others, which have no LDM/STM path */
+#define COPYBENCH_CLASSES (2u)
+#define COPYBENCH_LADDER_MAX (4u)
+static const uint8 copyBenchLadder[COPYBENCH_CLASSES][COPYBENCH_LADDER_MAX] = {
+    {COPYBENCH_LOOP, COPYBENCH_WORDS, COPYBENCH_LDMSTM, COPYBENCH_DMA},
+    {COPYBENCH_LOOP, COPYBENCH_WORDS, COPYBENCH_DMA}};
+static const uint8 copyBenchLadderSteps[COPYBENCH_CLASSES] = {4u, 3u};
+
+/* Latency of each ladder backend over the fastest of them, summed over the cases of a class */
+typedef uint64 CopyBench_Excess[COPYBENCH_LADDER_MAX][COPYBENCH_MAX_SIZE + 1u];
+static CopyBench_Excess *copyBenchExcess;
+
+/*******************************************************************************
+ * Cortex-M3 estimates
+ ******************************************************************************/
+
+/** Wait states of one data access at @p addr. */
+static uint32 CopyBench_Ws(uint32 addr)
+{
+    return (addr >= CYREG_SRAM_DATA_MBASE) ? CYEMU_M3_RAM2_WAIT_STATES : CYEMU_M3_RAM_WAIT_STATES;
+}
+
+/**
+ * Byte loop body, @p alu extra ALU instructions per iteration:
+ *     loop: ldrb r3, [r1], #1 ; strb r3, [r0], #1 ; <alu> ; bne loop
+ */
+static uint32 CopyBench_Bytes(uint32 src, uint32 dst, uint32 n, uint32 alu)
+{
+    uint32 body = CYEMU_M3_LOAD + CopyBench_Ws(src) + CYEMU_M3_PIPELINED_ACCESS +
+                  CopyBench_Ws(dst) + alu * CYEMU_M3_ALU;
+
+    if (n == 0u)
+        return 0u;
+    return n * body + (n - 1u) * CYEMU_M3_BRANCH_TAKEN + CYEMU_M3_BRANCH_NOT_TAKEN;
+}
+
+/**
+ * Word loop body, source may be unaligned, destination is aligned:
+ *     loop: ldr r3, [r1], #4 ; str r3, [r0], #4 ; subs r2, #4 ; cmp r2, #3 ; bhi loop
+ */
+static uint32 CopyBench_Words(uint32 src, uint32 dst, uint32 n)
+{
+    uint32 words = n / 4u;
+    uint32 body = CYEMU_M3_LOAD + CopyBench_Ws(src) + ((src & 3u) ? CYEMU_M3_UNALIGNED_EXTRA : 0u) +
+                  CYEMU_M3_PIPELINED_ACCESS + CopyBench_Ws(dst) + 2u * CYEMU_M3_ALU;
+
+    if (words == 0u)
+        return CYEMU_M3_ALU + CYEMU_M3_BRANCH_NOT_TAKEN;
+    return CYEMU_M3_ALU + words * body + (words - 1u) * CYEMU_M3_BRANCH_TAKEN +
+           CYEMU_M3_BRANCH_NOT_TAKEN;
+}
+
+/**
+ * CopyWithLoop(), inlined:
+ *     adds r2, r0, r2 ; cbz ... ; <byte loop, cmp r0, r2>
+ */
+static uint32 CopyBench_CostLoop(uint32 src, uint32 dst, uint32 n)
+{
+    return 2u * CYEMU_M3_ALU + CopyBench_Bytes(src, dst, n, 1u);
+}
+
+/**
+ * CopyWithMemcpy(), newlib-nano memcpy():
+ *     movs r0..r2 ; bl memcpy ; push {r4, lr} ; 2x setup
+ *     loop: cmp r1, r2 ; beq done ; ldrb r4, [r1], #1 ; strb r4, [r3, #1]! ; b loop
+ *     done: pop {r4, pc}
+ */
+static uint32 CopyBench_CostMemcpy(uint32 src, uint32 dst, uint32 n)
+{
+    uint32 body = CYEMU_M3_ALU + CYEMU_M3_BRANCH_NOT_TAKEN + CYEMU_M3_LOAD + CopyBench_Ws(src) +
+                  CYEMU_M3_PIPELINED_ACCESS + CopyBench_Ws(dst) + CYEMU_M3_BRANCH_TAKEN;
+
+    return 3u * CYEMU_M3_ALU + CYEMU_M3_CALL + CYEMU_M3_LDM_STM(2u) + 2u * CYEMU_M3_ALU +
+           n * body + CYEMU_M3_ALU + CYEMU_M3_BRANCH_TAKEN + CYEMU_M3_POP_PC(2u);
+}
+
+/** Bytes copied one by one until dest is word aligned. */
+static uint32 CopyBench_Head(uint32 dst, uint32 n)
+{
+    uint32 head = (4u - (dst & 3u)) & 3u;
+
+    return (head < n) ? head : n;
+}
+
+/**
+ * CopyWithWords(): head bytes until dest is aligned (cbz/tst + byte loop), word loop, tail bytes.
+ */
+static uint32 CopyBench_CostWords(uint32 src, uint32 dst, uint32 n)
+{
+    uint32 head = CopyBench_Head(dst, n);
+    uint32 words = (n - head) & ~3u;
+    uint32 tail = n - head - words;
+    uint32 cycles = 2u * (CYEMU_M3_ALU + CYEMU_M3_BRANCH_NOT_TAKEN);
+
+    cycles += CopyBench_Bytes(src, dst, head, 2u);
+    cycles += CopyBench_Words(src + head, dst + head, words);
+    cycles += CopyBench_Bytes(src + head + words, dst + head + words, tail, 1u);
+    return cycles;
+}
+
+/**
+ * CopyWithLdmStm(): head bytes, then when src is aligned too
+ *     push {r4-r7}
+ *     loop: ldmia r1!, {r4-r7} ; stmia r0!, {r4-r7} ; subs r2, #16 ; cmp r2, #15 ; bhi loop
+ *     pop {r4-r7}
+ * followed by the word loop and tail bytes of CopyWithWords().
+ */
+static uint32 CopyBench_CostLdmStm(uint32 src, uint32 dst, uint32 n)
+{
+    uint32 head = CopyBench_Head(dst, n);
+    uint32 cycles = 2u * (CYEMU_M3_ALU + CYEMU_M3_BRANCH_NOT_TAKEN);
+    uint32 done = head;
+    uint32 words;
+
+    cycles += CopyBench_Bytes(src, dst, head, 2u);
+    cycles += CYEMU_M3_ALU + CYEMU_M3_BRANCH_NOT_TAKEN; /* tst src, #3 */
+    if (((src + head) & 3u) == 0u)
+    {
+        uint32 blocks = (n - head) / 16u;
+        uint32 body = 2u * CYEMU_M3_LDM_STM(4u) + 4u * CopyBench_Ws(src) + 4u * CopyBench_Ws(dst) +
+                      2u * CYEMU_M3_ALU;
+
+        cycles += 2u * CYEMU_M3_LDM_STM(4u) + CYEMU_M3_ALU;
+        if (blocks != 0u)
+            cycles += blocks * body + (blocks - 1u) * CYEMU_M3_BRANCH_TAKEN +
+                      CYEMU_M3_BRANCH_NOT_TAKEN;
+        else
+            cycles += CYEMU_M3_BRANCH_NOT_TAKEN;
+        done += blocks * 16u;
+    }
+    words = (n - done) & ~3u;
+    cycles += CopyBench_Words(src + done, dst + done, words);
+    done += words;
+    cycles += CopyBench_Bytes(src + done, dst + done, n - done, 1u);
+    return cycles;
+}
+
+/*******************************************************************************
+ * DMA, run through the DMAC model
+ ******************************************************************************/
+
+/** Channel as FastCopy_DmaInit() expects it: SRAM both sides, one burst per TD. */
+static void CopyBench_DmaSetup(void)
+{
+    uint8 ch;
+
+    CyDmaEmu_Reset();
+    ch = CyDmaEmu_DmaInitialize(COPYBENCH_DMA_CH, 0u, 0u, HI16(CYDEV_SRAM_BASE),
+                                HI16(CYDEV_SRAM_BASE));
+    FastCopy_DmaInit(ch, CyDmaTdAllocate());
+}
+
+/** One FastCopy_Dma(); cpu excludes the completion poll. */
+static void CopyBench_Dma(uint8 *src, uint8 *dst, uint32 n, uint32 *cpu, uint32 *latency)
+{
+    uint64 start = CyEmu_Now();
+    uint64 wait = CyDmaEmu_GetStats(COPYBENCH_DMA_CH)->waitCycles;
+
+    memset(dst, 0, n);
+    FastCopy_Dma(dst, src, n);
+    *latency = (uint32)(CyEmu_Now() - start);
+    *cpu = *latency - (uint32)(CyDmaEmu_GetStats(COPYBENCH_DMA_CH)->waitCycles - wait);
+
+    if (memcmp(dst, src, n) != 0)
+        copyBenchMismatches++;
+}
+
+/*******************************************************************************
+ * FastCopy() correctness
+ ******************************************************************************/
+
+#define COPYBENCH_GUARD (0xA5u)
+
+/** Copies with @p fn and checks the data and the bytes on both sides of the destination. */
+static void CopyBench_Check(void (*fn)(void *, const void *, size_t), const char *name,
+                            uint8 *src, uint8 *dst, uint32 n)
+{
+    memset(dst - 1, COPYBENCH_GUARD, n + 2u);
+    fn(dst, src, n);
+    if ((memcmp(dst, src, n) != 0) || (dst[-1] != COPYBENCH_GUARD) || (dst[n] != COPYBENCH_GUARD))
+    {
+        if (copyBenchMismatches++ < 10u)
+            printf("mismatch: %s src=0x%08x dst=0x%08x n=%u\n", name, (unsigned)(uint32)src,
+                   (unsigned)(uint32)dst, (unsigned)n);
+    }
+}
+
+/* Constant sizes around every threshold, each expands its own FastCopy_Const() */
+#define COPYBENCH_CONST_SIZES(X)                                                                   \
+    X(1) X(2) X(3) X(4) X(5) X(6) X(7) X(8) X(15) X(16) X(17) X(18) X(19) X(20) X(31) X(32)       \
+    X(131) X(132) X(133) X(328) X(329) X(330) X(1000) X(4092) X(4093)
+
+#define COPYBENCH_CHECK_CONST(N)                                                                   \
+    memset(dst - 1, COPYBENCH_GUARD, (N) + 2u);                                                    \
+    FastCopy(dst, src, (N));                                                                       \
+    if ((memcmp(dst, src, (N)) != 0) || (dst[-1] != COPYBENCH_GUARD) ||                           \
+        (dst[(N)] != COPYBENCH_GUARD))                                                             \
+        copyBenchMismatches++;                                                                     \
+    memset(alignedDst - 1, COPYBENCH_GUARD, (N) + 2u);                                             \
+    FastCopy(alignedDst, alignedSrc, (N));                                                         \
+    if ((memcmp(alignedDst, alignedSrc, (N)) != 0) || (alignedDst[-1] != COPYBENCH_GUARD) ||      \
+        (alignedDst[(N)] != COPYBENCH_GUARD))                                                      \
+        copyBenchMismatches++;
+
+/**
+ * Every backend and the runtime dispatch at every size, alignment and placement, then the
+ * compile-time path at the constant sizes. Destinations start one byte in, so dst[-1] exists.
+ */
+static void CopyBench_Verify(void)
+{
+    static uint8 alignedSrcBuf[COPYBENCH_BUF_SIZE] __attribute__((aligned(4)));
+    uint8 *alignedSrc = alignedSrcBuf;
+    uint8 *alignedDst = ram2Dst + 4u;
+    uint32 p;
+
+    for (p = 0u; p < COPYBENCH_NUM_PLACEMENTS; p++)
+    {
+        uint32 srcAlign;
+        uint32 dstAlign;
+        uint32 n;
+
+        for (srcAlign = 0u; srcAlign < 4u; srcAlign++)
+        {
+            for (dstAlign = 1u; dstAlign < 5u; dstAlign++)
+            {
+                uint8 *src = copyBenchPlacement[p].src + srcAlign;
+                uint8 *dst = copyBenchPlacement[p].dst + dstAlign;
+
+                for (n = 0u; n <= (COPYBENCH_MAX_SIZE - 4u); n++)
+                {
+                    CopyBench_Check(FastCopy_Bytes, "bytes", src, dst, n);
+                    CopyBench_Check(FastCopy_Words, "words", src, dst, n);
+                    CopyBench_Check(FastCopy_LdmStm, "ldmstm", src, dst, n);
+                    CopyBench_Check(FastCopy_Dma, "dma", src, dst, n);
+                    CopyBench_Check(FastCopy_Dispatch, "dispatch", src, dst, n);
+                }
+            }
+        }
+    }
+
+    for (p = 0u; p < 4u; p++)
+    {
+        uint8 *src = ramSrc + p;
+        uint8 *dst = ram2Dst + 1u + (p ^ 1u);
+
+        memcpy(alignedSrcBuf, ram2Src, sizeof(alignedSrcBuf));
+        COPYBENCH_CONST_SIZES(COPYBENCH_CHECK_CONST)
+    }
+}
+
+/*******************************************************************************
+ * Sweep and report
+ ******************************************************************************/
+
+static void CopyBench_RunCase(const CopyBench_Placement *p, uint32 srcAlign, uint32 dstAlign)
+{
+    uint8 *src = p->src + srcAlign;
+    uint8 *dst = p->dst + dstAlign;
+    uint32 s = (uint32)src;
+    uint32 d = (uint32)dst;
+    uint32 n;
+
+    for (n = 1u; n <= COPYBENCH_MAX_SIZE; n++)
+    {
+        copyBenchCpu[COPYBENCH_LOOP][n] = CopyBench_CostLoop(s, d, n);
+        copyBenchCpu[COPYBENCH_MEMCPY][n] = CopyBench_CostMemcpy(s, d, n);
+        copyBenchCpu[COPYBENCH_WORDS][n] = CopyBench_CostWords(s, d, n);
+        copyBenchCpu[COPYBENCH_LDMSTM][n] = CopyBench_CostLdmStm(s, d, n);
+        copyBenchLatency[COPYBENCH_LOOP][n] = copyBenchCpu[COPYBENCH_LOOP][n];
+        copyBenchLatency[COPYBENCH_MEMCPY][n] = copyBenchCpu[COPYBENCH_MEMCPY][n];
+        copyBenchLatency[COPYBENCH_WORDS][n] = copyBenchCpu[COPYBENCH_WORDS][n];
+        copyBenchLatency[COPYBENCH_LDMSTM][n] = copyBenchCpu[COPYBENCH_LDMSTM][n];
+        CopyBench_Dma(src, dst, n, &copyBenchCpu[COPYBENCH_DMA][n],
+                      &copyBenchLatency[COPYBENCH_DMA][n]);
+    }
+}
+
+/** Adds the case just run to the excess latency of its class. */
+static void CopyBench_AddExcess(uint32 k)
+{
+    uint32 n;
+    uint32 j;
+
+    for (n = 1u; n <= COPYBENCH_MAX_SIZE; n++)
+    {
+        uint32 best = copyBenchLatency[copyBenchLadder[k][0]][n];
+
+        for (j = 1u; j < copyBenchLadderSteps[k]; j++)
+            if (copyBenchLatency[copyBenchLadder[k][j]][n] < best)
+                best = copyBenchLatency[copyBenchLadder[k][j]][n];
+        for (j = 0u; j < copyBenchLadderSteps[k]; j++)
+            copyBenchExcess[k][j][n] += copyBenchLatency[copyBenchLadder[k][j]][n] - best;
+    }
+}
+
+/**
+ * Thresholds of the ladder of class @p k: each backend takes one contiguous size range, in
+ * ladder order, and the ranges are those with the least excess latency summed over all sizes
+ * and cases of the class. @p start gets the first size of each backend, COPYBENCH_MAX_SIZE + 1
+ * for one that never pays off. Returns the excess latency left, in bus clocks.
+ */
+static uint64 CopyBench_FitLadder(uint32 k, uint32 *start)
+{
+    uint32 steps = copyBenchLadderSteps[k];
+    uint64 *dp = calloc(COPYBENCH_LADDER_MAX * (COPYBENCH_MAX_SIZE + 1u), sizeof(uint64));
+    uint8 *moved = calloc(COPYBENCH_LADDER_MAX * (COPYBENCH_MAX_SIZE + 1u), sizeof(uint8));
+    uint64 excess;
+    uint32 last = 0u;
+    uint32 n;
+    uint32 j;
+
+#define COPYBENCH_AT(a, j, n) ((a)[(j) * (COPYBENCH_MAX_SIZE + 1u) + (n)])
+    if ((dp == NULL) || (moved == NULL))
+        exit(EXIT_FAILURE);
+    /* dp(j, n): least excess of sizes 1..n with backend j on size n. Ties keep the simpler
+       backend, so a switch only happens where it gains. */
+    for (n = 1u; n <= COPYBENCH_MAX_SIZE; n++)
+    {
+        for (j = 0u; j < steps; j++)
+        {
+            uint64 stay = (n == 1u) ? ((j == 0u) ? 0u : UINT64_MAX) : COPYBENCH_AT(dp, j, n - 1u);
+            uint64 step = ((j == 0u) || (n == 1u)) ? UINT64_MAX : COPYBENCH_AT(dp, j - 1u, n - 1u);
+
+            COPYBENCH_AT(moved, j, n) = (uint8)(step <= stay);
+            COPYBENCH_AT(dp, j, n) = (((step <= stay) ? step : stay) == UINT64_MAX)
+                                         ? UINT64_MAX
+                                         : ((step <= stay) ? step : stay) +
+                                               copyBenchExcess[k][j][n];
+        }
+    }
+    for (j = 1u; j < steps; j++)
+        if (COPYBENCH_AT(dp, j, COPYBENCH_MAX_SIZE) < COPYBENCH_AT(dp, last, COPYBENCH_MAX_SIZE))
+            last = j;
+    excess = COPYBENCH_AT(dp, last, COPYBENCH_MAX_SIZE);
+
+    for (j = 0u; j < COPYBENCH_LADDER_MAX; j++)
+        start[j] = COPYBENCH_MAX_SIZE + 1u;
+    start[0] = 1u;
+    for (n = COPYBENCH_MAX_SIZE, j = last; j > 0u; n--)
+    {
+        if (COPYBENCH_AT(moved, j, n))
+        {
+            start[j] = n;
+            j--;
+        }
+    }
+#undef COPYBENCH_AT
+    free(dp);
+    free(moved);
+    return excess;
+}
+
+/** Cheapest strategy at size @p n, ties go to the simpler (lower) one. */
+static uint32 CopyBench_Winner(const CopyBench_Costs *table, uint32 n)
+{
+    uint32 best = 0u;
+    uint32 i;
+
+    for (i = 1u; i < COPYBENCH_NUM_STRATEGIES; i++)
+        if (table[i][n] < table[best][n])
+            best = i;
+    return best;
+}
+
+/**
+ * Smallest size from which @p b is cheaper than @p a for every larger size, 0 if it never is.
+ */
+static uint32 CopyBench_Crossover(const CopyBench_Costs *table, uint32 a, uint32 b)
+{
+    uint32 n;
+
+    if (table[b][COPYBENCH_MAX_SIZE] >= table[a][COPYBENCH_MAX_SIZE])
+        return 0u;
+    for (n = COPYBENCH_MAX_SIZE; n > 1u; n--)
+        if (table[b][n - 1u] >= table[a][n - 1u])
+            break;
+    return n;
+}
+
+/** Cheapest of the CPU strategies at every size, the DMA crossover baseline. */
+static void CopyBench_BestCpu(const CopyBench_Costs *table, uint32 *best)
+{
+    uint32 n;
+    uint32 i;
+
+    for (n = 1u; n <= COPYBENCH_MAX_SIZE; n++)
+    {
+        best[n] = table[0][n];
+        for (i = 1u; i < COPYBENCH_DMA; i++)
+            if (table[i][n] < best[n])
+                best[n] = table[i][n];
+    }
+}
+
+static uint32 CopyBench_DmaCrossover(const CopyBench_Costs *table)
+{
+    CopyBench_Costs best;
+    uint32 n;
+
+    CopyBench_BestCpu(table, best);
+    if (table[COPYBENCH_DMA][COPYBENCH_MAX_SIZE] >= best[COPYBENCH_MAX_SIZE])
+        return 0u;
+    for (n = COPYBENCH_MAX_SIZE; n > 1u; n--)
+        if (table[COPYBENCH_DMA][n - 1u] >= best[n - 1u])
+            break;
+    return n;
+}
+
+static void CopyBench_PrintRanges(const char *placement, uint32 srcAlign, uint32 dstAlign)
+{
+    uint32 start = 1u;
+    uint32 n;
+
+    printf("%-10s  %u  %u  ", placement, (unsigned)srcAlign, (unsigned)dstAlign);
+    for (n = 2u; n <= (COPYBENCH_MAX_SIZE + 1u); n++)
+    {
+        uint32 w = CopyBench_Winner(copyBenchLatency, start);
+        if ((n > COPYBENCH_MAX_SIZE) || (CopyBench_Winner(copyBenchLatency, n) != w))
+        {
+            printf(" %u-%u:%s", (unsigned)start, (unsigned)(n - 1u), copyBenchName[w]);
+            start = n;
+        }
+    }
+    printf("\n");
+}
+
+static void CopyBench_PrintCsv(const char *placement, uint32 srcAlign, uint32 dstAlign)
+{
+    uint32 n;
+    uint32 i;
+
+    for (n = 1u; n <= COPYBENCH_MAX_SIZE; n++)
+        for (i = 0u; i < COPYBENCH_NUM_STRATEGIES; i++)
+            printf("%s,%u,%u,%u,%s,%u,%u\n", placement, (unsigned)srcAlign, (unsigned)dstAlign,
+                   (unsigned)n, copyBenchName[i], (unsigned)copyBenchCpu[i][n],
+                   (unsigned)copyBenchLatency[i][n]);
+}
+
+int main(int argc, char **argv)
+{
+    uint8 csv = (uint8)((argc > 1) && (strcmp(argv[1], "--csv") == 0));
+    /* Worst (largest) crossovers over all cases, [0] co-aligned pairs, [1] the others */
+    uint32 wordsMin[2] = {0u, 0u};
+    uint32 ldmStmMin[2] = {0u, 0u};
+    uint32 dmaMin[2] = {0u, 0u};
+    uint32 dmaCpuMin[2] = {0u, 0u};
+    /* The thresholds of FastCopy.h, as the ladders should have them */
+    const uint32 header[COPYBENCH_CLASSES][COPYBENCH_LADDER_MAX] = {
+        {1u, FAST_COPY_WORDS_MIN, FAST_COPY_LDMSTM_MIN, FAST_COPY_DMA_MIN},
+        {1u, FAST_COPY_WORDS_MIN, FAST_COPY_DMA_MIN_MISALIGNED, COPYBENCH_MAX_SIZE + 1u}};
+    uint32 start[COPYBENCH_CLASSES][COPYBENCH_LADDER_MAX];
+    uint64 excess[COPYBENCH_CLASSES];
+    uint32 stale = 0u;
+    uint32 p;
+    uint32 i;
+
+    CyEmu_Init();
+    copyBenchCpu = calloc(COPYBENCH_NUM_STRATEGIES, sizeof(CopyBench_Costs));
+    copyBenchLatency = calloc(COPYBENCH_NUM_STRATEGIES, sizeof(CopyBench_Costs));
+    copyBenchExcess = calloc(COPYBENCH_CLASSES, sizeof(CopyBench_Excess));
+    if ((copyBenchCpu == NULL) || (copyBenchLatency == NULL) || (copyBenchExcess == NULL))
+        return EXIT_FAILURE;
+    for (i = 0u; i < COPYBENCH_BUF_SIZE; i++)
+    {
+        ramSrc[i] = (uint8)(i * 7u + 1u);
+        ram2Src[i] = (uint8)(i * 13u + 5u);
+    }
+
+    CopyBench_DmaSetup();
+    if (csv)
+        printf("placement,src_align,dst_align,size,strategy,cpu_cycles,latency_cycles\n");
+    else
+        printf("placement  src dst  fastest strategy by size (latency)\n");
+
+    for (p = 0u; p < COPYBENCH_NUM_PLACEMENTS; p++)
+    {
+        uint32 srcAlign;
+        uint32 dstAlign;
+
+        for (srcAlign = 0u; srcAlign < 4u; srcAlign++)
+        {
+            for (dstAlign = 0u; dstAlign < 4u; dstAlign++)
+            {
+                uint32 k = (srcAlign == dstAlign) ? 0u : 1u;
+                uint32 x;
+
+                CopyBench_RunCase(&copyBenchPlacement[p], srcAlign, dstAlign);
+                CopyBench_AddExcess(((srcAlign ^ dstAlign) == 0u) ? 0u : 1u);
+                if (csv)
+                {
+                    CopyBench_PrintCsv(copyBenchPlacement[p].name, srcAlign, dstAlign);
+                    continue;
+                }
+                CopyBench_PrintRanges(copyBenchPlacement[p].name, srcAlign, dstAlign);
+
+                x = CopyBench_Crossover(copyBenchLatency, COPYBENCH_LOOP, COPYBENCH_WORDS);
+                wordsMin[k] = (x > wordsMin[k]) ? x : wordsMin[k];
+                x = CopyBench_Crossover(copyBenchLatency, COPYBENCH_WORDS, COPYBENCH_LDMSTM);
+                ldmStmMin[k] = (x > ldmStmMin[k]) ? x : ldmStmMin[k];
+                x = CopyBench_DmaCrossover(copyBenchLatency);
+                dmaMin[k] = (x > dmaMin[k]) ? x : dmaMin[k];
+                x = CopyBench_DmaCrossover(copyBenchCpu);
+                dmaCpuMin[k] = (x > dmaCpuMin[k]) ? x : dmaCpuMin[k];
+            }
+        }
+    }
+
+    CopyBench_Verify();
+    for (i = 0u; i < COPYBENCH_CLASSES; i++)
+    {
+        uint32 j;
+
+        excess[i] = CopyBench_FitLadder(i, start[i]);
+        for (j = 0u; j < copyBenchLadderSteps[i]; j++)
+            if (start[i][j] != header[i][j])
+                stale++;
+    }
+    if (!csv)
+    {
+        /* One contiguous range per backend, the thresholds FastCopy.h has to carry */
+        printf("\nladders (bytes, fitted on the latency summed over every case of the class)\n");
+        for (i = 0u; i < COPYBENCH_CLASSES; i++)
+        {
+            uint32 j;
+
+            printf("%s:", (i == 0u) ? "co-aligned" : "misaligned");
+            for (j = 0u; j < copyBenchLadderSteps[i]; j++)
+            {
+                uint32 end = (j + 1u < copyBenchLadderSteps[i]) ? start[i][j + 1u] - 1u
+                                                                 : COPYBENCH_MAX_SIZE;
+
+                if (start[i][j] <= end)
+                    printf(" %u-%u:%s", (unsigned)start[i][j], (unsigned)end,
+                           copyBenchName[copyBenchLadder[i][j]]);
+            }
+            printf(" excess_cycles=%llu\n", (unsigned long long)excess[i]);
+        }
+
+        /* Crossover sizes valid for every placement, 0 means the faster strategy never wins */
+        printf("\ncrossovers (bytes, 0 = never)\n");
+        printf("co-aligned: loop->words=%u words->ldmstm=%u cpu->dma=%u cpu->dma(cpu only)=%u\n",
+               (unsigned)wordsMin[0], (unsigned)ldmStmMin[0], (unsigned)dmaMin[0],
+               (unsigned)dmaCpuMin[0]);
+        printf("misaligned: loop->words=%u words->ldmstm=%u cpu->dma=%u cpu->dma(cpu only)=%u\n",
+               (unsigned)wordsMin[1], (unsigned)ldmStmMin[1], (unsigned)dmaMin[1],
+               (unsigned)dmaCpuMin[1]);
+        printf("words_min=%u ldmstm_min=%u dma_min=%u words_min_misaligned=%u "
+               "dma_min_misaligned=%u dma_cpu_min=%u stale_thresholds=%u mismatches=%u\n",
+               (unsigned)start[0][1], (unsigned)start[0][2], (unsigned)start[0][3],
+               (unsigned)start[1][1], (unsigned)start[1][2], (unsigned)dmaCpuMin[0],
+               (unsigned)stale, (unsigned)copyBenchMismatches);
+    }
+    return ((copyBenchMismatches == 0u) && (stale == 0u)) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,1168 @@
+/**
+ * @file
+ * @brief Filter design to dfb.v2 code, see DfbGen.h.
+ */
+#include "DfbGen.h"
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define DFBGEN_Q23 (8388608.0)
+#define DFBGEN_MAX24 (0x7FFFFF)
+#define DFBGEN_MIN24 (-0x800000)
+#define DFBGEN_MASK48 (0xFFFFFFFFFFFFuLL)
+#define DFBGEN_BIQUAD_WORDS (5u) /* coefficients of a section */
+#define DFBGEN_RING_STEP (2u)    /* freg of the biquad ring, see DfbGen_EmitIir() */
+#define DFBGEN_LINE (256u)
+#define DFBGEN_DECIMATE_CODE (14u) /* instructions of a decimating FIR besides its MACs */
+
+/* Generated text */
+typedef struct
+{
+    char *text;
+    uint32 size;
+    uint32 length;
+    uint8 overflow;
+} DfbGen_Out;
+
+/* A channel as DfbGen_Emit() writes it */
+typedef struct
+{
+    const DfbGen_Channel *ch;
+    const char *name; /* "ChA", "ChB" */
+    uint8 s;          /* sample side, 0 for A */
+    uint8 dual;
+} DfbGen_Ctx;
+
+static cystatus DfbGen_Fail(char *error, uint32 errorSize, const char *format, ...)
+{
+    va_list args;
+
+    if ((error != NULL) && (errorSize != 0u))
+    {
+        va_start(args, format);
+        (void)vsnprintf(error, errorSize, format, args);
+        va_end(args);
+    }
+    return CYRET_BAD_DATA;
+}
+
+/* ---- Designs ---- */
+
+static double DfbGen_Window(const char *window, uint32 k, uint32 n)
+{
+    double x = (n > 1u) ? 2.0 * M_PI * k / (n - 1u) : 0.0;
+
+    if (strcmp(window, "hann") == 0)
+        return 0.5 - 0.5 * cos(x);
+    if (strcmp(window, "blackman") == 0)
+        return 0.42 - 0.5 * cos(x) + 0.08 * cos(2.0 * x);
+    if (strcmp(window, "rect") == 0)
+        return 1.0;
+    return 0.54 - 0.46 * cos(x);
+}
+
+/* Windowed-sinc lowpass at @p fc (fraction of fs) into @p h, unnormalized. */
+static void DfbGen_Sinc(double *h, uint32 n, double fc, const char *window)
+{
+    double m = (n - 1u) / 2.0;
+    uint32 k;
+
+    for (k = 0u; k < n; k++)
+    {
+        double t = k - m;
+
+        h[k] = ((t == 0.0) ? 2.0 * fc : sin(2.0 * M_PI * fc * t) / (M_PI * t)) *
+               DfbGen_Window(window, k, n);
+    }
+}
+
+static cystatus DfbGen_Fir(DfbGen_Filter *filter, const char *response, uint32 taps, double fs,
+                           double f1, double f2, const char *window, char *error,
+                           uint32 errorSize)
+{
+    double lo[DFBGEN_TAPS_MAX];
+    double sum = 0.0;
+    uint8 inverted = (uint8)((strcmp(response, "highpass") == 0) ||
+                             (strcmp(response, "bandstop") == 0));
+    uint8 band = (uint8)((strcmp(response, "bandpass") == 0) ||
+                         (strcmp(response, "bandstop") == 0));
+    uint32 k;
+
+    if (!band && !inverted && (strcmp(response, "lowpass") != 0))
+        return DfbGen_Fail(error, errorSize, "unknown FIR response %s", response);
+    if ((taps < 2u) || (taps > DFBGEN_TAPS_MAX))
+        return DfbGen_Fail(error, errorSize, "taps has to be 2 to %u", (unsigned)DFBGEN_TAPS_MAX);
+    if (inverted && ((taps & 1u) == 0u))
+        return DfbGen_Fail(error, errorSize, "a %s FIR needs an odd number of taps", response);
+    if ((fs <= 0.0) || (f1 <= 0.0) || (f1 >= fs / 2.0) ||
+        (band && ((f2 <= f1) || (f2 >= fs / 2.0))))
+        return DfbGen_Fail(error, errorSize, "the cutoffs have to be between 0 and fs/2");
+
+    filter->kind = DFBGEN_KIND_FIR;
+    filter->taps = (uint16)taps;
+    if (band)
+    {
+        DfbGen_Sinc(lo, taps, f1 / fs, window);
+        DfbGen_Sinc(filter->coef, taps, f2 / fs, window);
+        for (k = 0u; k < taps; k++)
+            filter->coef[k] -= lo[k];
+    }
+    else
+    {
+        /* Unity gain at DC, before a highpass inverts it */
+        DfbGen_Sinc(filter->coef, taps, f1 / fs, window);
+        for (k = 0u; k < taps; k++)
+            sum += filter->coef[k];
+        for (k = 0u; k < taps; k++)
+            filter->coef[k] /= sum;
+    }
+    if (inverted)
+    {
+        for (k = 0u; k < taps; k++)
+            filter->coef[k] = -filter->coef[k];
+        filter->coef[taps / 2u] += 1.0;
+    }
+    return CYRET_SUCCESS;
+}
+
+/* One RBJ biquad, b0 b1 b2 a1 a2 normalized to a0, into @p c. */
+static void DfbGen_Biquad(double *c, const char *response, double fs, double f0, double q)
+{
+    double w = 2.0 * M_PI * f0 / fs;
+    double cw = cos(w);
+    double alpha = sin(w) / (2.0 * q);
+    double a0 = 1.0 + alpha;
+
+    if (strcmp(response, "highpass") == 0)
+    {
+        c[0] = (1.0 + cw) / 2.0;
+        c[1] = -(1.0 + cw);
+        c[2] = c[0];
+    }
+    else if (strcmp(response, "bandpass") == 0)
+    {
+        c[0] = alpha;
+        c[1] = 0.0;
+        c[2] = -alpha;
+    }
+    else if (strcmp(response, "notch") == 0)
+    {
+        c[0] = 1.0;
+        c[1] = -2.0 * cw;
+        c[2] = 1.0;
+    }
+    else
+    {
+        c[0] = (1.0 - cw) / 2.0;
+        c[1] = 1.0 - cw;
+        c[2] = c[0];
+    }
+    c[3] = -2.0 * cw;
+    c[4] = 1.0 - alpha;
+    c[0] /= a0;
+    c[1] /= a0;
+    c[2] /= a0;
+    c[3] /= a0;
+    c[4] /= a0;
+}
+
+static cystatus DfbGen_Iir(DfbGen_Filter *filter, const char *response, uint32 order, double fs,
+                           double f0, double q, char *error, uint32 errorSize)
+{
+    uint8 butterworth =
+        (uint8)((strcmp(response, "lowpass") == 0) || (strcmp(response, "highpass") == 0));
+    uint32 k;
+
+    if (!butterworth && (strcmp(response, "bandpass") != 0) && (strcmp(response, "notch") != 0))
+        return DfbGen_Fail(error, errorSize, "unknown IIR response %s", response);
+    if ((order == 0u) || (order & 1u) || (order / 2u > DFBGEN_SECTIONS_MAX))
+        return DfbGen_Fail(error, errorSize, "order has to be even, 2 to %u",
+                           (unsigned)(2u * DFBGEN_SECTIONS_MAX));
+    if ((fs <= 0.0) || (f0 <= 0.0) || (f0 >= fs / 2.0) || (!butterworth && (q <= 0.0)))
+        return DfbGen_Fail(error, errorSize, "fc has to be between 0 and fs/2, q above 0");
+
+    filter->kind = DFBGEN_KIND_IIR;
+    filter->sections = (uint8)(order / 2u);
+    for (k = 0u; k < filter->sections; k++)
+    {
+        /* Butterworth poles, the lowest Q first so that the peaking sections come last */
+        double qk = butterworth ? 1.0 / (2.0 * cos(M_PI * (2u * k + 1u) / (2.0 * order))) : q;
+
+        DfbGen_Biquad(&filter->coef[k * DFBGEN_BIQUAD_WORDS], response, fs, f0, qk);
+    }
+    return CYRET_SUCCESS;
+}
+
+/* Numbers of @p path into @p values; @p integers is cleared when one of them is a real. */
+static cystatus DfbGen_ReadNumbers(const char *path, double *values, uint32 max, uint32 *count,
+                                   uint8 *integers, char *error, uint32 errorSize)
+{
+    FILE *file = fopen(path, "r");
+    char token[64];
+    uint32 n = 0u;
+
+    if (file == NULL)
+        return DfbGen_Fail(error, errorSize, "cannot open %s", path);
+    *integers = 1u;
+    while (fscanf(file, " %63[^ \t\r\n,;]%*[ \t\r\n,;]", token) == 1)
+    {
+        char *end;
+        double v = strtod(token, &end);
+
+        if (*end != '\0')
+        {
+            (void)fclose(file);
+            return DfbGen_Fail(error, errorSize, "%s: %s is not a number", path, token);
+        }
+        if (n >= max)
+        {
+            (void)fclose(file);
+            return DfbGen_Fail(error, errorSize, "%s: more than %u numbers", path, (unsigned)max);
+        }
+        if (strpbrk(token, ".eE") != NULL)
+            *integers = 0u;
+        values[n++] = v;
+    }
+    (void)fclose(file);
+    *count = n;
+    return CYRET_SUCCESS;
+}
+
+static cystatus DfbGen_Coef(DfbGen_Filter *filter, const char *path, char *error,
+                            uint32 errorSize)
+{
+    size_t length = strlen(path);
+    uint32 n = 0u;
+    uint32 k;
+    uint8 integers = 1u;
+
+    if ((length > 3u) && (strcmp(path + length - 3u, ".v2") == 0))
+    {
+        static DfbEmu_Program program;
+        char message[160];
+
+        if (DfbEmu_AssembleFile(path, &program, message, sizeof(message)) != CYRET_SUCCESS)
+            return DfbGen_Fail(error, errorSize, "%s: %s", path, message);
+        n = program.dataWords[1];
+        for (k = 0u; k < n; k++)
+            filter->coef[k] = DfbEmu_Signed24(program.data[1][k]);
+    }
+    else if (DfbGen_ReadNumbers(path, filter->coef, DFBGEN_TAPS_MAX, &n, &integers, error,
+                                errorSize) != CYRET_SUCCESS)
+        return CYRET_BAD_DATA;
+
+    if (n < 2u)
+        return DfbGen_Fail(error, errorSize, "%s: a FIR needs 2 taps or more", path);
+    if (integers)
+    {
+        for (k = 0u; k < n; k++)
+        {
+            double v = filter->coef[k];
+
+            if ((v < DFBGEN_MIN24) || (v > (double)DFBEMU_MASK24))
+                return DfbGen_Fail(error, errorSize, "%s: %.0f is not a 24-bit word", path, v);
+            filter->coef[k] = DfbEmu_Signed24((uint32)(int32)v) / DFBGEN_Q23;
+        }
+    }
+    filter->kind = DFBGEN_KIND_FIR;
+    filter->taps = (uint16)n;
+    return CYRET_SUCCESS;
+}
+
+static cystatus DfbGen_Sos(DfbGen_Filter *filter, const char *path, char *error,
+                           uint32 errorSize)
+{
+    FILE *file = fopen(path, "r");
+    char line[DFBGEN_LINE];
+    uint8 sections = 0u;
+
+    if (file == NULL)
+        return DfbGen_Fail(error, errorSize, "cannot open %s", path);
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        double v[6];
+        double *c = &filter->coef[sections * DFBGEN_BIQUAD_WORDS];
+        int n = sscanf(line, "%lf%*[ \t,]%lf%*[ \t,]%lf%*[ \t,]%lf%*[ \t,]%lf%*[ \t,]%lf", &v[0],
+                       &v[1], &v[2], &v[3], &v[4], &v[5]);
+
+        if (n <= 0)
+            continue;
+        if (((n != 5) && (n != 6)) || (sections >= DFBGEN_SECTIONS_MAX) ||
+            ((n == 6) && (v[3] == 0.0)))
+        {
+            (void)fclose(file);
+            return DfbGen_Fail(error, errorSize,
+                               "%s: a section is b0 b1 b2 a1 a2 or b0 b1 b2 a0 a1 a2, %u at most",
+                               path, (unsigned)DFBGEN_SECTIONS_MAX);
+        }
+        if (n == 6)
+        {
+            c[0] = v[0] / v[3];
+            c[1] = v[1] / v[3];
+            c[2] = v[2] / v[3];
+            c[3] = v[4] / v[3];
+            c[4] = v[5] / v[3];
+        }
+        else
+            memcpy(c, v, DFBGEN_BIQUAD_WORDS * sizeof(double));
+        sections++;
+    }
+    (void)fclose(file);
+    if (sections == 0u)
+        return DfbGen_Fail(error, errorSize, "%s: no sections", path);
+    filter->kind = DFBGEN_KIND_IIR;
+    filter->sections = sections;
+    return CYRET_SUCCESS;
+}
+
+/* Decimation by @p m of the FIR @p filter, 1 for none. */
+static cystatus DfbGen_Decimate(DfbGen_Filter *filter, uint32 m, char *error, uint32 errorSize)
+{
+    if (m == 1u)
+        return CYRET_SUCCESS;
+    if (filter->kind != DFBGEN_KIND_FIR)
+        return DfbGen_Fail(error, errorSize, "only a FIR decimates");
+    if ((m < 2u) || (m > DFBGEN_DECIMATION_MAX) || (m >= filter->taps))
+        return DfbGen_Fail(error, errorSize, "decimate has to be 2 to %u, and below the taps",
+                           (unsigned)DFBGEN_DECIMATION_MAX);
+    filter->decimation = (uint8)m;
+    return CYRET_SUCCESS;
+}
+
+/**
+ * @brief Designs the filter of @p spec (see DfbGen.h) into @p filter.
+ *
+ * @return CYRET_SUCCESS, or CYRET_BAD_DATA with the reason in @p error.
+ */
+cystatus DfbGen_Parse(const char *spec, DfbGen_Filter *filter, char *error, uint32 errorSize)
+{
+    char copy[DFBGEN_DESCRIPTION];
+    char *field[12];
+    uint32 fields = 0u;
+    const char *window = "hamming";
+    const char *response;
+    double fs = 0.0;
+    double f1 = 0.0;
+    double f2 = 0.0;
+    double q = 0.7071067811865476;
+    uint32 taps = 0u;
+    uint32 order = 2u;
+    uint32 decimate = 1u;
+    uint32 k;
+    cystatus status;
+    char *p;
+
+    memset(filter, 0, sizeof(*filter));
+    filter->decimation = 1u;
+    if (strlen(spec) >= sizeof(copy))
+        return DfbGen_Fail(error, errorSize, "the spec is too long");
+    (void)snprintf(filter->description, sizeof(filter->description), "%s", spec);
+    strcpy(copy, spec);
+    if (strncmp(spec, "coef:", 5u) == 0)
+    {
+        /* The path may hold colons, the option is the end of the spec */
+        p = strstr(copy, ":decimate=");
+        if (p != NULL)
+        {
+            *p = '\0';
+            decimate = (uint32)strtoul(p + 10, NULL, 10);
+        }
+        status = DfbGen_Coef(filter, copy + 5, error, errorSize);
+        return (status == CYRET_SUCCESS) ? DfbGen_Decimate(filter, decimate, error, errorSize)
+                                         : status;
+    }
+    if (strncmp(spec, "sos:", 4u) == 0)
+        return DfbGen_Sos(filter, spec + 4, error, errorSize);
+
+    for (p = copy; (p != NULL) && (fields < sizeof(field) / sizeof(field[0])); fields++)
+    {
+        field[fields] = p;
+        p = strchr(p, ':');
+        if (p != NULL)
+            *p++ = '\0';
+    }
+    if ((fields < 2u) || ((strcmp(field[0], "fir") != 0) && (strcmp(field[0], "iir") != 0)))
+        return DfbGen_Fail(error, errorSize, "%s: expected fir:, iir:, coef: or sos:", spec);
+    response = field[1];
+    for (k = 2u; k < fields; k++)
+    {
+        char *value = strchr(field[k], '=');
+
+        if (value == NULL)
+            return DfbGen_Fail(error, errorSize, "%s: expected name=value", field[k]);
+        *value++ = '\0';
+        if (strcmp(field[k], "taps") == 0)
+            taps = (uint32)strtoul(value, NULL, 10);
+        else if (strcmp(field[k], "order") == 0)
+            order = (uint32)strtoul(value, NULL, 10);
+        else if (strcmp(field[k], "fs") == 0)
+            fs = strtod(value, NULL);
+        else if (strcmp(field[k], "fc") == 0)
+        {
+            f1 = strtod(value, &p);
+            f2 = (*p == ',') ? strtod(p + 1, NULL) : 0.0;
+        }
+        else if (strcmp(field[k], "q") == 0)
+            q = strtod(value, NULL);
+        else if (strcmp(field[k], "decimate") == 0)
+            decimate = (uint32)strtoul(value, NULL, 10);
+        else if ((strcmp(field[k], "window") == 0) &&
+                 ((strcmp(value, "hamming") == 0) || (strcmp(value, "hann") == 0) ||
+                  (strcmp(value, "blackman") == 0) || (strcmp(value, "rect") == 0)))
+            window = value;
+        else
+            return DfbGen_Fail(error, errorSize, "unknown parameter %s=%s", field[k], value);
+    }
+    if (field[0][0] == 'f')
+        status = DfbGen_Fir(filter, response, taps, fs, f1, f2, window, error, errorSize);
+    else
+        status = DfbGen_Iir(filter, response, order, fs, f1, q, error, errorSize);
+    return (status == CYRET_SUCCESS) ? DfbGen_Decimate(filter, decimate, error, errorSize)
+                                     : status;
+}
+
+/* ---- Layout ---- */
+
+static uint32 DfbGen_Quantize(double v, uint32 *clamped)
+{
+    double scaled = floor(v * DFBGEN_Q23 + 0.5);
+
+    if (scaled > DFBGEN_MAX24)
+    {
+        scaled = DFBGEN_MAX24;
+        (*clamped)++;
+    }
+    else if (scaled < DFBGEN_MIN24)
+    {
+        scaled = DFBGEN_MIN24;
+        (*clamped)++;
+    }
+    return (uint32)(int32)scaled & DFBEMU_MASK24;
+}
+
+/* MACs an input of a decimating FIR, the taps of a phase. */
+static uint32 DfbGen_PhaseTaps(const DfbGen_Filter *filter)
+{
+    return (filter->taps + filter->decimation - 1u) / filter->decimation;
+}
+
+/*
+ * The word of FIR tap @p k. Folded taps are stored once; a decimating FIR stores its phases in
+ * the order the inputs of an output come, the one of tap M - 1 first and of tap 0 last.
+ */
+static uint32 DfbGen_TapWord(const DfbGen_Channel *ch, uint32 k)
+{
+    const DfbGen_Filter *filter = ch->filter;
+    uint32 m = filter->decimation;
+
+    if (m > 1u)
+        return (m - 1u - k % m) * DfbGen_PhaseTaps(filter) + k / m;
+    return (ch->fold && (k >= ch->words)) ? filter->taps - 1u - k : k;
+}
+
+/*
+ * Quantizes @p filter into @p ch: the taps, or per biquad the halved b2 b1 -a2 b0 -a1 in the
+ * order the section multiplies them (see DfbGen_EmitIir()).
+ */
+static void DfbGen_Words(const DfbGen_Filter *filter, DfbGen_Channel *ch)
+{
+    static const uint8 order[DFBGEN_BIQUAD_WORDS] = {2u, 1u, 4u, 0u, 3u};
+    uint32 k;
+
+    memset(ch, 0, sizeof(*ch));
+    ch->filter = filter;
+    if ((filter->kind == DFBGEN_KIND_FIR) && (filter->decimation > 1u))
+    {
+        uint32 taps = DfbGen_PhaseTaps(filter);
+
+        /* Whole phases, the padding taps are zeros; Layout refuses what is over a RAM */
+        ch->words = (uint16)(taps * filter->decimation);
+        ch->samples = (uint16)((taps - 1u) * filter->decimation + 1u);
+        if (ch->words > DFBGEN_TAPS_MAX)
+            return;
+        for (k = 0u; k < filter->taps; k++)
+        {
+            uint32 w = DfbGen_TapWord(ch, k);
+            double error;
+
+            ch->q[w] = DfbGen_Quantize(filter->coef[k], &ch->clamped);
+            error = fabs(DfbEmu_Signed24(ch->q[w]) - filter->coef[k] * DFBGEN_Q23);
+            if (error > ch->coefErrorMax)
+                ch->coefErrorMax = error;
+        }
+        return;
+    }
+    if (filter->kind == DFBGEN_KIND_FIR)
+    {
+        for (k = 0u; k < filter->taps; k++)
+        {
+            double error;
+
+            ch->q[k] = DfbGen_Quantize(filter->coef[k], &ch->clamped);
+            error = fabs(DfbEmu_Signed24(ch->q[k]) - filter->coef[k] * DFBGEN_Q23);
+            if (error > ch->coefErrorMax)
+                ch->coefErrorMax = error;
+        }
+        ch->symmetric = (uint8)(filter->taps >= 3u);
+        for (k = 0u; k < filter->taps / 2u; k++)
+        {
+            if (ch->q[k] != ch->q[filter->taps - 1u - k])
+                ch->symmetric = 0u;
+        }
+        ch->words = filter->taps;
+        ch->samples = filter->taps;
+        return;
+    }
+    for (k = 0u; k < filter->sections * DFBGEN_BIQUAD_WORDS; k++)
+    {
+        uint32 at = (k / DFBGEN_BIQUAD_WORDS) * DFBGEN_BIQUAD_WORDS;
+        uint8 which = order[k % DFBGEN_BIQUAD_WORDS];
+        double v = filter->coef[at + which] * ((which >= 3u) ? -0.5 : 0.5);
+        double error;
+
+        ch->q[k] = DfbGen_Quantize(v, &ch->clamped);
+        error = fabs(DfbEmu_Signed24(ch->q[k]) - v * DFBGEN_Q23);
+        if (error > ch->coefErrorMax)
+            ch->coefErrorMax = error;
+    }
+    ch->words = (uint16)(filter->sections * DFBGEN_BIQUAD_WORDS);
+    ch->samples = (uint16)(3u * (filter->sections + 1u));
+}
+
+/**
+ * @brief Places @p channels filters (1 or 2) in the DFB RAMs.
+ *
+ * Symmetric FIR taps are folded as @p fold says; with DFBGEN_FOLD_AUTO when that costs no
+ * cycle, or when the filters do not fit otherwise. A decimating FIR is not folded and runs
+ * alone.
+ *
+ * @return CYRET_SUCCESS, or CYRET_BAD_DATA with the reason in @p error.
+ */
+cystatus DfbGen_Layout(const DfbGen_Filter *const *filters, uint8 channels, uint8 fold,
+                       DfbGen_Channel *out, char *error, uint32 errorSize)
+{
+    uint32 best = 0xFFFFFFFFu;
+    uint8 choice;
+    uint8 k;
+
+    if ((channels == 0u) || (channels > DFBEMU_CHANNELS))
+        return DfbGen_Fail(error, errorSize, "1 or 2 channels");
+    for (k = 0u; k < channels; k++)
+    {
+        DfbGen_Words(filters[k], &out[k]);
+        if ((filters[k]->decimation > 1u) && (channels > 1u))
+            return DfbGen_Fail(error, errorSize,
+                               "channel %c: a decimating FIR runs alone, its sum stays in the MAC "
+                               "from input to input",
+                               'A' + k);
+        if ((filters[k]->decimation > 1u) && (fold == DFBGEN_FOLD_ON))
+            return DfbGen_Fail(error, errorSize, "a decimating FIR is not folded");
+        if ((filters[k]->decimation > 1u) &&
+            (DfbGen_PhaseTaps(filters[k]) + DFBGEN_DECIMATE_CODE > DFBEMU_CODE_WORDS))
+            return DfbGen_Fail(error, errorSize,
+                               "%u MACs an input, one instruction each, are over the control "
+                               "store: decimate more",
+                               (unsigned)DfbGen_PhaseTaps(filters[k]));
+        if ((fold == DFBGEN_FOLD_ON) && (filters[k]->kind == DFBGEN_KIND_FIR) &&
+            !out[k].symmetric)
+            return DfbGen_Fail(error, errorSize, "channel %c: the taps are not symmetric",
+                               'A' + k);
+    }
+
+    /* Fold choices as bits, by cycles then words */
+    for (choice = 0u; choice < (1u << channels); choice++)
+    {
+        uint32 words[2] = {0u, 0u};
+        uint32 samples[2] = {0u, 0u};
+        uint32 cost = 0u;
+
+        for (k = 0u; k < channels; k++)
+        {
+            uint8 folded = (uint8)((choice >> k) & 1u);
+            uint16 taps = filters[k]->taps;
+
+            if (folded && (!out[k].symmetric || (fold == DFBGEN_FOLD_OFF)))
+                break;
+            if (!folded && out[k].symmetric && (fold == DFBGEN_FOLD_ON))
+                break;
+            words[k] = folded ? (taps + 1u) / 2u : out[k].words;
+            samples[k] = out[k].samples;
+            cost += (folded && (taps & 1u)) ? 1000u : 0u;
+        }
+        if (k != channels)
+            continue;
+        /* RAM A: A samples, B coefficients; RAM B: A coefficients, B samples */
+        if ((samples[0] + words[1] > DFBEMU_DATA_WORDS) ||
+            (words[0] + samples[1] > DFBEMU_DATA_WORDS))
+            continue;
+        cost += words[0] + words[1];
+        if (cost < best)
+        {
+            best = cost;
+            for (k = 0u; k < channels; k++)
+            {
+                out[k].fold = (uint8)((choice >> k) & 1u);
+                if (out[k].fold)
+                    out[k].words = (uint16)words[k];
+            }
+        }
+    }
+    if (best == 0xFFFFFFFFu)
+        return DfbGen_Fail(error, errorSize,
+                           "does not fit: %u data words a RAM, the samples of a channel and the "
+                           "coefficients of the other one share one",
+                           (unsigned)DFBEMU_DATA_WORDS);
+
+    out[0].sampleBase = 0u;
+    out[0].coefBase = 0u;
+    if (channels > 1u)
+    {
+        out[1].sampleBase = out[0].words;
+        out[1].coefBase = out[0].samples;
+    }
+    return CYRET_SUCCESS;
+}
+
+/* ---- Code ---- */
+
+static void DfbGen_Put(DfbGen_Out *out, const char *format, ...)
+{
+    va_list args;
+    int n;
+
+    if (out->overflow)
+        return;
+    va_start(args, format);
+    n = vsnprintf(out->text + out->length, out->size - out->length, format, args);
+    va_end(args);
+    if ((n < 0) || ((uint32)n >= out->size - out->length))
+        out->overflow = 1u;
+    else
+        out->length += (uint32)n;
+}
+
+/*
+ * One instruction of channel @p cx, operands of its sample side first: @p sAcu / @p cAcu the
+ * ACU operations and @p sMux / @p cMux the dmux codes of the sample and coefficient sides.
+ */
+static void DfbGen_Insn(DfbGen_Out *out, const DfbGen_Ctx *cx, const char *sAcu, const char *cAcu,
+                        const char *addr, const char *sMux, const char *cMux, const char *alu,
+                        const char *mac, const char *rest)
+{
+    const char *acu[2];
+    const char *mux[2];
+
+    acu[cx->s] = sAcu;
+    acu[1u - cx->s] = cAcu;
+    mux[cx->s] = sMux;
+    mux[1u - cx->s] = cMux;
+    DfbGen_Put(out, "    acu(%s,%s)", acu[0], acu[1]);
+    if (addr != NULL)
+        DfbGen_Put(out, " addr(%s)", addr);
+    DfbGen_Put(out, " dmux(%s,%s) alu(%s) mac(%s)%s%s\n", mux[0], mux[1], alu, mac,
+               (rest[0] != '\0') ? " " : "", rest);
+}
+
+/* Loads the modulus registers of a dual channel program; the sample is read on the last one. */
+static void DfbGen_EmitLoads(DfbGen_Out *out, const DfbGen_Ctx *cx, uint8 readBus)
+{
+    char addr[16];
+
+    (void)snprintf(addr, sizeof(addr), "%s_MIN", cx->name);
+    DfbGen_Insn(out, cx, "loadl", "loadl", addr, "sa", "sa", "hold", "hold", "");
+    (void)snprintf(addr, sizeof(addr), "%s_MAX", cx->name);
+    DfbGen_Insn(out, cx, "loadm", "loadm", addr, readBus ? "ba" : "sa", "sa", "hold", "hold", "");
+}
+
+static void DfbGen_EmitFir(DfbGen_Out *out, const DfbGen_Ctx *cx)
+{
+    const DfbGen_Channel *ch = cx->ch;
+    const char *n = cx->name;
+    uint8 odd = (uint8)(ch->filter->taps & 1u);
+    char bus[4];
+    char start[16];
+    char rest[64];
+    char setc[8];
+    char cond[16];
+    char data[4];
+
+    (void)snprintf(bus, sizeof(bus), "%u", (unsigned)(cx->s + 1u));
+    (void)snprintf(start, sizeof(start), "%s_START", n);
+    (void)snprintf(setc, sizeof(setc), "set%c", 'a' + (1 - cx->s));
+    (void)snprintf(cond, sizeof(cond), "acu%ceq", 'a' + (1 - cx->s));
+    (void)snprintf(data, sizeof(data), "d%c", 'a' + cx->s);
+
+    DfbGen_Put(out, "\n%s_init:\n", n);
+    if (cx->dual)
+        DfbGen_EmitLoads(out, cx, 1u);
+    else
+        DfbGen_Insn(out, cx, "hold", "hold", bus, "ba", "sa", "hold", "hold", "");
+    (void)snprintf(rest, sizeof(rest), "write(%s) jmp(eob, %s_%s)", data, n,
+                   ch->fold ? "up" : "fir");
+    DfbGen_Insn(out, cx, "read", "read", start, "sra", "sra", "hold", "clra", rest);
+
+    if (ch->fold)
+    {
+        /* The coefficient ACU turns at the middle tap and walks back down to the first */
+        char addr[16];
+
+        (void)snprintf(addr, sizeof(addr), "%s_MIN", n);
+        (void)snprintf(rest, sizeof(rest), "jmp(eob, %s_down)", n);
+        DfbGen_Put(out, "%s_turn:\n", n);
+        DfbGen_Insn(out, cx, odd ? "hold" : "incr", "loadm", addr, "sra", "sra", "hold",
+                    odd ? "hold" : "macc", rest);
+    }
+
+    DfbGen_Put(out, "%s_finish:\n", n);
+    DfbGen_Insn(out, cx, "write", "hold", start, "sa", "sa", setc, "hold", "");
+    if (ch->fold)
+    {
+        char addr[16];
+
+        (void)snprintf(addr, sizeof(addr), "%s_MAX", n);
+        DfbGen_Insn(out, cx, "hold", "loadm", addr, "sa", "sa", "hold", "hold", "");
+    }
+    else
+        DfbGen_Insn(out, cx, "hold", "hold", NULL, "sa", "sa", "hold", "hold", "");
+    DfbGen_Insn(out, cx, "hold", "hold", bus, "sa", "sa", "hold", "hold",
+                "write(bus) jmp(eob, WaitForNew)");
+
+    if (ch->fold)
+    {
+        (void)snprintf(rest, sizeof(rest), "jmpl(eob, %s, %s_turn)", cond, n);
+        DfbGen_Put(out, "%s_up:\n", n);
+        DfbGen_Insn(out, cx, "incr", "incr", NULL, "sra", "sra", "hold", "macc", rest);
+        (void)snprintf(rest, sizeof(rest), "jmpl(eob, %s, %s_finish)", cond, n);
+        DfbGen_Put(out, "%s_down:\n", n);
+        DfbGen_Insn(out, cx, "incr", "decr", NULL, "sra", "srm", "hold", "macc", rest);
+    }
+    else
+    {
+        (void)snprintf(rest, sizeof(rest), "jmpl(eob, %s, %s_finish)", cond, n);
+        DfbGen_Put(out, "%s_fir:\n", n);
+        DfbGen_Insn(out, cx, "incr", "incr", NULL, "sra", "srm", "hold", "macc", rest);
+    }
+}
+
+/*
+ * Polyphase: every input runs the same ceil(N / M) MACs, the newest sample and every Mth older
+ * one (freg M) by the next taps in the coefficient RAM, which come phase by phase. The input
+ * that uses the last coefficient, where the coefficient ACU meets its modulus top, is the last
+ * of an output: it writes the sum to the bus and the next input starts a new one with clra.
+ * After ceil(N / M) - 1 steps of M the sample ACU is one below where it started, on the oldest
+ * sample, which is where the next one goes.
+ */
+static void DfbGen_EmitDecimate(DfbGen_Out *out, const DfbGen_Ctx *cx)
+{
+    uint32 taps = DfbGen_PhaseTaps(cx->ch->filter);
+    uint32 k;
+
+    DfbGen_Put(out, "\nChA_first:\n");
+    DfbGen_Insn(out, cx, "hold", "hold", "1", "ba", "sa", "hold", "hold", "");
+    DfbGen_Insn(out, cx, "read", "incr", "ChA_START", "sra", "sra", "hold", "clra",
+                "write(da) jmp(eob, ChA_phase)");
+    DfbGen_Put(out, "ChA_next:\n");
+    DfbGen_Insn(out, cx, "hold", "hold", "1", "ba", "sa", "hold", "hold", "");
+    DfbGen_Insn(out, cx, "read", "incr", "ChA_START", "sra", "sra", "hold", "macc", "write(da)");
+    DfbGen_Put(out, "ChA_phase:\n");
+    for (k = 2u; k < taps; k++)
+        DfbGen_Insn(out, cx, "addf", "incr", NULL, "sra", "sra", "hold", "macc", "");
+    DfbGen_Insn(out, cx, "addf", "incr", NULL, "sra", "srm", "hold", "macc",
+                "jmp(eob, acubeq, ChA_output)");
+    DfbGen_Insn(out, cx, "write", "hold", "ChA_START", "sa", "sa", "hold", "hold",
+                "jmp(eob, WaitForNext)");
+    DfbGen_Put(out, "ChA_output:\n");
+    DfbGen_Insn(out, cx, "write", "hold", "ChA_START", "sa", "sa", "setb", "hold", "");
+    DfbGen_Insn(out, cx, "hold", "hold", NULL, "sa", "sa", "hold", "hold", "");
+    DfbGen_Insn(out, cx, "hold", "hold", "1", "sa", "sa", "hold", "hold",
+                "write(bus) jmp(eob, WaitForFirst)");
+}
+
+/*
+ * Section k multiplies its input signal k at delays 2, 1, 0 and its output signal k + 1 at
+ * delays 2 and 1, in the order X2 X1 Y2 X0 Y1: at base + 3k - 2, +1, +2, -1, +2 with freg 2,
+ * and the next section's X2 is one down from this Y1. The output of section k - 1 goes through
+ * the ALU on the X2 of section k, is shifted back into MUX1 on its Y2 and written as its X0,
+ * which the MAC reads in the same cycle; section 0 reads the bus instead.
+ */
+static void DfbGen_EmitIir(DfbGen_Out *out, const DfbGen_Ctx *cx)
+{
+    const char *n = cx->name;
+    uint8 sections = cx->ch->filter->sections;
+    char bus[4];
+    char start[16];
+    char setc[8];
+    char data[16];
+    char rest[64];
+    uint8 k;
+
+    (void)snprintf(bus, sizeof(bus), "%u", (unsigned)(cx->s + 1u));
+    (void)snprintf(start, sizeof(start), "%s_START", n);
+    (void)snprintf(setc, sizeof(setc), "set%c", 'a' + (1 - cx->s));
+    (void)snprintf(data, sizeof(data), "write(d%c)", 'a' + cx->s);
+
+    DfbGen_Put(out, "\n%s_init:\n", n);
+    if (cx->dual)
+        DfbGen_EmitLoads(out, cx, 0u);
+    for (k = 0u; k < sections; k++)
+    {
+        DfbGen_Put(out, "    // section %u\n", (unsigned)k);
+        if (k == 0u)
+            DfbGen_Insn(out, cx, "read", "read", start, "sra", "sra", "hold", "clra", "");
+        else
+            DfbGen_Insn(out, cx, "decr", "incr", NULL, "sra", "sra", setc, "clra", "");
+        DfbGen_Insn(out, cx, "incr", "incr", NULL, "sra", "sra", "hold", "macc", "");
+        if (k == 0u)
+            DfbGen_Insn(out, cx, "addf", "incr", bus, "bra", "sra", "hold", "macc", "");
+        else
+            DfbGen_Insn(out, cx, "addf", "incr", NULL, "sra", "sra", "hold", "macc",
+                        "shift(left,1)");
+        DfbGen_Insn(out, cx, "decr", "incr", NULL, "sra", "sra", "hold", "macc", data);
+        DfbGen_Insn(out, cx, "addf", "incr", NULL, "sra", "srm", "hold", "macc", "");
+    }
+
+    /* Output: into the ring as the last signal, to the bus; base moves one up */
+    DfbGen_Put(out, "    // output\n");
+    DfbGen_Insn(out, cx, "incr", "hold", NULL, "sa", "sa", setc, "hold", "");
+    DfbGen_Insn(out, cx, "addf", "hold", NULL, "sa", "sa", "hold", "hold", "");
+    DfbGen_Insn(out, cx, "write", "hold", start, "sa", "sa", "hold", "hold", "shift(left,1)");
+    (void)snprintf(rest, sizeof(rest), "shift(left,1) write(bus,d%c) jmp(eob, WaitForNew)",
+                   'a' + cx->s);
+    DfbGen_Insn(out, cx, "subf", "hold", bus, "sa", "sa", "hold", "hold", rest);
+}
+
+/* An ACU word, its channel's sample side value and coefficient side value. */
+static void DfbGen_AcuWord(DfbGen_Out *out, const DfbGen_Ctx *cx, const char *name, uint32 sValue,
+                           uint32 cValue, const char *comment)
+{
+    uint32 v[2];
+
+    v[cx->s] = sValue;
+    v[1u - cx->s] = cValue;
+    DfbGen_Put(out, "    %s_%s: dw %u, %u // %s\n", cx->name, name, (unsigned)v[0], (unsigned)v[1],
+               comment);
+}
+
+static void DfbGen_EmitAcu(DfbGen_Out *out, const DfbGen_Ctx *cx, const char *which)
+{
+    const DfbGen_Channel *ch = cx->ch;
+    uint8 iir = (uint8)(ch->filter->kind == DFBGEN_KIND_IIR);
+
+    if ((strcmp(which, "START") == 0) && (ch->filter->decimation > 1u))
+        DfbGen_AcuWord(out, cx, "START", ch->sampleBase, ch->coefBase + ch->words - 1u,
+                       "newest sample, the coefficient before the first");
+    else if (strcmp(which, "MAX") == 0)
+        DfbGen_AcuWord(out, cx, "MAX", ch->sampleBase + ch->samples - 1u,
+                       ch->coefBase + ch->words - 1u, "modulus tops, last coefficient");
+    else if (strcmp(which, "MIN") == 0)
+        DfbGen_AcuWord(out, cx, "MIN", ch->sampleBase, ch->coefBase,
+                       "modulus bottoms, first coefficient");
+    else
+        DfbGen_AcuWord(out, cx, "START", iir ? ch->sampleBase + ch->samples - 2u : ch->sampleBase,
+                       ch->coefBase, iir ? "X2 of section 0, first coefficient"
+                                         : "newest sample, first coefficient");
+}
+
+/* The words of RAM @p side: samples as zeros, coefficients with their value. */
+static void DfbGen_EmitData(DfbGen_Out *out, const DfbGen_Ctx *cx, uint8 count, uint8 side)
+{
+    uint8 k;
+
+    DfbGen_Put(out, "\narea data_%c\n", 'a' + side);
+    for (k = 0u; k < count; k++)
+    {
+        /* Channel k's samples are in RAM k, its coefficients in the other one */
+        const DfbGen_Ctx *c = &cx[k];
+        const DfbGen_Channel *ch = c->ch;
+        uint16 w;
+
+        if (c->s == side)
+        {
+            /* Zeros only to place what follows */
+            if ((k + 1u < count) || ((count > 1u) && (k == 0u)))
+            {
+                DfbGen_Put(out, "%s_SAMPLES:", c->name);
+                for (w = 0u; w < ch->samples; w++)
+                    DfbGen_Put(out, "%sdw 0\n", (w == 0u) ? " " : "");
+            }
+            continue;
+        }
+        DfbGen_Put(out, "%s_COEF:", c->name);
+        for (w = 0u; w < ch->words; w++)
+        {
+            int32 v = DfbEmu_Signed24(ch->q[w]);
+
+            if (ch->filter->kind == DFBGEN_KIND_IIR)
+            {
+                static const char *const names[DFBGEN_BIQUAD_WORDS] = {"b2", "b1", "-a2", "b0",
+                                                                       "-a1"};
+
+                DfbGen_Put(out, "%sdw %u // %s/2 of section %u = %.9f\n", (w == 0u) ? " " : "",
+                           (unsigned)ch->q[w], names[w % DFBGEN_BIQUAD_WORDS],
+                           (unsigned)(w / DFBGEN_BIQUAD_WORDS), v / DFBGEN_Q23);
+            }
+            else if (ch->filter->decimation > 1u)
+            {
+                uint32 taps = DfbGen_PhaseTaps(ch->filter);
+                uint32 m = ch->filter->decimation;
+                uint32 tap = (m - 1u - w / taps) + (w % taps) * m;
+
+                if (tap < ch->filter->taps)
+                    DfbGen_Put(out, "%sdw %u // c%u = %.9f\n", (w == 0u) ? " " : "",
+                               (unsigned)ch->q[w], (unsigned)tap, v / DFBGEN_Q23);
+                else
+                    DfbGen_Put(out, "%sdw 0 // padding\n", (w == 0u) ? " " : "");
+            }
+            else
+                DfbGen_Put(out, "%sdw %u // c%u = %.9f\n", (w == 0u) ? " " : "",
+                           (unsigned)ch->q[w], (unsigned)w, v / DFBGEN_Q23);
+        }
+    }
+}
+
+/**
+ * @brief Writes the dfb.v2 program of @p count laid out channels into @p text.
+ *
+ * @return CYRET_SUCCESS, or CYRET_MEMORY when @p size is too small.
+ */
+cystatus DfbGen_Emit(const DfbGen_Channel *channels, uint8 count, char *text, uint32 size)
+{
+    DfbGen_Out out = {text, size, 0u, 0u};
+    DfbGen_Ctx cx[DFBEMU_CHANNELS];
+    uint8 decimation = channels[0].filter->decimation;
+    uint8 step = 0u;
+    uint8 k;
+
+    for (k = 0u; k < count; k++)
+    {
+        const DfbGen_Channel *ch = &channels[k];
+
+        cx[k].ch = ch;
+        cx[k].name = k ? "ChB" : "ChA";
+        cx[k].s = k;
+        cx[k].dual = (uint8)(count > 1u);
+        step |= (uint8)((ch->filter->kind == DFBGEN_KIND_IIR) || (decimation > 1u));
+        DfbGen_Put(&out, "// Channel %c: %s\n", 'A' + k, ch->filter->description);
+        if (decimation > 1u)
+            DfbGen_Put(&out, "//   %u taps decimating by %u: %u MACs an input, an output every "
+                             "%u inputs, %u coefficient words\n",
+                       (unsigned)ch->filter->taps, (unsigned)decimation,
+                       (unsigned)DfbGen_PhaseTaps(ch->filter), (unsigned)decimation,
+                       (unsigned)ch->words);
+        else if (ch->filter->kind == DFBGEN_KIND_FIR)
+            DfbGen_Put(&out, "//   %u taps%s, %u coefficient words\n",
+                       (unsigned)ch->filter->taps,
+                       ch->fold ? ", symmetric, half of them stored" : "", (unsigned)ch->words);
+        else
+            DfbGen_Put(&out, "//   %u biquads, direct form I, coefficients halved\n",
+                       (unsigned)ch->filter->sections);
+    }
+    DfbGen_Put(&out, "// Generated by HostEmu/Dfb/dfbgen: change the design and generate it "
+                     "again rather than this file.\n\n");
+
+    DfbGen_Put(&out, "initialize:\n");
+    DfbGen_Insn(&out, &cx[0], "setmod", "setmod", NULL, "sa", "sa", "set0", "clra", "");
+    if (step)
+        DfbGen_Insn(&out, &cx[0], "loadf", "loadf", "STEP", "sa", "sa", "hold", "hold", "");
+    if (decimation > 1u)
+    {
+        /* The coefficient ACU starts on the modulus top, the first input steps it to the bottom */
+        DfbGen_Insn(&out, &cx[0], "loadm", "loadm", "ChA_MAX", "sa", "sa", "hold", "hold", "");
+        DfbGen_Insn(&out, &cx[0], "loadl", "loadl", "ChA_MIN", "sa", "sa", "hold", "hold", "");
+        DfbGen_Insn(&out, &cx[0], "read", "read", "ChA_START", "sa", "sa", "hold", "hold",
+                    "jmp(eob, WaitForFirst)");
+        DfbGen_Put(&out, "\nWaitForFirst:\n");
+        DfbGen_Insn(&out, &cx[0], "hold", "hold", NULL, "sa", "sa", "hold", "hold",
+                    "jmpl(in1, ChA_first)");
+        DfbGen_Put(&out, "WaitForNext:\n");
+        DfbGen_Insn(&out, &cx[0], "hold", "hold", NULL, "sa", "sa", "hold", "hold",
+                    "jmpl(in1, ChA_next)");
+    }
+    else if (count == 1u)
+    {
+        /* One channel: the modulus registers never change */
+        DfbGen_Insn(&out, &cx[0], "loadm", "loadm", "ChA_MAX", "sa", "sa", "hold", "hold", "");
+        DfbGen_Insn(&out, &cx[0], "loadl", "loadl", "ChA_MIN", "sa", "sa", "hold", "hold",
+                    "jmp(eob, WaitForNew)");
+        DfbGen_Put(&out, "\nWaitForNew:\n");
+        DfbGen_Insn(&out, &cx[0], "hold", "hold", NULL, "sa", "sa", "hold", "hold",
+                    "jmpl(in1, ChA_init)");
+    }
+    else
+    {
+        DfbGen_Insn(&out, &cx[0], "hold", "hold", NULL, "sa", "sa", "hold", "hold",
+                    "jmp(eob, WaitForNew)");
+        DfbGen_Put(&out, "\nWaitForNew:\n");
+        DfbGen_Insn(&out, &cx[0], "hold", "hold", NULL, "sa", "sa", "hold", "hold",
+                    "jmp(in1, ChA_init)");
+        DfbGen_Insn(&out, &cx[0], "hold", "hold", NULL, "sa", "sa", "hold", "hold",
+                    "jmpl(in2, ChB_init)");
+    }
+    for (k = 0u; k < count; k++)
+    {
+        if (decimation > 1u)
+            DfbGen_EmitDecimate(&out, &cx[k]);
+        else if (channels[k].filter->kind == DFBGEN_KIND_FIR)
+            DfbGen_EmitFir(&out, &cx[k]);
+        else
+            DfbGen_EmitIir(&out, &cx[k]);
+    }
+
+    DfbGen_Put(&out, "\narea acu\n");
+    if (count == 1u)
+    {
+        DfbGen_EmitAcu(&out, &cx[0], "MAX");
+        DfbGen_EmitAcu(&out, &cx[0], "MIN");
+        DfbGen_EmitAcu(&out, &cx[0], "START");
+    }
+    else
+    {
+        DfbGen_Put(&out, "    // ChA_MAX and ChB_MAX at 1 and 2, the bus addresses of their "
+                         "channels: one addr() reads the sample and loads the modulus tops\n");
+        DfbGen_EmitAcu(&out, &cx[0], "MIN");
+        DfbGen_EmitAcu(&out, &cx[0], "MAX");
+        DfbGen_EmitAcu(&out, &cx[1], "MAX");
+        DfbGen_EmitAcu(&out, &cx[1], "MIN");
+        DfbGen_EmitAcu(&out, &cx[0], "START");
+        DfbGen_EmitAcu(&out, &cx[1], "START");
+    }
+    if (decimation > 1u)
+        DfbGen_Put(&out, "    STEP: dw %u, 1 // freg, from a sample to the next one of its phase\n",
+                   (unsigned)decimation);
+    else if (step)
+        DfbGen_Put(&out, "    STEP: dw %u, %u // freg, the biquad signal ring\n",
+                   (unsigned)DFBGEN_RING_STEP, (unsigned)DFBGEN_RING_STEP);
+    DfbGen_EmitData(&out, cx, count, 0u);
+    DfbGen_EmitData(&out, cx, count, 1u);
+    return out.overflow ? CYRET_MEMORY : CYRET_SUCCESS;
+}
+
+/* ---- Models ---- */
+
+static int32 DfbGen_Result(const DfbGen_Model *model, int64 value)
+{
+    if (model->saturate)
+    {
+        if (value > DFBGEN_MAX24)
+            value = DFBGEN_MAX24;
+        else if (value < DFBGEN_MIN24)
+            value = DFBGEN_MIN24;
+    }
+    return DfbEmu_Signed24((uint32)value);
+}
+
+/* The MAC output of a sum of Q23 products, as the DFB truncates or rounds it. */
+static int32 DfbGen_MacOut(const DfbGen_Model *model, uint64 acc)
+{
+    int64 sum;
+
+    acc &= DFBGEN_MASK48;
+    sum = (acc & 0x800000000000uLL) ? (int64)(acc | ~DFBGEN_MASK48) : (int64)acc;
+    if (model->round)
+        sum += (int64)1 << 22;
+    return DfbGen_Result(model, sum >> 23);
+}
+
+/** @brief Empties the delay lines of the models of @p channel. */
+void DfbGen_ModelInit(DfbGen_Model *model, const DfbGen_Channel *channel, uint8 round,
+                      uint8 saturate)
+{
+    memset(model, 0, sizeof(*model));
+    model->channel = channel;
+    model->round = round;
+    model->saturate = saturate;
+}
+
+/**
+ * @brief Input @p sample to the model of the generated program.
+ *
+ * @return 1 with its output, bit for bit, in @p output; 0 on the inputs a decimating FIR
+ *         does not output on.
+ */
+uint8 DfbGen_Reference(DfbGen_Model *model, int32 sample, int32 *output)
+{
+    const DfbGen_Channel *ch = model->channel;
+    const DfbGen_Filter *filter = ch->filter;
+    uint64 acc = 0u;
+    uint32 k;
+
+    if (filter->kind == DFBGEN_KIND_FIR)
+    {
+        uint32 taps = filter->taps;
+
+        memmove(&model->x[1], &model->x[0], (taps - 1u) * sizeof(model->x[0]));
+        model->x[0] = sample;
+        if (++model->inputs % filter->decimation != 0u)
+            return 0u;
+        /* The 48-bit sum wraps the same in any order, the DFB's phase by phase included */
+        for (k = 0u; k < taps; k++)
+            acc += (uint64)((int64)DfbEmu_Signed24(ch->q[DfbGen_TapWord(ch, k)]) * model->x[k]);
+        *output = DfbGen_MacOut(model, acc);
+        return 1u;
+    }
+
+    /* Signal s at delay d in x[3 * s + d] */
+    for (k = 0u; k <= filter->sections; k++)
+    {
+        model->x[3u * k + 2u] = model->x[3u * k + 1u];
+        model->x[3u * k + 1u] = model->x[3u * k];
+    }
+    model->x[0] = sample;
+    for (k = 0u; k < filter->sections; k++)
+    {
+        const uint32 *q = &ch->q[k * DFBGEN_BIQUAD_WORDS];
+        const int32 *x = &model->x[3u * k];
+
+        acc = (uint64)((int64)DfbEmu_Signed24(q[0]) * x[2]) +
+              (uint64)((int64)DfbEmu_Signed24(q[1]) * x[1]) +
+              (uint64)((int64)DfbEmu_Signed24(q[2]) * x[5]) +
+              (uint64)((int64)DfbEmu_Signed24(q[3]) * x[0]) +
+              (uint64)((int64)DfbEmu_Signed24(q[4]) * x[4]);
+        model->x[3u * k + 3u] = DfbGen_Result(model, (int64)DfbGen_MacOut(model, acc) * 2);
+    }
+    *output = model->x[3u * filter->sections];
+    return 1u;
+}
+
+/**
+ * @brief The output of the unquantized design for input @p sample, in double; of a decimating
+ *        FIR on every input, its outputs are those DfbGen_Reference() gives.
+ */
+double DfbGen_Ideal(DfbGen_Model *model, double sample)
+{
+    const DfbGen_Filter *filter = model->channel->filter;
+    double *x = model->ideal;
+    double y = 0.0;
+    uint32 k;
+
+    if (filter->kind == DFBGEN_KIND_FIR)
+    {
+        memmove(&x[1], &x[0], (filter->taps - 1u) * sizeof(x[0]));
+        x[0] = sample;
+        for (k = 0u; k < filter->taps; k++)
+            y += filter->coef[k] * x[k];
+        return y;
+    }
+    for (k = 0u; k <= filter->sections; k++)
+    {
+        x[3u * k + 2u] = x[3u * k + 1u];
+        x[3u * k + 1u] = x[3u * k];
+    }
+    x[0] = sample;
+    for (k = 0u; k < filter->sections; k++)
+    {
+        const double *c = &filter->coef[k * DFBGEN_BIQUAD_WORDS];
+        double *s = &x[3u * k];
+
+        s[3] = c[0] * s[0] + c[1] * s[1] + c[2] * s[2] - c[3] * s[4] - c[4] * s[5];
+    }
+    return x[3u * filter->sections];
+}
@@ -0,0 +1,108 @@
+/**
+ * @file
+ * @brief Filter design to dfb.v2 code: FIR and biquad designs, their Q23 coefficients, the DFB
+ *        program that runs them on one or both channels, and a bit-exact C model of that
+ *        program to check it against.
+ *
+ * A design is a spec string:
+ * - `fir:lowpass|highpass|bandpass|bandstop:taps=N:fs=Hz:fc=Hz[,Hz][:window=hamming|hann|
+ *   blackman|rect][:decimate=M]`, a windowed-sinc FIR (highpass and bandstop need an odd N);
+ * - `iir:lowpass|highpass:order=N:fs=Hz:fc=Hz`, a Butterworth cascade of N/2 biquads, or
+ *   `iir:bandpass|notch:fs=Hz:fc=Hz:q=Q[:order=N]`, N/2 equal biquads;
+ * - `coef:FILE[:decimate=M]`, FIR taps: reals, or Q23 integers as in a dfb.v2 (16776927 is
+ *   -689), or the data_b words of a .v2 file;
+ * - `sos:FILE`, biquads a line each: b0 b1 b2 a1 a2, or b0 b1 b2 a0 a1 a2.
+ *
+ * FIR code is the direct form of the Filter component: the delay line in the RAM of the sample
+ * side, a modulo ring, the taps in the other one, one MAC a tap. When the taps are symmetric
+ * only the first half is stored and the coefficient ACU walks it up and back down, at no cost
+ * for an even N and one cycle for an odd one. Adding the paired samples before the multiply
+ * does not save cycles on the DFB: the MAC and the ALU take their operands from the same two RAM
+ * reads, so the add takes the cycle the MAC would have; halving the coefficient RAM is what the
+ * symmetry buys, and what fits two 85-tap filters in the DFB.
+ *
+ * A FIR decimating by M is polyphase: an output every M inputs, and each input is multiplied
+ * only by the taps of its phase, every Mth one, the accumulator carrying the sum from input to
+ * input. An input costs ceil(N / M) MACs instead of N, so the input rate goes up about M times
+ * while the holding register, and the Filter_Done interrupt or DMA behind it, runs at the output
+ * rate. The taps are stored phase by phase in the order the inputs use them, padded to M whole
+ * phases, and the delay line is a ring of (ceil(N / M) - 1) * M + 1 samples walked with freg M.
+ * As the sum lives in the MAC, a decimating FIR runs on one channel.
+ *
+ * Biquads are direct form I with the coefficients halved (|a1| reaches 2) and the result
+ * shifted back left by one. The signals of the cascade (input, output of every section) keep
+ * their last three values in one modulo ring of the sample side, signal s at delay d at
+ * base + 3 * s - d, and base steps by one a sample, so no state is ever copied: a section is
+ * five MAC cycles, its output written back while the next section is multiplying.
+ *
+ * With two channels channel A samples and channel B coefficients share RAM A, and the other way
+ * round in RAM B, each channel reloading the modulus registers when it runs.
+ */
+#ifndef DFB_GEN_H
+#define DFB_GEN_H
+
+#include "DfbEmu.h"
+
+/* clang-format off */
+#define DFBGEN_TAPS_MAX       (DFBEMU_DATA_WORDS)
+#define DFBGEN_SECTIONS_MAX   (8u)
+#define DFBGEN_DECIMATION_MAX (16u)
+#define DFBGEN_DESCRIPTION    (160u)
+#define DFBGEN_TEXT_SIZE      (32768u) /**< bytes of a generated program */
+
+#define DFBGEN_KIND_FIR (0u)
+#define DFBGEN_KIND_IIR (1u)
+
+#define DFBGEN_FOLD_AUTO (0u) /**< fold symmetric taps when it costs no cycle or is needed to fit */
+#define DFBGEN_FOLD_OFF  (1u)
+#define DFBGEN_FOLD_ON   (2u)
+/* clang-format on */
+
+/** A filter design, before quantization. */
+typedef struct
+{
+    uint8 kind;       /**< DFBGEN_KIND_* */
+    uint16 taps;      /**< FIR taps */
+    uint8 sections;   /**< biquads */
+    uint8 decimation; /**< FIR inputs per output, 1 for none */
+    /** FIR taps, or b0 b1 b2 a1 a2 of every biquad (a0 is 1) */
+    double coef[DFBGEN_TAPS_MAX];
+    char description[DFBGEN_DESCRIPTION];
+} DfbGen_Filter;
+
+/** A filter as one channel runs it: its words in the DFB and where they are. */
+typedef struct
+{
+    const DfbGen_Filter *filter;
+    uint8 fold;                    /**< symmetric FIR taps stored once */
+    uint8 symmetric;
+    uint16 words;                  /**< coefficient words */
+    uint16 samples;                /**< delay line or signal ring words */
+    uint16 sampleBase;             /**< in the RAM of the sample side */
+    uint16 coefBase;               /**< in the RAM of the coefficient side */
+    uint32 q[DFBGEN_TAPS_MAX];     /**< Q23 coefficient words, in RAM order */
+    uint32 clamped;                /**< coefficients out of the Q23 range */
+    double coefErrorMax;           /**< in Q23 LSBs */
+} DfbGen_Channel;
+
+/** Bit-exact model of a channel, the state of DfbGen_Reference(). */
+typedef struct
+{
+    const DfbGen_Channel *channel;
+    uint8 round;
+    uint8 saturate;
+    uint32 inputs;
+    int32 x[DFBGEN_TAPS_MAX]; /**< FIR delay line, or 3 values of every biquad signal */
+    double ideal[DFBGEN_TAPS_MAX];
+} DfbGen_Model;
+
+cystatus DfbGen_Parse(const char *spec, DfbGen_Filter *filter, char *error, uint32 errorSize);
+cystatus DfbGen_Layout(const DfbGen_Filter *const *filters, uint8 channels, uint8 fold,
+                       DfbGen_Channel *out, char *error, uint32 errorSize);
+cystatus DfbGen_Emit(const DfbGen_Channel *channels, uint8 count, char *text, uint32 size);
+void DfbGen_ModelInit(DfbGen_Model *model, const DfbGen_Channel *channel, uint8 round,
+                      uint8 saturate);
+uint8 DfbGen_Reference(DfbGen_Model *model, int32 sample, int32 *output);
+double DfbGen_Ideal(DfbGen_Model *model, double sample);
+
+#endif /* DFB_GEN_H */
@@ -0,0 +1,251 @@
+/**
+ * @file
+ * @brief Checks the DfbEmu model on the FIR program of Filter_24Bit.cydsn.
+ *
+ * Built and run by HostEmu/Makefile (make -C HostEmu dfbcheck):
+ *
+ *     dfbcheck [program.v2]
+ *
+ * The program is fed pseudo-random 24-bit samples as Filter_24Bit's DMA writes them and every
+ * output is compared with a C FIR of the coefficients in its data_b area: 48-bit accumulator,
+ * bits 46..23 out, truncated and rounded. Then the bus side: a staging value is not taken before
+ * its key byte, a holding value stays whole while it is read over a newer result, two samples
+ * without a DFB run between them are an overrun, and the 16-bit alignment of Filter_16Bit
+ * (DALIGN 0x05, key mid) carries the same filter. Last, an assembler error names its line.
+ * The last line is a key=value summary, the exit status nonzero on any mismatch.
+ */
+#include "DfbEmu.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DFBCHECK_PROGRAM                                                                           \
+    "PSoC_5LP_16_Bit_and_24_Bit_Digital_Filter/PSoC 5LP_16 Bit and 24 Bit Digital Filter Code "    \
+    "Examples/Filter_24Bit.cydsn/dfb.v2"
+#define DFBCHECK_SAMPLES (2000u)
+#define DFBCHECK_CLOCK_HZ (24000000u) /* BUS_CLK of the Filter examples */
+#define DFBCHECK_RUN_CYCLES (1000u)   /* a sample takes less */
+#define DFBCHECK_MASK48 (0xFFFFFFFFFFFFuLL)
+
+static DfbEmu_Program program;
+static DfbEmu dfb;
+static int32 history[DFBEMU_DATA_WORDS];
+static uint32 taps;
+static uint32 seed = 1u;
+static uint32 failures;
+
+static void DfbCheck_Fail(const char *what, uint32 n, int32 got, int32 want)
+{
+    if (failures++ < 10u)
+        printf("FAIL %s: sample %u got %ld want %ld\n", what, (unsigned)n, (long)got, (long)want);
+}
+
+static int32 DfbCheck_Random(void)
+{
+    seed = seed * 1103515245u + 12345u;
+    return DfbEmu_Signed24(seed >> 8);
+}
+
+/* The reference FIR: @p sample in, the 24-bit output out. */
+static int32 DfbCheck_Reference(int32 sample, uint8 round)
+{
+    uint64 acc = 0u;
+    int64 sum;
+    uint32 k;
+
+    memmove(&history[1], &history[0], (taps - 1u) * sizeof(history[0]));
+    history[0] = sample;
+    for (k = 0u; k < taps; k++)
+        acc += (uint64)((int64)DfbEmu_Signed24(program.data[1][k]) * history[k]);
+    acc &= DFBCHECK_MASK48;
+    sum = (acc & 0x800000000000uLL) ? (int64)(acc | ~DFBCHECK_MASK48) : (int64)acc;
+    if (round)
+        sum += (int64)1 << 22;
+    return DfbEmu_Signed24((uint32)(sum >> 23));
+}
+
+/* Runs until the DFB waits on in1 again, returns the cycles that took. */
+static uint32 DfbCheck_RunToWait(void)
+{
+    uint64 idle = dfb.stats.idleCycles;
+    uint32 cycles;
+
+    for (cycles = 0u; (cycles < DFBCHECK_RUN_CYCLES) && (dfb.stats.idleCycles == idle); cycles++)
+        DfbEmu_Step(&dfb);
+    return cycles - 1u;
+}
+
+static void DfbCheck_Write(int32 sample)
+{
+    DfbEmu_WriteStage(&dfb, 0u, 0u, (uint8)sample);
+    DfbEmu_WriteStage(&dfb, 0u, 1u, (uint8)(sample >> 8));
+    DfbEmu_WriteStage(&dfb, 0u, 2u, (uint8)(sample >> 16));
+}
+
+static int32 DfbCheck_Read(void)
+{
+    uint32 value = DfbEmu_ReadHold(&dfb, 0u, 0u);
+
+    value |= (uint32)DfbEmu_ReadHold(&dfb, 0u, 1u) << 8;
+    value |= (uint32)DfbEmu_ReadHold(&dfb, 0u, 2u) << 16;
+    return DfbEmu_Signed24(value);
+}
+
+/* Filter_Start() with the Filter_24Bit coherency, the reference emptied. */
+static void DfbCheck_Start(uint8 round)
+{
+    DfbEmu_Init(&dfb, &program);
+    DfbEmu_SetRounding(&dfb, round);
+    DfbEmu_SetCoherency(&dfb, 0u, DFBEMU_KEY_HIGH);
+    memset(history, 0, sizeof(history));
+    (void)DfbCheck_RunToWait();
+}
+
+/* Random samples against the reference; returns the worst cycles a sample took. */
+static uint32 DfbCheck_Fir(uint8 round)
+{
+    uint32 worst = 0u;
+    uint32 n;
+
+    DfbCheck_Start(round);
+    for (n = 0u; n < DFBCHECK_SAMPLES; n++)
+    {
+        int32 sample = (n == 0u) ? 0x400000 : DfbCheck_Random();
+        int32 want = DfbCheck_Reference(sample, round);
+        uint32 cycles;
+        int32 got;
+
+        DfbCheck_Write(sample);
+        cycles = DfbCheck_RunToWait();
+        if (cycles > worst)
+            worst = cycles;
+        if (!DfbEmu_Ready(&dfb, 0u))
+        {
+            DfbCheck_Fail(round ? "fir_round ready" : "fir ready", n, 0, 1);
+            continue;
+        }
+        got = DfbCheck_Read();
+        if (got != want)
+            DfbCheck_Fail(round ? "fir_round" : "fir", n, got, want);
+    }
+    return worst;
+}
+
+/* Staging and holding coherency, and the overrun count. */
+static void DfbCheck_Coherency(void)
+{
+    uint32 outputs;
+    int32 first;
+    int32 second;
+    uint32 value;
+
+    DfbCheck_Start(0u);
+
+    /* Low and mid bytes alone do not hand the sample over */
+    DfbEmu_WriteStage(&dfb, 0u, 0u, 0x00u);
+    DfbEmu_WriteStage(&dfb, 0u, 1u, 0x00u);
+    outputs = dfb.stats.outputs[0];
+    DfbEmu_Run(&dfb, DFBCHECK_RUN_CYCLES);
+    if ((dfb.stats.outputs[0] != outputs) || dfb.in[0])
+        DfbCheck_Fail("stage before key", 0u, (int32)dfb.stats.outputs[0], (int32)outputs);
+    DfbEmu_WriteStage(&dfb, 0u, 2u, 0x40u);
+    (void)DfbCheck_RunToWait();
+    first = DfbCheck_Reference(0x400000, 0u);
+    second = DfbCheck_Reference(0x400000, 0u);
+
+    /* A result written while the bus reads the last one waits for the key byte */
+    value = DfbEmu_ReadHold(&dfb, 0u, 0u);
+    DfbCheck_Write(0x400000);
+    (void)DfbCheck_RunToWait();
+    value |= (uint32)DfbEmu_ReadHold(&dfb, 0u, 1u) << 8;
+    value |= (uint32)DfbEmu_ReadHold(&dfb, 0u, 2u) << 16;
+    if (DfbEmu_Signed24(value) != first)
+        DfbCheck_Fail("hold locked", 1u, DfbEmu_Signed24(value), first);
+    if (!DfbEmu_Ready(&dfb, 0u))
+        DfbCheck_Fail("hold pending ready", 1u, 0, 1);
+    value = (uint32)DfbCheck_Read();
+    if ((int32)value != second)
+        DfbCheck_Fail("hold pending", 1u, (int32)value, second);
+    if (DfbEmu_Ready(&dfb, 0u))
+        DfbCheck_Fail("hold read ready", 1u, 1, 0);
+
+    /* Two samples before the DFB runs: the first is lost */
+    DfbCheck_Write(1);
+    DfbCheck_Write(2);
+    if (dfb.stats.overruns[0] != 1u)
+        DfbCheck_Fail("overrun", 2u, (int32)dfb.stats.overruns[0], 1);
+}
+
+/* Filter_16Bit: DALIGN stage A and hold A, key mid, two bytes each way. */
+static void DfbCheck_Aligned(void)
+{
+    uint32 n;
+
+    DfbCheck_Start(0u);
+    DfbEmu_SetDalign(&dfb, DFBEMU_DALIGN_STAGEA | DFBEMU_DALIGN_HOLDA);
+    DfbEmu_SetCoherency(&dfb, 0u, DFBEMU_KEY_MID);
+    for (n = 0u; n < DFBCHECK_SAMPLES / 4u; n++)
+    {
+        int16 sample = (int16)(DfbCheck_Random() >> 8);
+        int32 want = DfbCheck_Reference((int32)sample * 256, 0u) >> 8;
+        int32 got;
+
+        DfbEmu_WriteStage(&dfb, 0u, 0u, (uint8)sample);
+        DfbEmu_WriteStage(&dfb, 0u, 1u, (uint8)((uint16)sample >> 8));
+        (void)DfbCheck_RunToWait();
+        got = DfbEmu_ReadHold(&dfb, 0u, 0u);
+        got |= (int32)DfbEmu_ReadHold(&dfb, 0u, 1u) << 8;
+        if ((int16)got != want)
+            DfbCheck_Fail("aligned", n, (int16)got, want);
+    }
+}
+
+static void DfbCheck_AssemblerError(void)
+{
+    static DfbEmu_Program bad;
+    char error[160];
+
+    if ((DfbEmu_Assemble("start:\n"
+                         "    acu(hold,hold) dmux(sa,sa) alu(hold) mac(hold)\n"
+                         "    acu(hold,hold) dmux(sa,sa) alu(hold) mac(hold) jmp(eob, nowhere)\n",
+                         &bad, error, sizeof(error)) != CYRET_BAD_DATA) ||
+        (strncmp(error, "line 3:", 7u) != 0))
+    {
+        printf("FAIL assembler error: %s\n", error);
+        failures++;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = (argc > 1) ? argv[1] : DFBCHECK_PROGRAM;
+    char error[160];
+    uint32 cycles;
+    uint32 cyclesRound;
+
+    if (DfbEmu_AssembleFile(path, &program, error, sizeof(error)) != CYRET_SUCCESS)
+    {
+        printf("%s: %s\n", path, error);
+        return EXIT_FAILURE;
+    }
+    taps = program.dataWords[1];
+
+    cycles = DfbCheck_Fir(0u);
+    cyclesRound = DfbCheck_Fir(1u);
+    DfbCheck_Coherency();
+    DfbCheck_Aligned();
+    DfbCheck_AssemblerError();
+    if (dfb.stats.faults != 0u)
+        DfbCheck_Fail("faults", 0u, (int32)dfb.stats.faults, 0);
+    /* WaitForNew, the 4 of ChA_init, a loop pass per tap but the first, ChA_firFinish */
+    if ((cycles != 1u + 4u + (taps - 1u) + 3u) || (cyclesRound != cycles))
+        DfbCheck_Fail("cycles", 0u, (int32)cycles, (int32)(taps + 7u));
+
+    printf("taps=%u code_words=%u samples=%u cycles_per_sample=%u clock_hz=%u "
+           "max_sample_rate_hz=%u failures=%u\n",
+           (unsigned)taps, (unsigned)program.codeWords, (unsigned)DFBCHECK_SAMPLES,
+           (unsigned)cycles, (unsigned)DFBCHECK_CLOCK_HZ, (unsigned)(DFBCHECK_CLOCK_HZ / cycles),
+           (unsigned)failures);
+    return (failures == 0u) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
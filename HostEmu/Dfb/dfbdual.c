@@ -0,0 +1,334 @@
+/**
+ * @file
+ * @brief Models Filter_ADC_VDAC01 with both DFB channels fed from one multiplexed ADC: checks
+ *        that the channels do not disturb each other and what the pair costs against one.
+ *
+ * Built and run by HostEmu/Makefile (make -C HostEmu dfbdual):
+ *
+ *     dfbdual [-c clock_hz] [-a conversion_hz] [-n conversions] [specA specB]
+ *
+ * It follows main.c with FILTER_CHANNELS 2: ADC_DelSig converts the two inputs in turn, one
+ * conversion every clock / conversion_hz DFB cycles, and the DMA TD chain writes each 8-bit
+ * result into the high byte, the coherency key, of staging register A and then B. DMA_1 and
+ * DMA_2 take the high byte of holding register A and B to their VDAC as soon as the channel's
+ * data ready rises. The DFB runs the two channel program dfbgen makes of specA and specB (see
+ * DfbGen.h); by default channel A of the schematic, an 85-tap Blackman lowpass at 6 kHz, and a
+ * 63-tap Hamming highpass at 1 kHz on B, both at 48 kHz, so 96 kHz of conversions.
+ *
+ * The conversions run three times: both inputs driven, B silent, A silent. Every byte a sink
+ * gets has to match the C model of its channel alone; the sink of a driven channel has to be the
+ * same whether the other input is driven or not, and the sink of a silent one has to stay 0. No
+ * conversion may reach a staging register before the DFB took the one before (an overrun).
+ *
+ * For the throughput, the cycles the two channel program spends on a sample of A and on one of
+ * B are set against those of the program that runs A alone, giving the conversion rate each keeps
+ * up with. The last line is a key=value summary; the exit status is nonzero when a check fails.
+ */
+#include "DfbGen.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DFBDUAL_CLOCK_HZ (24000000u)
+#define DFBDUAL_CONVERSION_HZ (96000u) /* 48 kHz a channel */
+#define DFBDUAL_CONVERSIONS (4096u)
+#define DFBDUAL_CONVERSIONS_MAX (16384u)
+#define DFBDUAL_SAMPLE_CYCLES (10000u) /* a sample that takes longer never ends */
+#define DFBDUAL_RUNS (3u)              /* both driven, B silent, A silent */
+
+static const char *const dfbDualSpecs[DFBEMU_CHANNELS] = {
+    "fir:lowpass:taps=85:fs=48000:fc=6000:window=blackman",
+    "fir:highpass:taps=63:fs=48000:fc=1000:window=hamming"};
+
+static DfbGen_Filter filters[DFBEMU_CHANNELS];
+static DfbGen_Channel channels[DFBEMU_CHANNELS];
+static DfbGen_Channel alone;
+static DfbGen_Model models[DFBEMU_CHANNELS];
+static DfbEmu_Program dual;
+static DfbEmu_Program single;
+static DfbEmu dfb;
+static char text[DFBGEN_TEXT_SIZE];
+static uint8 sinks[DFBDUAL_RUNS][DFBEMU_CHANNELS][DFBDUAL_CONVERSIONS_MAX / 2u];
+static uint8 wants[DFBEMU_CHANNELS][DFBDUAL_CONVERSIONS_MAX / 2u];
+static uint32 seed;
+
+static int8 DfbDual_Random(void)
+{
+    seed = seed * 1103515245u + 12345u;
+    return (int8)(seed >> 16);
+}
+
+/* Runs until the DFB waits on in1 / in2, returns the cycles that took or 0 when it never did. */
+static uint32 DfbDual_RunToWait(void)
+{
+    uint64 idle = dfb.stats.idleCycles;
+    uint32 cycles;
+
+    for (cycles = 0u; cycles < DFBDUAL_SAMPLE_CYCLES; cycles++)
+    {
+        DfbEmu_Step(&dfb);
+        if (!dfb.running)
+            return 0u;
+        if (dfb.stats.idleCycles != idle)
+            return cycles;
+    }
+    return 0u;
+}
+
+static void DfbDual_Start(const DfbEmu_Program *program)
+{
+    DfbEmu_Init(&dfb, program);
+    DfbEmu_SetCoherency(&dfb, 0u, DFBEMU_KEY_HIGH);
+    DfbEmu_SetCoherency(&dfb, 1u, DFBEMU_KEY_HIGH);
+}
+
+/* The most cycles @p program spends on a sample of @p channel, samples back to back; 0 when it
+ * does not go back to waiting. */
+static uint32 DfbDual_Cost(const DfbEmu_Program *program, uint8 channel, uint32 samples)
+{
+    uint32 worst = 0u;
+    uint32 n;
+
+    DfbDual_Start(program);
+    if (DfbDual_RunToWait() == 0u)
+        return 0u;
+    seed = 1u;
+    for (n = 0u; n < samples; n++)
+    {
+        uint32 cycles;
+
+        DfbEmu_WriteStage(&dfb, channel, 2u, (uint8)DfbDual_Random());
+        cycles = DfbDual_RunToWait();
+        if (cycles == 0u)
+            return 0u;
+        if (cycles > worst)
+            worst = cycles;
+        if (DfbEmu_Ready(&dfb, channel))
+            (void)DfbEmu_ReadHold(&dfb, channel, 2u);
+    }
+    return worst;
+}
+
+/* One DFB cycle, and the DMAs moving what is ready to the sinks of @p run. */
+static uint8 DfbDual_Step(uint8 run, uint32 *outputs)
+{
+    uint8 ch;
+
+    DfbEmu_Step(&dfb);
+    for (ch = 0u; ch < DFBEMU_CHANNELS; ch++)
+    {
+        if (DfbEmu_Ready(&dfb, ch))
+        {
+            uint8 byte = DfbEmu_ReadHold(&dfb, ch, 2u);
+
+            if (outputs[ch] < DFBDUAL_CONVERSIONS_MAX / 2u)
+                sinks[run][ch][outputs[ch]++] = byte;
+        }
+    }
+    return dfb.running;
+}
+
+/* Feeds @p conversions, A and B in turn every @p period cycles, the inputs not in @p driven
+ * silent; returns the sink bytes that differ from the models. */
+static uint32 DfbDual_Run(uint8 run, uint8 driven, uint32 period, uint32 conversions,
+                          uint32 *overruns, uint64 *busy)
+{
+    uint32 outputs[DFBEMU_CHANNELS] = {0u, 0u};
+    uint32 mismatches = 0u;
+    uint32 n;
+    uint32 c;
+    uint8 ch;
+
+    DfbDual_Start(&dual);
+    for (ch = 0u; ch < DFBEMU_CHANNELS; ch++)
+        DfbGen_ModelInit(&models[ch], &channels[ch], 0u, 0u);
+    if (DfbDual_RunToWait() == 0u)
+        return conversions;
+    seed = 1u;
+    for (n = 0u; n < conversions; n++)
+    {
+        int8 sample = DfbDual_Random();
+        int32 want = 0;
+
+        ch = (uint8)(n & 1u);
+        if (!(driven & (1u << ch)))
+            sample = 0;
+        DfbEmu_WriteStage(&dfb, ch, 2u, (uint8)sample);
+        (void)DfbGen_Reference(&models[ch], (int32)sample * 65536, &want);
+        wants[ch][n / 2u] = (uint8)((uint32)want >> 16);
+        for (c = 0u; c < period; c++)
+            if (!DfbDual_Step(run, outputs))
+                return conversions;
+    }
+    /* The last outputs */
+    for (c = 0u; c < DFBDUAL_SAMPLE_CYCLES; c++)
+        if (!DfbDual_Step(run, outputs))
+            return conversions;
+
+    for (ch = 0u; ch < DFBEMU_CHANNELS; ch++)
+    {
+        uint32 expected = (conversions + 1u - ch) / 2u;
+
+        if (outputs[ch] != expected)
+        {
+            fprintf(stderr, "run %u channel %c: %u outputs for %u samples\n", (unsigned)run,
+                    'A' + ch, (unsigned)outputs[ch], (unsigned)expected);
+            mismatches += (outputs[ch] > expected) ? outputs[ch] - expected
+                                                   : expected - outputs[ch];
+        }
+        for (n = 0u; (n < outputs[ch]) && (n < expected); n++)
+        {
+            if ((sinks[run][ch][n] != wants[ch][n]) && (mismatches++ < 5u))
+                fprintf(stderr, "run %u channel %c sample %u: got %u want %u\n", (unsigned)run,
+                        'A' + ch, (unsigned)n, (unsigned)sinks[run][ch][n],
+                        (unsigned)wants[ch][n]);
+        }
+        *overruns += dfb.stats.overruns[ch];
+    }
+    *busy = dfb.stats.cycles - dfb.stats.idleCycles;
+    return mismatches;
+}
+
+static cystatus DfbDual_Program(const DfbGen_Filter *const *designs, uint8 count,
+                                DfbGen_Channel *out, DfbEmu_Program *program)
+{
+    char error[256];
+
+    if (DfbGen_Layout(designs, count, DFBGEN_FOLD_AUTO, out, error, sizeof(error)) !=
+        CYRET_SUCCESS)
+    {
+        fprintf(stderr, "%s\n", error);
+        return CYRET_BAD_PARAM;
+    }
+    if (DfbGen_Emit(out, count, text, sizeof(text)) != CYRET_SUCCESS)
+    {
+        fprintf(stderr, "the program is over %u bytes\n", (unsigned)sizeof(text));
+        return CYRET_MEMORY;
+    }
+    if (DfbEmu_Assemble(text, program, error, sizeof(error)) != CYRET_SUCCESS)
+    {
+        fprintf(stderr, "the generated program does not assemble: %s\n", error);
+        return CYRET_BAD_DATA;
+    }
+    return CYRET_SUCCESS;
+}
+
+static void DfbDual_Usage(void)
+{
+    fprintf(stderr, "usage: dfbdual [-c clock_hz] [-a conversion_hz] [-n conversions] "
+                    "[specA specB]\n");
+}
+
+int main(int argc, char **argv)
+{
+    static const uint8 driven[DFBDUAL_RUNS] = {0x3u, 0x1u, 0x2u};
+    const DfbGen_Filter *designs[DFBEMU_CHANNELS];
+    const char *specs[DFBEMU_CHANNELS];
+    char error[256];
+    uint32 clockHz = DFBDUAL_CLOCK_HZ;
+    uint32 conversionHz = DFBDUAL_CONVERSION_HZ;
+    uint32 conversions = DFBDUAL_CONVERSIONS;
+    uint32 mismatches = 0u;
+    uint32 overruns = 0u;
+    uint32 isolation = 0u;
+    uint32 crosstalk = 0u;
+    uint32 costAlone;
+    uint32 cost[DFBEMU_CHANNELS];
+    uint32 period;
+    uint32 dualHz;
+    uint64 busy = 0u;
+    uint32 n;
+    uint8 count = 0u;
+    uint8 run;
+    uint8 ok = 1u;
+    uint8 ch;
+    int k;
+
+    specs[0] = dfbDualSpecs[0];
+    specs[1] = dfbDualSpecs[1];
+    for (k = 1; k < argc; k++)
+    {
+        if ((strcmp(argv[k], "-c") == 0) && (k + 1 < argc))
+            clockHz = (uint32)strtoul(argv[++k], NULL, 0);
+        else if ((strcmp(argv[k], "-a") == 0) && (k + 1 < argc))
+            conversionHz = (uint32)strtoul(argv[++k], NULL, 0);
+        else if ((strcmp(argv[k], "-n") == 0) && (k + 1 < argc))
+            conversions = (uint32)strtoul(argv[++k], NULL, 0);
+        else if ((argv[k][0] != '-') && (count < DFBEMU_CHANNELS))
+            specs[count++] = argv[k];
+        else
+            count = DFBEMU_CHANNELS + 1u;
+    }
+    if ((count == 1u) || (count > DFBEMU_CHANNELS) || (clockHz == 0u) || (conversionHz == 0u) ||
+        (conversionHz > clockHz) || (conversions < 2u) || (conversions > DFBDUAL_CONVERSIONS_MAX))
+    {
+        DfbDual_Usage();
+        return EXIT_FAILURE;
+    }
+    period = clockHz / conversionHz;
+
+    for (ch = 0u; ch < DFBEMU_CHANNELS; ch++)
+    {
+        if (DfbGen_Parse(specs[ch], &filters[ch], error, sizeof(error)) != CYRET_SUCCESS)
+        {
+            fprintf(stderr, "channel %c: %s\n", 'A' + ch, error);
+            return EXIT_FAILURE;
+        }
+        designs[ch] = &filters[ch];
+    }
+    if ((DfbDual_Program(designs, 1u, &alone, &single) != CYRET_SUCCESS) ||
+        (DfbDual_Program(designs, DFBEMU_CHANNELS, channels, &dual) != CYRET_SUCCESS))
+        return EXIT_FAILURE;
+
+    /* Throughput */
+    costAlone = DfbDual_Cost(&single, 0u, DFBDUAL_CONVERSIONS);
+    cost[0] = DfbDual_Cost(&dual, 0u, DFBDUAL_CONVERSIONS);
+    cost[1] = DfbDual_Cost(&dual, 1u, DFBDUAL_CONVERSIONS);
+    if ((costAlone == 0u) || (cost[0] == 0u) || (cost[1] == 0u))
+    {
+        fprintf(stderr, "a program did not go back to waiting\n");
+        return EXIT_FAILURE;
+    }
+    dualHz = (uint32)(2u * (uint64)clockHz / (cost[0] + cost[1]));
+
+    /* Isolation */
+    for (run = 0u; run < DFBDUAL_RUNS; run++)
+    {
+        uint64 cycles = 0u;
+
+        mismatches += DfbDual_Run(run, driven[run], period, conversions, &overruns, &cycles);
+        if (run == 0u)
+            busy = cycles;
+        if (dfb.stats.faults != 0u)
+            ok = 0u;
+    }
+    for (n = 0u; n < conversions / 2u; n++)
+    {
+        isolation += (sinks[0][0][n] != sinks[1][0][n]) ? 1u : 0u;
+        isolation += (sinks[0][1][n] != sinks[2][1][n]) ? 1u : 0u;
+        crosstalk += (sinks[1][1][n] != 0u) ? 1u : 0u;
+        crosstalk += (sinks[2][0][n] != 0u) ? 1u : 0u;
+    }
+    if ((mismatches != 0u) || (overruns != 0u) || (isolation != 0u) || (crosstalk != 0u))
+        ok = 0u;
+
+    for (ch = 0u; ch < DFBEMU_CHANNELS; ch++)
+        printf("channel %c: %s, %u coefficient words%s, %u sample words, %u cycles a sample\n",
+               'A' + ch, filters[ch].description, (unsigned)channels[ch].words,
+               channels[ch].fold ? " (folded)" : "", (unsigned)channels[ch].samples,
+               (unsigned)cost[ch]);
+    printf("channel A alone: %u coefficient words%s, %u cycles a sample\n",
+           (unsigned)alone.words, alone.fold ? " (folded)" : "", (unsigned)costAlone);
+    printf("channels=2 clock_hz=%u conversion_hz=%u period_cycles=%u conversions=%u "
+           "single_cycles=%u single_max_hz=%u dual_cycles_a=%u dual_cycles_b=%u "
+           "dual_max_conversion_hz=%u throughput_ratio=%.2f dfb_load=%.2f overruns=%u "
+           "mismatches=%u isolation_diffs=%u crosstalk=%u faults=%u ok=%u\n",
+           (unsigned)clockHz, (unsigned)conversionHz, (unsigned)period, (unsigned)conversions,
+           (unsigned)costAlone, (unsigned)(clockHz / costAlone), (unsigned)cost[0],
+           (unsigned)cost[1], (unsigned)dualHz, (double)dualHz * costAlone / clockHz,
+           (double)busy / ((uint64)period * conversions), (unsigned)overruns,
+           (unsigned)mismatches, (unsigned)isolation, (unsigned)crosstalk,
+           (unsigned)dfb.stats.faults, (unsigned)ok);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
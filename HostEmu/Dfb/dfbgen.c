@@ -0,0 +1,320 @@
+/**
+ * @file
+ * @brief Designs a filter, writes the dfb.v2 program that runs it and checks that program on
+ *        the DfbEmu model.
+ *
+ * Built and run by HostEmu/Makefile (make -C HostEmu dfbgen):
+ *
+ *     dfbgen [-o out.v2] [-c clock_hz] [-R rate_hz] [-n samples] [-f auto|on|off] [-r] [-s]
+ *            [-2] specA [specB]
+ *
+ * The specs are described in DfbGen.h, e.g. fir:lowpass:taps=85:fs=48000:fc=4000 or
+ * iir:lowpass:order=4:fs=48000:fc=1000. One spec runs on channel A; two, or one with -2, run on
+ * both channels, A and B each with their own coefficients. -f folds symmetric FIR taps (auto
+ * does when it is free or needed to fit). -r and -s are the rounding and saturation the program
+ * will run with, -c the DFB clock (BUS_CLK, 24 MHz in the Filter examples) and -R the sample
+ * rate it has to keep up with.
+ *
+ * The program is assembled and fed pseudo-random samples, scaled so that the design cannot
+ * overflow, on every channel; each output has to match the C model of the program bit for bit,
+ * and is compared with the unquantized design for the error the Q23 coefficients and the MAC
+ * truncation add. A line per channel gives the storage and the errors, the last line is a
+ * key=value summary. The program is only written to -o when it passed; the exit status is
+ * nonzero when a design does not fit, a sample mismatches or the DFB is too slow for -R.
+ */
+#include "DfbGen.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DFBGEN_CLOCK_HZ (24000000u)
+#define DFBGEN_SAMPLES (4096u)
+#define DFBGEN_SAMPLE_CYCLES (10000u) /* a sample that takes longer never ends */
+#define DFBGEN_GAIN_SAMPLES (4096u)   /* of the impulse response for the gain bound */
+
+static DfbGen_Filter filters[DFBEMU_CHANNELS];
+static DfbGen_Channel channels[DFBEMU_CHANNELS];
+static DfbGen_Model models[DFBEMU_CHANNELS];
+static DfbEmu_Program program;
+static DfbEmu dfb;
+static char text[DFBGEN_TEXT_SIZE];
+static uint32 seed = 1u;
+
+static int32 DfbGenCli_Random(void)
+{
+    seed = seed * 1103515245u + 12345u;
+    return DfbEmu_Signed24(seed >> 8);
+}
+
+/* Runs until the DFB waits on in1 / in2, returns the cycles that took or 0 when it never did. */
+static uint32 DfbGenCli_RunToWait(void)
+{
+    uint64 idle = dfb.stats.idleCycles;
+    uint32 cycles;
+
+    for (cycles = 0u; cycles < DFBGEN_SAMPLE_CYCLES; cycles++)
+    {
+        DfbEmu_Step(&dfb);
+        if (!dfb.running)
+            return 0u;
+        if (dfb.stats.idleCycles != idle)
+            return cycles;
+    }
+    return 0u;
+}
+
+static void DfbGenCli_Write(uint8 channel, int32 sample)
+{
+    DfbEmu_WriteStage(&dfb, channel, 0u, (uint8)sample);
+    DfbEmu_WriteStage(&dfb, channel, 1u, (uint8)(sample >> 8));
+    DfbEmu_WriteStage(&dfb, channel, 2u, (uint8)(sample >> 16));
+}
+
+static int32 DfbGenCli_Read(uint8 channel)
+{
+    uint32 value = DfbEmu_ReadHold(&dfb, channel, 0u);
+
+    value |= (uint32)DfbEmu_ReadHold(&dfb, channel, 1u) << 8;
+    value |= (uint32)DfbEmu_ReadHold(&dfb, channel, 2u) << 16;
+    return DfbEmu_Signed24(value);
+}
+
+/* The sum of |h| of the design, the most its output grows over a full scale input. */
+static double DfbGenCli_Gain(const DfbGen_Channel *channel)
+{
+    static DfbGen_Model model;
+    double gain = 0.0;
+    uint32 n;
+
+    DfbGen_ModelInit(&model, channel, 0u, 0u);
+    for (n = 0u; n < DFBGEN_GAIN_SAMPLES; n++)
+        gain += fabs(DfbGen_Ideal(&model, (n == 0u) ? 1.0 : 0.0));
+    return gain;
+}
+
+static void DfbGenCli_Usage(void)
+{
+    fprintf(stderr, "usage: dfbgen [-o out.v2] [-c clock_hz] [-R rate_hz] [-n samples] "
+                    "[-f auto|on|off] [-r] [-s] [-2] specA [specB]\n");
+}
+
+int main(int argc, char **argv)
+{
+    const DfbGen_Filter *designs[DFBEMU_CHANNELS];
+    const char *specs[DFBEMU_CHANNELS] = {NULL, NULL};
+    const char *outPath = NULL;
+    char error[256];
+    double scale[DFBEMU_CHANNELS];
+    double gain[DFBEMU_CHANNELS];
+    double errorMax[DFBEMU_CHANNELS] = {0.0, 0.0};
+    double signal[DFBEMU_CHANNELS] = {0.0, 0.0};
+    double noise[DFBEMU_CHANNELS] = {0.0, 0.0};
+    uint32 mismatches[DFBEMU_CHANNELS] = {0u, 0u};
+    uint32 clockHz = DFBGEN_CLOCK_HZ;
+    uint32 rateHz = 0u;
+    uint32 samples = DFBGEN_SAMPLES;
+    uint32 cyclesMin = 0xFFFFFFFFu;
+    uint32 cyclesMax = 0u;
+    uint64 cyclesSum = 0u;
+    uint32 outputs = 0u;
+    uint32 n;
+    uint8 fold = DFBGEN_FOLD_AUTO;
+    uint8 count = 0u;
+    uint8 round = 0u;
+    uint8 saturate = 0u;
+    uint8 both = 0u;
+    uint8 ok = 1u;
+    uint8 ch;
+    int k;
+
+    for (k = 1; k < argc; k++)
+    {
+        if ((strcmp(argv[k], "-o") == 0) && (k + 1 < argc))
+            outPath = argv[++k];
+        else if ((strcmp(argv[k], "-c") == 0) && (k + 1 < argc))
+            clockHz = (uint32)strtoul(argv[++k], NULL, 0);
+        else if ((strcmp(argv[k], "-R") == 0) && (k + 1 < argc))
+            rateHz = (uint32)strtoul(argv[++k], NULL, 0);
+        else if ((strcmp(argv[k], "-n") == 0) && (k + 1 < argc))
+            samples = (uint32)strtoul(argv[++k], NULL, 0);
+        else if ((strcmp(argv[k], "-f") == 0) && (k + 1 < argc))
+        {
+            k++;
+            if (strcmp(argv[k], "on") == 0)
+                fold = DFBGEN_FOLD_ON;
+            else if (strcmp(argv[k], "off") == 0)
+                fold = DFBGEN_FOLD_OFF;
+            else if (strcmp(argv[k], "auto") != 0)
+                count = DFBEMU_CHANNELS + 1u;
+        }
+        else if (strcmp(argv[k], "-r") == 0)
+            round = 1u;
+        else if (strcmp(argv[k], "-s") == 0)
+            saturate = 1u;
+        else if (strcmp(argv[k], "-2") == 0)
+            both = 1u;
+        else if ((argv[k][0] != '-') && (count < DFBEMU_CHANNELS))
+            specs[count++] = argv[k];
+        else
+            count = DFBEMU_CHANNELS + 1u;
+    }
+    if ((count == 0u) || (count > DFBEMU_CHANNELS) || (both && (count != 1u)) || (clockHz == 0u) ||
+        (samples == 0u))
+    {
+        DfbGenCli_Usage();
+        return EXIT_FAILURE;
+    }
+    if (both)
+        specs[count++] = specs[0];
+
+    for (ch = 0u; ch < count; ch++)
+    {
+        if (DfbGen_Parse(specs[ch], &filters[ch], error, sizeof(error)) != CYRET_SUCCESS)
+        {
+            fprintf(stderr, "channel %c: %s\n", 'A' + ch, error);
+            return EXIT_FAILURE;
+        }
+        designs[ch] = &filters[ch];
+    }
+    if (DfbGen_Layout(designs, count, fold, channels, error, sizeof(error)) != CYRET_SUCCESS)
+    {
+        fprintf(stderr, "%s\n", error);
+        return EXIT_FAILURE;
+    }
+    if (DfbGen_Emit(channels, count, text, sizeof(text)) != CYRET_SUCCESS)
+    {
+        fprintf(stderr, "the program is over %u bytes\n", (unsigned)sizeof(text));
+        return EXIT_FAILURE;
+    }
+    if (DfbEmu_Assemble(text, &program, error, sizeof(error)) != CYRET_SUCCESS)
+    {
+        fprintf(stderr, "the generated program does not assemble: %s\n", error);
+        return EXIT_FAILURE;
+    }
+
+    for (ch = 0u; ch < count; ch++)
+    {
+        gain[ch] = DfbGenCli_Gain(&channels[ch]);
+        scale[ch] = (gain[ch] > 1.0) ? 1.0 / gain[ch] : 1.0;
+        DfbGen_ModelInit(&models[ch], &channels[ch], round, saturate);
+    }
+    DfbEmu_Init(&dfb, &program);
+    DfbEmu_SetRounding(&dfb, round);
+    DfbEmu_SetSaturation(&dfb, saturate);
+    DfbEmu_SetCoherency(&dfb, 0u, DFBEMU_KEY_HIGH);
+    DfbEmu_SetCoherency(&dfb, 1u, DFBEMU_KEY_HIGH);
+    if (DfbGenCli_RunToWait() == 0u)
+    {
+        fprintf(stderr, "the generated program never waits on in1 / in2\n");
+        return EXIT_FAILURE;
+    }
+
+    for (n = 0u; n < samples; n++)
+    {
+        int32 in[DFBEMU_CHANNELS];
+        uint32 cycles;
+
+        for (ch = 0u; ch < count; ch++)
+        {
+            in[ch] = (int32)floor(DfbGenCli_Random() * scale[ch]);
+            DfbGenCli_Write(ch, in[ch]);
+        }
+        cycles = DfbGenCli_RunToWait();
+        if (cycles == 0u)
+        {
+            fprintf(stderr, "sample %u: the DFB did not go back to waiting\n", (unsigned)n);
+            ok = 0u;
+            break;
+        }
+        cyclesSum += cycles;
+        if (cycles < cyclesMin)
+            cyclesMin = cycles;
+        if (cycles > cyclesMax)
+            cyclesMax = cycles;
+        for (ch = 0u; ch < count; ch++)
+        {
+            int32 want = 0;
+            uint8 output = DfbGen_Reference(&models[ch], in[ch], &want);
+            double ideal = DfbGen_Ideal(&models[ch], in[ch]);
+            int32 got;
+
+            if (!output)
+            {
+                /* A decimating FIR between outputs */
+                if (DfbEmu_Ready(&dfb, ch) && (mismatches[ch]++ < 5u))
+                    fprintf(stderr, "channel %c sample %u: an output where none is due\n",
+                            'A' + ch, (unsigned)n);
+                continue;
+            }
+            got = DfbEmu_Ready(&dfb, ch) ? DfbGenCli_Read(ch) : ~want;
+            outputs += (ch == 0u) ? 1u : 0u;
+            if ((got != want) && (mismatches[ch]++ < 5u))
+                fprintf(stderr, "channel %c sample %u: got %ld want %ld\n", 'A' + ch,
+                        (unsigned)n, (long)got, (long)want);
+            if (fabs(got - ideal) > errorMax[ch])
+                errorMax[ch] = fabs(got - ideal);
+            signal[ch] += ideal * ideal;
+            noise[ch] += (got - ideal) * (got - ideal);
+        }
+    }
+    if (dfb.stats.faults != 0u)
+        ok = 0u;
+    if (n == 0u)
+        cyclesMin = 0u;
+
+    for (ch = 0u; ch < count; ch++)
+    {
+        const DfbGen_Channel *c = &channels[ch];
+
+        if (mismatches[ch] != 0u)
+            ok = 0u;
+        printf("channel %c: %s, %u coefficient words%s, %u sample words, coef_error_max=%.3f "
+               "clamped=%u gain_bound=%.3f input_scale=%.3f out_error_max=%.2f snr_db=%.1f "
+               "mismatches=%u\n",
+               'A' + ch, c->filter->description, (unsigned)c->words, c->fold ? " (folded)" : "",
+               (unsigned)c->samples, c->coefErrorMax, (unsigned)c->clamped, gain[ch], scale[ch],
+               errorMax[ch], (noise[ch] > 0.0) ? 10.0 * log10(signal[ch] / noise[ch]) : 999.0,
+               (unsigned)mismatches[ch]);
+    }
+    if ((rateHz != 0u) && ((cyclesMax == 0u) || (clockHz / cyclesMax < rateHz)))
+    {
+        fprintf(stderr, "%u cycles a sample at %u Hz do not keep up with %u Hz\n",
+                (unsigned)cyclesMax, (unsigned)clockHz, (unsigned)rateHz);
+        ok = 0u;
+    }
+    if (ok && (outPath != NULL))
+    {
+        FILE *out = fopen(outPath, "w");
+
+        if ((out != NULL) &&
+            (fprintf(out, "// DfbEmu: %u to %u cycles a sample, %.1f on average; at %u Hz up to "
+                          "%u Hz\n",
+                     (unsigned)cyclesMin, (unsigned)cyclesMax, (double)cyclesSum / n,
+                     (unsigned)clockHz, (unsigned)(clockHz / cyclesMax)) < 0))
+        {
+            (void)fclose(out);
+            out = NULL;
+        }
+        if ((out == NULL) || (fputs(text, out) == EOF) || (fclose(out) != 0))
+        {
+            fprintf(stderr, "cannot write %s\n", outPath);
+            ok = 0u;
+        }
+    }
+
+    printf("channels=%u code_words=%u/%u data_a_words=%u data_b_words=%u acu_words=%u "
+           "samples=%u decimation=%u outputs=%u cycles_per_sample_min=%u "
+           "cycles_per_sample_avg=%.1f cycles_per_sample=%u clock_hz=%u max_sample_rate_hz=%u rate_hz=%u fits=%s faults=%u "
+           "ok=%u\n",
+           (unsigned)count, (unsigned)program.codeWords, (unsigned)DFBEMU_CODE_WORDS,
+           (unsigned)program.dataWords[0], (unsigned)program.dataWords[1],
+           (unsigned)program.acuWords, (unsigned)n, (unsigned)filters[0].decimation,
+           (unsigned)outputs, (unsigned)cyclesMin, n ? (double)cyclesSum / n : 0.0,
+           (unsigned)cyclesMax, (unsigned)clockHz,
+           cyclesMax ? (unsigned)(clockHz / cyclesMax) : 0u, (unsigned)rateHz,
+           ((rateHz == 0u) || (cyclesMax && (clockHz / cyclesMax >= rateHz))) ? "yes" : "no",
+           (unsigned)dfb.stats.faults, (unsigned)ok);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
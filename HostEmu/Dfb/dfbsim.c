@@ -0,0 +1,204 @@
+/**
+ * @file
+ * @brief Runs a dfb.v2 program on the DfbEmu model and reports what it costs per sample.
+ *
+ * Built and run by HostEmu/Makefile (make -C HostEmu dfbsim):
+ *
+ *     dfbsim [-c clock_hz] [-n samples] [-i input] [-r] [-s] [-v] program.v2
+ *
+ * The samples go into staging register A, and B as well when the program waits on in2, as
+ * Filter_24Bit writes them: three bytes, the high one the coherency key. Without -i they are an
+ * impulse of 0.5 followed by zeros, so -v prints the impulse response; -i reads one sample a
+ * line, a signed 24-bit integer. -r rounds the MAC output, -s saturates. -c is the DFB clock,
+ * BUS_CLK, 24 MHz in the Filter examples.
+ *
+ * After each sample the DFB runs until it waits again; the cycles it took are the cost of a
+ * sample, and the clock over the worst of them the highest sample rate it keeps up with. The
+ * last line is a key=value summary; the exit status is nonzero when the program does not
+ * assemble, faults or never goes back to waiting.
+ */
+#include "DfbEmu.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DFBSIM_CLOCK_HZ (24000000u)
+#define DFBSIM_SAMPLES (256u)
+#define DFBSIM_IMPULSE (0x400000)
+#define DFBSIM_SAMPLE_CYCLES (10000u) /* a sample that takes longer never ends */
+
+static DfbEmu_Program program;
+static DfbEmu dfb;
+
+/* Runs until the DFB waits on in1 / in2, returns the cycles that took or 0 when it never did. */
+static uint32 DfbSim_RunToWait(void)
+{
+    uint64 idle = dfb.stats.idleCycles;
+    uint32 cycles;
+
+    for (cycles = 0u; cycles < DFBSIM_SAMPLE_CYCLES; cycles++)
+    {
+        DfbEmu_Step(&dfb);
+        if (!dfb.running)
+            return 0u;
+        if (dfb.stats.idleCycles != idle)
+            return cycles;
+    }
+    return 0u;
+}
+
+static void DfbSim_Write(uint8 channel, int32 sample)
+{
+    DfbEmu_WriteStage(&dfb, channel, 0u, (uint8)sample);
+    DfbEmu_WriteStage(&dfb, channel, 1u, (uint8)(sample >> 8));
+    DfbEmu_WriteStage(&dfb, channel, 2u, (uint8)(sample >> 16));
+}
+
+static int32 DfbSim_Read(uint8 channel)
+{
+    uint32 value = DfbEmu_ReadHold(&dfb, channel, 0u);
+
+    value |= (uint32)DfbEmu_ReadHold(&dfb, channel, 1u) << 8;
+    value |= (uint32)DfbEmu_ReadHold(&dfb, channel, 2u) << 16;
+    return DfbEmu_Signed24(value);
+}
+
+static void DfbSim_Usage(void)
+{
+    fprintf(stderr, "usage: dfbsim [-c clock_hz] [-n samples] [-i input] [-r] [-s] [-v] "
+                    "program.v2\n");
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = NULL;
+    const char *name;
+    const char *inputPath = NULL;
+    FILE *input = NULL;
+    char error[160];
+    uint32 clockHz = DFBSIM_CLOCK_HZ;
+    uint32 samples = DFBSIM_SAMPLES;
+    uint32 cyclesMin = 0xFFFFFFFFu;
+    uint32 cyclesMax = 0u;
+    uint64 cyclesSum = 0u;
+    uint32 n;
+    uint8 round = 0u;
+    uint8 saturate = 0u;
+    uint8 verbose = 0u;
+    uint8 channels = 1u;
+    uint8 ok = 1u;
+    int k;
+
+    for (k = 1; k < argc; k++)
+    {
+        if ((strcmp(argv[k], "-c") == 0) && (k + 1 < argc))
+            clockHz = (uint32)strtoul(argv[++k], NULL, 0);
+        else if ((strcmp(argv[k], "-n") == 0) && (k + 1 < argc))
+            samples = (uint32)strtoul(argv[++k], NULL, 0);
+        else if ((strcmp(argv[k], "-i") == 0) && (k + 1 < argc))
+            inputPath = argv[++k];
+        else if (strcmp(argv[k], "-r") == 0)
+            round = 1u;
+        else if (strcmp(argv[k], "-s") == 0)
+            saturate = 1u;
+        else if (strcmp(argv[k], "-v") == 0)
+            verbose = 1u;
+        else if ((argv[k][0] != '-') && (path == NULL))
+            path = argv[k];
+        else
+        {
+            DfbSim_Usage();
+            return EXIT_FAILURE;
+        }
+    }
+    if ((path == NULL) || (clockHz == 0u) || (samples == 0u))
+    {
+        DfbSim_Usage();
+        return EXIT_FAILURE;
+    }
+    if (DfbEmu_AssembleFile(path, &program, error, sizeof(error)) != CYRET_SUCCESS)
+    {
+        fprintf(stderr, "%s: %s\n", path, error);
+        return EXIT_FAILURE;
+    }
+    if ((inputPath != NULL) && ((input = fopen(inputPath, "r")) == NULL))
+    {
+        fprintf(stderr, "cannot open %s\n", inputPath);
+        return EXIT_FAILURE;
+    }
+    for (n = 0u; n < program.codeWords; n++)
+    {
+        if (program.code[n].cond & DFBEMU_COND_IN2)
+            channels = 2u;
+    }
+
+    DfbEmu_Init(&dfb, &program);
+    DfbEmu_SetRounding(&dfb, round);
+    DfbEmu_SetSaturation(&dfb, saturate);
+    DfbEmu_SetCoherency(&dfb, 0u, DFBEMU_KEY_HIGH);
+    DfbEmu_SetCoherency(&dfb, 1u, DFBEMU_KEY_HIGH);
+    if (DfbSim_RunToWait() == 0u)
+    {
+        fprintf(stderr, "%s: the program never waits on in1 / in2\n", path);
+        return EXIT_FAILURE;
+    }
+
+    for (n = 0u; n < samples; n++)
+    {
+        long sample = ((n == 0u) && (input == NULL)) ? DFBSIM_IMPULSE : 0;
+        uint32 cycles;
+        uint8 ch;
+
+        if ((input != NULL) && (fscanf(input, "%ld", &sample) != 1))
+            break;
+        for (ch = 0u; ch < channels; ch++)
+            DfbSim_Write(ch, (int32)sample);
+        cycles = DfbSim_RunToWait();
+        if (cycles == 0u)
+        {
+            fprintf(stderr, "sample %u: the DFB did not go back to waiting\n", (unsigned)n);
+            ok = 0u;
+            break;
+        }
+        cyclesSum += cycles;
+        if (cycles < cyclesMin)
+            cyclesMin = cycles;
+        if (cycles > cyclesMax)
+            cyclesMax = cycles;
+        if (verbose)
+        {
+            printf("%u", (unsigned)n);
+            for (ch = 0u; ch < channels; ch++)
+                printf(" %ld", DfbEmu_Ready(&dfb, ch) ? (long)DfbSim_Read(ch) : 0L);
+            printf("\n");
+        }
+        else
+        {
+            for (ch = 0u; ch < channels; ch++)
+                (void)DfbSim_Read(ch);
+        }
+    }
+    if (input != NULL)
+        (void)fclose(input);
+    name = strrchr(path, '/');
+    name = (name != NULL) ? name + 1 : path;
+    samples = n;
+    if (samples == 0u)
+        cyclesMin = 0u;
+    if (dfb.stats.faults != 0u)
+        ok = 0u;
+
+    printf("program=%s code_words=%u/%u data_a_words=%u data_b_words=%u acu_words=%u channels=%u "
+           "samples=%u cycles_per_sample_min=%u cycles_per_sample_max=%u "
+           "cycles_per_sample_avg=%.1f latency_cycles=%u clock_hz=%u max_sample_rate_hz=%u "
+           "outputs=%u faults=%u\n",
+           name, (unsigned)program.codeWords, (unsigned)DFBEMU_CODE_WORDS,
+           (unsigned)program.dataWords[0], (unsigned)program.dataWords[1],
+           (unsigned)program.acuWords, (unsigned)channels, (unsigned)samples, (unsigned)cyclesMin,
+           (unsigned)cyclesMax, samples ? (double)cyclesSum / samples : 0.0,
+           (unsigned)dfb.stats.latencyMax[0], (unsigned)clockHz,
+           cyclesMax ? (unsigned)(clockHz / cyclesMax) : 0u, (unsigned)dfb.stats.outputs[0],
+           (unsigned)dfb.stats.faults);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
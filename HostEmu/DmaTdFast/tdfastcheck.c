@@ -0,0 +1,196 @@
+/**
+ * @file
+ * @brief Host check of Common/DmaTdFast.h against the CyDmac TD API.
+ *
+ * Every TD the free list hands out after CyDmacConfigure() has to be the DMA_TD_FAST_SLOT() of
+ * its allocation order. On each of those handles, the same fields are then written once with
+ * CyDmaTdSetConfiguration() / CyDmaTdSetAddress() and once with the DmaTdFast macros, the
+ * single field ones and the whole word ones, and the TD memory of CY_DMA_TDMEM_STRUCT_PTR has
+ * to come out byte for byte the same, its neighbours untouched. The addresses are the LO16()
+ * halves of buffers in both SRAM halves and of peripheral registers, the counts span the 12
+ * bits. Built and run by HostEmu/Makefile (make -C HostEmu tdfastcheck):
+ *
+ *     tdfastcheck [rounds]
+ *
+ * The last line is a key=value summary; the process exits nonzero on any failed check.
+ */
+#include "CyDmac.h"
+#include "CyEmu.h"
+
+#include "../../Common/DmaTdFast.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TDFAST_CHECK_TDS (4u) /**< the TD under test, its neighbours and a far one */
+
+static uint32 checkFailures;
+static uint32 checkCount;
+
+/* Buffers in the lower and the upper SRAM half; their LO16() halves are what a TD holds */
+static uint8 lowBuffer[256];
+static uint8 highBuffer[256] __attribute__((section(".ram2")));
+
+#define CHECK(cond)                                                                                \
+    do                                                                                             \
+    {                                                                                              \
+        checkCount++;                                                                              \
+        if (!(cond))                                                                               \
+        {                                                                                          \
+            checkFailures++;                                                                       \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);                        \
+        }                                                                                          \
+    } while (0)
+
+static uint32 tdFastSeed = 1u;
+
+static uint32 TdFast_Random(void)
+{
+    tdFastSeed = tdFastSeed * 1103515245u + 12345u;
+    return tdFastSeed >> 8;
+}
+
+/** n-th allocation after reset is slot n, down from TD 127, until the free list is empty. */
+static uint8 CheckSlots(void)
+{
+    uint8 n = 0u;
+    uint8 td;
+
+    CyDmacConfigure();
+    while (CyDmaTdFreeCount() != 0u)
+    {
+        td = CyDmaTdAllocate();
+        CHECK(td == DMA_TD_FAST_SLOT(n));
+        n++;
+    }
+    CHECK(CyDmaTdAllocate() == DMA_INVALID_TD);
+    return n;
+}
+
+/** An address a TD takes: LO16() of an SRAM byte in either half, or of a peripheral register. */
+static uint16 RandomAddress(void)
+{
+    switch (TdFast_Random() % 3u)
+    {
+    case 0u:
+        return LO16((uint32)&lowBuffer[TdFast_Random() % sizeof(lowBuffer)]);
+    case 1u:
+        return LO16((uint32)&highBuffer[TdFast_Random() % sizeof(highBuffer)]);
+    default:
+        return LO16(CYDEV_PERIPH_BASE + (TdFast_Random() & 0xFFFCu));
+    }
+}
+
+/** TD memory around @p td: the TD, the ones either side and TD 64, as one snapshot. */
+static void Snapshot(uint8 td, dmac_tdmem *out)
+{
+    out[0] = CY_DMA_TDMEM_STRUCT_PTR[td];
+    out[1] = CY_DMA_TDMEM_STRUCT_PTR[(td + 1u) % CY_DMA_NUMBEROF_TDS];
+    out[2] = CY_DMA_TDMEM_STRUCT_PTR[(td + CY_DMA_NUMBEROF_TDS - 1u) % CY_DMA_NUMBEROF_TDS];
+    out[3] = CY_DMA_TDMEM_STRUCT_PTR[(td + CY_DMA_NUMBEROF_TDS / 2u) % CY_DMA_NUMBEROF_TDS];
+}
+
+/** Fills all of TD memory with one random pattern, the start of both writes. */
+static void Scramble(uint32 seed)
+{
+    uint8 *bytes = (uint8 *)CY_DMA_TDMEM_STRUCT_PTR;
+    uint32 i;
+
+    for (i = 0u; i < CY_DMA_NUMBEROF_TDS * sizeof(dmac_tdmem); i++)
+    {
+        seed = seed * 1103515245u + 12345u;
+        bytes[i] = (uint8)(seed >> 16);
+    }
+}
+
+/** One TD written through the API and through the macros, in every way they offer. */
+static void CheckTd(uint8 td)
+{
+    dmac_tdmem api[TDFAST_CHECK_TDS];
+    dmac_tdmem fast[TDFAST_CHECK_TDS];
+    uint16 count = (uint16)(TdFast_Random() & 0x0FFFu);
+    uint8 next = (uint8)TdFast_Random();
+    uint8 config = (uint8)TdFast_Random();
+    uint16 src = RandomAddress();
+    uint16 dst = RandomAddress();
+    uint32 pattern = TdFast_Random();
+
+    Scramble(pattern);
+    CHECK(CyDmaTdSetConfiguration(td, count, next, config) == CYRET_SUCCESS);
+    CHECK(CyDmaTdSetAddress(td, src, dst) == CYRET_SUCCESS);
+    Snapshot(td, api);
+
+    /* The whole words */
+    Scramble(pattern);
+    DmaTdFast_SetConfiguration(td, count, next, config);
+    DmaTdFast_SetAddress(td, src, dst);
+    Snapshot(td, fast);
+    CHECK(memcmp(api, fast, sizeof(api)) == 0);
+
+    /* One field at a time: the configuration byte only comes with the whole TD0 word */
+    Scramble(pattern);
+    DmaTdFast_SetConfiguration(td, (uint16)~count, (uint8)~next, config);
+    DmaTdFast_SetCount(td, count);
+    DmaTdFast_SetNext(td, next);
+    DmaTdFast_SetSrc(td, src);
+    DmaTdFast_SetDst(td, dst);
+    Snapshot(td, fast);
+    CHECK(memcmp(api, fast, sizeof(api)) == 0);
+
+    /* Read back through the API */
+    {
+        uint16 gotCount;
+        uint8 gotNext;
+        uint8 gotConfig;
+        uint16 gotSrc;
+        uint16 gotDst;
+
+        CHECK(CyDmaTdGetConfiguration(td, &gotCount, &gotNext, &gotConfig) == CYRET_SUCCESS);
+        CHECK(CyDmaTdGetAddress(td, &gotSrc, &gotDst) == CYRET_SUCCESS);
+        CHECK((gotCount == count) && (gotNext == next) && (gotConfig == config));
+        CHECK((gotSrc == src) && (gotDst == dst));
+    }
+}
+
+/** The HI16()/LO16() split: HI16 goes to the channel, LO16 to the TD, and they join again. */
+static void CheckSplit(void)
+{
+    const uint32 addresses[] = {(uint32)&lowBuffer[0], (uint32)&lowBuffer[255],
+                                (uint32)&highBuffer[0], (uint32)&highBuffer[255],
+                                CYDEV_PERIPH_BASE + 0x4E10u};
+    uint8 td = DMA_TD_FAST_SLOT(0u);
+    uint16 src;
+    uint16 dst;
+    uint32 i;
+
+    for (i = 0u; i < sizeof(addresses) / sizeof(addresses[0]); i++)
+    {
+        DmaTdFast_SetAddress(td, LO16(addresses[i]), LO16(addresses[i] + 1u));
+        CHECK(CyDmaTdGetAddress(td, &src, &dst) == CYRET_SUCCESS);
+        CHECK(CyDmaEmu_Address(HI16(addresses[i]), src) == addresses[i]);
+        CHECK(CyDmaEmu_Address(HI16(addresses[i] + 1u), dst) == addresses[i] + 1u);
+    }
+    /* The two SRAM halves differ in HI16 only */
+    CHECK(HI16((uint32)lowBuffer) == HI16(CYDEV_SRAM_BASE));
+    CHECK(HI16((uint32)highBuffer) == HI16(CYDEV_SRAM_BASE) + 1u);
+}
+
+int main(int argc, char **argv)
+{
+    uint32 rounds = (argc > 1) ? (uint32)strtoul(argv[1], NULL, 0) : 64u;
+    uint32 round;
+    uint8 slots;
+    uint8 n;
+
+    CyEmu_Init();
+    slots = CheckSlots();
+    for (round = 0u; round < rounds; round++)
+        for (n = 0u; n < slots; n++)
+            CheckTd(DMA_TD_FAST_SLOT(n));
+    CheckSplit();
+
+    printf("slots=%u rounds=%u checks=%u failures=%u\n", (unsigned)slots, (unsigned)rounds,
+           (unsigned)checkCount, (unsigned)checkFailures);
+    return (checkFailures == 0u) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,571 @@
+/**
+ * @file
+ * @brief Host-side emulation of the PSoC 5LP DMA controller (PHUB) and the cy_boot CyDmac API.
+ */
+#include "CyDmac.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CYDMAEMU_CH_ENABLE (0x01u)
+#define CYDMAEMU_CH_PRESERVE (0x20u)
+#define CYDMAEMU_MAX_BURST (4095u)
+
+/** Working copy of the TD a channel is executing. */
+typedef struct
+{
+    uint8 valid;
+    uint8 td;
+    uint16 count;
+    uint16 src;
+    uint16 dst;
+    uint8 next;
+    uint8 flags;
+} CyDmaEmu_WorkTd;
+
+typedef struct
+{
+    CyDmaEmu_WorkTd work;
+    CyDmaEmu_TermoutFn termout;
+    CyDmaEmu_ChStats stats;
+    uint64 busyUntil;
+} CyDmaEmu_Channel;
+
+/* Model state lives on the heap: .bss is the emulated .ram half and belongs to the firmware */
+static CyDmaEmu_Channel *cyDmaEmuCh;
+static uint8 cyDmaTdFreeIndex;
+static uint32 cyDmaChAllocated;
+
+/**
+ * @brief Combines a channel upper address and a TD lower address into a device address.
+ *
+ * The SRAM spoke decodes only the low 16 bits, so either SRAM upper (0x1FFF or 0x2000) reaches
+ * both halves: 0x8000-0xFFFF is the .ram half, 0x0000-0x7FFF the .ram2 half.
+ */
+uint32 CyDmaEmu_Address(uint16 upper, uint16 lower)
+{
+    if ((upper == HI16(CYDEV_SRAM_BASE)) || (upper == HI16(CYREG_SRAM_DATA_MBASE)))
+    {
+        return (lower >= 0x8000u) ? ((CYDEV_SRAM_BASE & 0xFFFF0000u) | lower)
+                                  : (CYREG_SRAM_DATA_MBASE | lower);
+    }
+    return ((uint32)upper << 16) | lower;
+}
+
+/* Mapped FIFOs are byte wide, every byte is its own transaction. */
+static uint8 CyDmaEmu_SpokeWidth(uint32 addr)
+{
+    if (CyEmu_IsMapped(addr) == CYEMU_MAPPED_FIFO)
+        return 1u;
+    return CyEmu_IsPeriph(addr) ? CYDMAEMU_PERIPH_SPOKE_WIDTH : CYDMAEMU_SRAM_SPOKE_WIDTH;
+}
+
+static uint32 CyDmaEmu_WaitStates(uint32 addr)
+{
+    return CyEmu_IsPeriph(addr) ? CYDMAEMU_PERIPH_WAIT_CYCLES : 0u;
+}
+
+static void CyDmaEmu_LoadTd(CyDmaEmu_Channel *ch, uint8 td)
+{
+    const dmac_tdmem *mem = &CY_DMA_TDMEM_STRUCT_PTR[td];
+
+    ch->work.valid = 1u;
+    ch->work.td = td;
+    ch->work.count = (uint16)(CY_GET_REG16(&mem->TD0[0]) & 0x0FFFu);
+    ch->work.next = mem->TD0[2];
+    ch->work.flags = mem->TD0[3];
+    ch->work.src = CY_GET_REG16(&mem->TD1[0]);
+    ch->work.dst = CY_GET_REG16(&mem->TD1[2]);
+    ch->stats.lastTdSrc = ch->work.src;
+}
+
+/* Without preserved TDs the DMAC consumes the TD memory copy as it goes. */
+static void CyDmaEmu_WriteBack(uint8 chHandle)
+{
+    CyDmaEmu_Channel *ch = &cyDmaEmuCh[chHandle];
+    dmac_tdmem *mem = &CY_DMA_TDMEM_STRUCT_PTR[ch->work.td];
+
+    if ((CY_DMA_CH_STRUCT_PTR[chHandle].basic_cfg[0] & CYDMAEMU_CH_PRESERVE) == 0u)
+    {
+        CY_SET_REG16(&mem->TD0[0], ch->work.count);
+        CY_SET_REG16(&mem->TD1[0], ch->work.src);
+        CY_SET_REG16(&mem->TD1[2], ch->work.dst);
+    }
+}
+
+/**
+ * @brief Runs one burst of the working TD and returns its cost in bus clocks.
+ */
+static uint32 CyDmaEmu_Burst(uint8 chHandle, uint16 n)
+{
+    CyDmaEmu_Channel *ch = &cyDmaEmuCh[chHandle];
+    const dmac_cfgmem *cfg = &CY_DMA_CFGMEM_STRUCT_PTR[chHandle];
+    uint16 upperSrc = CY_GET_REG16(&cfg->CFG1[0]);
+    uint16 upperDst = CY_GET_REG16(&cfg->CFG1[2]);
+    uint8 incSrc = (uint8)(ch->work.flags & TD_INC_SRC_ADR);
+    uint8 incDst = (uint8)(ch->work.flags & TD_INC_DST_ADR);
+    uint8 data[CYDMAEMU_MAX_BURST];
+    uint32 cycles = CYDMAEMU_BURST_CYCLES;
+    uint16 done;
+    uint16 unit;
+    uint16 i;
+
+    /* Spoke transactions restart at the TD address unless the TD increments it. */
+    for (done = 0u; done < n; done += unit)
+    {
+        uint32 src = CyDmaEmu_Address(upperSrc, (uint16)(ch->work.src + (incSrc ? done : 0u)));
+        uint32 dst = CyDmaEmu_Address(upperDst, (uint16)(ch->work.dst + (incDst ? done : 0u)));
+        uint16 roomSrc = (uint16)(CyDmaEmu_SpokeWidth(src) - (src % CyDmaEmu_SpokeWidth(src)));
+        uint16 roomDst = (uint16)(CyDmaEmu_SpokeWidth(dst) - (dst % CyDmaEmu_SpokeWidth(dst)));
+
+        unit = (uint16)(n - done);
+        if (unit > roomSrc)
+            unit = roomSrc;
+        if (unit > roomDst)
+            unit = roomDst;
+
+        if (CyEmu_IsMapped(src))
+        {
+            for (i = 0u; i < unit; i++)
+                data[done + i] = CyEmu_BusRead8(src + i);
+        }
+        else
+            memcpy(&data[done], CyEmu_Ptr(src), unit);
+        if (ch->work.flags & TD_SWAP_EN)
+        {
+            uint16 size = (ch->work.flags & TD_SWAP_SIZE4) ? 4u : 2u;
+            for (i = 0u; (i + size) <= unit; i += size)
+            {
+                uint8 t = data[done + i];
+                data[done + i] = data[done + i + size - 1u];
+                data[done + i + size - 1u] = t;
+                if (size == 4u)
+                {
+                    t = data[done + i + 1u];
+                    data[done + i + 1u] = data[done + i + 2u];
+                    data[done + i + 2u] = t;
+                }
+            }
+        }
+        if (CyEmu_IsMapped(dst))
+        {
+            for (i = 0u; i < unit; i++)
+                CyEmu_BusWrite8(dst + i, data[done + i]);
+        }
+        else
+            memcpy(CyEmu_Ptr(dst), &data[done], unit);
+
+        cycles += CYDMAEMU_SPOKE_CYCLES + CyDmaEmu_WaitStates(src) + CyDmaEmu_WaitStates(dst);
+        ch->stats.spokeTransactions++;
+    }
+
+    if (incSrc)
+        ch->work.src = (uint16)(ch->work.src + n);
+    if (incDst)
+        ch->work.dst = (uint16)(ch->work.dst + n);
+    ch->work.count = (uint16)(ch->work.count - n);
+    ch->stats.bursts++;
+    ch->stats.bytes += n;
+    return cycles;
+}
+
+/**
+ * @brief Retires the working TD: TERMOUT, next-TD selection and chain end handling.
+ *
+ * @return 1 when the next TD should run without a new request.
+ */
+static uint8 CyDmaEmu_CompleteTd(uint8 chHandle)
+{
+    CyDmaEmu_Channel *ch = &cyDmaEmuCh[chHandle];
+    dmac_ch *regs = &CY_DMA_CH_STRUCT_PTR[chHandle];
+    uint8 td = ch->work.td;
+    uint8 next = ch->work.next;
+    uint8 termout = (uint8)(ch->work.flags & (TD_TERMOUT0_EN | TD_TERMOUT1_EN));
+    uint8 autoNext = (uint8)(ch->work.flags & TD_AUTO_EXEC_NEXT);
+
+    CyDmaEmu_WriteBack(chHandle);
+    ch->work.valid = 0u;
+    ch->stats.tdsCompleted++;
+
+    if (next == CY_DMA_DISABLE_TD)
+    {
+        regs->basic_cfg[0] &= (uint8)~CYDMAEMU_CH_ENABLE;
+        regs->basic_status[0] = 0u;
+        autoNext = 0u;
+    }
+    else if (next == CY_DMA_END_CHAIN_TD)
+    {
+        regs->basic_status[0] = 0u;
+        regs->basic_status[1] = CY_DMA_END_CHAIN_TD;
+        autoNext = 0u;
+    }
+    else
+    {
+        regs->basic_status[1] = next;
+    }
+
+    if ((termout != 0u) && (ch->termout != NULL))
+        ch->termout(chHandle, td, termout);
+    return autoNext;
+}
+
+/**
+ * @brief Delivers one DMA request (hardware DRQ or CPU_REQ) to a channel.
+ *
+ * @return The bus clocks the DMAC spends serving the request.
+ */
+uint32 CyDmaEmu_Request(uint8 chHandle)
+{
+    CyDmaEmu_Channel *ch;
+    dmac_ch *regs;
+    uint8 burstCount;
+    uint8 requestPerBurst;
+    uint32 cycles = 0u;
+    uint32 tdsBefore;
+    uint8 more = 1u;
+
+    if (chHandle >= CY_DMA_NUMBEROF_CHANNELS)
+        return 0u;
+    ch = &cyDmaEmuCh[chHandle];
+    regs = &CY_DMA_CH_STRUCT_PTR[chHandle];
+    burstCount = (uint8)(CY_DMA_CFGMEM_STRUCT_PTR[chHandle].CFG0[0] & 0x7Fu);
+    requestPerBurst = (uint8)(CY_DMA_CFGMEM_STRUCT_PTR[chHandle].CFG0[1] & 0x01u);
+
+    if (((regs->basic_cfg[0] & CYDMAEMU_CH_ENABLE) == 0u) ||
+        ((ch->work.valid == 0u) && (regs->basic_status[1] >= CY_DMA_NUMBEROF_TDS)))
+    {
+        ch->stats.droppedRequests++;
+        return 0u;
+    }
+    tdsBefore = ch->stats.tdsCompleted;
+
+    while (more)
+    {
+        uint16 n;
+
+        if (ch->work.valid == 0u)
+        {
+            CyDmaEmu_LoadTd(ch, regs->basic_status[1]);
+            regs->basic_status[0] = CY_DMA_STATUS_CHAIN_ACTIVE | CY_DMA_STATUS_TD_ACTIVE;
+        }
+
+        n = ch->work.count;
+        if ((burstCount != 0u) && (n > burstCount))
+            n = burstCount;
+        if (n != 0u)
+            cycles += CyDmaEmu_Burst(chHandle, n);
+
+        if (ch->work.count == 0u)
+        {
+            more = CyDmaEmu_CompleteTd(chHandle);
+        }
+        else if (requestPerBurst)
+        {
+            CyDmaEmu_WriteBack(chHandle);
+            more = 0u;
+        }
+    }
+
+    ch->stats.requests++;
+    ch->stats.busCycles += cycles;
+    ch->stats.lastRequestCycles = cycles;
+    if (ch->busyUntil < CyEmu_Now())
+        ch->busyUntil = CyEmu_Now();
+    ch->busyUntil += cycles;
+    if (ch->stats.tdsCompleted != tdsBefore)
+        ch->stats.lastTdDoneAt = ch->busyUntil;
+    return cycles;
+}
+
+/** @brief Clears every channel, TD and counter and rebuilds the TD free list; call before use. */
+void CyDmaEmu_Reset(void)
+{
+    if (cyDmaEmuCh == NULL)
+        cyDmaEmuCh = calloc(CY_DMA_NUMBEROF_CHANNELS, sizeof(*cyDmaEmuCh));
+    if (cyDmaEmuCh == NULL)
+    {
+        fprintf(stderr, "CyDmac: no memory for the channel model\n");
+        exit(1);
+    }
+    memset(cyDmaEmuCh, 0, CY_DMA_NUMBEROF_CHANNELS * sizeof(*cyDmaEmuCh));
+    cyDmaChAllocated = 0u;
+    CyDmacConfigure();
+}
+
+/** @brief Routes the TERMOUT pulses of a channel, as wired in the schematic. */
+void CyDmaEmu_SetTermoutHandler(uint8 chHandle, CyDmaEmu_TermoutFn handler)
+{
+    if (chHandle < CY_DMA_NUMBEROF_CHANNELS)
+        cyDmaEmuCh[chHandle].termout = handler;
+}
+
+const CyDmaEmu_ChStats *CyDmaEmu_GetStats(uint8 chHandle)
+{
+    return (chHandle < CY_DMA_NUMBEROF_CHANNELS) ? &cyDmaEmuCh[chHandle].stats : NULL;
+}
+
+/** @brief Returns the bus-clock time at which the channel finishes its queued work. */
+uint64 CyDmaEmu_BusyUntil(uint8 chHandle)
+{
+    return (chHandle < CY_DMA_NUMBEROF_CHANNELS) ? cyDmaEmuCh[chHandle].busyUntil : 0u;
+}
+
+/** @brief Advances the clock to the end of the channel's queued work, as a completion poll. */
+void CyDmaEmu_WaitIdle(uint8 chHandle)
+{
+    uint64 now = CyEmu_Now();
+    uint64 until = CyDmaEmu_BusyUntil(chHandle);
+
+    if (until > now)
+    {
+        cyDmaEmuCh[chHandle].stats.waitCycles += until - now;
+        CyEmu_Spend((uint32)(until - now));
+    }
+}
+
+/**
+ * @brief Body shared by the generated <instance>_DmaInitialize() functions.
+ *
+ * The channel handle is the DRQ number the fitter assigned to the DMA component instance.
+ */
+uint8 CyDmaEmu_DmaInitialize(uint8 drq, uint8 burstCount, uint8 requestPerBurst,
+                             uint16 upperSrcAddress, uint16 upperDestAddress)
+{
+    cyDmaChAllocated |= (1uL << drq);
+    (void)CyDmaChSetConfiguration(drq, burstCount, requestPerBurst, 0u, 0u, 0u);
+    (void)CyDmaChSetExtendedAddress(drq, upperSrcAddress, upperDestAddress);
+    return drq;
+}
+
+/*******************************************************************************
+ * cy_boot API
+ ******************************************************************************/
+
+/** @brief Builds the TD free list; TD 0 is never handed out, as in cy_boot. */
+void CyDmacConfigure(void)
+{
+    uint8 i;
+
+    for (i = CY_DMA_NUMBEROF_TDS - 1u; i != 0u; i--)
+        CY_DMA_TDMEM_STRUCT_PTR[i].TD0[2] = (uint8)(i - 1u);
+    CY_DMA_TDMEM_STRUCT_PTR[0].TD0[2] = 0u;
+    cyDmaTdFreeIndex = CY_DMA_NUMBEROF_TDS - 1u;
+}
+
+uint8 CyDmaChAlloc(void)
+{
+    uint8 i;
+
+    for (i = 0u; i < CY_DMA_NUMBEROF_CHANNELS; i++)
+    {
+        if ((cyDmaChAllocated & (1uL << i)) == 0u)
+        {
+            cyDmaChAllocated |= (1uL << i);
+            return i;
+        }
+    }
+    return CY_DMA_INVALID_CHANNEL;
+}
+
+cystatus CyDmaChFree(uint8 chHandle)
+{
+    if (chHandle >= CY_DMA_NUMBEROF_CHANNELS)
+        return CYRET_BAD_PARAM;
+    cyDmaChAllocated &= ~(1uL << chHandle);
+    return CYRET_SUCCESS;
+}
+
+cystatus CyDmaChEnable(uint8 chHandle, uint8 preserveTds)
+{
+    if (chHandle >= CY_DMA_NUMBEROF_CHANNELS)
+        return CYRET_BAD_PARAM;
+    CyEmu_Spend(CYEMU_CPU_CH_CONTROL);
+    CY_DMA_CH_STRUCT_PTR[chHandle].basic_cfg[0] =
+        (uint8)(CYDMAEMU_CH_ENABLE | ((preserveTds != 0u) ? CYDMAEMU_CH_PRESERVE : 0u));
+    return CYRET_SUCCESS;
+}
+
+cystatus CyDmaChDisable(uint8 chHandle)
+{
+    if (chHandle >= CY_DMA_NUMBEROF_CHANNELS)
+        return CYRET_BAD_PARAM;
+    CyEmu_Spend(CYEMU_CPU_CH_CONTROL);
+    CY_DMA_CH_STRUCT_PTR[chHandle].basic_cfg[0] &= (uint8)~CYDMAEMU_CH_ENABLE;
+    CY_DMA_CH_STRUCT_PTR[chHandle].basic_status[0] = 0u;
+    cyDmaEmuCh[chHandle].work.valid = 0u;
+    return CYRET_SUCCESS;
+}
+
+cystatus CyDmaClearPendingDrq(uint8 chHandle)
+{
+    return (chHandle < CY_DMA_NUMBEROF_CHANNELS) ? CYRET_SUCCESS : CYRET_BAD_PARAM;
+}
+
+cystatus CyDmaChPriority(uint8 chHandle, uint8 priority)
+{
+    (void)priority;
+    return (chHandle < CY_DMA_NUMBEROF_CHANNELS) ? CYRET_SUCCESS : CYRET_BAD_PARAM;
+}
+
+cystatus CyDmaChSetExtendedAddress(uint8 chHandle, uint16 source, uint16 destination)
+{
+    if (chHandle >= CY_DMA_NUMBEROF_CHANNELS)
+        return CYRET_BAD_PARAM;
+    CY_SET_REG16(&CY_DMA_CFGMEM_STRUCT_PTR[chHandle].CFG1[0], source);
+    CY_SET_REG16(&CY_DMA_CFGMEM_STRUCT_PTR[chHandle].CFG1[2], destination);
+    return CYRET_SUCCESS;
+}
+
+cystatus CyDmaChSetInitialTd(uint8 chHandle, uint8 startTd)
+{
+    if (chHandle >= CY_DMA_NUMBEROF_CHANNELS)
+        return CYRET_BAD_PARAM;
+    CyEmu_Spend(CYEMU_CPU_CH_CONTROL);
+    CY_DMA_CH_STRUCT_PTR[chHandle].basic_status[1] = startTd;
+    cyDmaEmuCh[chHandle].work.valid = 0u;
+    return CYRET_SUCCESS;
+}
+
+/**
+ * @brief CPU request: CPU_REQ runs like a DRQ, CPU_TERM_TD / CPU_TERM_CHAIN retire early.
+ */
+cystatus CyDmaChSetRequest(uint8 chHandle, uint8 request)
+{
+    CyDmaEmu_Channel *ch;
+
+    if (chHandle >= CY_DMA_NUMBEROF_CHANNELS)
+        return CYRET_BAD_PARAM;
+    ch = &cyDmaEmuCh[chHandle];
+    CyEmu_Spend(CYEMU_CPU_CH_SET_REQUEST);
+
+    if (request & CY_DMA_CPU_TERM_CHAIN)
+    {
+        if (ch->work.valid)
+        {
+            ch->work.next = CY_DMA_END_CHAIN_TD;
+            (void)CyDmaEmu_CompleteTd(chHandle);
+        }
+    }
+    else if (request & CY_DMA_CPU_TERM_TD)
+    {
+        if (ch->work.valid)
+            (void)CyDmaEmu_CompleteTd(chHandle);
+    }
+    else if (request & CY_DMA_CPU_REQ)
+    {
+        (void)CyDmaEmu_Request(chHandle);
+    }
+    return CYRET_SUCCESS;
+}
+
+cystatus CyDmaChGetRequest(uint8 chHandle)
+{
+    (void)chHandle;
+    return 0u; /* requests are served synchronously, nothing is ever pending */
+}
+
+cystatus CyDmaChStatus(uint8 chHandle, uint8 *currentTd, uint8 *state)
+{
+    if (chHandle >= CY_DMA_NUMBEROF_CHANNELS)
+        return CYRET_BAD_PARAM;
+    if (currentTd != NULL)
+        *currentTd = CY_DMA_CH_STRUCT_PTR[chHandle].basic_status[1];
+    if (state != NULL)
+        *state = CY_DMA_CH_STRUCT_PTR[chHandle].basic_status[0];
+    return CYRET_SUCCESS;
+}
+
+cystatus CyDmaChSetConfiguration(uint8 chHandle, uint8 burstCount, uint8 requestPerBurst,
+                                 uint8 tdDone0, uint8 tdDone1, uint8 tdStop)
+{
+    dmac_cfgmem *cfg;
+
+    if (chHandle >= CY_DMA_NUMBEROF_CHANNELS)
+        return CYRET_BAD_PARAM;
+    (void)tdStop;
+    cfg = &CY_DMA_CFGMEM_STRUCT_PTR[chHandle];
+    cfg->CFG0[0] = (uint8)(burstCount & 0x7Fu);
+    cfg->CFG0[1] = (uint8)(requestPerBurst & 0x01u);
+    cfg->CFG0[2] = tdDone0;
+    cfg->CFG0[3] = tdDone1;
+    return CYRET_SUCCESS;
+}
+
+uint8 CyDmaTdAllocate(void)
+{
+    uint8 td = CY_DMA_INVALID_TD;
+
+    if (cyDmaTdFreeIndex != 0u)
+    {
+        td = cyDmaTdFreeIndex;
+        cyDmaTdFreeIndex = CY_DMA_TDMEM_STRUCT_PTR[td].TD0[2];
+    }
+    return td;
+}
+
+void CyDmaTdFree(uint8 tdHandle)
+{
+    if ((tdHandle != 0u) && (tdHandle < CY_DMA_NUMBEROF_TDS))
+    {
+        CY_DMA_TDMEM_STRUCT_PTR[tdHandle].TD0[2] = cyDmaTdFreeIndex;
+        cyDmaTdFreeIndex = tdHandle;
+    }
+}
+
+uint8 CyDmaTdFreeCount(void)
+{
+    uint8 count = 0u;
+    uint8 td;
+
+    for (td = cyDmaTdFreeIndex; td != 0u; td = CY_DMA_TDMEM_STRUCT_PTR[td].TD0[2])
+        count++;
+    return count;
+}
+
+cystatus CyDmaTdSetConfiguration(uint8 tdHandle, uint16 transferCount, uint8 nextTd,
+                                 uint8 configuration)
+{
+    if ((tdHandle >= CY_DMA_NUMBEROF_TDS) || ((transferCount & 0xF000u) != 0u))
+        return CYRET_BAD_PARAM;
+    CyEmu_Spend(CYEMU_CPU_TD_SET_CONFIG);
+    CY_SET_REG16(&CY_DMA_TDMEM_STRUCT_PTR[tdHandle].TD0[0], transferCount);
+    CY_DMA_TDMEM_STRUCT_PTR[tdHandle].TD0[2] = nextTd;
+    CY_DMA_TDMEM_STRUCT_PTR[tdHandle].TD0[3] = configuration;
+    return CYRET_SUCCESS;
+}
+
+cystatus CyDmaTdGetConfiguration(uint8 tdHandle, uint16 *transferCount, uint8 *nextTd,
+                                 uint8 *configuration)
+{
+    if (tdHandle >= CY_DMA_NUMBEROF_TDS)
+        return CYRET_BAD_PARAM;
+    if (transferCount != NULL)
+        *transferCount = (uint16)(CY_GET_REG16(&CY_DMA_TDMEM_STRUCT_PTR[tdHandle].TD0[0]) & 0x0FFFu);
+    if (nextTd != NULL)
+        *nextTd = CY_DMA_TDMEM_STRUCT_PTR[tdHandle].TD0[2];
+    if (configuration != NULL)
+        *configuration = CY_DMA_TDMEM_STRUCT_PTR[tdHandle].TD0[3];
+    return CYRET_SUCCESS;
+}
+
+cystatus CyDmaTdSetAddress(uint8 tdHandle, uint16 source, uint16 destination)
+{
+    if (tdHandle >= CY_DMA_NUMBEROF_TDS)
+        return CYRET_BAD_PARAM;
+    CyEmu_Spend(CYEMU_CPU_TD_SET_ADDRESS);
+    CY_SET_REG16(&CY_DMA_TDMEM_STRUCT_PTR[tdHandle].TD1[0], source);
+    CY_SET_REG16(&CY_DMA_TDMEM_STRUCT_PTR[tdHandle].TD1[2], destination);
+    return CYRET_SUCCESS;
+}
+
+cystatus CyDmaTdGetAddress(uint8 tdHandle, uint16 *source, uint16 *destination)
+{
+    if (tdHandle >= CY_DMA_NUMBEROF_TDS)
+        return CYRET_BAD_PARAM;
+    if (source != NULL)
+        *source = CY_GET_REG16(&CY_DMA_TDMEM_STRUCT_PTR[tdHandle].TD1[0]);
+    if (destination != NULL)
+        *destination = CY_GET_REG16(&CY_DMA_TDMEM_STRUCT_PTR[tdHandle].TD1[2]);
+    return CYRET_SUCCESS;
+}
@@ -0,0 +1,159 @@
+/**
+ * @file
+ * @brief Host-side emulation of the PSoC 5LP DMA controller (PHUB) and the cy_boot CyDmac API.
+ *
+ * The channel configuration, channel status and TD memory live at their device addresses inside
+ * the emulated peripheral window, with the device layout, so firmware that bypasses the API with
+ * CY_SET_REG16(CY_DMA_TDMEM_STRUCT_PTR[td].TD1, ...) behaves as on silicon.
+ *
+ * Transfers are modelled per request:
+ * - each burst moves up to burstCount bytes (0 means the whole TD) and costs
+ *   CYDMAEMU_BURST_CYCLES for arbitration and CFG/TD fetch;
+ * - a burst is split into spoke transactions, limited by the spoke width of both ends
+ *   (4 bytes for SRAM, 2 bytes for the peripheral spokes, 1 byte for a FIFO mapped with
+ *   CyEmu_MapRegister()) and by address alignment; each costs
+ *   CYDMAEMU_SPOKE_CYCLES plus CYDMAEMU_PERIPH_WAIT_CYCLES per peripheral access;
+ * - without TD_INC_SRC_ADR / TD_INC_DST_ADR every spoke transaction restarts at the TD address,
+ *   which is why bursts of up to the spoke width land correctly without incrementing;
+ * - with requestPerBurst set every burst needs its own request, otherwise one request runs the
+ *   whole TD; TD_AUTO_EXEC_NEXT continues into the next TD without a new request;
+ * - a completed TD raises its TERMOUT handler and loads the next TD from TD memory on the next
+ *   request, so TD writes made between requests are honoured; CY_DMA_DISABLE_TD disables the
+ *   channel, CY_DMA_END_CHAIN_TD ends the chain.
+ *
+ * Requests complete synchronously; per channel the model tracks when the DMAC would really be
+ * done (CyDmaEmu_BusyUntil) so callers that poll for completion can account the wait.
+ */
+#ifndef CY_BOOT_CYDMAC_H
+#define CY_BOOT_CYDMAC_H
+
+#include "CyEmu.h"
+#include "cytypes.h"
+
+#define CY_DMA_NUMBEROF_TDS (128u)
+#define CY_DMA_NUMBEROF_CHANNELS (24u)
+
+#define CY_DMA_INVALID_CHANNEL (0xFFu)
+#define CY_DMA_INVALID_TD (0xFFu)
+#define CY_DMA_END_CHAIN_TD (0xFFu)
+#define CY_DMA_DISABLE_TD (0xFEu)
+
+/* TD configuration flags */
+#define TD_SWAP_EN (0x80u)
+#define TD_SWAP_SIZE4 (0x40u)
+#define TD_AUTO_EXEC_NEXT (0x20u)
+#define TD_TERMIN_EN (0x10u)
+#define TD_TERMOUT1_EN (0x08u)
+#define TD_TERMOUT0_EN (0x04u)
+#define TD_INC_DST_ADR (0x02u)
+#define TD_INC_SRC_ADR (0x01u)
+
+/* CPU requests for CyDmaChSetRequest() */
+#define CY_DMA_CPU_REQ (0x01u)
+#define CY_DMA_CPU_TERM_TD (0x02u)
+#define CY_DMA_CPU_TERM_CHAIN (0x04u)
+
+/* CyDmaChStatus() state bits */
+#define CY_DMA_STATUS_CHAIN_ACTIVE (0x01u)
+#define CY_DMA_STATUS_TD_ACTIVE (0x02u)
+
+/* Legacy names still used by the examples */
+#define DMA_INVALID_CHANNEL (CY_DMA_INVALID_CHANNEL)
+#define DMA_INVALID_TD (CY_DMA_INVALID_TD)
+#define DMA_END_CHAIN_TD (CY_DMA_END_CHAIN_TD)
+#define DMA_DISABLE_TD (CY_DMA_DISABLE_TD)
+#define CPU_REQ (CY_DMA_CPU_REQ)
+#define CPU_TERM_TD (CY_DMA_CPU_TERM_TD)
+#define CPU_TERM_CHAIN (CY_DMA_CPU_TERM_CHAIN)
+
+/* PHUB register layout */
+typedef struct
+{
+    reg8 basic_cfg[4]; /**< [0]: bit0 enable, bit5 preserve TDs */
+    reg8 action[4];
+    reg8 basic_status[4]; /**< [0]: state bits, [1]: current TD */
+    reg8 reserved[4];
+} dmac_ch;
+
+typedef struct
+{
+    reg8 CFG0[4]; /**< burst count, request per burst, TD done sels */
+    reg8 CFG1[4]; /**< upper 16 bits of source and destination */
+} dmac_cfgmem;
+
+typedef struct
+{
+    reg8 TD0[4]; /**< [0..1] transfer count, [2] next TD, [3] configuration */
+    reg8 TD1[4]; /**< [0..1] source LO16, [2..3] destination LO16 */
+} dmac_tdmem;
+
+#define CY_DMA_CH_STRUCT_PTR ((dmac_ch *)(uintptr_t)CYDEV_PHUB_CH0_BASE)
+#define CY_DMA_CFGMEM_STRUCT_PTR ((dmac_cfgmem *)(uintptr_t)CYDEV_PHUB_CFGMEM0_BASE)
+#define CY_DMA_TDMEM_STRUCT_PTR ((dmac_tdmem *)(uintptr_t)CYDEV_PHUB_TDMEM0_BASE)
+
+/* clang-format off */
+#define CYDMAEMU_BURST_CYCLES       (6u) /**< arbitration + CFG/TD fetch per burst */
+#define CYDMAEMU_SPOKE_CYCLES       (2u) /**< one read and one write data phase */
+#define CYDMAEMU_PERIPH_WAIT_CYCLES (1u) /**< extra wait state per peripheral-spoke access */
+#define CYDMAEMU_SRAM_SPOKE_WIDTH   (4u)
+#define CYDMAEMU_PERIPH_SPOKE_WIDTH (2u)
+/* clang-format on */
+
+/* cy_boot API */
+void CyDmacConfigure(void);
+uint8 CyDmaChAlloc(void);
+cystatus CyDmaChFree(uint8 chHandle);
+cystatus CyDmaChEnable(uint8 chHandle, uint8 preserveTds);
+cystatus CyDmaChDisable(uint8 chHandle);
+cystatus CyDmaClearPendingDrq(uint8 chHandle);
+cystatus CyDmaChPriority(uint8 chHandle, uint8 priority);
+cystatus CyDmaChSetExtendedAddress(uint8 chHandle, uint16 source, uint16 destination);
+cystatus CyDmaChSetInitialTd(uint8 chHandle, uint8 startTd);
+cystatus CyDmaChSetRequest(uint8 chHandle, uint8 request);
+cystatus CyDmaChGetRequest(uint8 chHandle);
+cystatus CyDmaChStatus(uint8 chHandle, uint8 *currentTd, uint8 *state);
+cystatus CyDmaChSetConfiguration(uint8 chHandle, uint8 burstCount, uint8 requestPerBurst,
+                                 uint8 tdDone0, uint8 tdDone1, uint8 tdStop);
+uint8 CyDmaTdAllocate(void);
+void CyDmaTdFree(uint8 tdHandle);
+uint8 CyDmaTdFreeCount(void);
+cystatus CyDmaTdSetConfiguration(uint8 tdHandle, uint16 transferCount, uint8 nextTd,
+                                 uint8 configuration);
+cystatus CyDmaTdGetConfiguration(uint8 tdHandle, uint16 *transferCount, uint8 *nextTd,
+                                 uint8 *configuration);
+cystatus CyDmaTdSetAddress(uint8 tdHandle, uint16 source, uint16 destination);
+cystatus CyDmaTdGetAddress(uint8 tdHandle, uint16 *source, uint16 *destination);
+
+/* Emulator extensions */
+typedef void (*CyDmaEmu_TermoutFn)(uint8 chHandle, uint8 tdHandle, uint8 termout);
+
+/** Per-channel counters, reset by CyDmaEmu_Reset(). */
+typedef struct
+{
+    uint32 requests;          /**< requests that moved data */
+    uint32 droppedRequests;   /**< requests seen while disabled or without a TD */
+    uint32 bursts;            /**< bursts executed */
+    uint32 spokeTransactions; /**< spoke data phases executed */
+    uint32 bytes;             /**< bytes moved */
+    uint32 tdsCompleted;      /**< TDs run to completion */
+    uint64 busCycles;         /**< DMAC bus clocks spent */
+    uint32 lastRequestCycles; /**< bus clocks of the most recent request */
+    uint64 lastTdDoneAt;      /**< bus-clock time the most recent TD finished its last burst */
+    uint64 waitCycles;        /**< bus clocks the CPU spent in CyDmaEmu_WaitIdle() */
+    uint16 lastTdSrc;         /**< TD1 source LO16 of the most recently loaded TD */
+} CyDmaEmu_ChStats;
+
+/** Common/FastCopy.h polls TD memory for completion, charge the time the poll would take. */
+#define FAST_COPY_DMA_ACCOUNT(ch) CyDmaEmu_WaitIdle(ch)
+
+void CyDmaEmu_Reset(void);
+uint32 CyDmaEmu_Request(uint8 chHandle);
+void CyDmaEmu_SetTermoutHandler(uint8 chHandle, CyDmaEmu_TermoutFn handler);
+const CyDmaEmu_ChStats *CyDmaEmu_GetStats(uint8 chHandle);
+uint64 CyDmaEmu_BusyUntil(uint8 chHandle);
+void CyDmaEmu_WaitIdle(uint8 chHandle);
+uint32 CyDmaEmu_Address(uint16 upper, uint16 lower);
+uint8 CyDmaEmu_DmaInitialize(uint8 drq, uint8 burstCount, uint8 requestPerBurst,
+                             uint16 upperSrcAddress, uint16 upperDestAddress);
+
+#endif /* CY_BOOT_CYDMAC_H */
@@ -0,0 +1,404 @@
+/**
+ * @file
+ * @brief Host-side PSoC 5LP emulation core: bus-clock time base and device memory map.
+ */
+#include "CyEmu.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+
+#define CYEMU_MAX_COMPONENTS (8u)
+#define CYEMU_MAX_REGISTERS (16u)
+#define CYEMU_MAX_PENDING (8u)
+
+volatile uint8 CyEmu_PeriphSpace[CYDEV_PERIPH_SIZE] __attribute__((section(".cyperiph")));
+
+typedef struct
+{
+    CyEmu_StepFn step;
+    void *component;
+} CyEmu_Component;
+
+typedef struct
+{
+    uint32 addr;
+    uint8 size; /* bytes from addr */
+    uint8 kind; /* CYEMU_MAPPED_* */
+    CyEmu_RegReadFn read;
+    CyEmu_RegWriteFn write;
+    void *component;
+} CyEmu_Register;
+
+static uint64 cyEmuCycles;
+static CyEmu_Component cyEmuComponents[CYEMU_MAX_COMPONENTS];
+static uint8 cyEmuComponentCount;
+static uint8 cyEmuInStep; /* a component step is running, time only accumulates */
+static uint8 cyEmuInIsr;
+static uint8 cyEmuMasked; /* PRIMASK */
+static void (*cyEmuPending[CYEMU_MAX_PENDING])(void);
+static uint8 cyEmuPendingCount;
+static uint32 cyEmuInterrupts;
+static CyEmu_Register cyEmuRegisters[CYEMU_MAX_REGISTERS];
+static uint8 cyEmuRegisterCount;
+static volatile uint32 *cyEmuExclusive; /* address armed by LDREX, NULL when open */
+static void (*cyEmuPreempt)(void);
+static uint8 cyEmuAliasMapped;
+
+/**
+ * @brief Checks the host link layout and maps the SRAM bit-band alias window.
+ *
+ * Must be called before any firmware code runs. The alias window only absorbs raw accesses so
+ * they do not fault; Common/BitBandFlags.h goes through CyEmu_BitBandWrite()/Read(), which do
+ * reach the SRAM bits. Calling it again starts a new run: time 0, no components, registers or
+ * pending interrupts.
+ */
+void CyEmu_Init(void)
+{
+    void *alias;
+
+    if ((uintptr_t)CyEmu_PeriphSpace != CYDEV_PERIPH_BASE)
+    {
+        fprintf(stderr, "CyEmu: peripheral window at %p, link with "
+                        "-Wl,--section-start=.cyperiph=0x40000000 -no-pie\n",
+                (void *)CyEmu_PeriphSpace);
+        exit(1);
+    }
+
+    if (cyEmuAliasMapped == 0u)
+    {
+        alias = mmap((void *)(uintptr_t)CYDEV_SRAM_BITBAND_BASE, CYDEV_SRAM_BITBAND_SIZE,
+                     PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE,
+                     -1, 0);
+        if (alias != (void *)(uintptr_t)CYDEV_SRAM_BITBAND_BASE)
+        {
+            fprintf(stderr, "CyEmu: cannot map the bit-band alias window\n");
+            exit(1);
+        }
+        cyEmuAliasMapped = 1u;
+    }
+    cyEmuCycles = 0u;
+    cyEmuComponentCount = 0u;
+    cyEmuRegisterCount = 0u;
+    cyEmuPendingCount = 0u;
+    cyEmuInterrupts = 0u;
+    cyEmuMasked = 0u;
+}
+
+/** @brief Returns the emulated time in bus clocks. */
+uint64 CyEmu_Now(void) { return cyEmuCycles; }
+
+/* Runs every component at the current time and returns the earliest next event. */
+static uint64 CyEmu_Step(void)
+{
+    uint64 next = CYEMU_NEVER;
+    uint8 i;
+
+    cyEmuInStep = 1u;
+    for (i = 0u; i < cyEmuComponentCount; i++)
+    {
+        uint64 at = cyEmuComponents[i].step(cyEmuComponents[i].component, cyEmuCycles);
+
+        if (at <= cyEmuCycles)
+            at = cyEmuCycles + 1u; /* a step that made no progress must not spin */
+        if (at < next)
+            next = at;
+    }
+    cyEmuInStep = 0u;
+    return next;
+}
+
+/* Runs pending interrupts one after the other (tail chaining), not nested into each other. */
+static void CyEmu_RunPending(void)
+{
+    if (cyEmuInIsr)
+        return;
+    cyEmuInIsr = 1u;
+    while (cyEmuPendingCount != 0u)
+    {
+        void (*isr)(void) = cyEmuPending[0];
+        uint8 i;
+
+        cyEmuPendingCount--;
+        for (i = 0u; i < cyEmuPendingCount; i++)
+            cyEmuPending[i] = cyEmuPending[i + 1u];
+        CyEmu_Spend(CYEMU_CPU_ISR_ENTRY_EXIT);
+        isr();
+        cyEmuInterrupts++;
+    }
+    cyEmuInIsr = 0u;
+}
+
+/**
+ * @brief Advances the emulated time by @p cycles bus clocks of the calling code.
+ *
+ * Component events due in the meantime run in order; interrupts they raise preempt the caller
+ * and extend the call by their run time.
+ */
+void CyEmu_Spend(uint32 cycles)
+{
+    uint64 target = cyEmuCycles + cycles;
+
+    if (cyEmuInStep || (cyEmuComponentCount == 0u))
+    {
+        cyEmuCycles = target;
+        return;
+    }
+    for (;;)
+    {
+        uint64 next = CyEmu_Step();
+
+        if ((cyEmuPendingCount != 0u) && (cyEmuInIsr == 0u) && (cyEmuMasked == 0u))
+        {
+            uint64 before = cyEmuCycles;
+
+            CyEmu_RunPending();
+            target += cyEmuCycles - before;
+            continue;
+        }
+        if (next > target)
+            break;
+        cyEmuCycles = next;
+    }
+    cyEmuCycles = target;
+}
+
+/** @brief Adds a component that runs on its own clock, see CyEmu_StepFn. */
+void CyEmu_Attach(CyEmu_StepFn step, void *component)
+{
+    if (cyEmuComponentCount >= CYEMU_MAX_COMPONENTS)
+    {
+        fprintf(stderr, "CyEmu: more than %u components\n", (unsigned)CYEMU_MAX_COMPONENTS);
+        exit(1);
+    }
+    cyEmuComponents[cyEmuComponentCount].step = step;
+    cyEmuComponents[cyEmuComponentCount].component = component;
+    cyEmuComponentCount++;
+}
+
+/**
+ * @brief Raises the interrupt that runs @p isr.
+ *
+ * Like an NVIC pending bit, a vector that is already pending is not queued twice. It runs, with
+ * entry and exit cost, as soon as the CPU side spends time outside another ISR.
+ */
+void CyEmu_Interrupt(void (*isr)(void))
+{
+    uint8 i;
+
+    if (isr == NULL)
+        return;
+    for (i = 0u; i < cyEmuPendingCount; i++)
+        if (cyEmuPending[i] == isr)
+            return;
+    if (cyEmuPendingCount >= CYEMU_MAX_PENDING)
+    {
+        fprintf(stderr, "CyEmu: more than %u pending interrupts\n", (unsigned)CYEMU_MAX_PENDING);
+        exit(1);
+    }
+    cyEmuPending[cyEmuPendingCount++] = isr;
+}
+
+/**
+ * @brief WFI: sleeps until an interrupt is pending, then lets it run unless masked.
+ *
+ * As on the Cortex-M3 a pending interrupt wakes the core even with PRIMASK set; it then runs on
+ * CyExitCriticalSection(). Exits the process when nothing is scheduled, the device would sleep
+ * forever.
+ */
+void CyEmu_WaitForInterrupt(void)
+{
+    uint32 seen = cyEmuInterrupts;
+
+    while ((cyEmuInterrupts == seen) && (cyEmuPendingCount == 0u))
+    {
+        uint64 next = CyEmu_Step();
+
+        if (cyEmuPendingCount != 0u)
+            break;
+        if (next == CYEMU_NEVER)
+        {
+            fprintf(stderr, "CyEmu: WFI with no event scheduled\n");
+            exit(1);
+        }
+        CyEmu_Spend((uint32)(next - cyEmuCycles));
+    }
+    CyEmu_Spend(0u);
+}
+
+/**
+ * @brief Sets PRIMASK and returns the previous value; unmasking runs what became pending.
+ */
+uint8 CyEmu_SetPrimask(uint8 masked)
+{
+    uint8 previous = cyEmuMasked;
+
+    cyEmuMasked = (uint8)(masked != 0u);
+    if (cyEmuMasked == 0u)
+        CyEmu_Spend(0u);
+    return previous;
+}
+
+static void CyEmu_Map(uint32 addr, uint8 size, uint8 kind, CyEmu_RegReadFn read,
+                      CyEmu_RegWriteFn write, void *component)
+{
+    CyEmu_Register *reg;
+
+    if (cyEmuRegisterCount >= CYEMU_MAX_REGISTERS)
+    {
+        fprintf(stderr, "CyEmu: more than %u mapped registers\n", (unsigned)CYEMU_MAX_REGISTERS);
+        exit(1);
+    }
+    reg = &cyEmuRegisters[cyEmuRegisterCount++];
+    reg->addr = addr;
+    reg->size = size;
+    reg->kind = kind;
+    reg->read = read;
+    reg->write = write;
+    reg->component = component;
+}
+
+/** @brief Routes DMA accesses to a byte-wide register (a FIFO) through @p read / @p write. */
+void CyEmu_MapRegister(uint32 addr, CyEmu_RegReadFn read, CyEmu_RegWriteFn write,
+                       void *component)
+{
+    CyEmu_Map(addr, 1u, CYEMU_MAPPED_FIFO, read, write, component);
+}
+
+/**
+ * @brief Routes DMA accesses to @p size consecutive byte registers through @p read / @p write.
+ *
+ * Unlike a FIFO the registers are byte lanes of the peripheral spoke: a 16-bit spoke transaction
+ * reaches two of them, and the callbacks see its bytes in address order.
+ */
+void CyEmu_MapRegisters(uint32 addr, uint8 size, CyEmu_RegReadFn read, CyEmu_RegWriteFn write,
+                        void *component)
+{
+    CyEmu_Map(addr, size, CYEMU_MAPPED_LANES, read, write, component);
+}
+
+static CyEmu_Register *CyEmu_FindRegister(uint32 addr)
+{
+    uint8 i;
+
+    for (i = 0u; i < cyEmuRegisterCount; i++)
+        if ((addr >= cyEmuRegisters[i].addr) &&
+            (addr < cyEmuRegisters[i].addr + cyEmuRegisters[i].size))
+            return &cyEmuRegisters[i];
+    return NULL;
+}
+
+/** @brief Returns how @p addr was mapped, CYEMU_MAPPED_NONE when it was not. */
+uint8 CyEmu_IsMapped(uint32 addr)
+{
+    CyEmu_Register *reg = CyEmu_FindRegister(addr);
+
+    return (reg != NULL) ? reg->kind : CYEMU_MAPPED_NONE;
+}
+
+/** @brief Bus read of one byte, through the owning component for mapped registers. */
+uint8 CyEmu_BusRead8(uint32 addr)
+{
+    CyEmu_Register *reg = CyEmu_FindRegister(addr);
+
+    if ((reg != NULL) && (reg->read != NULL))
+        return reg->read(reg->component, addr);
+    return *(volatile uint8 *)CyEmu_Ptr(addr);
+}
+
+/** @brief Bus write of one byte, through the owning component for mapped registers. */
+void CyEmu_BusWrite8(uint32 addr, uint8 value)
+{
+    CyEmu_Register *reg = CyEmu_FindRegister(addr);
+
+    if ((reg != NULL) && (reg->write != NULL))
+        reg->write(reg->component, addr, value);
+    else
+        *(volatile uint8 *)CyEmu_Ptr(addr) = value;
+}
+
+/** @brief Converts bus clocks to nanoseconds at CYEMU_BUS_CLK_HZ. */
+uint64 CyEmu_CyclesToNs(uint64 cycles)
+{
+    return (cycles * 1000000000u + CYEMU_BUS_CLK_HZ / 2u) / CYEMU_BUS_CLK_HZ;
+}
+
+/** @brief Returns 1 when @p addr falls in the peripheral window (16-bit spokes). */
+uint8 CyEmu_IsPeriph(uint32 addr)
+{
+    return (uint8)((addr >= CYDEV_PERIPH_BASE) && (addr < (CYDEV_PERIPH_BASE + CYDEV_PERIPH_SIZE)));
+}
+
+/** @brief Converts a 32-bit device address into a host pointer. */
+void *CyEmu_Ptr(uint32 addr) { return (void *)(uintptr_t)addr; }
+
+/* Byte and bit of the SRAM data half that an alias word maps to. */
+static volatile uint8 *CyEmu_BitBandByte(volatile uint32 *alias, uint8 *bit)
+{
+    uint32 offset = (uint32)alias - CYDEV_SRAM_BITBAND_BASE;
+
+    if (((uint32)alias < CYDEV_SRAM_BITBAND_BASE) || (offset >= CYDEV_SRAM_BITBAND_SIZE))
+    {
+        fprintf(stderr, "CyEmu: bit-band access outside the alias window at 0x%08x\n",
+                (unsigned)(uint32)alias);
+        exit(1);
+    }
+    *bit = (uint8)((offset / 4u) % 8u);
+    return (volatile uint8 *)CyEmu_Ptr(CYREG_SRAM_DATA_MBASE + offset / 32u);
+}
+
+/** @brief Alias store: the bus sets or clears the single SRAM bit in one transaction. */
+void CyEmu_BitBandWrite(volatile uint32 *alias, uint32 value)
+{
+    uint8 bit;
+    volatile uint8 *byte = CyEmu_BitBandByte(alias, &bit);
+
+    if (value & 1u)
+        __atomic_fetch_or(byte, (uint8)(1u << bit), __ATOMIC_SEQ_CST);
+    else
+        __atomic_fetch_and(byte, (uint8) ~(1u << bit), __ATOMIC_SEQ_CST);
+}
+
+/** @brief Alias load: 0 or 1. */
+uint32 CyEmu_BitBandRead(volatile uint32 *alias)
+{
+    uint8 bit;
+    volatile uint8 *byte = CyEmu_BitBandByte(alias, &bit);
+
+    return (uint32)((*byte >> bit) & 1u);
+}
+
+/**
+ * @brief LDREX: loads and arms the monitor, then lets a pending preemption run.
+ *
+ * Running the hook right after the load puts the emulated interrupt in the worst place for a
+ * read-modify-write; like exception entry on the Cortex-M3 it clears the monitor.
+ */
+uint32 CyEmu_Ldrex(volatile uint32 *addr)
+{
+    uint32 value = *addr;
+    void (*isr)(void) = cyEmuPreempt;
+
+    cyEmuExclusive = addr;
+    if (isr != NULL)
+    {
+        cyEmuPreempt = NULL;
+        cyEmuExclusive = NULL;
+        CyEmu_Spend(CYEMU_CPU_ISR_ENTRY_EXIT);
+        isr();
+    }
+    return value;
+}
+
+/** @brief STREX: stores and returns 0 only if the monitor is still armed for @p addr. */
+uint32 CyEmu_Strex(uint32 value, volatile uint32 *addr)
+{
+    if (cyEmuExclusive != addr)
+        return 1u;
+    *addr = value;
+    cyEmuExclusive = NULL;
+    return 0u;
+}
+
+/** @brief Runs @p isr once, inside the next LDREX/STREX window. */
+void CyEmu_SetPreemptHook(void (*isr)(void)) { cyEmuPreempt = isr; }
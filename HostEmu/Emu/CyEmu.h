@@ -0,0 +1,114 @@
+/**
+ * @file
+ * @brief Host-side PSoC 5LP emulation core: bus-clock time base and device memory map.
+ *
+ * The emulator runs firmware sources natively on Linux. To keep every DMA address computation
+ * in the examples meaningful (HI16()/LO16() of a (uint32) buffer pointer), the host executable
+ * must be linked non-PIE with the device section layout, DEVICE_FLAGS in HostEmu/Makefile:
+ *
+ *     -no-pie -Wno-pointer-to-int-cast -Wl,-Tdata=0x1FFF8000
+ *     -Wl,--section-start=.ram2=0x20000000 -Wl,--section-start=.cyperiph=0x40000000
+ *
+ * .data/.bss then land in the lower (.ram) SRAM half, `.ram2` in the upper half and the
+ * emulated peripheral registers (PHUB, TD memory, EEPROM, UDB registers) at their device
+ * addresses. Overflowing a SRAM half fails at link time, as it does on the device.
+ *
+ * Time is counted in bus clocks (BUS_CLK == CPU clock on the CY8CKIT-059 examples). CPU-side
+ * costs are charged by the emulated APIs from scope measurements taken on the kit; DMA costs are
+ * charged by the DMAC model in CyDmac.c.
+ *
+ * Components that run on their own clock (a SPI shifter) attach a step function. Every
+ * CyEmu_Spend() runs them up to the new time, one event at a time, so the DMA requests they raise
+ * land between CPU operations as they would on the device. Interrupts raised with
+ * CyEmu_Interrupt() pend until the step returns, then preempt the code that was spending time and
+ * delay it by their run time. Peripheral registers with side effects are mapped, FIFOs with
+ * CyEmu_MapRegister() and registers a spoke transaction reaches two of with CyEmu_MapRegisters();
+ * DMA accesses to them go through the component.
+ */
+#ifndef CY_EMU_H
+#define CY_EMU_H
+
+#include "cytypes.h"
+
+#define CYEMU_BUS_CLK_HZ (64000000u) /**< BUS_CLK of the examples */
+
+/* clang-format off */
+/* CPU-side costs in bus clocks, measured with Control_Reg_1 pulses on the kit (see PSOC_SPI_DMA main.c) */
+#define CYEMU_CPU_CONTROL_REG_WRITE   (26u)  /**< Control_Reg_Write() call, ~400 ns */
+#define CYEMU_CPU_TD_SET_ADDRESS      (96u)  /**< CyDmaTdSetAddress(), ~1500 ns */
+#define CYEMU_CPU_TD_SET_CONFIG       (96u)  /**< CyDmaTdSetConfiguration(), same shape as SetAddress */
+#define CYEMU_CPU_TD_RAW_WRITE        (32u)  /**< one CY_SET_REG16 into TD memory, ~500 ns */
+#define CYEMU_CPU_CH_SET_REQUEST      (109u) /**< CyDmaChSetRequest(CPU_REQ), ~1700 ns */
+#define CYEMU_CPU_CH_CONTROL          (64u)  /**< CyDmaChEnable/Disable/SetInitialTd, estimate */
+#define CYEMU_CPU_ISR_ENTRY_EXIT      (24u)  /**< Cortex-M3 exception entry + exit, 12 + 12 cycles */
+
+/* Cortex-M3 instruction timings in CPU clocks (Cortex-M3 TRM, "Processor instruction timings"),
+   code running from cached flash. Used to estimate code the emulator does not execute itself. */
+#define CYEMU_M3_REFILL               (2u)   /**< P, pipeline refill after a taken branch, 1..3 */
+#define CYEMU_M3_ALU                  (1u)   /**< ADD/SUB/CMP/MOV */
+#define CYEMU_M3_BRANCH_TAKEN         (1u + CYEMU_M3_REFILL)
+#define CYEMU_M3_BRANCH_NOT_TAKEN     (1u)
+#define CYEMU_M3_CALL                 (1u + CYEMU_M3_REFILL) /**< BL */
+#define CYEMU_M3_LOAD                 (2u)   /**< LDR/LDRB, not pipelined with a previous access */
+#define CYEMU_M3_PIPELINED_ACCESS     (1u)   /**< LDR/STR directly after another LDR/STR */
+#define CYEMU_M3_UNALIGNED_EXTRA      (1u)   /**< unaligned LDR/STR is split into two bus transfers */
+#define CYEMU_M3_LDM_STM(n)           (1u + (n)) /**< LDM/STM/PUSH of n registers */
+#define CYEMU_M3_POP_PC(n)            (1u + (n) + CYEMU_M3_REFILL) /**< POP {..., pc} of n registers */
+#define CYEMU_M3_RAM_WAIT_STATES      (0u)   /**< per data access to .ram (C-bus), TRM: zero wait */
+#define CYEMU_M3_RAM2_WAIT_STATES     (0u)   /**< per data access to .ram2 (S-bus), TRM: zero wait */
+/* clang-format on */
+
+/** Common/DmaTdFast.h stores bypass the emulated API, charge them here. */
+#define DMA_TD_FAST_ACCOUNT() CyEmu_Spend(CYEMU_CPU_TD_RAW_WRITE)
+
+/* Common/BitBandFlags.h: alias accesses are applied to the SRAM bit they map to, exclusives are
+   modelled with a one-address monitor that an emulated interrupt clears. */
+#define BITBAND_WRITE(alias, value) CyEmu_BitBandWrite((alias), (value))
+#define BITBAND_READ(alias) CyEmu_BitBandRead(alias)
+#define BITBAND_LDREX(addr) CyEmu_Ldrex(addr)
+#define BITBAND_STREX(value, addr) CyEmu_Strex((value), (addr))
+
+#define CYEMU_NEVER (UINT64_MAX) /**< step result of a component with nothing scheduled */
+
+/* CyEmu_IsMapped() */
+#define CYEMU_MAPPED_NONE (0u)
+#define CYEMU_MAPPED_FIFO (1u)  /**< CyEmu_MapRegister(), one byte a spoke transaction */
+#define CYEMU_MAPPED_LANES (2u) /**< CyEmu_MapRegisters(), byte lanes of the spoke */
+
+/**
+ * Component step: handles everything due at @p now and returns the time of its next event,
+ * later than @p now, or CYEMU_NEVER.
+ */
+typedef uint64 (*CyEmu_StepFn)(void *component, uint64 now);
+typedef uint8 (*CyEmu_RegReadFn)(void *component, uint32 addr);
+typedef void (*CyEmu_RegWriteFn)(void *component, uint32 addr, uint8 value);
+
+/** Emulated peripheral window, linked at CYDEV_PERIPH_BASE. */
+extern volatile uint8 CyEmu_PeriphSpace[CYDEV_PERIPH_SIZE];
+
+void CyEmu_Init(void);
+uint64 CyEmu_Now(void);
+void CyEmu_Spend(uint32 cycles);
+uint64 CyEmu_CyclesToNs(uint64 cycles);
+uint8 CyEmu_IsPeriph(uint32 addr);
+void *CyEmu_Ptr(uint32 addr);
+
+void CyEmu_Attach(CyEmu_StepFn step, void *component);
+void CyEmu_Interrupt(void (*isr)(void));
+void CyEmu_WaitForInterrupt(void);
+uint8 CyEmu_SetPrimask(uint8 masked);
+void CyEmu_MapRegister(uint32 addr, CyEmu_RegReadFn read, CyEmu_RegWriteFn write,
+                       void *component);
+void CyEmu_MapRegisters(uint32 addr, uint8 size, CyEmu_RegReadFn read, CyEmu_RegWriteFn write,
+                        void *component);
+uint8 CyEmu_IsMapped(uint32 addr);
+uint8 CyEmu_BusRead8(uint32 addr);
+void CyEmu_BusWrite8(uint32 addr, uint8 value);
+
+void CyEmu_BitBandWrite(volatile uint32 *alias, uint32 value);
+uint32 CyEmu_BitBandRead(volatile uint32 *alias);
+uint32 CyEmu_Ldrex(volatile uint32 *addr);
+uint32 CyEmu_Strex(uint32 value, volatile uint32 *addr);
+void CyEmu_SetPreemptHook(void (*isr)(void));
+
+#endif /* CY_EMU_H */
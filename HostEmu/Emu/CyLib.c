@@ -0,0 +1,20 @@
+/**
+ * @file
+ * @brief Host-side subset of the cy_boot CyLib.c API.
+ */
+#include "CyLib.h"
+
+/** @brief Busy-waits by advancing the emulated time base. */
+void CyDelay(uint32 milliseconds) { CyEmu_Spend(milliseconds * (CYEMU_BUS_CLK_HZ / 1000u)); }
+
+/** @brief Busy-waits by advancing the emulated time base. */
+void CyDelayUs(uint16 microseconds)
+{
+    CyEmu_Spend((uint32)microseconds * (CYEMU_BUS_CLK_HZ / 1000000u));
+}
+
+/** @brief Masks interrupts and returns the previous PRIMASK. */
+uint8 CyEnterCriticalSection(void) { return CyEmu_SetPrimask(1u); }
+
+/** @brief Restores PRIMASK; interrupts that became pending meanwhile run now. */
+void CyExitCriticalSection(uint8 savedIntrStatus) { (void)CyEmu_SetPrimask(savedIntrStatus); }
@@ -0,0 +1,30 @@
+/**
+ * @file
+ * @brief Host-side subset of the cy_boot CyLib.h API.
+ */
+#ifndef CY_BOOT_CYLIB_H
+#define CY_BOOT_CYLIB_H
+
+#include "CyEmu.h"
+#include "cytypes.h"
+
+typedef void (*cyisraddress)(void);
+
+#define CY_ISR(FuncName) void FuncName(void)
+#define CY_ISR_PROTO(FuncName) void FuncName(void)
+
+/* Interrupts run when the CPU side spends emulated time (CyEmu_Spend) with PRIMASK clear. */
+#define CyGlobalIntEnable ((void)CyEmu_SetPrimask(0u))
+#define CyGlobalIntDisable ((void)CyEmu_SetPrimask(1u))
+#define CYGlobalIntEnable CyGlobalIntEnable
+#define CYGlobalIntDisable CyGlobalIntDisable
+
+/* Sleeps until the emulated components raise an interrupt. */
+#define __WFI() CyEmu_WaitForInterrupt()
+
+void CyDelay(uint32 milliseconds);
+void CyDelayUs(uint16 microseconds);
+uint8 CyEnterCriticalSection(void);
+void CyExitCriticalSection(uint8 savedIntrStatus);
+
+#endif /* CY_BOOT_CYLIB_H */
@@ -0,0 +1,1038 @@
+/**
+ * @file
+ * @brief Host-side model of the Digital Filter Block, see DfbEmu.h.
+ */
+#include "DfbEmu.h"
+
+#include <ctype.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DFBEMU_SOURCE_MAX (65536u) /* bytes of a program file */
+#define DFBEMU_BUS_ADDR_MAX (63u)
+#define DFBEMU_SHIFT_MAX (23)
+#define DFBEMU_MAX24 (0x7FFFFF)
+#define DFBEMU_MIN24 (-0x800000)
+#define DFBEMU_MASK48 (0xFFFFFFFFFFFFuLL)
+
+typedef struct
+{
+    const char *name;
+    uint8 value;
+} DfbEmu_Name;
+
+/* clang-format off */
+static const DfbEmu_Name acuOps[] = {
+    {"hold", DFBEMU_ACU_HOLD},   {"clear", DFBEMU_ACU_CLEAR}, {"read", DFBEMU_ACU_READ},
+    {"write", DFBEMU_ACU_WRITE}, {"incr", DFBEMU_ACU_INCR},   {"decr", DFBEMU_ACU_DECR},
+    {"addf", DFBEMU_ACU_ADDF},   {"subf", DFBEMU_ACU_SUBF},   {"loadf", DFBEMU_ACU_LOADF},
+    {"loadm", DFBEMU_ACU_LOADM}, {"loadl", DFBEMU_ACU_LOADL}, {"setmod", DFBEMU_ACU_SETMOD},
+    {"unsetmod", DFBEMU_ACU_UNSETMOD}, {NULL, 0u}};
+static const DfbEmu_Name aluOps[] = {
+    {"hold", DFBEMU_ALU_HOLD},         {"set0", DFBEMU_ALU_SET0},
+    {"set1", DFBEMU_ALU_SET1},         {"seta", DFBEMU_ALU_SETA},
+    {"setb", DFBEMU_ALU_SETB},         {"nega", DFBEMU_ALU_NEGA},
+    {"negb", DFBEMU_ALU_NEGB},         {"passrama", DFBEMU_ALU_PASSRAMA},
+    {"passramb", DFBEMU_ALU_PASSRAMB}, {"add", DFBEMU_ALU_ADD},
+    {"suba", DFBEMU_ALU_SUBA},         {"subb", DFBEMU_ALU_SUBB},
+    {"absa", DFBEMU_ALU_ABSA},         {"absb", DFBEMU_ALU_ABSB},
+    {"addabsa", DFBEMU_ALU_ADDABSA},   {"addabsb", DFBEMU_ALU_ADDABSB},
+    {"tdeca", DFBEMU_ALU_TDECA},       {NULL, 0u}};
+static const DfbEmu_Name macOps[] = {
+    {"hold", DFBEMU_MAC_HOLD}, {"clra", DFBEMU_MAC_CLRA}, {"macc", DFBEMU_MAC_MACC}, {NULL, 0u}};
+static const DfbEmu_Name writes[] = {
+    {"da", DFBEMU_WRITE_DA}, {"db", DFBEMU_WRITE_DB}, {"bus", DFBEMU_WRITE_BUS}, {NULL, 0u}};
+static const DfbEmu_Name conds[] = {
+    {"eob", DFBEMU_COND_EOB},       {"in1", DFBEMU_COND_IN1},       {"in2", DFBEMU_COND_IN2},
+    {"acuaeq", DFBEMU_COND_ACUAEQ}, {"acubeq", DFBEMU_COND_ACUBEQ}, {"dpsign", DFBEMU_COND_DPSIGN},
+    {"dpeq", DFBEMU_COND_DPEQ},     {NULL, 0u}};
+static const DfbEmu_Name areas[] = {
+    {"code", DFBEMU_AREA_CODE},       {"acu", DFBEMU_AREA_ACU}, {"data_a", DFBEMU_AREA_DATA_A},
+    {"data_b", DFBEMU_AREA_DATA_B},   {NULL, 0u}};
+/* clang-format on */
+
+/* Assembler state of one pass over the source */
+typedef struct
+{
+    DfbEmu_Program *program;
+    char *error;
+    uint32 errorSize;
+    uint8 pass;  /* 1 collects the symbols, 2 emits */
+    uint16 line;
+    uint8 area;
+    uint16 block; /* instruction of the last code label */
+    uint16 counter[4];
+} DfbEmu_Asm;
+
+/* ---- Assembler ---- */
+
+static cystatus DfbEmu_Fail(DfbEmu_Asm *as, const char *format, ...)
+{
+    va_list args;
+    int n;
+
+    if ((as->error == NULL) || (as->errorSize == 0u))
+        return CYRET_BAD_DATA;
+    n = snprintf(as->error, as->errorSize, "line %u: ", (unsigned)as->line);
+    if ((n >= 0) && ((uint32)n < as->errorSize))
+    {
+        va_start(args, format);
+        (void)vsnprintf(as->error + n, as->errorSize - (uint32)n, format, args);
+        va_end(args);
+    }
+    return CYRET_BAD_DATA;
+}
+
+static char *DfbEmu_Trim(char *s)
+{
+    char *end;
+
+    while (isspace((unsigned char)*s))
+        s++;
+    end = s + strlen(s);
+    while ((end > s) && isspace((unsigned char)end[-1]))
+        *--end = '\0';
+    return s;
+}
+
+static uint8 DfbEmu_IsIdent(const char *s)
+{
+    if (!isalpha((unsigned char)*s) && (*s != '_'))
+        return 0u;
+    for (s++; *s != '\0'; s++)
+    {
+        if (!isalnum((unsigned char)*s) && (*s != '_'))
+            return 0u;
+    }
+    return 1u;
+}
+
+/* Length of the identifier at @p s, 0 when there is none. */
+static uint32 DfbEmu_IdentLength(const char *s)
+{
+    uint32 n = 0u;
+
+    if (!isalpha((unsigned char)*s) && (*s != '_'))
+        return 0u;
+    while (isalnum((unsigned char)s[n]) || (s[n] == '_'))
+        n++;
+    return n;
+}
+
+static int DfbEmu_Lookup(const DfbEmu_Name *names, const char *name)
+{
+    for (; names->name != NULL; names++)
+    {
+        if (strcmp(names->name, name) == 0)
+            return names->value;
+    }
+    return -1;
+}
+
+static DfbEmu_Symbol *DfbEmu_SymbolOf(DfbEmu_Program *program, const char *name)
+{
+    uint16 k;
+
+    for (k = 0u; k < program->symbolCount; k++)
+    {
+        if (strcmp(program->symbols[k].name, name) == 0)
+            return &program->symbols[k];
+    }
+    return NULL;
+}
+
+static cystatus DfbEmu_Define(DfbEmu_Asm *as, const char *name, uint8 area, int32 value,
+                              uint8 label)
+{
+    DfbEmu_Program *program = as->program;
+    DfbEmu_Symbol *sym = DfbEmu_SymbolOf(program, name);
+
+    if (sym != NULL)
+    {
+        if (label && (as->pass == 1u))
+            return DfbEmu_Fail(as, "%s is defined twice", name);
+    }
+    else
+    {
+        if (strlen(name) >= DFBEMU_NAME_LENGTH)
+            return DfbEmu_Fail(as, "%s is too long a name", name);
+        if (program->symbolCount >= DFBEMU_SYMBOLS)
+            return DfbEmu_Fail(as, "too many symbols");
+        sym = &program->symbols[program->symbolCount++];
+        strcpy(sym->name, name);
+    }
+    sym->area = area;
+    sym->value = value;
+    return CYRET_SUCCESS;
+}
+
+/*
+ * A number (decimal, 0x hex, signed) or a symbol into @p value and its area; a symbol not known
+ * yet is 0 in pass 1.
+ */
+static cystatus DfbEmu_Expr(DfbEmu_Asm *as, const char *text, int32 *value, uint8 *area)
+{
+    const DfbEmu_Symbol *sym;
+    char *end;
+    long n;
+
+    if (DfbEmu_IsIdent(text))
+    {
+        sym = DfbEmu_SymbolOf(as->program, text);
+        if (sym == NULL)
+        {
+            if (as->pass == 1u)
+            {
+                *value = 0;
+                *area = DFBEMU_AREA_VALUE;
+                return CYRET_STARTED;
+            }
+            return DfbEmu_Fail(as, "%s is not defined", text);
+        }
+        *value = sym->value;
+        *area = sym->area;
+        return CYRET_SUCCESS;
+    }
+    n = strtol(text, &end, 0);
+    if ((*text == '\0') || (*end != '\0'))
+        return DfbEmu_Fail(as, "%s is not a number or a name", text);
+    *value = (int32)n;
+    *area = DFBEMU_AREA_VALUE;
+    return CYRET_SUCCESS;
+}
+
+/* Splits @p args at the commas into at most @p max trimmed strings, returns how many. */
+static uint32 DfbEmu_Split(char *args, char **out, uint32 max)
+{
+    uint32 n = 0u;
+    char *comma;
+
+    for (;;)
+    {
+        comma = strchr(args, ',');
+        if (comma != NULL)
+            *comma = '\0';
+        if (n < max)
+            out[n] = DfbEmu_Trim(args);
+        n++;
+        if (comma == NULL)
+            return n;
+        args = comma + 1;
+    }
+}
+
+static cystatus DfbEmu_Dw(DfbEmu_Asm *as, char *list)
+{
+    char *values[DFBEMU_DATA_WORDS + 1u];
+    uint32 n = DfbEmu_Split(list, values, DFBEMU_DATA_WORDS + 1u);
+    uint32 k;
+    int32 v[DFBEMU_DATA_WORDS];
+    uint8 area;
+
+    if (n > DFBEMU_DATA_WORDS)
+        return DfbEmu_Fail(as, "too many words");
+    for (k = 0u; k < n; k++)
+    {
+        if (DfbEmu_Expr(as, values[k], &v[k], &area) == CYRET_BAD_DATA)
+            return CYRET_BAD_DATA;
+    }
+
+    if (as->area == DFBEMU_AREA_ACU)
+    {
+        uint16 w = as->counter[DFBEMU_AREA_ACU];
+
+        if (n != 2u)
+            return DfbEmu_Fail(as, "an ACU word is dw a, b");
+        if (w >= DFBEMU_ACU_WORDS)
+            return DfbEmu_Fail(as, "the ACU RAM holds %u words", (unsigned)DFBEMU_ACU_WORDS);
+        for (k = 0u; k < 2u; k++)
+        {
+            if ((v[k] < 0) || (v[k] >= (int32)DFBEMU_DATA_WORDS))
+                return DfbEmu_Fail(as, "%s is not a data RAM address", values[k]);
+            as->program->acu[k][w] = (uint8)v[k];
+        }
+        as->counter[DFBEMU_AREA_ACU] = (uint16)(w + 1u);
+        return CYRET_SUCCESS;
+    }
+    if (as->area == DFBEMU_AREA_CODE)
+        return DfbEmu_Fail(as, "dw in the code area");
+
+    for (k = 0u; k < n; k++)
+    {
+        uint8 side = (uint8)(as->area - DFBEMU_AREA_DATA_A);
+        uint16 w = as->counter[as->area];
+
+        if (w >= DFBEMU_DATA_WORDS)
+            return DfbEmu_Fail(as, "the data RAM holds %u words", (unsigned)DFBEMU_DATA_WORDS);
+        if ((v[k] < DFBEMU_MIN24) || (v[k] > (int32)DFBEMU_MASK24))
+            return DfbEmu_Fail(as, "%s does not fit in 24 bits", values[k]);
+        as->program->data[side][w] = (uint32)v[k] & DFBEMU_MASK24;
+        as->counter[as->area] = (uint16)(w + 1u);
+    }
+    return CYRET_SUCCESS;
+}
+
+/* One field of an instruction, @p seen has a bit per field name already given. */
+static cystatus DfbEmu_Field(DfbEmu_Asm *as, DfbEmu_Insn *insn, const char *name, char *args,
+                             uint16 *seen)
+{
+    static const char *const fields[] = {"acu",   "addr", "dmux", "alu", "mac",
+                                         "shift", "write", "jmp", "jmpl"};
+    char *arg[8];
+    uint32 n = DfbEmu_Split(args, arg, 8u);
+    uint32 field;
+    uint32 k;
+    int32 value;
+    uint8 area;
+    int op;
+
+    for (field = 0u; field < sizeof(fields) / sizeof(fields[0]); field++)
+    {
+        if (strcmp(fields[field], name) == 0)
+            break;
+    }
+    if (field == sizeof(fields) / sizeof(fields[0]))
+        return DfbEmu_Fail(as, "unknown field %s", name);
+    if (field >= 7u)
+        field = 7u; /* one jump an instruction */
+    if (*seen & (1u << field))
+        return DfbEmu_Fail(as, "%s given twice", name);
+    *seen |= (uint16)(1u << field);
+
+    switch (field)
+    {
+    case 0u: /* acu(a, b) */
+    case 2u: /* dmux(a, b) */
+        if (n != 2u)
+            return DfbEmu_Fail(as, "%s takes an A and a B side", name);
+        for (k = 0u; k < 2u; k++)
+        {
+            if (field == 0u)
+            {
+                op = DfbEmu_Lookup(acuOps, arg[k]);
+                if (op < 0)
+                    return DfbEmu_Fail(as, "unknown ACU operation %s", arg[k]);
+                insn->acu[k] = (uint8)op;
+            }
+            else
+            {
+                const char *c = arg[k];
+                uint8 mux = 0u;
+
+                if ((*c != 'b') && (*c != 's'))
+                    return DfbEmu_Fail(as, "bad dmux %s", arg[k]);
+                mux |= (*c++ == 'b') ? DFBEMU_MUX1_BUS : 0u;
+                if (*c == 'r')
+                {
+                    mux |= DFBEMU_MUX2_RAM;
+                    c++;
+                }
+                if (((*c != 'a') && (*c != 'm')) || (c[1] != '\0'))
+                    return DfbEmu_Fail(as, "bad dmux %s", arg[k]);
+                mux |= (*c == 'm') ? DFBEMU_MUX3_MAC : 0u;
+                insn->dmux[k] = mux;
+            }
+        }
+        return CYRET_SUCCESS;
+
+    case 1u: /* addr(n) */
+        if (n != 1u)
+            return DfbEmu_Fail(as, "addr takes one address");
+        if (DfbEmu_Expr(as, arg[0], &value, &area) == CYRET_BAD_DATA)
+            return CYRET_BAD_DATA;
+        if ((value < 0) || (value > (int32)DFBEMU_BUS_ADDR_MAX))
+            return DfbEmu_Fail(as, "%s is out of the address range", arg[0]);
+        insn->addr = (uint8)value;
+        return CYRET_SUCCESS;
+
+    case 3u: /* alu(op) */
+    case 4u: /* mac(op) */
+        if (n != 1u)
+            return DfbEmu_Fail(as, "%s takes one operation", name);
+        op = DfbEmu_Lookup((field == 3u) ? aluOps : macOps, arg[0]);
+        if (op < 0)
+            return DfbEmu_Fail(as, "unknown %s operation %s", name, arg[0]);
+        if (field == 3u)
+            insn->alu = (uint8)op;
+        else
+            insn->mac = (uint8)op;
+        return CYRET_SUCCESS;
+
+    case 5u: /* shift(left|right, n) */
+        if ((n != 2u) || ((strcmp(arg[0], "left") != 0) && (strcmp(arg[0], "right") != 0)))
+            return DfbEmu_Fail(as, "shift takes left or right and a count");
+        if (DfbEmu_Expr(as, arg[1], &value, &area) == CYRET_BAD_DATA)
+            return CYRET_BAD_DATA;
+        if ((value < 0) || (value > DFBEMU_SHIFT_MAX))
+            return DfbEmu_Fail(as, "shift count %s is out of range", arg[1]);
+        insn->shift = (int8)((arg[0][0] == 'l') ? value : -value);
+        return CYRET_SUCCESS;
+
+    case 6u: /* write(dest, ...) */
+        for (k = 0u; k < n; k++)
+        {
+            op = DfbEmu_Lookup(writes, arg[k]);
+            if (op < 0)
+                return DfbEmu_Fail(as, "unknown write destination %s", arg[k]);
+            insn->write |= (uint8)op;
+        }
+        return CYRET_SUCCESS;
+
+    default: /* jmp(cond, ..., label), jmpl(cond, ..., label) */
+        if ((n < 2u) || (n > 8u))
+            return DfbEmu_Fail(as, "%s takes conditions and a label", name);
+        for (k = 0u; k + 1u < n; k++)
+        {
+            op = DfbEmu_Lookup(conds, arg[k]);
+            if (op < 0)
+                return DfbEmu_Fail(as, "unknown condition %s", arg[k]);
+            insn->cond |= (uint8)op;
+        }
+        if (DfbEmu_Expr(as, arg[n - 1u], &value, &area) == CYRET_BAD_DATA)
+            return CYRET_BAD_DATA;
+        if ((as->pass == 2u) && ((area != DFBEMU_AREA_CODE) || (value < 0) ||
+                                 (value >= (int32)as->program->codeWords)))
+            return DfbEmu_Fail(as, "%s is not an instruction", arg[n - 1u]);
+        insn->jump = (strcmp(name, "jmp") == 0) ? DFBEMU_JUMP_JMP : DFBEMU_JUMP_JMPL;
+        insn->target = (uint8)value;
+        return CYRET_SUCCESS;
+    }
+}
+
+static cystatus DfbEmu_Instruction(DfbEmu_Asm *as, char *text)
+{
+    DfbEmu_Insn insn;
+    uint16 seen = 0u;
+    uint16 at = as->counter[DFBEMU_AREA_CODE];
+
+    if (as->area != DFBEMU_AREA_CODE)
+        return DfbEmu_Fail(as, "instruction outside the code area");
+    if (at >= DFBEMU_CODE_WORDS)
+        return DfbEmu_Fail(as, "the control store holds %u instructions",
+                           (unsigned)DFBEMU_CODE_WORDS);
+
+    memset(&insn, 0, sizeof(insn));
+    while (*text != '\0')
+    {
+        uint32 n = DfbEmu_IdentLength(text);
+        char name[DFBEMU_NAME_LENGTH];
+        char *close;
+
+        if ((n == 0u) || (n >= sizeof(name)))
+            return DfbEmu_Fail(as, "expected a field at %s", text);
+        memcpy(name, text, n);
+        name[n] = '\0';
+        text += n;
+        while (isspace((unsigned char)*text))
+            text++;
+        close = strchr(text, ')');
+        if ((*text != '(') || (close == NULL))
+            return DfbEmu_Fail(as, "expected %s(...)", name);
+        *close = '\0';
+        if (DfbEmu_Field(as, &insn, name, text + 1, &seen) != CYRET_SUCCESS)
+            return CYRET_BAD_DATA;
+        text = close + 1;
+        while (isspace((unsigned char)*text))
+            text++;
+    }
+
+    insn.block = (uint8)as->block;
+    insn.line = as->line;
+    as->program->code[at] = insn;
+    as->counter[DFBEMU_AREA_CODE] = (uint16)(at + 1u);
+    return CYRET_SUCCESS;
+}
+
+static cystatus DfbEmu_Line(DfbEmu_Asm *as, char *text)
+{
+    uint32 n;
+    char *rest;
+
+    /* Labels */
+    for (;;)
+    {
+        text = DfbEmu_Trim(text);
+        n = DfbEmu_IdentLength(text);
+        rest = text + n;
+        while (isspace((unsigned char)*rest))
+            rest++;
+        if ((n == 0u) || (*rest != ':'))
+            break;
+        text[n] = '\0';
+        if (DfbEmu_Define(as, text, as->area, as->counter[as->area], 1u) != CYRET_SUCCESS)
+            return CYRET_BAD_DATA;
+        if (as->area == DFBEMU_AREA_CODE)
+            as->block = as->counter[DFBEMU_AREA_CODE];
+        text = rest + 1;
+    }
+    if (*text == '\0')
+        return CYRET_SUCCESS;
+
+    /* NAME = value */
+    if ((n != 0u) && (*rest == '='))
+    {
+        int32 value;
+        uint8 area;
+
+        text[n] = '\0';
+        if (DfbEmu_Expr(as, DfbEmu_Trim(rest + 1), &value, &area) == CYRET_BAD_DATA)
+            return CYRET_BAD_DATA;
+        return DfbEmu_Define(as, text, area, value, 0u);
+    }
+
+    /* area name, dw list */
+    if ((n == 4u) && (strncmp(text, "area", 4u) == 0) && isspace((unsigned char)text[4]))
+    {
+        int area = DfbEmu_Lookup(areas, DfbEmu_Trim(text + 4));
+
+        if (area < 0)
+            return DfbEmu_Fail(as, "unknown area %s", DfbEmu_Trim(text + 4));
+        as->area = (uint8)area;
+        return CYRET_SUCCESS;
+    }
+    if ((n == 2u) && (strncmp(text, "dw", 2u) == 0) && isspace((unsigned char)text[2]))
+        return DfbEmu_Dw(as, text + 2);
+
+    return DfbEmu_Instruction(as, text);
+}
+
+static cystatus DfbEmu_Pass(DfbEmu_Asm *as, const char *source)
+{
+    char buffer[512];
+    uint8 inComment = 0u;
+
+    as->line = 0u;
+    as->area = DFBEMU_AREA_CODE;
+    as->block = 0u;
+    memset(as->counter, 0, sizeof(as->counter));
+
+    while (*source != '\0')
+    {
+        const char *eol = strchr(source, '\n');
+        uint32 length = (eol != NULL) ? (uint32)(eol - source) : (uint32)strlen(source);
+        char *c;
+
+        as->line++;
+        if (length >= sizeof(buffer))
+            return DfbEmu_Fail(as, "line too long");
+        memcpy(buffer, source, length);
+        buffer[length] = '\0';
+        source += length + ((eol != NULL) ? 1u : 0u);
+
+        /* Comments, block comments can span lines */
+        for (c = buffer; *c != '\0';)
+        {
+            if (inComment)
+            {
+                char *end = strstr(c, "*/");
+
+                memset(c, ' ', (end != NULL) ? (size_t)(end + 2 - c) : strlen(c));
+                inComment = (uint8)(end == NULL);
+                c = (end != NULL) ? end + 2 : c + strlen(c);
+            }
+            else if ((c[0] == '/') && (c[1] == '/'))
+                *c = '\0';
+            else if ((c[0] == '/') && (c[1] == '*'))
+                inComment = 1u;
+            else
+                c++;
+        }
+        if (DfbEmu_Line(as, buffer) != CYRET_SUCCESS)
+            return CYRET_BAD_DATA;
+    }
+    return CYRET_SUCCESS;
+}
+
+/**
+ * @brief Assembles the dfb.v2 text @p source into @p program.
+ *
+ * @param error Receives "line n: what" on failure, may be NULL.
+ * @return CYRET_SUCCESS or CYRET_BAD_DATA.
+ */
+cystatus DfbEmu_Assemble(const char *source, DfbEmu_Program *program, char *error,
+                         uint32 errorSize)
+{
+    DfbEmu_Asm as;
+
+    memset(program, 0, sizeof(*program));
+    memset(&as, 0, sizeof(as));
+    as.program = program;
+    as.error = error;
+    as.errorSize = errorSize;
+    if ((error != NULL) && (errorSize != 0u))
+        error[0] = '\0';
+
+    as.pass = 1u;
+    if (DfbEmu_Pass(&as, source) != CYRET_SUCCESS)
+        return CYRET_BAD_DATA;
+    program->codeWords = as.counter[DFBEMU_AREA_CODE];
+    as.pass = 2u;
+    if (DfbEmu_Pass(&as, source) != CYRET_SUCCESS)
+        return CYRET_BAD_DATA;
+    if (program->codeWords == 0u)
+    {
+        as.line = 0u;
+        return DfbEmu_Fail(&as, "no instructions");
+    }
+    program->acuWords = as.counter[DFBEMU_AREA_ACU];
+    program->dataWords[0] = as.counter[DFBEMU_AREA_DATA_A];
+    program->dataWords[1] = as.counter[DFBEMU_AREA_DATA_B];
+    return CYRET_SUCCESS;
+}
+
+/** @brief DfbEmu_Assemble() of the file at @p path; CYRET_BAD_PARAM when it cannot be read. */
+cystatus DfbEmu_AssembleFile(const char *path, DfbEmu_Program *program, char *error,
+                             uint32 errorSize)
+{
+    FILE *file = fopen(path, "rb");
+    char *source;
+    size_t length;
+    cystatus status;
+
+    if (file == NULL)
+    {
+        if ((error != NULL) && (errorSize != 0u))
+            (void)snprintf(error, errorSize, "cannot open %s", path);
+        return CYRET_BAD_PARAM;
+    }
+    source = (char *)malloc(DFBEMU_SOURCE_MAX + 1u);
+    length = (source != NULL) ? fread(source, 1u, DFBEMU_SOURCE_MAX + 1u, file) : 0u;
+    (void)fclose(file);
+    if ((source == NULL) || (length > DFBEMU_SOURCE_MAX))
+    {
+        free(source);
+        if ((error != NULL) && (errorSize != 0u))
+            (void)snprintf(error, errorSize, "%s is too big", path);
+        return CYRET_BAD_PARAM;
+    }
+    source[length] = '\0';
+    status = DfbEmu_Assemble(source, program, error, errorSize);
+    free(source);
+    return status;
+}
+
+/** @brief The symbol @p name of @p program, NULL when there is none. */
+const DfbEmu_Symbol *DfbEmu_FindSymbol(const DfbEmu_Program *program, const char *name)
+{
+    return DfbEmu_SymbolOf((DfbEmu_Program *)program, name);
+}
+
+/* ---- Datapath ---- */
+
+/** @brief The 24-bit two's complement @p value as a signed number. */
+int32 DfbEmu_Signed24(uint32 value)
+{
+    value &= DFBEMU_MASK24;
+    return (value & 0x800000u) ? (int32)value - 0x1000000 : (int32)value;
+}
+
+static uint32 DfbEmu_Result(const DfbEmu *dfb, int64 value)
+{
+    if (dfb->saturate)
+    {
+        if (value > DFBEMU_MAX24)
+            value = DFBEMU_MAX24;
+        else if (value < DFBEMU_MIN24)
+            value = DFBEMU_MIN24;
+    }
+    return (uint32)value & DFBEMU_MASK24;
+}
+
+static uint32 DfbEmu_Shift(const DfbEmu *dfb, uint32 value, int8 shift)
+{
+    int64 v = DfbEmu_Signed24(value);
+
+    if (shift >= 0)
+        return DfbEmu_Result(dfb, v * ((int64)1 << shift));
+    return (uint32)(v >> -shift) & DFBEMU_MASK24;
+}
+
+static uint32 DfbEmu_MacOut(const DfbEmu *dfb)
+{
+    int64 acc = dfb->acc;
+
+    if (dfb->round)
+        acc += (int64)1 << 22;
+    return DfbEmu_Result(dfb, acc >> 23);
+}
+
+static uint32 DfbEmu_Alu(const DfbEmu *dfb, uint8 op, const uint32 *ramOut)
+{
+    int64 a = DfbEmu_Signed24(dfb->aluIn[0]);
+    int64 b = DfbEmu_Signed24(dfb->aluIn[1]);
+
+    switch (op)
+    {
+    case DFBEMU_ALU_SET0:
+        return 0u;
+    case DFBEMU_ALU_SET1:
+        return 1u;
+    case DFBEMU_ALU_SETA:
+        return dfb->aluIn[0];
+    case DFBEMU_ALU_SETB:
+        return dfb->aluIn[1];
+    case DFBEMU_ALU_NEGA:
+        return DfbEmu_Result(dfb, -a);
+    case DFBEMU_ALU_NEGB:
+        return DfbEmu_Result(dfb, -b);
+    case DFBEMU_ALU_PASSRAMA:
+        return ramOut[0];
+    case DFBEMU_ALU_PASSRAMB:
+        return ramOut[1];
+    case DFBEMU_ALU_ADD:
+        return DfbEmu_Result(dfb, a + b);
+    case DFBEMU_ALU_SUBA:
+        return DfbEmu_Result(dfb, a - b);
+    case DFBEMU_ALU_SUBB:
+        return DfbEmu_Result(dfb, b - a);
+    case DFBEMU_ALU_ABSA:
+        return DfbEmu_Result(dfb, (a < 0) ? -a : a);
+    case DFBEMU_ALU_ABSB:
+        return DfbEmu_Result(dfb, (b < 0) ? -b : b);
+    case DFBEMU_ALU_ADDABSA:
+        return DfbEmu_Result(dfb, ((a < 0) ? -a : a) + b);
+    case DFBEMU_ALU_ADDABSB:
+        return DfbEmu_Result(dfb, a + ((b < 0) ? -b : b));
+    case DFBEMU_ALU_TDECA:
+        return DfbEmu_Result(dfb, a - 1);
+    default:
+        return dfb->aluOut;
+    }
+}
+
+/* ACU operation @p op of side @p side; returns 0 on a bad ACU RAM address. */
+static uint8 DfbEmu_Acu(DfbEmu *dfb, uint8 side, uint8 op, uint8 addr)
+{
+    uint8 *reg = &dfb->reg[side];
+    uint8 span = (uint8)(dfb->mreg[side] - dfb->lreg[side] + 1u);
+
+    if (((op == DFBEMU_ACU_READ) || (op == DFBEMU_ACU_WRITE) || (op == DFBEMU_ACU_LOADF) ||
+         (op == DFBEMU_ACU_LOADM) || (op == DFBEMU_ACU_LOADL)) &&
+        (addr >= DFBEMU_ACU_WORDS))
+        return 0u;
+
+    switch (op)
+    {
+    case DFBEMU_ACU_CLEAR:
+        *reg = 0u;
+        break;
+    case DFBEMU_ACU_READ:
+        *reg = dfb->acuRam[side][addr];
+        break;
+    case DFBEMU_ACU_WRITE:
+        dfb->acuRam[side][addr] = *reg;
+        break;
+    case DFBEMU_ACU_INCR:
+        *reg = (dfb->mod[side] && (*reg == dfb->mreg[side])) ? dfb->lreg[side]
+                                                              : (uint8)(*reg + 1u);
+        break;
+    case DFBEMU_ACU_DECR:
+        *reg = (dfb->mod[side] && (*reg == dfb->lreg[side])) ? dfb->mreg[side]
+                                                              : (uint8)(*reg - 1u);
+        break;
+    case DFBEMU_ACU_ADDF:
+    case DFBEMU_ACU_SUBF:
+    {
+        int32 step = (op == DFBEMU_ACU_ADDF) ? dfb->freg[side] : -(int32)dfb->freg[side];
+
+        if (dfb->mod[side] && (span != 0u))
+        {
+            int32 offset = ((int32)*reg - dfb->lreg[side] + step) % span;
+
+            *reg = (uint8)(dfb->lreg[side] + ((offset < 0) ? offset + span : offset));
+        }
+        else
+            *reg = (uint8)(*reg + step);
+        break;
+    }
+    case DFBEMU_ACU_LOADF:
+        dfb->freg[side] = dfb->acuRam[side][addr];
+        break;
+    case DFBEMU_ACU_LOADM:
+        dfb->mreg[side] = dfb->acuRam[side][addr];
+        break;
+    case DFBEMU_ACU_LOADL:
+        dfb->lreg[side] = dfb->acuRam[side][addr];
+        break;
+    case DFBEMU_ACU_SETMOD:
+        dfb->mod[side] = 1u;
+        break;
+    case DFBEMU_ACU_UNSETMOD:
+        dfb->mod[side] = 0u;
+        break;
+    default:
+        break;
+    }
+    *reg &= (uint8)(DFBEMU_DATA_WORDS - 1u);
+    return 1u;
+}
+
+/* The DFB side of write(bus) into holding register @p channel. */
+static void DfbEmu_Output(DfbEmu *dfb, uint8 channel, uint32 value)
+{
+    uint32 latency = (uint32)(dfb->stats.cycles + 1u - dfb->stageAt[channel]);
+
+    if (dfb->holdLocked[channel])
+    {
+        dfb->pending[channel] = value;
+        dfb->holdPending[channel] = 1u;
+    }
+    else
+        dfb->hold[channel] = value;
+    if (dfb->ready[channel])
+        dfb->stats.unread[channel]++;
+    dfb->ready[channel] = 1u;
+    dfb->stats.outputs[channel]++;
+    if (latency > dfb->stats.latencyMax[channel])
+        dfb->stats.latencyMax[channel] = latency;
+}
+
+/**
+ * @brief Loads @p program into the control store and RAMs, as Filter_Start(), and starts the
+ *        DFB at its first instruction. Rounding and saturation are off, the coherency keys low
+ *        and the data alignment off.
+ */
+void DfbEmu_Init(DfbEmu *dfb, const DfbEmu_Program *program)
+{
+    memset(dfb, 0, sizeof(*dfb));
+    dfb->program = program;
+    memcpy(dfb->ram, program->data, sizeof(dfb->ram));
+    memcpy(dfb->acuRam, program->acu, sizeof(dfb->acuRam));
+    dfb->running = 1u;
+}
+
+/** @brief Rounds the MAC output to nearest (@p round 1) instead of truncating it. */
+void DfbEmu_SetRounding(DfbEmu *dfb, uint8 round) { dfb->round = (uint8)(round != 0u); }
+
+/** @brief Saturates the MAC output, shifts and ALU results (@p saturate 1) instead of wrapping. */
+void DfbEmu_SetSaturation(DfbEmu *dfb, uint8 saturate)
+{
+    dfb->saturate = (uint8)(saturate != 0u);
+}
+
+/** @brief Filter_SetCoherency(): the key byte, DFBEMU_KEY_*, of staging and holding @p channel. */
+void DfbEmu_SetCoherency(DfbEmu *dfb, uint8 channel, uint8 key)
+{
+    DfbEmu_SetKey(dfb, channel, 0u, key);
+    DfbEmu_SetKey(dfb, channel, 1u, key);
+}
+
+/** @brief Filter_SetCoherencyEx(): the key byte of the staging, or with @p hold the holding,
+ *         register of @p channel alone. */
+void DfbEmu_SetKey(DfbEmu *dfb, uint8 channel, uint8 hold, uint8 key)
+{
+    if ((channel >= DFBEMU_CHANNELS) || (key > DFBEMU_KEY_HIGH))
+    {
+        dfb->stats.faults++;
+        return;
+    }
+    if (hold)
+        dfb->holdKey[channel] = key;
+    else
+        dfb->stageKey[channel] = key;
+}
+
+/** @brief Filter_DALIGN_REG, DFBEMU_DALIGN_* bits. */
+void DfbEmu_SetDalign(DfbEmu *dfb, uint8 dalign) { dfb->dalign = dalign; }
+
+/** @brief Runs one instruction, one DFB clock. Does nothing once the DFB has stopped on a fault. */
+void DfbEmu_Step(DfbEmu *dfb)
+{
+    const DfbEmu_Program *program = dfb->program;
+    const DfbEmu_Insn *insn;
+    uint32 shifter;
+    uint32 ramOut[2];
+    uint32 mux1[2];
+    uint32 mux2[2];
+    uint32 mux3[2];
+    uint32 macOut;
+    uint32 aluOut;
+    uint8 side;
+    uint8 taken;
+
+    if (!dfb->running)
+        return;
+    insn = &program->code[dfb->pc];
+    shifter = DfbEmu_Shift(dfb, dfb->aluOut, insn->shift);
+
+    /* ACUs first, the RAMs are accessed at the address they leave; writes go through */
+    for (side = 0u; side < 2u; side++)
+    {
+        if (!DfbEmu_Acu(dfb, side, insn->acu[side], insn->addr))
+            dfb->stats.faults++;
+        if (insn->write & (side ? DFBEMU_WRITE_DB : DFBEMU_WRITE_DA))
+            dfb->ram[side][dfb->reg[side]] = dfb->mux1[side];
+        ramOut[side] = dfb->ram[side][dfb->reg[side]];
+    }
+
+    /* MUX1 and the bus read, which takes the sample out of staging */
+    for (side = 0u; side < 2u; side++)
+    {
+        if (insn->dmux[side] & DFBEMU_MUX1_BUS)
+        {
+            if ((insn->addr == 0u) || (insn->addr > DFBEMU_CHANNELS))
+            {
+                dfb->stats.faults++;
+                mux1[side] = 0u;
+            }
+            else
+            {
+                mux1[side] = dfb->stage[insn->addr - 1u];
+                dfb->in[insn->addr - 1u] = 0u;
+            }
+        }
+        else
+            mux1[side] = shifter;
+        mux2[side] = (insn->dmux[side] & DFBEMU_MUX2_RAM) ? ramOut[side] : mux1[side];
+    }
+
+    /* MAC on this instruction's MUX2 outputs */
+    if (insn->mac != DFBEMU_MAC_HOLD)
+    {
+        int64 product = (int64)DfbEmu_Signed24(mux2[0]) * DfbEmu_Signed24(mux2[1]);
+        uint64 acc = (uint64)((insn->mac == DFBEMU_MAC_MACC) ? dfb->acc : 0) + (uint64)product;
+
+        acc &= DFBEMU_MASK48;
+        dfb->acc = (acc & 0x800000000000uLL) ? (int64)(acc | ~DFBEMU_MASK48) : (int64)acc;
+    }
+    macOut = DfbEmu_MacOut(dfb);
+    for (side = 0u; side < 2u; side++)
+        mux3[side] = (insn->dmux[side] & DFBEMU_MUX3_MAC) ? macOut : mux2[side];
+
+    /* ALU on last instruction's MUX3 outputs */
+    aluOut = DfbEmu_Alu(dfb, insn->alu, ramOut);
+
+    if (insn->write & DFBEMU_WRITE_BUS)
+    {
+        if ((insn->addr == 0u) || (insn->addr > DFBEMU_CHANNELS))
+            dfb->stats.faults++;
+        else
+            DfbEmu_Output(dfb, (uint8)(insn->addr - 1u), shifter);
+    }
+
+    memcpy(dfb->mux1, mux1, sizeof(mux1));
+    memcpy(dfb->aluIn, mux3, sizeof(mux3));
+    dfb->aluOut = aluOut;
+
+    /* Next instruction */
+    taken = 1u;
+    if ((insn->cond & DFBEMU_COND_IN1) && !dfb->in[0])
+        taken = 0u;
+    if ((insn->cond & DFBEMU_COND_IN2) && !dfb->in[1])
+        taken = 0u;
+    if ((insn->cond & DFBEMU_COND_ACUAEQ) && (dfb->reg[0] != dfb->mreg[0]))
+        taken = 0u;
+    if ((insn->cond & DFBEMU_COND_ACUBEQ) && (dfb->reg[1] != dfb->mreg[1]))
+        taken = 0u;
+    if ((insn->cond & DFBEMU_COND_DPSIGN) && !(aluOut & 0x800000u))
+        taken = 0u;
+    if ((insn->cond & DFBEMU_COND_DPEQ) && (aluOut != 0u))
+        taken = 0u;
+
+    dfb->stats.cycles++;
+    if (insn->jump == DFBEMU_JUMP_NONE)
+        dfb->pc++;
+    else if (taken)
+        dfb->pc = insn->target;
+    else if (insn->jump == DFBEMU_JUMP_JMP)
+        dfb->pc++;
+    else
+    {
+        dfb->pc = insn->block;
+        if (insn->cond & (DFBEMU_COND_IN1 | DFBEMU_COND_IN2))
+            dfb->stats.idleCycles++;
+    }
+    if (dfb->pc >= program->codeWords)
+    {
+        dfb->stats.faults++;
+        dfb->running = 0u;
+    }
+}
+
+/** @brief DfbEmu_Step() @p cycles times. */
+void DfbEmu_Run(DfbEmu *dfb, uint32 cycles)
+{
+    while (cycles-- != 0u)
+        DfbEmu_Step(dfb);
+}
+
+/**
+ * @brief A bus write of @p value to byte @p offset (0 low, 2 high) of staging register
+ *        @p channel; the key byte hands the whole value to the DFB and raises in1 / in2.
+ */
+void DfbEmu_WriteStage(DfbEmu *dfb, uint8 channel, uint8 offset, uint8 value)
+{
+    uint8 *bytes;
+    uint8 aligned;
+
+    if ((channel >= DFBEMU_CHANNELS) || (offset > 2u))
+    {
+        dfb->stats.faults++;
+        return;
+    }
+    bytes = dfb->stageBytes[channel];
+    aligned = (uint8)(dfb->dalign & (channel ? DFBEMU_DALIGN_STAGEB : DFBEMU_DALIGN_STAGEA));
+    if (!aligned)
+        bytes[offset] = value;
+    else if (offset < 2u)
+        bytes[offset + 1u] = value;
+
+    if (offset != dfb->stageKey[channel])
+        return;
+    if (dfb->in[channel])
+        dfb->stats.overruns[channel]++;
+    dfb->stage[channel] = (uint32)bytes[0] | ((uint32)bytes[1] << 8) | ((uint32)bytes[2] << 16);
+    dfb->in[channel] = 1u;
+    dfb->stageAt[channel] = dfb->stats.cycles;
+    dfb->stats.inputs[channel]++;
+}
+
+/**
+ * @brief A bus read of byte @p offset of holding register @p channel.
+ *
+ * Reading another byte than the key locks the value, reading the key byte unlocks it and clears
+ * the data ready, unless the DFB wrote a result meanwhile: that one is ready next. Aligned, the
+ * high byte address reads the sign extension.
+ */
+uint8 DfbEmu_ReadHold(DfbEmu *dfb, uint8 channel, uint8 offset)
+{
+    uint32 value;
+    uint8 byte;
+
+    if ((channel >= DFBEMU_CHANNELS) || (offset > 2u))
+    {
+        dfb->stats.faults++;
+        return 0u;
+    }
+    value = dfb->hold[channel];
+    if (!(dfb->dalign & (channel ? DFBEMU_DALIGN_HOLDB : DFBEMU_DALIGN_HOLDA)))
+        byte = (uint8)(value >> (8u * offset));
+    else if (offset < 2u)
+        byte = (uint8)(value >> (8u * (offset + 1u)));
+    else
+        byte = (value & 0x800000u) ? 0xFFu : 0u;
+
+    if (offset != dfb->holdKey[channel])
+    {
+        dfb->holdLocked[channel] = 1u;
+        return byte;
+    }
+    dfb->holdLocked[channel] = 0u;
+    if (dfb->holdPending[channel])
+    {
+        /* The result that waited is the next one to read */
+        dfb->hold[channel] = dfb->pending[channel];
+        dfb->holdPending[channel] = 0u;
+    }
+    else
+        dfb->ready[channel] = 0u;
+    return byte;
+}
+
+/** @brief Data ready of holding register @p channel, as the Filter_Done interrupt sees it. */
+uint8 DfbEmu_Ready(const DfbEmu *dfb, uint8 channel)
+{
+    return (channel < DFBEMU_CHANNELS) ? dfb->ready[channel] : 0u;
+}
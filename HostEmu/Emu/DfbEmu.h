@@ -0,0 +1,248 @@
+/**
+ * @file
+ * @brief Host-side model of the Digital Filter Block: assembler for dfb.v2 programs, the
+ *        microcoded datapath and the staging / holding registers the bus sees.
+ *
+ * Programs are assembled from the text the Filter component takes (Filter_24Bit.cydsn/dfb.v2):
+ * labels, `area acu` / `area data_a` / `area data_b` with `dw` words, `NAME = label` equates and
+ * one instruction per line, made of the fields acu(a,b) addr(n) dmux(a,b) alu(op) mac(op)
+ * shift(dir,n) write(dest,...) and jmp(cond,...,label) or jmpl(cond,...,label). A missing field
+ * holds. Every instruction takes one DFB clock (BUS_CLK), jumps included.
+ *
+ * The datapath is 24 bits wide, two's complement (Q23 for the filters). Each side (A and B) has
+ * a data RAM of DFBEMU_DATA_WORDS words addressed by its ACU, and three muxes that dmux() sets
+ * per side with a code of up to three letters:
+ * - MUX1: `b` the bus (the staging register addr() names) or `s` the shifter output;
+ * - MUX2: `r` the data RAM output, else MUX1;
+ * - MUX3: `m` the MAC output, else MUX2.
+ *
+ * Timing, per instruction:
+ * - the ACU operation comes first and the RAM is accessed at the address it leaves;
+ * - the MAC takes the MUX2 outputs of the same instruction; mac(clra) loads the product,
+ *   mac(macc) adds it. The accumulator is 48 bits; the MAC output is its bits 46..23, truncated
+ *   or rounded (DfbEmu_SetRounding()), which is the Q23 value of a sum of Q23 products;
+ * - MUX3 and MUX1 are registered: alu() works on the MUX3 outputs and write(da) / write(db) store
+ *   the MUX1 output of the instruction before. A RAM read of the address written in the same
+ *   instruction returns the new word;
+ * - the shifter takes the ALU result of the instruction before, shifted as this instruction's
+ *   shift() says; write(bus) stores it into the holding register addr() names, so a result is
+ *   written out two instructions after the alu() that made it;
+ * - jmp() goes to its label when all its conditions hold, else to the next instruction;
+ *   jmpl() goes back to the first instruction of its block (after the last label) until they
+ *   do. eob always holds, in1 / in2 while a new sample waits in staging register A / B, acuaeq /
+ *   acubeq when the ACU register equals its modulus top, dpsign / dpeq on the new ALU result.
+ *
+ * Bus addresses are 1 for channel A and 2 for channel B. The staging and holding registers are
+ * three bytes per channel (low, mid, high): a staging value reaches the DFB, and sets in1/in2,
+ * when its coherency key byte is written; a holding value stays whole while the bus reads it,
+ * from the first byte read to the key byte, later DFB results wait until then. The key byte
+ * read also clears the channel's data ready (the Filter_Done interrupt and DMA request). With
+ * data alignment (Filter_DALIGN_REG) the low and mid byte addresses carry bits 15..8 and 23..16,
+ * as for 16-bit samples.
+ *
+ * The model follows the datapath as described for the Filter component; it was checked against
+ * the Filter_24Bit program (HostEmu/Dfb/dfbcheck.c), not against silicon cycle by cycle. DFB
+ * semaphores, globals and the DSI outputs are not modelled.
+ */
+#ifndef DFB_EMU_H
+#define DFB_EMU_H
+
+#include "cytypes.h"
+
+/* clang-format off */
+#define DFBEMU_CODE_WORDS  (64u)  /**< instructions the control store holds */
+#define DFBEMU_DATA_WORDS  (128u) /**< words of data RAM A and of data RAM B */
+#define DFBEMU_ACU_WORDS   (16u)  /**< ACU RAM words, an A and a B address each */
+#define DFBEMU_SYMBOLS     (96u)
+#define DFBEMU_NAME_LENGTH (32u)
+#define DFBEMU_CHANNELS    (2u)   /**< A and B */
+#define DFBEMU_MASK24      (0xFFFFFFu)
+
+/* ACU operations */
+#define DFBEMU_ACU_HOLD     (0u)
+#define DFBEMU_ACU_CLEAR    (1u)  /**< register = 0 */
+#define DFBEMU_ACU_READ     (2u)  /**< register = ACU RAM[addr] */
+#define DFBEMU_ACU_WRITE    (3u)  /**< ACU RAM[addr] = register */
+#define DFBEMU_ACU_INCR     (4u)  /**< register + 1, modulo when set */
+#define DFBEMU_ACU_DECR     (5u)
+#define DFBEMU_ACU_ADDF     (6u)  /**< register + freg */
+#define DFBEMU_ACU_SUBF     (7u)
+#define DFBEMU_ACU_LOADF    (8u)  /**< freg = ACU RAM[addr] */
+#define DFBEMU_ACU_LOADM    (9u)  /**< modulus top */
+#define DFBEMU_ACU_LOADL    (10u) /**< modulus bottom */
+#define DFBEMU_ACU_SETMOD   (11u)
+#define DFBEMU_ACU_UNSETMOD (12u)
+
+/* ALU operations, on the registered MUX3 outputs A and B */
+#define DFBEMU_ALU_HOLD     (0u)
+#define DFBEMU_ALU_SET0     (1u)
+#define DFBEMU_ALU_SET1     (2u)
+#define DFBEMU_ALU_SETA     (3u)
+#define DFBEMU_ALU_SETB     (4u)
+#define DFBEMU_ALU_NEGA     (5u)
+#define DFBEMU_ALU_NEGB     (6u)
+#define DFBEMU_ALU_PASSRAMA (7u)  /**< the data RAM A output of this instruction */
+#define DFBEMU_ALU_PASSRAMB (8u)
+#define DFBEMU_ALU_ADD      (9u)
+#define DFBEMU_ALU_SUBA     (10u) /**< A - B */
+#define DFBEMU_ALU_SUBB     (11u) /**< B - A */
+#define DFBEMU_ALU_ABSA     (12u)
+#define DFBEMU_ALU_ABSB     (13u)
+#define DFBEMU_ALU_ADDABSA  (14u) /**< |A| + B */
+#define DFBEMU_ALU_ADDABSB  (15u) /**< A + |B| */
+#define DFBEMU_ALU_TDECA    (16u) /**< A - 1 */
+
+/* MAC operations */
+#define DFBEMU_MAC_HOLD (0u)
+#define DFBEMU_MAC_CLRA (1u) /**< accumulator = product */
+#define DFBEMU_MAC_MACC (2u) /**< accumulator += product */
+
+/* dmux() code of one side */
+#define DFBEMU_MUX1_BUS (0x01u)
+#define DFBEMU_MUX2_RAM (0x02u)
+#define DFBEMU_MUX3_MAC (0x04u)
+
+/* write() destinations */
+#define DFBEMU_WRITE_DA  (0x01u)
+#define DFBEMU_WRITE_DB  (0x02u)
+#define DFBEMU_WRITE_BUS (0x04u)
+
+/* Jumps and their conditions */
+#define DFBEMU_JUMP_NONE (0u)
+#define DFBEMU_JUMP_JMP  (1u)
+#define DFBEMU_JUMP_JMPL (2u)
+#define DFBEMU_COND_EOB    (0x01u)
+#define DFBEMU_COND_IN1    (0x02u)
+#define DFBEMU_COND_IN2    (0x04u)
+#define DFBEMU_COND_ACUAEQ (0x08u)
+#define DFBEMU_COND_ACUBEQ (0x10u)
+#define DFBEMU_COND_DPSIGN (0x20u)
+#define DFBEMU_COND_DPEQ   (0x40u)
+
+/* Assembler areas, of a symbol */
+#define DFBEMU_AREA_CODE   (0u)
+#define DFBEMU_AREA_ACU    (1u)
+#define DFBEMU_AREA_DATA_A (2u)
+#define DFBEMU_AREA_DATA_B (3u)
+#define DFBEMU_AREA_VALUE  (4u) /**< an equate to a number */
+
+/* Coherency keys (Filter_KEY_*) and data alignment bits (Filter_DALIGN_REG) */
+#define DFBEMU_KEY_LOW     (0u)
+#define DFBEMU_KEY_MID     (1u)
+#define DFBEMU_KEY_HIGH    (2u)
+#define DFBEMU_DALIGN_STAGEA (0x01u)
+#define DFBEMU_DALIGN_STAGEB (0x02u)
+#define DFBEMU_DALIGN_HOLDA  (0x04u)
+#define DFBEMU_DALIGN_HOLDB  (0x08u)
+/* clang-format on */
+
+typedef struct
+{
+    uint8 acu[2];   /**< DFBEMU_ACU_* of ACU A and B */
+    uint8 addr;     /**< ACU RAM or bus address */
+    uint8 dmux[2];  /**< DFBEMU_MUX* of side A and B */
+    uint8 alu;      /**< DFBEMU_ALU_* */
+    uint8 mac;      /**< DFBEMU_MAC_* */
+    int8 shift;     /**< left when positive, arithmetic right when negative */
+    uint8 write;    /**< DFBEMU_WRITE_* */
+    uint8 jump;     /**< DFBEMU_JUMP_* */
+    uint8 cond;     /**< DFBEMU_COND_*, all of them have to hold */
+    uint8 target;   /**< instruction jumped to */
+    uint8 block;    /**< first instruction of the block, where jmpl loops back to */
+    uint16 line;    /**< source line */
+} DfbEmu_Insn;
+
+typedef struct
+{
+    char name[DFBEMU_NAME_LENGTH];
+    uint8 area;   /**< DFBEMU_AREA_* */
+    int32 value;  /**< instruction, word address or number */
+} DfbEmu_Symbol;
+
+/** An assembled program, the content of the control store, data RAMs and ACU RAM. */
+typedef struct
+{
+    DfbEmu_Insn code[DFBEMU_CODE_WORDS];
+    uint32 data[2][DFBEMU_DATA_WORDS]; /**< data RAM A and B, 24-bit words */
+    uint8 acu[2][DFBEMU_ACU_WORDS];    /**< ACU RAM, the A and B address of each word */
+    uint16 codeWords;
+    uint16 dataWords[2]; /**< words of data_a and data_b given with dw */
+    uint16 acuWords;
+    DfbEmu_Symbol symbols[DFBEMU_SYMBOLS];
+    uint16 symbolCount;
+} DfbEmu_Program;
+
+/** Counters, reset by DfbEmu_Init(). */
+typedef struct
+{
+    uint64 cycles;                      /**< instructions run */
+    uint64 idleCycles;                  /**< spent in a jmpl waiting on in1 / in2 */
+    uint32 inputs[DFBEMU_CHANNELS];     /**< staging key byte writes */
+    uint32 overruns[DFBEMU_CHANNELS];   /**< key writes before the DFB read the last sample */
+    uint32 outputs[DFBEMU_CHANNELS];    /**< write(bus) into the holding register */
+    uint32 unread[DFBEMU_CHANNELS];     /**< outputs over one the bus had not read yet */
+    uint32 latencyMax[DFBEMU_CHANNELS]; /**< cycles from a staging key write to the output */
+    uint32 faults;                      /**< bad bus address, ran off the end of the program */
+} DfbEmu_Stats;
+
+typedef struct
+{
+    /* Configuration */
+    uint8 round;    /**< round the MAC output instead of truncating it */
+    uint8 saturate; /**< saturate the MAC output and the ALU instead of wrapping */
+    uint8 dalign;   /**< DFBEMU_DALIGN_* */
+    uint8 stageKey[DFBEMU_CHANNELS];
+    uint8 holdKey[DFBEMU_CHANNELS];
+
+    /* Controller, ACUs and RAMs */
+    const DfbEmu_Program *program;
+    uint8 pc;
+    uint8 running;
+    uint8 reg[2];
+    uint8 mreg[2];
+    uint8 lreg[2];
+    uint8 freg[2];
+    uint8 mod[2];
+    uint8 acuRam[2][DFBEMU_ACU_WORDS];
+    uint32 ram[2][DFBEMU_DATA_WORDS];
+
+    /* Datapath registers */
+    int64 acc;      /**< 48 bits, sign extended */
+    uint32 mux1[2]; /**< MUX1 outputs of the last instruction, the RAM write data */
+    uint32 aluIn[2];
+    uint32 aluOut;
+
+    /* Bus side */
+    uint8 stageBytes[DFBEMU_CHANNELS][3];
+    uint32 stage[DFBEMU_CHANNELS]; /**< the value the DFB reads */
+    uint8 in[DFBEMU_CHANNELS];     /**< in1 / in2 */
+    uint64 stageAt[DFBEMU_CHANNELS];
+    uint32 hold[DFBEMU_CHANNELS];    /**< the value the bus reads */
+    uint32 pending[DFBEMU_CHANNELS]; /**< written while the bus was reading */
+    uint8 holdPending[DFBEMU_CHANNELS];
+    uint8 holdLocked[DFBEMU_CHANNELS];
+    uint8 ready[DFBEMU_CHANNELS]; /**< data ready, until the key byte is read */
+
+    DfbEmu_Stats stats;
+} DfbEmu;
+
+cystatus DfbEmu_Assemble(const char *source, DfbEmu_Program *program, char *error,
+                         uint32 errorSize);
+cystatus DfbEmu_AssembleFile(const char *path, DfbEmu_Program *program, char *error,
+                             uint32 errorSize);
+const DfbEmu_Symbol *DfbEmu_FindSymbol(const DfbEmu_Program *program, const char *name);
+
+void DfbEmu_Init(DfbEmu *dfb, const DfbEmu_Program *program);
+void DfbEmu_SetRounding(DfbEmu *dfb, uint8 round);
+void DfbEmu_SetSaturation(DfbEmu *dfb, uint8 saturate);
+void DfbEmu_SetCoherency(DfbEmu *dfb, uint8 channel, uint8 key);
+void DfbEmu_SetKey(DfbEmu *dfb, uint8 channel, uint8 hold, uint8 key);
+void DfbEmu_SetDalign(DfbEmu *dfb, uint8 dalign);
+void DfbEmu_Step(DfbEmu *dfb);
+void DfbEmu_Run(DfbEmu *dfb, uint32 cycles);
+void DfbEmu_WriteStage(DfbEmu *dfb, uint8 channel, uint8 offset, uint8 value);
+uint8 DfbEmu_ReadHold(DfbEmu *dfb, uint8 channel, uint8 offset);
+uint8 DfbEmu_Ready(const DfbEmu *dfb, uint8 channel);
+int32 DfbEmu_Signed24(uint32 value);
+
+#endif /* DFB_EMU_H */
@@ -0,0 +1,210 @@
+/**
+ * @file
+ * @brief Host-side model of the SPI Master component datapath.
+ */
+#include "SpimEmu.h"
+
+#include <string.h>
+
+static void SpimEmu_RegWrite(void *component, uint32 addr, uint8 value)
+{
+    (void)addr;
+    SpimEmu_WriteTxData((SpimEmu *)component, value);
+}
+
+static uint8 SpimEmu_RegRead(void *component, uint32 addr)
+{
+    (void)addr;
+    return SpimEmu_ReadRxData((SpimEmu *)component);
+}
+
+/* Ends the byte in the shifter: exchange with the slave, MISO byte into the RX FIFO. */
+static void SpimEmu_FinishByte(SpimEmu *spim)
+{
+    uint8 miso = (spim->exchange != NULL) ? spim->exchange(spim->context, spim->shiftByte)
+                                          : spim->shiftByte;
+
+    spim->shifting = 0u;
+    spim->stats.bytes++;
+    spim->stats.lastByteAt = spim->shiftEnd;
+    if (spim->rxCount >= SPIMEMU_FIFO_DEPTH)
+    {
+        spim->stats.rxOverflows++;
+        return;
+    }
+    spim->rxFifo[(spim->rxHead + spim->rxCount) % SPIMEMU_FIFO_DEPTH] = miso;
+    spim->rxCount++;
+}
+
+/* Loads the next TX FIFO byte into the shifter at @p now. */
+static void SpimEmu_StartByte(SpimEmu *spim, uint64 now)
+{
+    if (spim->stats.bytes == 0u)
+        spim->stats.firstByteAt = now;
+    else if (now > spim->stats.lastByteAt)
+    {
+        spim->stats.gaps++;
+        if (spim->txDrqIgnored == 0u)
+            spim->stats.txStarved++;
+    }
+    spim->txDrqIgnored = 0u;
+
+    spim->shiftByte = spim->txFifo[spim->txHead];
+    spim->txHead = (uint8)((spim->txHead + 1u) % SPIMEMU_FIFO_DEPTH);
+    spim->txCount--;
+    spim->shifting = 1u;
+    spim->shiftEnd = now + spim->byteCycles;
+    spim->stats.busyCycles += spim->byteCycles;
+}
+
+/* Raises one DMA request, returns 1 when the DMAC served it. */
+static uint8 SpimEmu_Drq(SpimEmu *spim, uint8 chHandle, uint64 now)
+{
+    uint32 cycles = CyDmaEmu_Request(chHandle);
+
+    if (cycles == 0u)
+        return 0u;
+    spim->drqFree = now + cycles;
+    return 1u;
+}
+
+/**
+ * @brief CyEmu_StepFn: shifter, then the DMA requests the FIFO levels raise.
+ *
+ * RX is served first, a full RX FIFO loses data while a full TX FIFO only waits. A channel that
+ * ignores its request (disabled, chain ended) is asked again at the next step.
+ */
+static uint64 SpimEmu_Step(void *component, uint64 now)
+{
+    SpimEmu *spim = (SpimEmu *)component;
+    uint64 next = CYEMU_NEVER;
+    uint8 rxIgnored = 0u;
+    uint8 txIgnored = 0u;
+    uint8 progress;
+
+    if (spim->enabled == 0u)
+        return CYEMU_NEVER;
+
+    do
+    {
+        progress = 0u;
+        if (spim->shifting && (spim->shiftEnd <= now))
+        {
+            SpimEmu_FinishByte(spim);
+            progress = 1u;
+        }
+        if ((spim->shifting == 0u) && (spim->txCount != 0u))
+        {
+            SpimEmu_StartByte(spim, now);
+            progress = 1u;
+        }
+        if (spim->drqFree <= now)
+        {
+            uint8 served = 0u;
+
+            if ((spim->rxCount != 0u) && (spim->rxDrq != CY_DMA_INVALID_CHANNEL) && !rxIgnored)
+            {
+                served = SpimEmu_Drq(spim, spim->rxDrq, now);
+                rxIgnored = (uint8)!served;
+            }
+            if (!served && (spim->txCount < SPIMEMU_FIFO_DEPTH) &&
+                (spim->txDrq != CY_DMA_INVALID_CHANNEL) && !txIgnored)
+            {
+                served = SpimEmu_Drq(spim, spim->txDrq, now);
+                txIgnored = (uint8)!served;
+                spim->txDrqIgnored |= txIgnored;
+            }
+            progress |= served;
+        }
+    } while (progress);
+
+    if (spim->shifting)
+        next = spim->shiftEnd;
+    if ((spim->drqFree > now) && (spim->drqFree < next) &&
+        (((spim->rxCount != 0u) && (spim->rxDrq != CY_DMA_INVALID_CHANNEL)) ||
+         ((spim->txCount < SPIMEMU_FIFO_DEPTH) && (spim->txDrq != CY_DMA_INVALID_CHANNEL))))
+        next = spim->drqFree;
+    return next;
+}
+
+/**
+ * @brief Wires a SPIM instance and attaches it to the emulator; call after CyEmu_Init().
+ *
+ * @param txDrq DMA channel on tx_interrupt, or CY_DMA_INVALID_CHANNEL.
+ * @param rxDrq DMA channel on rx_interrupt, or CY_DMA_INVALID_CHANNEL.
+ * @param bitRate SCLK rate in bits per second.
+ */
+void SpimEmu_Init(SpimEmu *spim, uint32 txData, uint32 rxData, uint8 txDrq, uint8 rxDrq,
+                  uint32 bitRate)
+{
+    memset(spim, 0, sizeof(*spim));
+    spim->txData = txData;
+    spim->rxData = rxData;
+    spim->txDrq = txDrq;
+    spim->rxDrq = rxDrq;
+    SpimEmu_SetBitRate(spim, bitRate);
+    CyEmu_MapRegister(txData, NULL, SpimEmu_RegWrite, spim);
+    CyEmu_MapRegister(rxData, SpimEmu_RegRead, NULL, spim);
+    CyEmu_Attach(SpimEmu_Step, spim);
+}
+
+/** @brief Sets the SCLK rate in bits per second; takes effect with the next byte. */
+void SpimEmu_SetBitRate(SpimEmu *spim, uint32 bitRate)
+{
+    spim->byteCycles = (uint32)((8uLL * CYEMU_BUS_CLK_HZ + bitRate / 2u) / bitRate);
+}
+
+/** @brief Sets the slave model that answers on MISO; NULL loops MOSI back. */
+void SpimEmu_SetExchange(SpimEmu *spim, SpimEmu_ExchangeFn exchange, void *context)
+{
+    spim->exchange = exchange;
+    spim->context = context;
+}
+
+/** @brief SPIM_Start()/SPIM_Enable(). */
+void SpimEmu_Enable(SpimEmu *spim) { spim->enabled = 1u; }
+
+/** @brief SPIM_Stop(): the byte in the shifter is abandoned, the FIFOs keep their content. */
+void SpimEmu_Disable(SpimEmu *spim)
+{
+    spim->enabled = 0u;
+    spim->shifting = 0u;
+}
+
+/** @brief Pushes one byte into the TX FIFO, as a write to TXDATA. */
+void SpimEmu_WriteTxData(SpimEmu *spim, uint8 value)
+{
+    if (spim->txCount >= SPIMEMU_FIFO_DEPTH)
+    {
+        spim->stats.txOverflows++;
+        return;
+    }
+    spim->txFifo[(spim->txHead + spim->txCount) % SPIMEMU_FIFO_DEPTH] = value;
+    spim->txCount++;
+}
+
+/** @brief Pops one byte from the RX FIFO, as a read of RXDATA; 0 when empty. */
+uint8 SpimEmu_ReadRxData(SpimEmu *spim)
+{
+    uint8 value;
+
+    if (spim->rxCount == 0u)
+    {
+        spim->stats.rxUnderflows++;
+        return 0u;
+    }
+    value = spim->rxFifo[spim->rxHead];
+    spim->rxHead = (uint8)((spim->rxHead + 1u) % SPIMEMU_FIFO_DEPTH);
+    spim->rxCount--;
+    return value;
+}
+
+uint8 SpimEmu_TxCount(const SpimEmu *spim) { return spim->txCount; }
+
+uint8 SpimEmu_RxCount(const SpimEmu *spim) { return spim->rxCount; }
+
+/** @brief 1 when the TX FIFO is empty and nothing is shifting, as SPIM_STS_SPI_IDLE. */
+uint8 SpimEmu_IsIdle(const SpimEmu *spim)
+{
+    return (uint8)((spim->txCount == 0u) && (spim->shifting == 0u));
+}
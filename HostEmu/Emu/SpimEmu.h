@@ -0,0 +1,84 @@
+/**
+ * @file
+ * @brief Host-side model of the SPI Master component datapath: TX/RX FIFOs and the shifter.
+ *
+ * The UDB implementation has a 4-byte TX FIFO in front of the shifter and a 4-byte RX FIFO behind
+ * it. The model follows that shape:
+ * - a byte in the TX FIFO starts shifting as soon as the shifter is idle, one byte takes
+ *   8 SCLK periods at the configured bit rate;
+ * - the byte clocked in on MISO at the end of it goes to the RX FIFO, or is lost (overflow) when
+ *   the RX FIFO is full;
+ * - the TX DMA request is level sensitive on "TX FIFO not full", the RX request on "RX FIFO not
+ *   empty", as with the component's tx_interrupt/rx_interrupt wired to DMA drq inputs. Both
+ *   channels share the DMAC, a new request is only issued once the previous one is served.
+ *
+ * TXDATA/RXDATA are mapped with CyEmu_MapRegister(), so DMA writes push and DMA reads pop exactly
+ * as the FIFO registers do. The MISO byte comes from an exchange callback (a slave model); without
+ * one MISO is looped back from MOSI.
+ */
+#ifndef SPIM_EMU_H
+#define SPIM_EMU_H
+
+#include "CyDmac.h"
+#include "CyEmu.h"
+#include "cytypes.h"
+
+#define SPIMEMU_FIFO_DEPTH (4u)
+
+/** Returns the MISO byte clocked in while @p mosi was shifted out. */
+typedef uint8 (*SpimEmu_ExchangeFn)(void *context, uint8 mosi);
+
+/** Counters, reset by SpimEmu_Init(). */
+typedef struct
+{
+    uint32 bytes;       /**< bytes shifted */
+    uint32 gaps;        /**< idle SCLK time between two bytes: the TX FIFO ran dry */
+    uint32 txStarved;   /**< gaps with the TX channel still active: the DMA fell behind */
+    uint32 txOverflows; /**< writes into a full TX FIFO, the byte is dropped */
+    uint32 rxOverflows; /**< bytes received into a full RX FIFO, the byte is lost */
+    uint32 rxUnderflows; /**< reads of an empty RX FIFO */
+    uint64 busyCycles;  /**< bus clocks the shifter was busy */
+    uint64 firstByteAt; /**< start of the first byte */
+    uint64 lastByteAt;  /**< end of the most recent byte */
+} SpimEmu_Stats;
+
+typedef struct
+{
+    /* Wiring, fixed by SpimEmu_Init() */
+    uint32 txData; /**< TXDATA register address */
+    uint32 rxData; /**< RXDATA register address */
+    uint8 txDrq;   /**< channel on tx_interrupt, CY_DMA_INVALID_CHANNEL when unwired */
+    uint8 rxDrq;   /**< channel on rx_interrupt, CY_DMA_INVALID_CHANNEL when unwired */
+    uint32 byteCycles;
+    SpimEmu_ExchangeFn exchange;
+    void *context;
+
+    /* State */
+    uint8 enabled;
+    uint8 txFifo[SPIMEMU_FIFO_DEPTH];
+    uint8 txHead;
+    uint8 txCount;
+    uint8 rxFifo[SPIMEMU_FIFO_DEPTH];
+    uint8 rxHead;
+    uint8 rxCount;
+    uint8 shifting;
+    uint8 shiftByte;
+    uint64 shiftEnd;
+    uint64 drqFree; /**< the DMAC is done with the previous SPIM request */
+    uint8 txDrqIgnored; /**< the TX channel ignored a request since the last byte started */
+    SpimEmu_Stats stats;
+} SpimEmu;
+
+void SpimEmu_Init(SpimEmu *spim, uint32 txData, uint32 rxData, uint8 txDrq, uint8 rxDrq,
+                  uint32 bitRate);
+void SpimEmu_SetBitRate(SpimEmu *spim, uint32 bitRate);
+void SpimEmu_SetExchange(SpimEmu *spim, SpimEmu_ExchangeFn exchange, void *context);
+void SpimEmu_Enable(SpimEmu *spim);
+void SpimEmu_Disable(SpimEmu *spim);
+void SpimEmu_WriteTxData(SpimEmu *spim, uint8 value);
+uint8 SpimEmu_ReadRxData(SpimEmu *spim);
+uint8 SpimEmu_TxCount(const SpimEmu *spim);
+uint8 SpimEmu_RxCount(const SpimEmu *spim);
+uint8 SpimEmu_IsIdle(const SpimEmu *spim);
+
+#endif /* SPIM_EMU_H */
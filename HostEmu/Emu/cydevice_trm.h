@@ -0,0 +1,35 @@
+/**
+ * @file
+ * @brief Host-side subset of the PSoC 5LP register map (cydevice_trm.h).
+ *
+ * Only the bases the examples and the emulated components touch are listed. The values are
+ * the device ones: the host build places .data/.bss, .ram2 and the peripheral window at the
+ * same addresses (see CyEmu.h), so a pointer cast to uint32 is the device address.
+ */
+#ifndef CYDEVICE_TRM_H
+#define CYDEVICE_TRM_H
+
+#define CYDEV_SRAM_BASE 0x1fff8000u
+#define CYDEV_SRAM_SIZE 0x00010000u
+#define CYREG_SRAM_CODE64K_MBASE 0x1fff8000u
+#define CYREG_SRAM_DATA_MBASE 0x20000000u
+#define CYREG_SRAM_DATA_MSIZE 0x00008000u
+
+/* Cortex-M3 bit-band alias of the SRAM data half */
+#define CYDEV_SRAM_BITBAND_BASE 0x22000000u
+#define CYDEV_SRAM_BITBAND_SIZE (CYREG_SRAM_DATA_MSIZE * 32u)
+
+#define CYDEV_PERIPH_BASE 0x40000000u
+#define CYDEV_PERIPH_SIZE 0x00010000u
+
+#define CYDEV_PHUB_BASE 0x40007000u
+#define CYDEV_PHUB_CH0_BASE 0x40007010u
+#define CYDEV_PHUB_CFGMEM0_BASE 0x40007600u
+#define CYDEV_PHUB_TDMEM0_BASE 0x40007800u
+
+#define CYDEV_EE_BASE 0x40008000u
+#define CYDEV_EE_SIZE 0x00000800u
+
+#define CYDEV_UDB_BASE 0x40006400u
+
+#endif /* CYDEVICE_TRM_H */
@@ -0,0 +1,71 @@
+/**
+ * @file
+ * @brief Host-side replacement for the PSoC Creator cytypes.h.
+ *
+ * Provides the base types, the LO/HI address split macros and the register access macros with
+ * the same names and semantics as cy_boot, so firmware sources compile unchanged on Linux.
+ */
+#ifndef CY_BOOT_CYTYPES_H
+#define CY_BOOT_CYTYPES_H
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cydevice_trm.h"
+
+typedef uint8_t uint8;
+typedef uint16_t uint16;
+typedef uint32_t uint32;
+typedef uint64_t uint64;
+typedef int8_t int8;
+typedef int16_t int16;
+typedef int32_t int32;
+typedef int64_t int64;
+typedef float float32;
+typedef double float64;
+typedef char char8;
+
+typedef volatile uint8 reg8;
+typedef volatile uint16 reg16;
+typedef volatile uint32 reg32;
+
+typedef uint32 cystatus;
+#define CYRET_SUCCESS (0x00u)
+#define CYRET_UNKNOWN (0x01u)
+#define CYRET_BAD_PARAM (0x02u)
+#define CYRET_INVALID_OBJECT (0x03u)
+#define CYRET_MEMORY (0x04u)
+#define CYRET_LOCKED (0x05u)
+#define CYRET_EMPTY (0x06u)
+#define CYRET_BAD_DATA (0x07u)
+#define CYRET_STARTED (0x08u)
+#define CYRET_FINISHED (0x09u)
+#define CYRET_CANCELED (0x0Au)
+#define CYRET_TIMEOUT (0x10u)
+#define CYRET_INVALID_STATE (0x11u)
+
+#define LO8(x) ((uint8)((x)&0xFFu))
+#define HI8(x) ((uint8)((uint16)(x) >> 8))
+#define LO16(x) ((uint16)((x)&0xFFFFu))
+#define HI16(x) ((uint16)((uint32)(x) >> 16))
+
+#define CY_GET_REG8(addr) (*((reg8 *)(uintptr_t)(addr)))
+#define CY_SET_REG8(addr, value) (*((reg8 *)(uintptr_t)(addr)) = (uint8)(value))
+#define CY_GET_REG16(addr) (*((reg16 *)(uintptr_t)(addr)))
+#define CY_SET_REG16(addr, value) (*((reg16 *)(uintptr_t)(addr)) = (uint16)(value))
+#define CY_GET_REG24(addr) (CY_GET_REG32(addr) & 0x00FFFFFFu)
+#define CY_SET_REG24(addr, value)                                                                  \
+    (CY_SET_REG16((addr), LO16(value)), CY_SET_REG8((uintptr_t)(addr) + 2u, (uint32)(value) >> 16))
+#define CY_GET_REG32(addr) (*((reg32 *)(uintptr_t)(addr)))
+#define CY_SET_REG32(addr, value) (*((reg32 *)(uintptr_t)(addr)) = (uint32)(value))
+
+#define CYASSERT(x) assert(x)
+
+#define CY_INLINE inline
+#define CY_PACKED
+#define CY_PACKED_ATTR __attribute__((packed))
+#define CY_ALIGN(align) __attribute__((aligned(align)))
+#define CY_NOINIT __attribute__((section(".noinit")))
+
+#endif /* CY_BOOT_CYTYPES_H */
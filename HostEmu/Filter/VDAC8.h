@@ -0,0 +1,10 @@
+/**
+ * @file
+ * @brief Host replacement for the generated VDAC8.h (Filter_ADC_VDAC01), see project.h.
+ */
+#ifndef VDAC8_H
+#define VDAC8_H
+
+#include "project.h"
+
+#endif /* VDAC8_H */
@@ -0,0 +1,10 @@
+/**
+ * @file
+ * @brief Host replacement for the generated device.h (Filter_ADC_VDAC01), see project.h.
+ */
+#ifndef DEVICE_H
+#define DEVICE_H
+
+#include "project.h"
+
+#endif /* DEVICE_H */
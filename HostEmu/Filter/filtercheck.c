@@ -0,0 +1,158 @@
+/**
+ * @file
+ * @brief Runs the main.c of a Filter example (Filter_16Bit, Filter_24Bit, Filter_ADC_VDAC01) on
+ *        the host against the components of project.h and checks every result it takes out.
+ *
+ * main.c is compiled unchanged, FILTER_ADC_BITS set to the resolution its ADC_DelSig has; its
+ * DMA setups run as written against the CyDmac model. The DFB runs program, a .v2 file, or the
+ * one or two channel program dfbgen makes of specA and specB (see DfbGen.h). Built and run by
+ * HostEmu/Makefile (make -C HostEmu check):
+ *
+ *     filtercheck [-a conversion_hz] [-n conversions] program.v2 | specA [specB]
+ *
+ * Every result read out of a holding register, by Filter_ReadN() or a DMA, has to be the next one
+ * the reference DFB made of the same conversions on that channel, and every one has to be read;
+ * each VDAC takes one update per result, or one per block in block mode, whose blocks have to
+ * hold the results DMA_Out moved. With two channels every conversion has to reach the channel of
+ * its AMux input. The last line is a key=value summary; the exit status is nonzero when a check
+ * fails.
+ */
+#include "DfbGen.h"
+#include "project.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* -Dmain=... renames the firmware entry point; this file provides the real one. */
+#undef main
+
+#define FILTERCHECK_CONVERSION_HZ (48000u)
+#define FILTERCHECK_CONVERSIONS (1024u)
+
+int Filter_main(void);
+
+static DfbEmu_Program program;
+static DfbGen_Filter filters[DFBEMU_CHANNELS];
+static DfbGen_Channel channels[DFBEMU_CHANNELS];
+static char text[DFBGEN_TEXT_SIZE];
+
+/* program of a .v2 file, or of one DfbGen design a channel */
+static cystatus FilterCheck_Program(const char *const *specs, uint8 count)
+{
+    const DfbGen_Filter *designs[DFBEMU_CHANNELS];
+    char error[256];
+    uint8 ch;
+
+    if ((count == 1u) && (strstr(specs[0], ".v2") != NULL))
+    {
+        if (DfbEmu_AssembleFile(specs[0], &program, error, sizeof(error)) != CYRET_SUCCESS)
+        {
+            fprintf(stderr, "%s: %s\n", specs[0], error);
+            return CYRET_BAD_DATA;
+        }
+        return CYRET_SUCCESS;
+    }
+    for (ch = 0u; ch < count; ch++)
+    {
+        if (DfbGen_Parse(specs[ch], &filters[ch], error, sizeof(error)) != CYRET_SUCCESS)
+        {
+            fprintf(stderr, "channel %c: %s\n", 'A' + ch, error);
+            return CYRET_BAD_PARAM;
+        }
+        designs[ch] = &filters[ch];
+    }
+    if ((DfbGen_Layout(designs, count, DFBGEN_FOLD_AUTO, channels, error, sizeof(error)) !=
+         CYRET_SUCCESS) ||
+        (DfbGen_Emit(channels, count, text, sizeof(text)) != CYRET_SUCCESS) ||
+        (DfbEmu_Assemble(text, &program, error, sizeof(error)) != CYRET_SUCCESS))
+    {
+        fprintf(stderr, "%s\n", error);
+        return CYRET_BAD_DATA;
+    }
+    return CYRET_SUCCESS;
+}
+
+static void FilterCheck_Report(void)
+{
+    const FilterEmu_Trace *t = &FilterEmu_trace;
+    const DfbEmu_Stats *dfb = &FilterEmu_dfb.stats;
+    uint32 dropped = 0u;
+    uint32 vdacErrors = 0u;
+    uint8 ok = 1u;
+    uint8 ch;
+
+    for (ch = 0u; ch < CY_DMA_NUMBEROF_CHANNELS; ch++)
+        dropped += CyDmaEmu_GetStats(ch)->droppedRequests;
+    for (ch = 0u; ch < DFBEMU_CHANNELS; ch++)
+    {
+        printf("channel %c: outputs=%u expected=%u taken=%u mismatches=%u vdac_writes=%u "
+               "overruns=%u unread=%u latency_max=%u\n",
+               'A' + ch, (unsigned)t->outputs[ch], (unsigned)t->expected[ch],
+               (unsigned)t->taken[ch], (unsigned)t->mismatches[ch], (unsigned)t->vdacWrites[ch],
+               (unsigned)dfb->overruns[ch], (unsigned)dfb->unread[ch],
+               (unsigned)dfb->latencyMax[ch]);
+        if ((t->mismatches[ch] != 0u) || (t->outputs[ch] != t->expected[ch]) ||
+            (t->taken[ch] != t->outputs[ch]) || (dfb->overruns[ch] != 0u) ||
+            (dfb->unread[ch] != 0u))
+            ok = 0u;
+        /* Block mode updates the VDAC once a block, the main loop may be on the last one yet */
+        if ((t->blocks != 0u) ? ((t->vdacWrites[ch] + 1u < t->blocks) ||
+                                 (t->vdacWrites[ch] > t->blocks))
+                              : (t->vdacWrites[ch] != t->taken[ch]))
+            vdacErrors++;
+        if (t->blocks != 0u)
+            break;
+    }
+    if ((t->outputs[Filter_CHANNEL_A] == 0u) || (vdacErrors != 0u) || (dropped != 0u) ||
+        (dfb->faults != 0u) || (t->blockMismatches != 0u) || (t->muxErrors != 0u))
+        ok = 0u;
+
+    printf("conversions=%u outputs_a=%u outputs_b=%u mismatches=%u filter_isrs=%u blocks=%u "
+           "block_mismatches=%u mux_errors=%u vdac_errors=%u dma_dropped=%u faults=%u "
+           "result=%s\n",
+           (unsigned)t->conversions, (unsigned)t->outputs[0], (unsigned)t->outputs[1],
+           (unsigned)(t->mismatches[0] + t->mismatches[1]), (unsigned)t->filterIsrs,
+           (unsigned)t->blocks, (unsigned)t->blockMismatches, (unsigned)t->muxErrors,
+           (unsigned)vdacErrors, (unsigned)dropped, (unsigned)dfb->faults, ok ? "pass" : "fail");
+    exit(ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+static void FilterCheck_Usage(void)
+{
+    fprintf(stderr, "usage: filtercheck [-a conversion_hz] [-n conversions] "
+                    "program.v2 | specA [specB]\n");
+}
+
+int main(int argc, char **argv)
+{
+    const char *specs[DFBEMU_CHANNELS];
+    uint32 conversionHz = FILTERCHECK_CONVERSION_HZ;
+    uint32 conversions = FILTERCHECK_CONVERSIONS;
+    uint8 count = 0u;
+    int k;
+
+    for (k = 1; k < argc; k++)
+    {
+        if ((strcmp(argv[k], "-a") == 0) && (k + 1 < argc))
+            conversionHz = (uint32)strtoul(argv[++k], NULL, 0);
+        else if ((strcmp(argv[k], "-n") == 0) && (k + 1 < argc))
+            conversions = (uint32)strtoul(argv[++k], NULL, 0);
+        else if ((argv[k][0] != '-') && (count < DFBEMU_CHANNELS))
+            specs[count++] = argv[k];
+        else
+            count = DFBEMU_CHANNELS + 1u;
+    }
+    if ((count == 0u) || (count > DFBEMU_CHANNELS) || (conversionHz == 0u) ||
+        (conversionHz > CYEMU_BUS_CLK_HZ) || (conversions == 0u))
+    {
+        FilterCheck_Usage();
+        return EXIT_FAILURE;
+    }
+    if (FilterCheck_Program(specs, count) != CYRET_SUCCESS)
+        return EXIT_FAILURE;
+
+    CyEmu_Init();
+    FilterEmu_Init(&program, conversions, CYEMU_BUS_CLK_HZ / conversionHz, FilterCheck_Report);
+    return Filter_main();
+}
@@ -0,0 +1,449 @@
+/**
+ * @file
+ * @brief Emulated component instances of the Filter examples, see project.h.
+ *
+ * A second DfbEmu runs the same program as a reference: every conversion is staged into it
+ * directly, as the firmware's DMA should stage it, and every result the firmware reads out of
+ * the Filter (the key byte read, by the CPU or a DMA) has to be the next one the reference made
+ * on that channel.
+ */
+#include "project.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define FILTER_EMU_INPUTS (2u)
+#define FILTER_EMU_ADC_BYTES ((FILTER_ADC_BITS + 7u) / 8u)
+
+FilterEmu_Trace FilterEmu_trace;
+DfbEmu FilterEmu_dfb;
+
+static DfbEmu filterEmuReference;
+static const DfbEmu_Program *filterEmuProgram;
+static uint32 filterEmuExpected[DFBEMU_CHANNELS][FILTER_EMU_LOG];
+
+/* ADC_DelSig and AMux */
+static uint8 adcRunning;
+static uint64 adcNext;
+static uint32 adcPeriod;
+static uint32 adcLimit;
+static uint8 adcInput;     /* the AMux input converted last */
+static uint8 amuxStarted;
+static uint8 amuxSelected;
+static uint32 adcSeed[FILTER_EMU_INPUTS];
+static void (*filterEmuOnLimit)(void);
+
+/* Filter */
+static uint8 dfbStarted;
+static uint8 dfbIdle;
+static uint64 dfbTime;
+static uint32 dfbOutputs[DFBEMU_CHANNELS];
+
+static uint8 dmaInitialized[CY_DMA_NUMBEROF_CHANNELS];
+static cyisraddress isrFilterVector;
+static cyisraddress isrBlockVector;
+static uint32 blockTaken; /* channel A results taken when the last block was done */
+static cyisraddress isrMuxVector;
+
+/* Next sample of an input, FILTER_ADC_BITS wide, signed */
+static int32 FilterEmu_Sample(uint8 input)
+{
+    adcSeed[input] = adcSeed[input] * 1103515245u + 12345u;
+    return (int32)adcSeed[input] >> (32u - FILTER_ADC_BITS);
+}
+
+/* Runs the reference until it waits and logs its results. */
+static void FilterEmu_ReferenceRun(void)
+{
+    uint64 idle = filterEmuReference.stats.idleCycles;
+    uint32 cycles;
+    uint8 ch;
+
+    for (cycles = 0u; cycles < 10000u; cycles++)
+    {
+        DfbEmu_Step(&filterEmuReference);
+        for (ch = 0u; ch < DFBEMU_CHANNELS; ch++)
+        {
+            if (DfbEmu_Ready(&filterEmuReference, ch))
+            {
+                filterEmuExpected[ch][FilterEmu_trace.expected[ch]++ % FILTER_EMU_LOG] =
+                    filterEmuReference.hold[ch];
+                (void)DfbEmu_ReadHold(&filterEmuReference, ch, DFBEMU_KEY_HIGH);
+            }
+        }
+        if (!filterEmuReference.running || (filterEmuReference.stats.idleCycles != idle))
+            return;
+    }
+}
+
+/* The DFB side of a conversion of @p input: staged whole into the reference's channel. */
+static void FilterEmu_ReferenceStage(uint8 input, int32 sample)
+{
+    uint32 stage = ((uint32)sample << (8u * (3u - FILTER_EMU_ADC_BYTES))) & DFBEMU_MASK24;
+
+    if (!dfbStarted)
+        return;
+    DfbEmu_WriteStage(&filterEmuReference, input, 0u, (uint8)stage);
+    DfbEmu_WriteStage(&filterEmuReference, input, 1u, (uint8)(stage >> 8));
+    DfbEmu_WriteStage(&filterEmuReference, input, 2u, (uint8)(stage >> 16));
+    FilterEmu_ReferenceRun();
+}
+
+/* ADC_DelSig: a conversion every period, the DMA request and isr_Mux at its end. */
+static uint64 FilterEmu_AdcStep(void *component, uint64 now)
+{
+    (void)component;
+    if (!adcRunning)
+        return CYEMU_NEVER;
+    if (now < adcNext)
+        return adcNext;
+    adcNext += adcPeriod;
+
+    if (FilterEmu_trace.conversions >= adcLimit)
+    {
+        /* Two more periods for the last results, then the run is over */
+        if (FilterEmu_trace.conversions++ == adcLimit + 2u)
+        {
+            adcRunning = 0u;
+            if (filterEmuOnLimit != NULL)
+                filterEmuOnLimit();
+            return CYEMU_NEVER;
+        }
+        return adcNext;
+    }
+
+    {
+        int32 sample;
+        uint32 value;
+
+        adcInput = amuxStarted ? amuxSelected : 0u;
+        sample = FilterEmu_Sample(adcInput);
+        value = (uint32)sample & DFBEMU_MASK24;
+        ADC_DelSig_DEC_SAMP_PTR[0] = (uint8)value;
+        ADC_DelSig_DEC_SAMP_PTR[1] = (uint8)(value >> 8);
+        ADC_DelSig_DEC_SAMP_PTR[2] = (uint8)(value >> 16);
+        CY_SET_REG16(ADC_DelSig_DEC_SAMP_16B_PTR, (uint16)value);
+        FilterEmu_trace.conversions++;
+        FilterEmu_ReferenceStage(adcInput, sample);
+    }
+    if (dmaInitialized[DMA__DRQ_NUMBER])
+        (void)CyDmaEmu_Request(DMA__DRQ_NUMBER);
+    CyEmu_Interrupt(isrMuxVector);
+    return adcNext;
+}
+
+/* Channel and byte lane of a stage or hold register address; 0 when it is not one. */
+static uint8 FilterEmu_Decode(uint32 addr, uint8 hold, uint8 *channel, uint8 *lane)
+{
+    uint32 offset = addr - (Filter__BASE + (hold ? 0x08u : 0x00u));
+
+    *channel = (uint8)(offset / 4u);
+    *lane = (uint8)(offset % 4u);
+    return (uint8)((*channel < DFBEMU_CHANNELS) && (*lane < 3u));
+}
+
+/* A bus read of a holding register lane; the key lane hands the result to the checks. */
+static uint8 FilterEmu_ReadHold(uint8 channel, uint8 lane)
+{
+    uint32 n;
+
+    DfbEmu_SetDalign(&FilterEmu_dfb, Filter_DALIGN_REG);
+    if ((lane == FilterEmu_dfb.holdKey[channel]) && FilterEmu_dfb.ready[channel])
+    {
+        n = FilterEmu_trace.taken[channel]++;
+        if ((n >= FilterEmu_trace.expected[channel]) ||
+            (FilterEmu_dfb.hold[channel] != filterEmuExpected[channel][n % FILTER_EMU_LOG]))
+        {
+            if (FilterEmu_trace.mismatches[channel]++ < 5u)
+                fprintf(stderr, "channel %c result %u: 0x%06x, the reference made 0x%06x\n",
+                        'A' + channel, (unsigned)n, (unsigned)FilterEmu_dfb.hold[channel],
+                        (unsigned)filterEmuExpected[channel][n % FILTER_EMU_LOG]);
+        }
+    }
+    return DfbEmu_ReadHold(&FilterEmu_dfb, channel, lane);
+}
+
+static uint8 FilterEmu_HoldRead(void *component, uint32 addr)
+{
+    uint8 channel;
+    uint8 lane;
+
+    (void)component;
+    if (!FilterEmu_Decode(addr, 1u, &channel, &lane))
+    {
+        FilterEmu_dfb.stats.faults++;
+        return 0u;
+    }
+    return FilterEmu_ReadHold(channel, lane);
+}
+
+static void FilterEmu_StageWrite(void *component, uint32 addr, uint8 value)
+{
+    uint8 channel;
+    uint8 lane;
+
+    (void)component;
+    if (!FilterEmu_Decode(addr, 0u, &channel, &lane))
+    {
+        FilterEmu_dfb.stats.faults++;
+        return;
+    }
+    DfbEmu_SetDalign(&FilterEmu_dfb, Filter_DALIGN_REG);
+    DfbEmu_WriteStage(&FilterEmu_dfb, channel, lane, value);
+    if (FilterEmu_dfb.in[channel])
+    {
+        if (amuxStarted && (channel != adcInput))
+            FilterEmu_trace.muxErrors++;
+        if (dfbIdle)
+            dfbTime = CyEmu_Now();
+        dfbIdle = 0u;
+    }
+}
+
+/* Filter: the DFB in step with the bus clock while it has work; results raise the requests. */
+static uint64 FilterEmu_DfbStep(void *component, uint64 now)
+{
+    uint8 ch;
+
+    (void)component;
+    if (!dfbStarted || dfbIdle)
+        return CYEMU_NEVER;
+    while (dfbTime < now)
+    {
+        uint64 idle = FilterEmu_dfb.stats.idleCycles;
+
+        DfbEmu_Step(&FilterEmu_dfb);
+        dfbTime++;
+        for (ch = 0u; ch < DFBEMU_CHANNELS; ch++)
+        {
+            if (FilterEmu_dfb.stats.outputs[ch] == dfbOutputs[ch])
+                continue;
+            dfbOutputs[ch] = FilterEmu_dfb.stats.outputs[ch];
+            FilterEmu_trace.outputs[ch]++;
+            if (ch == Filter_CHANNEL_A)
+            {
+                if (dmaInitialized[DMA_1__DRQ_NUMBER])
+                    (void)CyDmaEmu_Request(DMA_1__DRQ_NUMBER);
+                if (dmaInitialized[DMA_Out__DRQ_NUMBER])
+                    (void)CyDmaEmu_Request(DMA_Out__DRQ_NUMBER);
+                if (isrFilterVector != NULL)
+                {
+                    FilterEmu_trace.filterIsrs++;
+                    CyEmu_Interrupt(isrFilterVector);
+                }
+            }
+            else if (dmaInitialized[DMA_2__DRQ_NUMBER])
+                (void)CyDmaEmu_Request(DMA_2__DRQ_NUMBER);
+        }
+        if (!FilterEmu_dfb.running)
+            return CYEMU_NEVER;
+        if ((FilterEmu_dfb.stats.idleCycles != idle) && !FilterEmu_dfb.in[0] &&
+            !FilterEmu_dfb.in[1])
+        {
+            dfbIdle = 1u;
+            return CYEMU_NEVER;
+        }
+    }
+    return dfbTime + 1u;
+}
+
+/* VDAC8 and VDAC8_1 data registers, as the DMA writes them */
+static void FilterEmu_VdacWrite(void *component, uint32 addr, uint8 value)
+{
+    (void)component;
+    *(volatile uint8 *)CyEmu_Ptr(addr) = value;
+    FilterEmu_trace.vdacWrites[(addr == (uint32)VDAC8_1_Data_PTR) ? 1u : 0u]++;
+}
+
+/* DMA_Out nrq: the block the TD filled has to hold the upper 16 bits of its results, and the
+   bursts have to have taken one result each, key byte included. */
+static void FilterEmu_BlockDone(uint8 chHandle, uint8 tdHandle, uint8 termout)
+{
+    const dmac_cfgmem *cfg = &CY_DMA_CFGMEM_STRUCT_PTR[chHandle];
+    const int16 *block;
+    uint16 count;
+    uint16 src;
+    uint16 dst;
+    uint32 first;
+    uint16 i;
+
+    (void)termout;
+    (void)CyDmaTdGetConfiguration(tdHandle, &count, NULL, NULL);
+    (void)CyDmaTdGetAddress(tdHandle, &src, &dst);
+    block = (const int16 *)CyEmu_Ptr(CyDmaEmu_Address(CY_GET_REG16(&cfg->CFG1[2]), dst));
+    count /= sizeof(int16);
+    first = FilterEmu_trace.taken[Filter_CHANNEL_A] - count;
+    if ((first != blockTaken) && (FilterEmu_trace.blockMismatches++ < 5u))
+        fprintf(stderr, "block %u: %u results taken for %u samples\n",
+                (unsigned)FilterEmu_trace.blocks,
+                (unsigned)(FilterEmu_trace.taken[Filter_CHANNEL_A] - blockTaken), (unsigned)count);
+    blockTaken = FilterEmu_trace.taken[Filter_CHANNEL_A];
+    for (i = 0u; i < count; i++)
+    {
+        uint32 want = filterEmuExpected[Filter_CHANNEL_A][(first + i) % FILTER_EMU_LOG];
+
+        if ((block[i] != (int16)(want >> 8)) && (FilterEmu_trace.blockMismatches++ < 5u))
+            fprintf(stderr, "block %u sample %u: 0x%04x, the result was 0x%06x\n",
+                    (unsigned)FilterEmu_trace.blocks, (unsigned)i, (unsigned)(uint16)block[i],
+                    (unsigned)want);
+    }
+    FilterEmu_trace.blocks++;
+    CyEmu_Interrupt(isrBlockVector);
+}
+
+/**
+ * @brief Wires the components to run @p program; @p onLimit runs once @p conversions
+ * conversions, one every @p periodCycles bus clocks, and their results are through.
+ */
+void FilterEmu_Init(const DfbEmu_Program *program, uint32 conversions, uint32 periodCycles,
+                    void (*onLimit)(void))
+{
+    memset(&FilterEmu_trace, 0, sizeof(FilterEmu_trace));
+    memset(dmaInitialized, 0, sizeof(dmaInitialized));
+    memset(dfbOutputs, 0, sizeof(dfbOutputs));
+    blockTaken = 0u;
+    filterEmuProgram = program;
+    filterEmuOnLimit = onLimit;
+    adcLimit = conversions;
+    adcPeriod = (periodCycles != 0u) ? periodCycles : 1u;
+    adcRunning = 0u;
+    adcSeed[0] = 1u;
+    adcSeed[1] = 2u;
+    amuxStarted = 0u;
+    amuxSelected = 0u;
+    dfbStarted = 0u;
+    isrFilterVector = NULL;
+    isrBlockVector = NULL;
+    isrMuxVector = NULL;
+
+    CyDmaEmu_Reset();
+    CyDmaEmu_SetTermoutHandler(DMA_Out__DRQ_NUMBER, FilterEmu_BlockDone);
+    CyEmu_MapRegisters((uint32)Filter_STAGEA_PTR, 8u, NULL, FilterEmu_StageWrite, NULL);
+    CyEmu_MapRegisters((uint32)Filter_HOLDA_PTR, 8u, FilterEmu_HoldRead, NULL, NULL);
+    CyEmu_MapRegister((uint32)VDAC8_Data_PTR, NULL, FilterEmu_VdacWrite, NULL);
+    CyEmu_MapRegister((uint32)VDAC8_1_Data_PTR, NULL, FilterEmu_VdacWrite, NULL);
+    CyEmu_Attach(FilterEmu_AdcStep, NULL);
+    CyEmu_Attach(FilterEmu_DfbStep, NULL);
+}
+
+uint8 FilterEmu_DmaInitialize(uint8 drq, uint8 burstCount, uint8 requestPerBurst,
+                              uint16 upperSrcAddress, uint16 upperDestAddress)
+{
+    dmaInitialized[drq] = 1u;
+    return CyDmaEmu_DmaInitialize(drq, burstCount, requestPerBurst, upperSrcAddress,
+                                  upperDestAddress);
+}
+
+void ADC_DelSig_Start(void) { CyEmu_Spend(FILTER_EMU_API_CYCLES); }
+
+void ADC_DelSig_Stop(void) { adcRunning = 0u; }
+
+void ADC_DelSig_IRQ_Start(void) { CyEmu_Spend(FILTER_EMU_API_CYCLES); }
+
+void ADC_DelSig_StartConvert(void)
+{
+    CyEmu_Spend(FILTER_EMU_API_CYCLES);
+    adcRunning = 1u;
+    adcNext = CyEmu_Now() + adcPeriod;
+}
+
+void ADC_DelSig_StopConvert(void) { adcRunning = 0u; }
+
+void AMux_Start(void) { amuxStarted = 1u; }
+
+void AMux_Select(uint8 channel) { amuxSelected = (uint8)(channel % FILTER_EMU_INPUTS); }
+
+void AMux_Next(void)
+{
+    CyEmu_Spend(FILTER_EMU_API_CYCLES);
+    amuxSelected = (uint8)((amuxSelected + 1u) % FILTER_EMU_INPUTS);
+}
+
+void Opamp_Start(void) {}
+
+/* Filter_Start(): the program loaded, the DFB running to its first wait; the reference too. */
+void Filter_Start(void)
+{
+    CyEmu_Spend(FILTER_EMU_API_CYCLES);
+    DfbEmu_Init(&FilterEmu_dfb, filterEmuProgram);
+    DfbEmu_Init(&filterEmuReference, filterEmuProgram);
+    /* The customizer's default coherency */
+    DfbEmu_SetCoherency(&FilterEmu_dfb, 0u, DFBEMU_KEY_HIGH);
+    DfbEmu_SetCoherency(&FilterEmu_dfb, 1u, DFBEMU_KEY_HIGH);
+    DfbEmu_SetCoherency(&filterEmuReference, 0u, DFBEMU_KEY_HIGH);
+    DfbEmu_SetCoherency(&filterEmuReference, 1u, DFBEMU_KEY_HIGH);
+    FilterEmu_ReferenceRun();
+    Filter_DALIGN_REG = 0u;
+    dfbStarted = 1u;
+    dfbIdle = 0u;
+    dfbTime = CyEmu_Now();
+}
+
+void Filter_Stop(void) { dfbStarted = 0u; }
+
+void Filter_SetCoherency(uint8 channel, uint8 key)
+{
+    CyEmu_Spend(FILTER_EMU_API_CYCLES);
+    DfbEmu_SetCoherency(&FilterEmu_dfb, channel, key);
+}
+
+void Filter_SetCoherencyEx(uint8 regSelect, uint8 key)
+{
+    CyEmu_Spend(FILTER_EMU_API_CYCLES);
+    DfbEmu_SetKey(&FilterEmu_dfb, (uint8)(regSelect / 2u), (uint8)(regSelect % 2u), key);
+}
+
+/* One bus access of lanes first..last of a holding register: the key lane goes last. */
+static uint32 FilterEmu_ReadLanes(uint8 channel, uint8 first, uint8 last)
+{
+    uint32 value = 0u;
+    uint8 key = FilterEmu_dfb.holdKey[channel];
+    uint8 lane;
+
+    CyEmu_Spend(FILTER_EMU_API_CYCLES);
+    for (lane = first; lane <= last; lane++)
+        if (lane != key)
+            value |= (uint32)FilterEmu_ReadHold(channel, lane) << (8u * (lane - first));
+    if ((key >= first) && (key <= last))
+        value |= (uint32)FilterEmu_ReadHold(channel, key) << (8u * (key - first));
+    return value;
+}
+
+uint8 Filter_Read8(uint8 channel) { return (uint8)FilterEmu_ReadLanes(channel, 2u, 2u); }
+
+uint16 Filter_Read16(uint8 channel) { return (uint16)FilterEmu_ReadLanes(channel, 1u, 2u); }
+
+uint32 Filter_Read24(uint8 channel) { return FilterEmu_ReadLanes(channel, 0u, 2u); }
+
+void VDAC8_Start(void) {}
+
+void VDAC8_SetValue(uint8 value)
+{
+    CyEmu_Spend(FILTER_EMU_API_CYCLES);
+    *VDAC8_Data_PTR = value;
+    FilterEmu_trace.vdacWrites[0]++;
+}
+
+void VDAC8_1_Start(void) {}
+
+void VDAC8_1_SetValue(uint8 value)
+{
+    CyEmu_Spend(FILTER_EMU_API_CYCLES);
+    *VDAC8_1_Data_PTR = value;
+    FilterEmu_trace.vdacWrites[1]++;
+}
+
+void VDAC_Start(void) {}
+
+void VDAC_SetValue(uint16 value)
+{
+    (void)value;
+    CyEmu_Spend(FILTER_EMU_API_CYCLES);
+    FilterEmu_trace.vdacWrites[0]++;
+}
+
+void isr_Filter_StartEx(cyisraddress address) { isrFilterVector = address; }
+
+void isr_Block_StartEx(cyisraddress address) { isrBlockVector = address; }
+
+void isr_Mux_StartEx(cyisraddress address) { isrMuxVector = address; }
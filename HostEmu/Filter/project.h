@@ -0,0 +1,154 @@
+/**
+ * @file
+ * @brief Host replacement for the generated project.h of the Filter examples: Filter_16Bit and
+ *        Filter_24Bit (PSoC_5LP_16_Bit_and_24_Bit_Digital_Filter) and Filter_ADC_VDAC01.
+ *
+ * The three schematics share their instance names; the ones a project does not place are never
+ * started. Wiring:
+ * - ADC_DelSig converts every FilterEmu_Init() period; its end of conversion is the DMA request
+ *   and raises isr_Mux. The result sits in DEC_SAMP, three bytes sign extended, and its low 16
+ *   bits in DEC_SAMP_16B; FILTER_ADC_BITS is the resolution the project configures;
+ * - AMux has two inputs, the harness drives both, input 0 alone unless AMux is started;
+ * - Filter is the DfbEmu model running the program the harness loads, one DFB cycle a bus
+ *   clock. Its stage and hold registers are byte lanes, low / mid / high, of one word per
+ *   register, and the DMA reaches them through the model; Filter_DALIGN_REG is applied on every
+ *   access. A result on channel A is the DMA request of DMA_1 and DMA_Out and raises isr_Filter,
+ *   one on channel B the request of DMA_2;
+ * - DMA_Out TERMOUT raises isr_Block;
+ * - VDAC8, VDAC8_1 and VDAC count what they are written, by the CPU or the DMA.
+ * The register addresses are free spots of the peripheral window, not the device ones.
+ */
+#ifndef PROJECT_H
+#define PROJECT_H
+
+#include "CyDmac.h"
+#include "CyEmu.h"
+#include "CyLib.h"
+#include "DfbEmu.h"
+#include "cytypes.h"
+
+#ifndef FILTER_ADC_BITS
+#define FILTER_ADC_BITS (16u)
+#endif
+
+/* clang-format off */
+#define FILTER_EMU_API_CYCLES  (CYEMU_M3_CALL + CYEMU_M3_POP_PC(1u)) /**< a component API call */
+#define FILTER_POLL_CYCLES     (8u) /**< a pass of an empty main loop, load compare branch */
+/* clang-format on */
+
+/* main.c spends this much on each pass of its main loop */
+#define FILTER_POLL_ACCOUNT() CyEmu_Spend(FILTER_POLL_CYCLES)
+
+/* ADC_DelSig */
+#define ADC_DelSig_DEC_SAMP_PTR ((reg8 *)(uintptr_t)(CYDEV_PERIPH_BASE + 0x4E10u))
+#define ADC_DelSig_DEC_SAMP_16B_PTR ((reg16 *)(uintptr_t)(CYDEV_PERIPH_BASE + 0x4E14u))
+void ADC_DelSig_Start(void);
+void ADC_DelSig_Stop(void);
+void ADC_DelSig_IRQ_Start(void);
+void ADC_DelSig_StartConvert(void);
+void ADC_DelSig_StopConvert(void);
+
+/* AMux */
+void AMux_Start(void);
+void AMux_Select(uint8 channel);
+void AMux_Next(void);
+
+/* Opamp */
+void Opamp_Start(void);
+
+/* Filter */
+#define Filter_CHANNEL_A (0u)
+#define Filter_CHANNEL_B (1u)
+#define Filter_KEY_LOW (DFBEMU_KEY_LOW)
+#define Filter_KEY_MID (DFBEMU_KEY_MID)
+#define Filter_KEY_HIGH (DFBEMU_KEY_HIGH)
+#define Filter_STAGEA_COHER (0u) /**< Filter_SetCoherencyEx() registers: channel * 2 + hold */
+#define Filter_HOLDA_COHER (1u)
+#define Filter_STAGEB_COHER (2u)
+#define Filter_HOLDB_COHER (3u)
+#define Filter__BASE (CYDEV_PERIPH_BASE + 0x4780u)
+#define Filter_STAGEA_PTR ((reg8 *)(uintptr_t)(Filter__BASE + 0x00u))
+#define Filter_STAGEAM_PTR ((reg8 *)(uintptr_t)(Filter__BASE + 0x01u))
+#define Filter_STAGEAH_PTR ((reg8 *)(uintptr_t)(Filter__BASE + 0x02u))
+#define Filter_STAGEB_PTR ((reg8 *)(uintptr_t)(Filter__BASE + 0x04u))
+#define Filter_STAGEBM_PTR ((reg8 *)(uintptr_t)(Filter__BASE + 0x05u))
+#define Filter_STAGEBH_PTR ((reg8 *)(uintptr_t)(Filter__BASE + 0x06u))
+#define Filter_HOLDA_PTR ((reg8 *)(uintptr_t)(Filter__BASE + 0x08u))
+#define Filter_HOLDAM_PTR ((reg8 *)(uintptr_t)(Filter__BASE + 0x09u))
+#define Filter_HOLDAH_PTR ((reg8 *)(uintptr_t)(Filter__BASE + 0x0Au))
+#define Filter_HOLDB_PTR ((reg8 *)(uintptr_t)(Filter__BASE + 0x0Cu))
+#define Filter_HOLDBM_PTR ((reg8 *)(uintptr_t)(Filter__BASE + 0x0Du))
+#define Filter_HOLDBH_PTR ((reg8 *)(uintptr_t)(Filter__BASE + 0x0Eu))
+#define Filter_DALIGN_PTR ((reg8 *)(uintptr_t)(Filter__BASE + 0x10u))
+#define Filter_DALIGN_REG (*Filter_DALIGN_PTR)
+void Filter_Start(void);
+void Filter_Stop(void);
+void Filter_SetCoherency(uint8 channel, uint8 key);
+void Filter_SetCoherencyEx(uint8 regSelect, uint8 key);
+uint8 Filter_Read8(uint8 channel);
+uint16 Filter_Read16(uint8 channel);
+uint32 Filter_Read24(uint8 channel);
+
+/* VDAC8, VDAC8_1 (Filter_16Bit, Filter_ADC_VDAC01) and VDAC (Filter_24Bit) */
+#define VDAC8_Data_PTR ((reg8 *)(uintptr_t)(CYDEV_PERIPH_BASE + 0x5B00u))
+#define VDAC8_1_Data_PTR ((reg8 *)(uintptr_t)(CYDEV_PERIPH_BASE + 0x5B04u))
+void VDAC8_Start(void);
+void VDAC8_SetValue(uint8 value);
+void VDAC8_1_Start(void);
+void VDAC8_1_SetValue(uint8 value);
+void VDAC_Start(void);
+void VDAC_SetValue(uint16 value);
+
+/* DMA (ADC_DelSig to Filter), DMA_1 / DMA_Out (Filter channel A), DMA_2 (Filter channel B) */
+#define DMA__DRQ_NUMBER (0u)
+#define DMA_1__DRQ_NUMBER (1u)
+#define DMA_2__DRQ_NUMBER (2u)
+#define DMA_Out__DRQ_NUMBER (3u)
+#define DMA__TD_TERMOUT_EN (TD_TERMOUT0_EN)
+#define DMA_1__TD_TERMOUT_EN (TD_TERMOUT0_EN)
+#define DMA_2__TD_TERMOUT_EN (TD_TERMOUT0_EN)
+#define DMA_Out__TD_TERMOUT_EN (TD_TERMOUT0_EN)
+#define DMA_DmaInitialize(BurstCount, ReqestPerBurst, UpperSrcAddress, UpperDestAddress)          \
+    FilterEmu_DmaInitialize(DMA__DRQ_NUMBER, (BurstCount), (ReqestPerBurst), (UpperSrcAddress),   \
+                            (UpperDestAddress))
+#define DMA_1_DmaInitialize(BurstCount, ReqestPerBurst, UpperSrcAddress, UpperDestAddress)        \
+    FilterEmu_DmaInitialize(DMA_1__DRQ_NUMBER, (BurstCount), (ReqestPerBurst), (UpperSrcAddress), \
+                            (UpperDestAddress))
+#define DMA_2_DmaInitialize(BurstCount, ReqestPerBurst, UpperSrcAddress, UpperDestAddress)        \
+    FilterEmu_DmaInitialize(DMA_2__DRQ_NUMBER, (BurstCount), (ReqestPerBurst), (UpperSrcAddress), \
+                            (UpperDestAddress))
+#define DMA_Out_DmaInitialize(BurstCount, ReqestPerBurst, UpperSrcAddress, UpperDestAddress)      \
+    FilterEmu_DmaInitialize(DMA_Out__DRQ_NUMBER, (BurstCount), (ReqestPerBurst),                  \
+                            (UpperSrcAddress), (UpperDestAddress))
+uint8 FilterEmu_DmaInitialize(uint8 drq, uint8 burstCount, uint8 requestPerBurst,
+                              uint16 upperSrcAddress, uint16 upperDestAddress);
+
+/* isr_Filter (Filter channel A), isr_Block (DMA_Out nrq), isr_Mux (ADC_DelSig eoc) */
+void isr_Filter_StartEx(cyisraddress address);
+void isr_Block_StartEx(cyisraddress address);
+void isr_Mux_StartEx(cyisraddress address);
+
+/* Host harness hooks */
+#define FILTER_EMU_LOG (4096u) /**< results of a channel kept for the checks, a power of 2 */
+
+typedef struct
+{
+    uint32 conversions;                 /**< ADC_DelSig results */
+    uint32 outputs[DFBEMU_CHANNELS];    /**< DFB results */
+    uint32 expected[DFBEMU_CHANNELS];   /**< results of the reference DFB */
+    uint32 taken[DFBEMU_CHANNELS];      /**< results read out, by the CPU or a DMA */
+    uint32 mismatches[DFBEMU_CHANNELS]; /**< results that differ from the reference DFB */
+    uint32 vdacWrites[DFBEMU_CHANNELS]; /**< VDAC8 / VDAC and VDAC8_1 updates */
+    uint32 filterIsrs;                  /**< isr_Filter raised */
+    uint32 blocks;                      /**< DMA_Out TDs completed */
+    uint32 blockMismatches;             /**< samples of a block that differ from the results */
+    uint32 muxErrors;                   /**< conversions of another input than expected */
+} FilterEmu_Trace;
+
+extern FilterEmu_Trace FilterEmu_trace;
+extern DfbEmu FilterEmu_dfb;
+
+void FilterEmu_Init(const DfbEmu_Program *program, uint32 conversions, uint32 periodCycles,
+                    void (*onLimit)(void));
+
+#endif /* PROJECT_H */
@@ -0,0 +1,415 @@
+/**
+ * @file
+ * @brief Pixels and Cortex-M3 cost of VideoWorkspace/PSoC5LPVGA.cydsn/VgaGfx.c.
+ *
+ * Every primitive of VgaGfx.c draws into a frame buffer in .ram2 and, pixel by pixel, into a
+ * reference copy here: a fixed scene with clipping at all four edges and glyphs at every bit
+ * offset, then random primitives with random raster operations, each followed by a compare of
+ * the two frames and a check that the draw hook reported every row that changed. Scrolls by a
+ * few rows copy with LDM/STM, larger ones through DMA_MEM. Then the cost of some primitives is
+ * measured on the emulator clock against drawing the same pixels one at a time. Built and run
+ * by HostEmu/Makefile (make -C HostEmu vga_gfx):
+ *
+ *     vga_gfx [scene.pbm]
+ *
+ * The scene is written to scene.pbm when given. The last line is a key=value summary:
+ * - wrong_ops: primitives after which the frame differed from the reference (the scene counts
+ *   as one), wrong_pixels: reads of VgaGfx_GetPixel() that disagreed with it;
+ * - unreported_rows: rows a primitive changed without the draw hook reporting them;
+ * - scroll_dma, scroll_cpu: scroll chunks copied by DMA / by the CPU;
+ * - fill_cycles, hline_cycles, line_cycles, text_cycles: a full frame cleared, one 800 pixel
+ *   row, a line across the frame and 100 glyphs, each with its per-pixel cost after it;
+ * - scroll_cycles, scroll_cpu_cycles: scrolling by one glyph row with DMA and without.
+ *
+ * The process exits nonzero on a wrong frame or pixel, an unreported row, when no scroll used
+ * DMA or the CPU, or when spans are not faster than pixels.
+ */
+#include "project.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../../Common/FastCopy.h"
+#include "VgaGfx.h"
+
+#define GFX_CHECK_W (VGA_PIXELS_X)
+#define GFX_CHECK_H (VGA_Y_BYTES)
+#define GFX_CHECK_SIZE (VGA_Y_BYTES * VGA_X_BYTES)
+#define GFX_CHECK_OPS (4000u)
+#define GFX_CHECK_MARGIN (40) /**< random coordinates reach this far outside the frame */
+#define GFX_CHECK_PROBES (2000u)
+/* Plotting one pixel: address and mask from x and y, LDRB, ORR, STRB and the loop branch */
+#define GFX_CHECK_PIXEL_CYCLES                                                                     \
+    (CYEMU_M3_LOAD + 5u * CYEMU_M3_ALU + CYEMU_M3_PIPELINED_ACCESS + CYEMU_M3_BRANCH_TAKEN)
+
+static uint8 frame[VGA_Y_BYTES][VGA_X_BYTES] __attribute__((aligned(4), section(".ram2")));
+
+/* On the heap, the .ram half is the emulated SRAM */
+static uint8 *ref;
+static uint8 *before;
+static uint8 *reported;
+static uint32 rng = 0x2545F491u;
+static uint32 wrongOps;
+static uint32 wrongPixels;
+static uint32 unreportedRows;
+
+static uint32 GfxCheck_Rand(uint32 n)
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng % n;
+}
+
+static void GfxCheck_OnDraw(uint16 row, uint16 count)
+{
+    for (; count != 0u; count--, row++)
+    {
+        if (row < GFX_CHECK_H)
+            reported[row] = 1u;
+    }
+}
+
+static void GfxCheck_RefPixel(int32 x, int32 y, uint8 op)
+{
+    uint8 *b;
+    uint8 mask;
+
+    if ((x < 0) || (x >= GFX_CHECK_W) || (y < 0) || (y >= GFX_CHECK_H))
+        return;
+    b = &ref[y * VGA_X_BYTES + x / 8];
+    mask = (uint8)(0x80u >> (x & 7));
+    if (op == VGA_GFX_CLEAR)
+        *b &= (uint8)~mask;
+    else if (op == VGA_GFX_INVERT)
+        *b ^= mask;
+    else
+        *b |= mask;
+}
+
+static void GfxCheck_RefFill(int32 x, int32 y, int32 w, int32 h, uint8 op)
+{
+    int32 i;
+    int32 j;
+
+    for (j = y; j < y + h; j++)
+    {
+        for (i = x; i < x + w; i++)
+            GfxCheck_RefPixel(i, j, op);
+    }
+}
+
+static void GfxCheck_RefRect(int32 x, int32 y, int32 w, int32 h, uint8 op)
+{
+    int32 i;
+    int32 j;
+
+    for (j = y; j < y + h; j++)
+    {
+        for (i = x; i < x + w; i++)
+        {
+            if ((j == y) || (j == y + h - 1) || (i == x) || (i == x + w - 1))
+                GfxCheck_RefPixel(i, j, op);
+        }
+    }
+}
+
+/* Bresenham one pixel at a time, the decisions VgaGfx_Line() makes */
+static void GfxCheck_RefLine(int32 x0, int32 y0, int32 x1, int32 y1, uint8 op)
+{
+    int32 dx = (x1 > x0) ? x1 - x0 : x0 - x1;
+    int32 dy = (y1 > y0) ? y1 - y0 : y0 - y1;
+    int32 sx = (x1 > x0) ? 1 : -1;
+    int32 sy = (y1 > y0) ? 1 : -1;
+    int32 major = (dx >= dy) ? dx : dy;
+    int32 minor = (dx >= dy) ? dy : dx;
+    int32 err = 2 * minor - major;
+    int32 k;
+
+    for (k = 0; k <= major; k++)
+    {
+        GfxCheck_RefPixel(x0, y0, op);
+        if (err > 0)
+        {
+            if (dx >= dy)
+                y0 += sy;
+            else
+                x0 += sx;
+            err -= 2 * major;
+        }
+        err += 2 * minor;
+        if (dx >= dy)
+            x0 += sx;
+        else
+            y0 += sy;
+    }
+}
+
+static void GfxCheck_RefGlyph(int32 x, int32 y, uint8 c, uint8 op)
+{
+    int32 r;
+    int32 i;
+
+    for (r = 0; r < 8; r++)
+    {
+        uint8 bits = CY_GET_REG8(CYDEV_EE_BASE + c + (uint32)r * 256u);
+
+        for (i = 0; i < 8; i++)
+        {
+            uint8 on = (uint8)((bits >> (7 - i)) & 1u);
+
+            if (op == VGA_GFX_COPY)
+                GfxCheck_RefPixel(x + i, y + r, on ? VGA_GFX_SET : VGA_GFX_CLEAR);
+            else if (on)
+                GfxCheck_RefPixel(x + i, y + r, op);
+        }
+    }
+}
+
+static void GfxCheck_RefScroll(int32 rows)
+{
+    int32 n = (rows < 0) ? -rows : rows;
+
+    if (n >= GFX_CHECK_H)
+    {
+        memset(ref, 0, GFX_CHECK_SIZE);
+    }
+    else if (rows > 0)
+    {
+        memmove(ref, ref + n * VGA_X_BYTES, (size_t)(GFX_CHECK_H - n) * VGA_X_BYTES);
+        memset(ref + (GFX_CHECK_H - n) * VGA_X_BYTES, 0, (size_t)n * VGA_X_BYTES);
+    }
+    else if (rows < 0)
+    {
+        memmove(ref + n * VGA_X_BYTES, ref, (size_t)(GFX_CHECK_H - n) * VGA_X_BYTES);
+        memset(ref, 0, (size_t)n * VGA_X_BYTES);
+    }
+}
+
+/* Frame against the reference after a primitive, and the rows it changed against the hook. */
+static void GfxCheck_Compare(void)
+{
+    uint32 row;
+
+    if (memcmp(frame, ref, GFX_CHECK_SIZE) != 0)
+        wrongOps++;
+    for (row = 0u; row < GFX_CHECK_H; row++)
+    {
+        if ((memcmp(&frame[row][0], &before[row * VGA_X_BYTES], VGA_X_BYTES) != 0) &&
+            (reported[row] == 0u))
+            unreportedRows++;
+    }
+    memcpy(before, frame, GFX_CHECK_SIZE);
+    memset(reported, 0, GFX_CHECK_H);
+}
+
+static int16 GfxCheck_X(void)
+{
+    return (int16)((int32)GfxCheck_Rand(GFX_CHECK_W + 2 * GFX_CHECK_MARGIN) - GFX_CHECK_MARGIN);
+}
+
+static int16 GfxCheck_Y(void)
+{
+    return (int16)((int32)GfxCheck_Rand(GFX_CHECK_H + 2 * GFX_CHECK_MARGIN) - GFX_CHECK_MARGIN);
+}
+
+/* One random primitive on both frames */
+static void GfxCheck_RandomOp(void)
+{
+    int16 x = GfxCheck_X();
+    int16 y = GfxCheck_Y();
+    int16 w = (int16)((int32)GfxCheck_Rand(260u) - 4);
+    int16 h = (int16)((int32)GfxCheck_Rand(120u) - 4);
+    uint8 op = (uint8)GfxCheck_Rand(4u);
+    uint8 c = (uint8)GfxCheck_Rand(256u);
+
+    switch (GfxCheck_Rand(9u))
+    {
+    case 0u:
+        VgaGfx_Pixel(x, y, op);
+        GfxCheck_RefPixel(x, y, op);
+        break;
+    case 1u:
+        VgaGfx_HLine(x, y, w, op);
+        GfxCheck_RefFill(x, y, w, 1, op);
+        break;
+    case 2u:
+        VgaGfx_VLine(x, y, h, op);
+        GfxCheck_RefFill(x, y, 1, h, op);
+        break;
+    case 3u:
+        VgaGfx_FillRect(x, y, w, h, op);
+        GfxCheck_RefFill(x, y, w, h, op);
+        break;
+    case 4u:
+        VgaGfx_Rect(x, y, w, h, op);
+        GfxCheck_RefRect(x, y, w, h, op);
+        break;
+    case 5u:
+    case 6u:
+    {
+        int16 x1 = GfxCheck_X();
+        int16 y1 = GfxCheck_Y();
+
+        VgaGfx_Line(x, y, x1, y1, op);
+        GfxCheck_RefLine(x, y, x1, y1, op);
+        break;
+    }
+    case 7u:
+        VgaGfx_Glyph(x, y, c, op);
+        GfxCheck_RefGlyph(x, y, c, op);
+        break;
+    default:
+        if (GfxCheck_Rand(8u) == 0u)
+        {
+            int16 rows = (int16)((int32)GfxCheck_Rand(2u * GFX_CHECK_H + 1u) - GFX_CHECK_H);
+
+            VgaGfx_Scroll(rows);
+            GfxCheck_RefScroll(rows);
+        }
+        break;
+    }
+}
+
+/* Borders, text at every bit offset, a fan of lines, clipping on all four edges */
+static void GfxCheck_Scene(void)
+{
+    static const char hello[] = "VgaGfx 800x300";
+    int32 k;
+
+    VgaGfx_FillRect(0, 0, GFX_CHECK_W, GFX_CHECK_H, VGA_GFX_CLEAR);
+    GfxCheck_RefFill(0, 0, GFX_CHECK_W, GFX_CHECK_H, VGA_GFX_CLEAR);
+    VgaGfx_Rect(0, 0, GFX_CHECK_W, GFX_CHECK_H, VGA_GFX_SET);
+    GfxCheck_RefRect(0, 0, GFX_CHECK_W, GFX_CHECK_H, VGA_GFX_SET);
+    for (k = 0; k < 8; k++)
+    {
+        int32 i;
+
+        VgaGfx_Text((int16)(16 + k), (int16)(8 + 10 * k), hello, VGA_GFX_COPY);
+        for (i = 0; hello[i] != '\0'; i++)
+            GfxCheck_RefGlyph(16 + k + 8 * i, 8 + 10 * k, (uint8)hello[i], VGA_GFX_COPY);
+    }
+    for (k = 0; k <= 16; k++)
+    {
+        int16 x1 = (int16)(300 + 30 * k);
+        int16 y1 = (int16)((k < 8) ? 299 - 37 * k : 2);
+
+        VgaGfx_Line(300, 150, x1, y1, VGA_GFX_SET);
+        GfxCheck_RefLine(300, 150, x1, y1, VGA_GFX_SET);
+    }
+    VgaGfx_FillRect(120, 100, 157, 61, VGA_GFX_INVERT);
+    GfxCheck_RefFill(120, 100, 157, 61, VGA_GFX_INVERT);
+    VgaGfx_FillRect(-20, 200, 70, 130, VGA_GFX_INVERT);
+    GfxCheck_RefFill(-20, 200, 70, 130, VGA_GFX_INVERT);
+    VgaGfx_Rect(770, -10, 60, 40, VGA_GFX_SET);
+    GfxCheck_RefRect(770, -10, 60, 40, VGA_GFX_SET);
+    VgaGfx_Line(-100, 250, 900, 320, VGA_GFX_INVERT);
+    GfxCheck_RefLine(-100, 250, 900, 320, VGA_GFX_INVERT);
+    VgaGfx_Text(-5, 290, "clipped", VGA_GFX_INVERT);
+    VgaGfx_Text(780, 180, "clipped", VGA_GFX_COPY);
+    for (k = 0; k < 7; k++)
+    {
+        GfxCheck_RefGlyph(-5 + 8 * k, 290, (uint8)"clipped"[k], VGA_GFX_INVERT);
+        GfxCheck_RefGlyph(780 + 8 * k, 180, (uint8)"clipped"[k], VGA_GFX_COPY);
+    }
+    GfxCheck_Compare();
+}
+
+static void GfxCheck_WritePbm(const char *path)
+{
+    FILE *f = fopen(path, "wb");
+
+    if (f == NULL)
+    {
+        fprintf(stderr, "gfxcheck: cannot write %s\n", path);
+        return;
+    }
+    fprintf(f, "P4\n%d %d\n", GFX_CHECK_W, GFX_CHECK_H);
+    (void)fwrite(frame, 1u, GFX_CHECK_SIZE, f);
+    (void)fclose(f);
+}
+
+/* Emulator clock before the primitive, see GFX_CHECK_COST() */
+static uint64 costStart;
+
+#define GFX_CHECK_COST(call) (costStart = CyEmu_Now(), (call), (uint32)(CyEmu_Now() - costStart))
+
+int main(int argc, char **argv)
+{
+    uint32 fillCycles;
+    uint32 hlineCycles;
+    uint32 lineCycles;
+    uint32 textCycles;
+    uint32 scrollCycles;
+    uint32 scrollCpuCycles;
+    uint32 k;
+    uint8 ch;
+
+    ref = calloc(1u, GFX_CHECK_SIZE);
+    before = calloc(1u, GFX_CHECK_SIZE);
+    reported = calloc(1u, GFX_CHECK_H);
+    if ((ref == NULL) || (before == NULL) || (reported == NULL))
+        return EXIT_FAILURE;
+    CyEmu_Init();
+    CyDmaEmu_Reset();
+    EEPROM_Start();
+    ch = DMA_MEM_DmaInitialize(64u, 0u, HI16(CYDEV_SRAM_BASE), HI16(CYDEV_SRAM_BASE));
+    if ((VgaGfx_Start(NULL, ch) != CYRET_BAD_PARAM) ||
+        (VgaGfx_Start(&frame[0][0], ch) != CYRET_SUCCESS))
+    {
+        fprintf(stderr, "gfxcheck: VgaGfx_Start\n");
+        return EXIT_FAILURE;
+    }
+    VgaGfx_SetDrawHook(GfxCheck_OnDraw);
+
+    GfxCheck_Scene();
+    if (argc > 1)
+        GfxCheck_WritePbm(argv[1]);
+    for (k = 0u; k < GFX_CHECK_OPS; k++)
+    {
+        GfxCheck_RandomOp();
+        GfxCheck_Compare();
+    }
+    for (k = 0u; k < GFX_CHECK_PROBES; k++)
+    {
+        int16 x = GfxCheck_X();
+        int16 y = GfxCheck_Y();
+        uint8 want = 0u;
+
+        if ((x >= 0) && (x < GFX_CHECK_W) && (y >= 0) && (y < GFX_CHECK_H))
+            want = (uint8)((ref[y * VGA_X_BYTES + x / 8] >> (7 - (x & 7))) & 1u);
+        if (VgaGfx_GetPixel(x, y) != want)
+            wrongPixels++;
+    }
+
+    VgaGfx_SetDrawHook(NULL);
+    fillCycles = GFX_CHECK_COST(VgaGfx_FillRect(0, 0, GFX_CHECK_W, GFX_CHECK_H, VGA_GFX_CLEAR));
+    hlineCycles = GFX_CHECK_COST(VgaGfx_HLine(0, 10, GFX_CHECK_W, VGA_GFX_SET));
+    lineCycles = GFX_CHECK_COST(VgaGfx_Line(0, 0, GFX_CHECK_W - 1, GFX_CHECK_H - 1, VGA_GFX_SET));
+    costStart = CyEmu_Now();
+    for (k = 0u; k < 100u; k++)
+        VgaGfx_Glyph((int16)(k * 8u), 20, (uint8)('A' + k % 26u), VGA_GFX_COPY);
+    textCycles = (uint32)(CyEmu_Now() - costStart);
+    scrollCycles = GFX_CHECK_COST(VgaGfx_Scroll(8));
+    (void)VgaGfx_Start(&frame[0][0], CY_DMA_INVALID_CHANNEL);
+    scrollCpuCycles = GFX_CHECK_COST(VgaGfx_Scroll(8));
+
+    printf("wrong_ops=%lu wrong_pixels=%lu unreported_rows=%lu scroll_dma=%lu scroll_cpu=%lu "
+           "fill_cycles=%lu/%lu hline_cycles=%lu/%lu line_cycles=%lu/%lu text_cycles=%lu/%lu "
+           "scroll_cycles=%lu scroll_cpu_cycles=%lu\n",
+           (unsigned long)wrongOps, (unsigned long)wrongPixels, (unsigned long)unreportedRows,
+           (unsigned long)VgaGfx_GetStats()->dmaCopies,
+           (unsigned long)VgaGfx_GetStats()->cpuCopies, (unsigned long)fillCycles,
+           (unsigned long)(GFX_CHECK_SIZE * 8u * GFX_CHECK_PIXEL_CYCLES),
+           (unsigned long)hlineCycles, (unsigned long)(GFX_CHECK_W * GFX_CHECK_PIXEL_CYCLES),
+           (unsigned long)lineCycles, (unsigned long)(GFX_CHECK_W * GFX_CHECK_PIXEL_CYCLES),
+           (unsigned long)textCycles, (unsigned long)(100u * 64u * GFX_CHECK_PIXEL_CYCLES),
+           (unsigned long)scrollCycles, (unsigned long)scrollCpuCycles);
+
+    if ((wrongOps != 0u) || (wrongPixels != 0u) || (unreportedRows != 0u) ||
+        (VgaGfx_GetStats()->dmaCopies == 0u) || (VgaGfx_GetStats()->cpuCopies == 0u) ||
+        (fillCycles >= GFX_CHECK_SIZE * 8u * GFX_CHECK_PIXEL_CYCLES) ||
+        (hlineCycles >= GFX_CHECK_W * GFX_CHECK_PIXEL_CYCLES))
+        return EXIT_FAILURE;
+    return EXIT_SUCCESS;
+}
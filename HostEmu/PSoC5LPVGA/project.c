@@ -0,0 +1,267 @@
+/**
+ * @file
+ * @brief Emulated component instances of VideoWorkspace/PSoC5LPVGA.cydsn.
+ */
+#include "project.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define PSOC5LPVGA_SCANOUT_SIZE (VideoCtrl_1_V_RES * PSOC5LPVGA_SCANOUT_X_BYTES)
+
+PSoC5LPVGA_Trace PSoC5LPVGA_trace;
+
+static cyisraddress scanlineVector;
+static cyisraddress frameRdyVector;
+
+/* VideoCtrl_1: frame lines count from the front porch line after reset, 0..PSOC5LPVGA_V_TOTAL-1 */
+static uint64 videoStart;
+static uint64 videoNextLine; /* line of the next line_dma, counted from reset */
+
+/* DMA_OUT capture, on the heap as the device has no SRAM for it */
+static uint8 *scanout;
+static uint16 scanLine;
+static uint16 scanColumn;
+static uint8 dmaOut;
+static uint16 *lineSrc; /* TD source LO16 each visible line was read from */
+
+static void (*frameHook)(const uint8 *scanout);
+
+static uint64 videoDeadline;
+static void (*videoOnLimit)(void);
+
+/* Bus-clock time of a pixel clock edge, counted from reset. */
+static uint64 PSoC5LPVGA_PixelTime(uint64 pixel)
+{
+    return videoStart + pixel * CYEMU_BUS_CLK_HZ / PSOC5LPVGA_PIXEL_CLK_HZ;
+}
+
+/**
+ * @brief VideoCtrl_1: raises line_dma on every visible line and captures what DMA_OUT receives.
+ *
+ * The line DMA moves a whole TD per request, so the line's bytes are in place when the request
+ * returns; a disabled channel, or one without a TD, leaves the line short.
+ */
+static uint64 PSoC5LPVGA_Video(void *component, uint64 now)
+{
+    (void)component;
+    for (;;)
+    {
+        uint64 at = PSoC5LPVGA_PixelTime(videoNextLine * PSOC5LPVGA_H_TOTAL +
+                                         PSOC5LPVGA_LINE_DMA_PIXEL);
+
+        if (at > now)
+            return at;
+        scanLine = (uint16)(videoNextLine % PSOC5LPVGA_V_TOTAL - PSOC5LPVGA_V_BLANK);
+        scanColumn = 0u;
+        memset(&scanout[scanLine * PSOC5LPVGA_SCANOUT_X_BYTES], 0, PSOC5LPVGA_SCANOUT_X_BYTES);
+        PSoC5LPVGA_trace.lines++;
+        (void)CyDmaEmu_Request(DMA__DRQ_NUMBER);
+        lineSrc[scanLine] = CyDmaEmu_GetStats(DMA__DRQ_NUMBER)->lastTdSrc;
+        if (scanColumn < PSOC5LPVGA_SCANOUT_X_BYTES)
+            PSoC5LPVGA_trace.shortLines++;
+
+        if (scanLine + 1u < VideoCtrl_1_V_RES)
+        {
+            videoNextLine++;
+            continue;
+        }
+        videoNextLine += PSOC5LPVGA_V_BLANK + 1u;
+        PSoC5LPVGA_trace.frames++;
+        PSoC5LPVGA_trace.lastFrameAt = at;
+        if (frameHook != NULL)
+            frameHook(scanout);
+    }
+}
+
+static uint8 PSoC5LPVGA_DmaOutRead(void *component, uint32 addr)
+{
+    (void)component;
+    (void)addr;
+    return dmaOut;
+}
+
+static void PSoC5LPVGA_DmaOutWrite(void *component, uint32 addr, uint8 value)
+{
+    (void)component;
+    (void)addr;
+    dmaOut = value;
+    if (scanColumn < PSOC5LPVGA_SCANOUT_X_BYTES)
+        scanout[scanLine * PSOC5LPVGA_SCANOUT_X_BYTES + scanColumn++] = value;
+}
+
+/** @brief DMA nrq. */
+static void PSoC5LPVGA_LineDone(uint8 chHandle, uint8 tdHandle, uint8 termout)
+{
+    (void)chHandle;
+    (void)tdHandle;
+    (void)termout;
+    PSoC5LPVGA_trace.scanlineIrqs++;
+    if (scanlineVector != NULL)
+        CyEmu_Interrupt(scanlineVector);
+}
+
+/** @brief DMA_MEM nrq. */
+static void PSoC5LPVGA_MemCopyDone(uint8 chHandle, uint8 tdHandle, uint8 termout)
+{
+    (void)chHandle;
+    (void)tdHandle;
+    (void)termout;
+    PSoC5LPVGA_trace.memCopyTds++;
+    if (frameRdyVector != NULL)
+        CyEmu_Interrupt(frameRdyVector);
+}
+
+/* Ends the run once the emulated time is up. */
+static uint64 PSoC5LPVGA_Deadline(void *component, uint64 now)
+{
+    (void)component;
+    if (now < videoDeadline)
+        return videoDeadline;
+    if (videoOnLimit != NULL)
+        videoOnLimit();
+    return CYEMU_NEVER;
+}
+
+/**
+ * @brief Wires the components and starts VideoCtrl_1 at its reset state; @p onLimit runs once
+ *        @p runCycles bus clocks have passed.
+ */
+void PSoC5LPVGA_Init(uint64 runCycles, void (*onLimit)(void))
+{
+    memset(&PSoC5LPVGA_trace, 0, sizeof(PSoC5LPVGA_trace));
+    scanlineVector = NULL;
+    frameRdyVector = NULL;
+    frameHook = NULL;
+    videoStart = CyEmu_Now();
+    videoNextLine = PSOC5LPVGA_V_BLANK;
+    videoDeadline = videoStart + runCycles;
+    videoOnLimit = onLimit;
+    if (scanout == NULL)
+        scanout = malloc(PSOC5LPVGA_SCANOUT_SIZE);
+    if (lineSrc == NULL)
+        lineSrc = malloc(VideoCtrl_1_V_RES * sizeof(*lineSrc));
+    if ((scanout == NULL) || (lineSrc == NULL))
+    {
+        fprintf(stderr, "PSoC5LPVGA: no memory for the scanout\n");
+        exit(1);
+    }
+    memset(scanout, 0, PSOC5LPVGA_SCANOUT_SIZE);
+    memset(lineSrc, 0, VideoCtrl_1_V_RES * sizeof(*lineSrc));
+    scanLine = 0u;
+    scanColumn = PSOC5LPVGA_SCANOUT_X_BYTES;
+    dmaOut = 0u;
+
+    CyDmaEmu_Reset();
+    CyDmaEmu_SetTermoutHandler(DMA__DRQ_NUMBER, PSoC5LPVGA_LineDone);
+    CyDmaEmu_SetTermoutHandler(DMA_MEM__DRQ_NUMBER, PSoC5LPVGA_MemCopyDone);
+    CyEmu_MapRegister((uint32)DMA_OUT_Control_PTR, PSoC5LPVGA_DmaOutRead, PSoC5LPVGA_DmaOutWrite,
+                      NULL);
+    CyEmu_Attach(PSoC5LPVGA_Video, NULL);
+    CyEmu_Attach(PSoC5LPVGA_Deadline, NULL);
+}
+
+/**
+ * @brief line_cnt as the LINE_CNT status registers show it: the visible line being drawn,
+ *        VideoCtrl_1_V_RES on the line after the last one, 0 through the rest of the blanking.
+ */
+uint16 PSoC5LPVGA_LineCount(void)
+{
+    uint64 pixel = (CyEmu_Now() - videoStart) * PSOC5LPVGA_PIXEL_CLK_HZ / CYEMU_BUS_CLK_HZ;
+    uint64 line = pixel / PSOC5LPVGA_H_TOTAL;
+    uint32 frameLine = (uint32)(line % PSOC5LPVGA_V_TOTAL);
+
+    if (frameLine >= PSOC5LPVGA_V_BLANK)
+        return (uint16)(frameLine - PSOC5LPVGA_V_BLANK);
+    return ((frameLine == 0u) && (line != 0u)) ? VideoCtrl_1_V_RES : 0u;
+}
+
+/** @brief Bytes DMA_OUT received per visible line, PSOC5LPVGA_SCANOUT_X_BYTES per line. */
+const uint8 *PSoC5LPVGA_Scanout(void) { return scanout; }
+
+/** @brief TD source LO16 the line DMA read each visible line of the last frame from. */
+const uint16 *PSoC5LPVGA_LineSources(void) { return lineSrc; }
+
+/** @brief Runs @p onFrame after the last visible line of every frame went out; NULL for none. */
+void PSoC5LPVGA_SetFrameHook(void (*onFrame)(const uint8 *scanout)) { frameHook = onFrame; }
+
+/**
+ * @brief RGBI colour VideoPixel_v1_0.v drives on pixel clock @p x of a scanout @p line at
+ *        @p bpp bits per pixel: one byte every 8 clocks, leftmost pixel in the high bits, each
+ *        pixel @p bpp clocks wide; 1 and 2 bpp through PALETTE_LO / PALETTE_HI. The picture
+ *        comes FINE_SCROLL clocks late, pixel value 0 before it.
+ */
+uint8 PSoC5LPVGA_PixelColor(const uint8 *line, uint16 x, uint8 bpp)
+{
+    uint8 fine = (uint8)(FINE_SCROLL_Control & 7u);
+    uint16 clock = (uint16)(x - fine);
+    uint8 pixel = (uint8)((clock % 8u) / bpp);
+    uint8 value = (x < fine) ? 0u
+                             : (uint8)((line[clock / 8u] >> (8u - bpp * (pixel + 1u))) &
+                                       ((1u << bpp) - 1u));
+    uint16 palette = (uint16)(PALETTE_LO_Control | (PALETTE_HI_Control << 8));
+
+    if (bpp == 4u)
+        return value;
+    return (uint8)((palette >> (4u * value)) & 0x0Fu);
+}
+
+void PALETTE_LO_Write(uint8 control)
+{
+    CyEmu_Spend(CYEMU_CPU_CONTROL_REG_WRITE);
+    PALETTE_LO_Control = control;
+}
+
+void PALETTE_HI_Write(uint8 control)
+{
+    CyEmu_Spend(CYEMU_CPU_CONTROL_REG_WRITE);
+    PALETTE_HI_Control = control;
+}
+
+void FINE_SCROLL_Write(uint8 control)
+{
+    CyEmu_Spend(CYEMU_CPU_CONTROL_REG_WRITE);
+    FINE_SCROLL_Control = control;
+}
+
+void UART_Start(void) {}
+
+void UART_PutString(const char8 string[]) { fputs(string, stdout); }
+
+void SCANLINE_StartEx(cyisraddress address) { scanlineVector = address; }
+
+void SCANLINE_Stop(void) { scanlineVector = NULL; }
+
+void FRAME_RDY_StartEx(cyisraddress address) { frameRdyVector = address; }
+
+void FRAME_RDY_Stop(void) { frameRdyVector = NULL; }
+
+/* Glyph row @p row of character @p c. */
+static uint8 PSoC5LPVGA_Glyph(uint8 c, uint8 row)
+{
+    switch (c)
+    {
+    case 0x00u:
+        return 0x00u;
+    case 0xB3u: /* vertical line */
+        return 0x18u;
+    case 0xC4u: /* horizontal line */
+        return (row == 3u) ? 0xFFu : 0x00u;
+    case 0xC5u: /* cross */
+        return (row == 3u) ? 0xFFu : 0x18u;
+    default:
+        return (row == 7u) ? 0x00u : (uint8)((c * 0x2Fu) ^ (row * 0x11u) ^ (c >> (row & 3u)));
+    }
+}
+
+void EEPROM_Start(void)
+{
+    uint16 c;
+    uint8 row;
+
+    for (c = 0u; c < 256u; c++)
+    {
+        for (row = 0u; row < 8u; row++)
+            CY_SET_REG8(CYDEV_EE_BASE + c + row * 256u, PSoC5LPVGA_Glyph((uint8)c, row));
+    }
+}
@@ -0,0 +1,165 @@
+/**
+ * @file
+ * @brief Host replacement for the generated project.h of VideoWorkspace/PSoC5LPVGA.cydsn.
+ *
+ * Declares the component instances main.c uses, wired as in PSoC5LPVGA.rpt:
+ * - VideoCtrl_1 at 800x600, 40 MHz pixel clock, with the state machines of
+ *   VideoCtrl_v1_0.v: line_cnt on the LINE_CNT_LO/LINE_CNT_HI status registers, line_dma on
+ *   the DMA drq once per visible line, HorizDMAAdjust pixels before the visible area;
+ * - DMA into DMA_OUT, the control register the pixel shifter reads; every byte written there is
+ *   captured as scanout of the current line;
+ * - PALETTE_LO, PALETTE_HI and FINE_SCROLL, the palette and the fine horizontal scroll of
+ *   VideoPixel_v1_0.v, which PSoC5LPVGA_PixelColor() models on the captured scanout;
+ * - DMA nrq on SCANLINE, DMA_MEM (CPU requests only) nrq on FRAME_RDY;
+ * - UART, the debug UART VGA_STATS_UART builds send the VgaStats.c counters on, to stdout;
+ * - EEPROM with a made-up 8x8 font in main.c's layout (glyph row r of character c at
+ *   c + 256 * r): the box drawing characters main.c draws its grid with, a fixed pattern for
+ *   every other character.
+ */
+#ifndef PROJECT_H
+#define PROJECT_H
+
+#include "CyDmac.h"
+#include "CyEmu.h"
+#include "CyLib.h"
+#include "cytypes.h"
+
+#include <string.h>
+
+/* One pass of a flag-polling loop: volatile load, compare, taken branch */
+#define PSOC5LPVGA_POLL_CYCLES (CYEMU_M3_LOAD + CYEMU_M3_ALU + CYEMU_M3_BRANCH_TAKEN)
+#define VGA_POLL_ACCOUNT() CyEmu_Spend(PSOC5LPVGA_POLL_CYCLES)
+
+/*
+ * Loop passes of VgaGfx.c, by VGA_GFX_COST_*: word LDR, ALU, STR and the loop branch; the same
+ * with the byte address stepped; a Bresenham step of compares and adds; two LDM/STM of four
+ * registers.
+ */
+#define PSOC5LPVGA_GFX_WORD_CYCLES                                                                 \
+    (CYEMU_M3_LOAD + 2u * CYEMU_M3_ALU + CYEMU_M3_PIPELINED_ACCESS + CYEMU_M3_BRANCH_TAKEN)
+#define PSOC5LPVGA_GFX_BYTE_CYCLES (PSOC5LPVGA_GFX_WORD_CYCLES + CYEMU_M3_ALU)
+#define PSOC5LPVGA_GFX_STEP_CYCLES (4u * CYEMU_M3_ALU + CYEMU_M3_BRANCH_TAKEN)
+#define PSOC5LPVGA_GFX_COPY_CYCLES                                                                 \
+    (2u * CYEMU_M3_LDM_STM(4u) + CYEMU_M3_ALU + CYEMU_M3_BRANCH_TAKEN)
+#define VGA_GFX_ACCOUNT(kind, n)                                                                   \
+    CyEmu_Spend((uint32)(n) * ((kind) == 0u   ? PSOC5LPVGA_GFX_WORD_CYCLES                       \
+                               : (kind) == 1u ? PSOC5LPVGA_GFX_BYTE_CYCLES                       \
+                               : (kind) == 2u ? PSOC5LPVGA_GFX_STEP_CYCLES                       \
+                                              : PSOC5LPVGA_GFX_COPY_CYCLES))
+
+/*
+ * VgaSprite.c, by VGA_SPRITE_COST_*: the LDM/STM pairs of VgaGfx.c; a sprite row shifted into
+ * place and three byte read-modify-writes.
+ */
+#define PSOC5LPVGA_SPRITE_ROW_CYCLES (3u * PSOC5LPVGA_GFX_BYTE_CYCLES + 2u * CYEMU_M3_ALU)
+#define VGA_SPRITE_ACCOUNT(kind, n)                                                                \
+    CyEmu_Spend((uint32)(n) * ((kind) == 0u ? PSOC5LPVGA_GFX_COPY_CYCLES                         \
+                                            : PSOC5LPVGA_SPRITE_ROW_CYCLES))
+
+/*
+ * VgaTile.c, per word of a line expanded: LDR of four tile numbers, four extracts, four LDRB
+ * (pipelined after the first), three ORRs, STR and the loop branch.
+ */
+#define PSOC5LPVGA_TILE_WORD_CYCLES                                                                \
+    (2u * CYEMU_M3_LOAD + 3u * CYEMU_M3_PIPELINED_ACCESS + 9u * CYEMU_M3_ALU +                   \
+     CYEMU_M3_PIPELINED_ACCESS + CYEMU_M3_BRANCH_TAKEN)
+#define VGA_TILE_ACCOUNT(words) CyEmu_Spend((uint32)(words) * PSOC5LPVGA_TILE_WORD_CYCLES)
+
+/* VgaStats.c: the emulator clock in bus clocks instead of the DWT cycle counter */
+#define VGA_STATS_TIMER_START() ((void)0)
+#define VGA_STATS_NOW() ((uint32)CyEmu_Now())
+
+/* clang-format off */
+/* VideoCtrl_1, parameters of VideoCtrl_v1_0.v */
+#define VideoCtrl_1_H_RES               800
+#define VideoCtrl_1_V_RES               600
+#define PSOC5LPVGA_PIXEL_CLK_HZ         (40000000u)
+#define PSOC5LPVGA_H_FRONT_PORCH        (40u)
+#define PSOC5LPVGA_H_SYNC_PULSE         (128u)
+#define PSOC5LPVGA_H_BACK_PORCH         (88u)
+#define PSOC5LPVGA_H_DMA_ADJUST         (16u)
+#define PSOC5LPVGA_V_FRONT_PORCH        (1u)
+#define PSOC5LPVGA_V_SYNC_PULSE         (4u)
+#define PSOC5LPVGA_V_BACK_PORCH         (23u)
+#define PSOC5LPVGA_H_TOTAL              (PSOC5LPVGA_H_FRONT_PORCH + PSOC5LPVGA_H_SYNC_PULSE + \
+                                         PSOC5LPVGA_H_BACK_PORCH + VideoCtrl_1_H_RES)
+#define PSOC5LPVGA_V_BLANK              (PSOC5LPVGA_V_FRONT_PORCH + PSOC5LPVGA_V_SYNC_PULSE + \
+                                         PSOC5LPVGA_V_BACK_PORCH)
+#define PSOC5LPVGA_V_TOTAL              (PSOC5LPVGA_V_BLANK + VideoCtrl_1_V_RES)
+/** Pixel of a line at which line_dma is high: h_count + HorizDMAAdjust == HorizBackPorch */
+#define PSOC5LPVGA_LINE_DMA_PIXEL       (PSOC5LPVGA_H_FRONT_PORCH + PSOC5LPVGA_H_SYNC_PULSE + \
+                                         PSOC5LPVGA_H_BACK_PORCH - PSOC5LPVGA_H_DMA_ADJUST - 1u)
+/** Bus clocks from the line_dma of the last visible line to that of the first one */
+#define PSOC5LPVGA_VBLANK_CYCLES        ((uint64)(PSOC5LPVGA_V_BLANK + 1u) * PSOC5LPVGA_H_TOTAL * \
+                                         CYEMU_BUS_CLK_HZ / PSOC5LPVGA_PIXEL_CLK_HZ)
+#define PSOC5LPVGA_SCANOUT_X_BYTES      (VideoCtrl_1_H_RES / 8u)
+/* clang-format on */
+
+/* LINE_CNT_LO, LINE_CNT_HI */
+#define LINE_CNT_LO_Status (LO8(PSoC5LPVGA_LineCount()))
+#define LINE_CNT_HI_Status (HI8(PSoC5LPVGA_LineCount()))
+
+/* DMA_OUT */
+#define DMA_OUT_Control_PTR ((reg8 *)(uintptr_t)(CYDEV_UDB_BASE + 0x60u))
+
+/* PALETTE_LO, PALETTE_HI: VideoPixel palette entries 0-1 and 2-3, colour builds only */
+#define PALETTE_LO_Control_PTR ((reg8 *)(uintptr_t)(CYDEV_UDB_BASE + 0x61u))
+#define PALETTE_LO_Control (*PALETTE_LO_Control_PTR)
+#define PALETTE_HI_Control_PTR ((reg8 *)(uintptr_t)(CYDEV_UDB_BASE + 0x62u))
+#define PALETTE_HI_Control (*PALETTE_HI_Control_PTR)
+void PALETTE_LO_Write(uint8 control);
+void PALETTE_HI_Write(uint8 control);
+
+/* FINE_SCROLL: VideoPixel fine horizontal scroll in pixel clocks, VGA_FINE_SCROLL builds only */
+#define FINE_SCROLL_Control_PTR ((reg8 *)(uintptr_t)(CYDEV_UDB_BASE + 0x63u))
+#define FINE_SCROLL_Control (*FINE_SCROLL_Control_PTR)
+void FINE_SCROLL_Write(uint8 control);
+
+/* DMA */
+#define DMA__DRQ_NUMBER (0u)
+#define DMA__TD_TERMOUT_EN (TD_TERMOUT0_EN)
+#define DMA_DmaInitialize(BurstCount, ReqestPerBurst, UpperSrcAddress, UpperDestAddress)          \
+    CyDmaEmu_DmaInitialize(DMA__DRQ_NUMBER, (BurstCount), (ReqestPerBurst), (UpperSrcAddress),    \
+                           (UpperDestAddress))
+
+/* DMA_MEM */
+#define DMA_MEM__DRQ_NUMBER (1u)
+#define DMA_MEM__TD_TERMOUT_EN (TD_TERMOUT0_EN)
+#define DMA_MEM_DmaInitialize(BurstCount, ReqestPerBurst, UpperSrcAddress, UpperDestAddress)      \
+    CyDmaEmu_DmaInitialize(DMA_MEM__DRQ_NUMBER, (BurstCount), (ReqestPerBurst),                   \
+                           (UpperSrcAddress), (UpperDestAddress))
+
+/* SCANLINE, FRAME_RDY */
+void SCANLINE_StartEx(cyisraddress address);
+void SCANLINE_Stop(void);
+void FRAME_RDY_StartEx(cyisraddress address);
+void FRAME_RDY_Stop(void);
+
+/* EEPROM */
+void EEPROM_Start(void);
+
+/* UART: the debug UART of VGA_STATS_UART builds, its TX goes to stdout */
+void UART_Start(void);
+void UART_PutString(const char8 string[]);
+
+/* Host harness hooks */
+typedef struct
+{
+    uint32 frames;       /**< frames whose last visible line went out */
+    uint32 lines;        /**< visible lines the line DMA was requested for */
+    uint32 shortLines;   /**< visible lines that got fewer than PSOC5LPVGA_SCANOUT_X_BYTES bytes */
+    uint32 memCopyTds;   /**< DMA_MEM TDs completed with TERMOUT */
+    uint32 scanlineIrqs; /**< DMA TDs completed with TERMOUT, i.e. SCANLINE interrupts */
+    uint64 lastFrameAt;  /**< bus-clock time of the last visible line_dma of the last frame */
+} PSoC5LPVGA_Trace;
+
+extern PSoC5LPVGA_Trace PSoC5LPVGA_trace;
+
+void PSoC5LPVGA_Init(uint64 runCycles, void (*onLimit)(void));
+uint16 PSoC5LPVGA_LineCount(void);
+const uint8 *PSoC5LPVGA_Scanout(void);
+const uint16 *PSoC5LPVGA_LineSources(void);
+void PSoC5LPVGA_SetFrameHook(void (*onFrame)(const uint8 *scanout));
+uint8 PSoC5LPVGA_PixelColor(const uint8 *line, uint16 x, uint8 bpp);
+
+#endif /* PROJECT_H */
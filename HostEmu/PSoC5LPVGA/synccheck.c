@@ -0,0 +1,401 @@
+/**
+ * @file
+ * @brief Frame update latency and retrace copy cost of VideoWorkspace/PSoC5LPVGA.cydsn/main.c.
+ *
+ * main.c (with VgaDirty.c) runs unchanged against the emulated VideoCtrl, DMA and DMA_MEM. At
+ * the end of every frame the CPU frame buffer is snapshotted; everything drawn by then must be
+ * on screen in the next frame, after one retrace copy. With VGA_PAGE_FLIP the snapshot is the
+ * page the ScanLine ISR is about to show: the back page when a flip is requested, else the
+ * front page. Each visible line is compared with the snapshot row the ScanLine ISR points the
+ * line TD at: line k shows row (k - 1) / 2 and lines 0..2 show the last row, as the TD source
+ * changes on the line after an even line. The TD source address each line was read from must be
+ * that row of the page being shown as well, with the per-line ISR (-DVGA_LINE_CHAIN=0) and with
+ * the TD ring of VgaChain.c alike. Every frame the check moves main.c's hardware scroll offset
+ * on, by 0, 1, 8, 150 rows or one back, so line k shows snapshot row ((k - 1) / 2 + scroll) %
+ * 300 with the scroll written at the end of the frame before.
+ *
+ * With VGA_SPRITES main.c moves its cursor sprite every frame and the check moves three sprites
+ * of its own over the edges of the screen, 8 and 16 pixels wide, ORed and XORed, overlapping
+ * each other now and then. The sprites written at the end of a frame are drawn over the
+ * snapshot pixel by pixel, on the screen rows of the lines, and every line must show that; the
+ * lines with a sprite on them come from a line buffer and have no frame buffer row address to
+ * check. The last frame is written to frame.pbm when given. Built and run by HostEmu/Makefile
+ * (make -C HostEmu check) once per variant: vga_sync as configured, vga_ring (VGA_LINE_CHAIN and
+ * VGA_DIRTY_SYNC, which the rest of the variants turn on as well), vga_flip / vga_isrflip
+ * (VGA_PAGE_FLIP with and without the ring), vga_isr (VGA_DIRTY_SYNC alone), vga_dirtycpu
+ * (VGA_DIRTY_SYNC with memcpy, no DMA_MEM traffic to count), vga_color /
+ * vga_color4 (VGA_BPP 2 / 4), vga_fine (VGA_FINE_SCROLL), vga_counters / vga_stats (VGA_STATS,
+ * with VGA_STATS_UART) and vga_sprite (VGA_SPRITES):
+ *
+ *     vga_sync [frames] [frame.pbm]
+ *
+ * The last line is a key=value summary:
+ * - stale_frames, stale_lines: frames / lines that did not show the snapshot of the frame
+ *   before, i.e. updates that took more than one frame to appear;
+ * - short_lines: visible lines the line DMA missed, the copy ran past the retrace;
+ * - address_lines: checked lines whose TD source was not the row the per-line ISR would set;
+ * - scanline_irqs_per_frame: SCANLINE interrupts per frame, VGA_RES_Y for the per-line ISR;
+ * - copy_bytes_per_frame, copy_bus_cycles_per_frame: DMA_MEM traffic per frame;
+ * - copy_cycles_max: from the line_dma of the last visible line to the end of the last DMA_MEM
+ *   TD, against vblank_cycles, the time until the line_dma of the first visible line;
+ * - flips (VGA_PAGE_FLIP): frames that ended with a flip requested, main.c draws every frame;
+ * - page_drift (VGA_PAGE_FLIP): flips where the page shown next differed from the one shown so
+ *   far in more than the 8 rows of one character, i.e. a change missing from one of the pages;
+ * - colors: RGBI colours on the pixels of the last checked frame, through the VideoPixel model
+ *   at VGA_BPP (only counted for 2 and 4 bpp, 1 bpp has no palette registers);
+ * - scrolls: checked frames shown with a nonzero scroll offset;
+ * - fine_errors (VGA_FINE_SCROLL): frames shown with another FINE_SCROLL than the fine scroll
+ *   written at the end of the frame before;
+ * - stats_errors: VgaStats.c counters that disagree with the emulator: the ScanLine interrupts
+ *   and frames it counted, its line period and vertical blanking against the VideoCtrl timing
+ *   (within SYNC_CHECK_STATS_SLACK bus clocks), and overruns without short lines or the other
+ *   way round;
+ * - sprite_lines (VGA_SPRITES): checked lines with a sprite on them.
+ *
+ * The VgaStats_Format() line comes right before the summary.
+ *
+ * The process exits nonzero on a stale frame, a short line, an address line, page drift, a
+ * page flip build that never flipped, a colour build showing fewer than 4 colours, when nothing
+ * scrolled, on a fine scroll error, a stats error or when no sprite was shown in a sprite build;
+ * the 1/10th memcpy variant
+ * (-DVGA_DIRTY_SYNC=0 -DDMA_MEM_CPY=0) does so by design.
+ */
+#include "project.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "VgaConfig.h"
+#include "VgaStats.h"
+#if VGA_SPRITES
+#include "VgaSprite.h"
+#endif
+
+/* -Dmain=... renames the firmware entry point; this file provides the real one. */
+#undef main
+
+#define SYNC_CHECK_FRAMES (120u)
+#define SYNC_CHECK_WARMUP (2u) /**< frames before the first copy has been shown */
+#define SYNC_CHECK_Y_BYTES (VideoCtrl_1_V_RES / 2u) /**< main.c's VGA_Y_FACTOR 2 */
+#define SYNC_CHECK_FRAME_CYCLES                                                                    \
+    ((uint64)PSOC5LPVGA_V_TOTAL * PSOC5LPVGA_H_TOTAL * CYEMU_BUS_CLK_HZ / PSOC5LPVGA_PIXEL_CLK_HZ)
+
+/** Interrupt latency jitter the VgaStats.c line period and blanking may be off by, bus clocks */
+#define SYNC_CHECK_STATS_SLACK (64u)
+
+/* main.c */
+int PSoC5LPVGA_main(void);
+extern uint8 cframe[SYNC_CHECK_Y_BYTES][PSOC5LPVGA_SCANOUT_X_BYTES];
+extern uint8 dframe[SYNC_CHECK_Y_BYTES][PSOC5LPVGA_SCANOUT_X_BYTES];
+#if VGA_PAGE_FLIP
+extern uint8 (*volatile frontPage)[PSOC5LPVGA_SCANOUT_X_BYTES];
+extern uint8 (*volatile backPage)[PSOC5LPVGA_SCANOUT_X_BYTES];
+extern volatile uint8 flipRequest;
+#endif
+extern volatile uint16 scrollRequest;
+#if VGA_FINE_SCROLL
+extern volatile uint8 fineRequest;
+#endif
+
+static uint8 *snapshot; /* cframe at the end of the previous frame */
+static const uint8 *shownPage = &dframe[0][0]; /* page the line DMA shows in this frame */
+static uint32 checkedFrames;
+static uint32 staleFrames;
+static uint32 staleLines;
+static uint32 addressLines;
+static uint64 frameEndAt;
+static uint64 copyCyclesMax;
+static uint32 flips;
+static uint32 pageDrift;
+static uint32 colors;
+static uint16 shownScroll; /* scrollRequest as the last line of the frame before left it */
+static uint32 scrolls;
+#if VGA_FINE_SCROLL
+static uint8 shownFine;
+#endif
+static uint32 fineErrors;
+static uint32 spriteLines;
+static uint32 lastFrame;       /* frame written to pbmPath */
+static const char *pbmPath;
+#if VGA_SPRITES
+static VgaSprite shownSprites[VGA_SPRITE_COUNT]; /* as written at the end of the frame before */
+
+/* The check's own sprites: a 16x12 frame, an 8x8 checker and a 16x20 bar */
+static const uint16 boxSprite[12] = {0xFFFFu, 0x8001u, 0x8001u, 0x8FF1u, 0x8811u, 0x8811u,
+                                     0x8811u, 0x8811u, 0x8FF1u, 0x8001u, 0x8001u, 0xFFFFu};
+static const uint16 checkerSprite[8] = {0xAA00u, 0x5500u, 0xAA00u, 0x5500u,
+                                        0xAA00u, 0x5500u, 0xAA00u, 0x5500u};
+static const uint16 barSprite[20] = {0x0FF0u, 0x1FF8u, 0x3FFCu, 0x7FFEu, 0xFFFFu, 0xFFFFu, 0xF00Fu,
+                                     0xF00Fu, 0xF00Fu, 0xF00Fu, 0xF00Fu, 0xF00Fu, 0xF00Fu, 0xF00Fu,
+                                     0xFFFFu, 0xFFFFu, 0x7FFEu, 0x3FFCu, 0x1FF8u, 0x0FF0u};
+#endif
+
+/* Frame buffer row the line TD points at on visible line @p line, from row @p scroll on. */
+static uint16 SyncCheck_Row(uint16 line, uint16 scroll)
+{
+    uint16 row = (line < 3u) ? (uint16)(SYNC_CHECK_Y_BYTES - 1u) : (uint16)((line - 1u) / 2u);
+
+    return (uint16)((row + scroll) % SYNC_CHECK_Y_BYTES);
+}
+
+#if VGA_SPRITES
+/*
+ * Moves the check's sprites on by a different step each, through the edges of the screen and
+ * over each other, and keeps every sprite as it is shown from the next frame on.
+ */
+static void SyncCheck_Sprites(void)
+{
+    uint32 f = PSoC5LPVGA_trace.frames;
+    uint8 id;
+
+    if (f == 1u)
+    {
+        (void)VgaSprite_Set(1u, boxSprite, 16u, 12u, VGA_SPRITE_OR);
+        (void)VgaSprite_Set(2u, checkerSprite, 8u, 8u, VGA_SPRITE_XOR);
+        (void)VgaSprite_Set(3u, barSprite, 16u, 20u, VGA_SPRITE_XOR);
+    }
+    VgaSprite_Move(1u, (int16)((int32)(f * 37u % 840u) - 20),
+                   (int16)((int32)(f * 23u % 330u) - 10));
+    VgaSprite_Move(2u, (int16)(VideoCtrl_1_H_RES - 6u + f % 13u - 6u), (int16)(f * 7u % 300u));
+    VgaSprite_Move(3u, (int16)((int32)(f * 5u % 816u) - 8), (int16)((int32)(f * 3u % 320u) - 20));
+    for (id = 0u; id < VGA_SPRITE_COUNT; id++)
+        shownSprites[id] = *VgaSprite_Get(id);
+}
+
+/* Draws the sprites of shownSprites on screen row @p screenRow into @p line, pixel by pixel. */
+static uint8 SyncCheck_DrawSprites(uint8 *line, uint16 screenRow)
+{
+    uint8 drawn = 0u;
+    uint8 id;
+
+    for (id = 0u; id < VGA_SPRITE_COUNT; id++)
+    {
+        const VgaSprite *s = &shownSprites[id];
+        int32 r = (int32)screenRow - s->y;
+        uint8 px;
+
+        if ((s->op == VGA_SPRITE_OFF) || (r < 0) || (r >= s->height))
+            continue;
+        drawn = 1u;
+        for (px = 0u; px < s->width; px++)
+        {
+            int32 x = s->x + px;
+            uint8 mask = (uint8)(0x80u >> (x & 7));
+
+            if (((s->bitmap[r] & (0x8000u >> px)) == 0u) || (x < 0) ||
+                (x >= (int32)VideoCtrl_1_H_RES))
+                continue;
+            if (s->op == VGA_SPRITE_OR)
+                line[x / 8] |= mask;
+            else
+                line[x / 8] ^= mask;
+        }
+    }
+    return drawn;
+}
+#endif
+
+static void SyncCheck_WritePbm(const uint8 *scanout)
+{
+    FILE *f = fopen(pbmPath, "wb");
+
+    if (f == NULL)
+    {
+        fprintf(stderr, "synccheck: cannot write %s\n", pbmPath);
+        return;
+    }
+    fprintf(f, "P4\n%u %u\n", (unsigned)VideoCtrl_1_H_RES, (unsigned)VideoCtrl_1_V_RES);
+    (void)fwrite(scanout, 1u, VideoCtrl_1_V_RES * PSOC5LPVGA_SCANOUT_X_BYTES, f);
+    (void)fclose(f);
+}
+
+/*
+ * Moves the scroll offset on like a log viewer would, by 0, 1 and 8 rows and backwards, with
+ * the one write per frame main.c takes over on the last line.
+ */
+static void SyncCheck_Scroll(void)
+{
+    static const uint16 steps[] = {0u, 8u, 1u, SYNC_CHECK_Y_BYTES - 1u, 8u, 150u};
+    uint16 next = (uint16)((shownScroll + steps[PSoC5LPVGA_trace.frames % 6u]) %
+                           SYNC_CHECK_Y_BYTES);
+
+    scrollRequest = next;
+    shownScroll = next;
+#if VGA_FINE_SCROLL
+    shownFine = (uint8)(PSoC5LPVGA_trace.frames % 8u);
+    fineRequest = shownFine;
+#endif
+}
+
+static void SyncCheck_Frame(const uint8 *scanout)
+{
+    uint64 copyDoneAt = CyDmaEmu_GetStats(DMA_MEM__DRQ_NUMBER)->lastTdDoneAt;
+    uint16 line;
+
+    /* The retrace copy of the frame before, if there was one */
+    if ((frameEndAt != 0u) && (copyDoneAt > frameEndAt) &&
+        (copyDoneAt - frameEndAt > copyCyclesMax))
+        copyCyclesMax = copyDoneAt - frameEndAt;
+    frameEndAt = CyEmu_Now();
+
+    if (PSoC5LPVGA_trace.frames > SYNC_CHECK_WARMUP)
+    {
+        uint32 stale = 0u;
+
+        const uint16 *src = PSoC5LPVGA_LineSources();
+
+        for (line = 0u; line < VideoCtrl_1_V_RES; line++)
+        {
+            uint32 offset = SyncCheck_Row(line, shownScroll) * PSOC5LPVGA_SCANOUT_X_BYTES;
+            uint8 expected[PSOC5LPVGA_SCANOUT_X_BYTES];
+            uint8 sprite = 0u;
+
+            memcpy(expected, &snapshot[offset], PSOC5LPVGA_SCANOUT_X_BYTES);
+#if VGA_SPRITES
+            sprite = SyncCheck_DrawSprites(expected, SyncCheck_Row(line, 0u));
+            spriteLines += sprite;
+#endif
+            if (memcmp(&scanout[line * PSOC5LPVGA_SCANOUT_X_BYTES], expected,
+                       PSOC5LPVGA_SCANOUT_X_BYTES) != 0)
+                stale++;
+            if (!sprite && (src[line] != LO16((uint32)&shownPage[offset])))
+                addressLines++;
+        }
+#if VGA_BPP > 1
+        {
+            uint16 seen = 0u;
+            uint16 x;
+
+            for (line = 0u; line < VideoCtrl_1_V_RES; line++)
+            {
+                for (x = 0u; x < VideoCtrl_1_H_RES; x++)
+                    seen |= (uint16)(1u << PSoC5LPVGA_PixelColor(
+                                         &scanout[line * PSOC5LPVGA_SCANOUT_X_BYTES], x, VGA_BPP));
+            }
+            for (colors = 0u; seen != 0u; seen &= (uint16)(seen - 1u))
+                colors++;
+        }
+#endif
+#if VGA_FINE_SCROLL
+        if (FINE_SCROLL_Control != shownFine)
+            fineErrors++;
+#endif
+        if (shownScroll != 0u)
+            scrolls++;
+        if ((pbmPath != NULL) && (PSoC5LPVGA_trace.frames == lastFrame))
+            SyncCheck_WritePbm(scanout);
+        checkedFrames++;
+        staleLines += stale;
+        if (stale != 0u)
+            staleFrames++;
+    }
+#if VGA_PAGE_FLIP
+    if (flipRequest)
+    {
+        uint32 i;
+        uint32 changed = 0u;
+
+        flips++;
+        for (i = 0u; i < sizeof(cframe); i++)
+            changed += (backPage[0][i] != frontPage[0][i]);
+        if (changed > 8u * VGA_GLYPH_BYTES)
+            pageDrift++;
+        shownPage = &backPage[0][0];
+    }
+    else
+        shownPage = &frontPage[0][0];
+    memcpy(snapshot, shownPage, sizeof(cframe));
+#else
+    memcpy(snapshot, cframe, sizeof(cframe));
+#endif
+    SyncCheck_Scroll();
+#if VGA_SPRITES
+    SyncCheck_Sprites();
+#endif
+}
+
+/* VgaStats.c counters that disagree with the emulator's trace, none without them. */
+static uint32 SyncCheck_StatsErrors(void)
+{
+#if VGA_STATS
+    const PSoC5LPVGA_Trace *t = &PSoC5LPVGA_trace;
+    const VgaStats_Counters *stats = VgaStats_Get();
+    uint32 lineCycles =
+        (uint32)((uint64)PSOC5LPVGA_H_TOTAL * CYEMU_BUS_CLK_HZ / PSOC5LPVGA_PIXEL_CLK_HZ);
+    uint32 vblankCycles = (uint32)PSOC5LPVGA_VBLANK_CYCLES;
+    uint32 errors = 0u;
+
+    errors += (stats->irqs != t->scanlineIrqs);
+    errors += (stats->frames != t->frames);
+    errors += (stats->lineCycles + SYNC_CHECK_STATS_SLACK < lineCycles) ||
+              (stats->lineCycles > lineCycles + SYNC_CHECK_STATS_SLACK);
+    errors += (stats->vblankCycles + SYNC_CHECK_STATS_SLACK < vblankCycles) ||
+              (stats->vblankCycles > vblankCycles + SYNC_CHECK_STATS_SLACK);
+    errors += ((stats->overruns != 0u) != (t->shortLines != 0u));
+    return errors;
+#else
+    return 0u;
+#endif
+}
+
+static void SyncCheck_Report(void)
+{
+    const PSoC5LPVGA_Trace *t = &PSoC5LPVGA_trace;
+    const CyDmaEmu_ChStats *mem = CyDmaEmu_GetStats(DMA_MEM__DRQ_NUMBER);
+    uint32 frames = (t->frames != 0u) ? t->frames : 1u;
+    uint32 statsErrors = SyncCheck_StatsErrors();
+#if VGA_STATS
+    char statsLine[VGA_STATS_LINE_MAX];
+#endif
+    uint8 failed = (uint8)((staleFrames != 0u) || (t->shortLines != 0u) || (addressLines != 0u) ||
+                           (pageDrift != 0u) || (checkedFrames == 0u) ||
+                           (scrolls == 0u) || (fineErrors != 0u) || (statsErrors != 0u));
+
+#if VGA_PAGE_FLIP
+    if (flips == 0u)
+        failed = 1u;
+#endif
+#if VGA_BPP > 1
+    if (colors < 4u)
+        failed = 1u;
+#endif
+#if VGA_SPRITES
+    if (spriteLines == 0u)
+        failed = 1u;
+#endif
+
+#if VGA_STATS
+    VgaStats_Format(statsLine, sizeof(statsLine));
+    fputs(statsLine, stdout);
+#endif
+    printf("frames=%u checked_frames=%u stale_frames=%u stale_lines=%u short_lines=%u "
+           "address_lines=%u scanline_irqs_per_frame=%u copy_bytes_per_frame=%u "
+           "copy_bus_cycles_per_frame=%u copy_cycles_max=%u vblank_cycles=%u flips=%u "
+           "page_drift=%u colors=%u scrolls=%u fine_errors=%u stats_errors=%u sprite_lines=%u\n",
+           (unsigned)t->frames, (unsigned)checkedFrames, (unsigned)staleFrames,
+           (unsigned)staleLines, (unsigned)t->shortLines, (unsigned)addressLines,
+           (unsigned)(t->scanlineIrqs / frames), (unsigned)(mem->bytes / frames),
+           (unsigned)(mem->busCycles / frames), (unsigned)copyCyclesMax,
+           (unsigned)PSOC5LPVGA_VBLANK_CYCLES, (unsigned)flips,
+           (unsigned)pageDrift, (unsigned)colors, (unsigned)scrolls, (unsigned)fineErrors,
+           (unsigned)statsErrors, (unsigned)spriteLines);
+    exit(failed ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
+int main(int argc, char **argv)
+{
+    uint32 frames = (argc > 1) ? (uint32)strtoul(argv[1], NULL, 0) : SYNC_CHECK_FRAMES;
+
+    lastFrame = frames;
+    pbmPath = (argc > 2) ? argv[2] : NULL;
+    snapshot = calloc(1u, sizeof(cframe));
+    if (snapshot == NULL)
+        return EXIT_FAILURE;
+    CyEmu_Init();
+    /* A little past the last visible line of the last frame */
+    PSoC5LPVGA_Init((uint64)((frames != 0u) ? frames : 1u) * SYNC_CHECK_FRAME_CYCLES +
+                        SYNC_CHECK_FRAME_CYCLES / 2u,
+                    SyncCheck_Report);
+    PSoC5LPVGA_SetFrameHook(SyncCheck_Frame);
+    return PSoC5LPVGA_main();
+}
@@ -0,0 +1,149 @@
+/**
+ * @file
+ * @brief Scanout and SRAM use of the text mode of VideoWorkspace/PSoC5LPVGA.cydsn/main.c.
+ *
+ * main.c built with VGA_TEXT_MODE runs unchanged against the emulated VideoCtrl and DMA. Every
+ * visible line is compared with the glyph row the character buffer gives it, rendered here
+ * straight from the EEPROM font: line k shows glyph row (k / 2) % 8 of character row k / 16,
+ * inverted where the attribute bit is set, and the lines below the last character row are
+ * blank. main.c changes the screen right after the last line, so a frame must show the screen
+ * as it is at its own end, except its first two glyph rows (lines 0..3), which are expanded on
+ * the last lines of the frame before. Built and run by HostEmu/Makefile (make -C HostEmu vga_text):
+ *
+ *     vga_text [frames]
+ *
+ * The last line is a key=value summary:
+ * - wrong_frames, wrong_lines: frames / lines that did not show the character buffer;
+ * - short_lines: visible lines the line DMA missed;
+ * - changed_cells: characters main.c changed over the run (one per frame);
+ * - scanline_irqs_per_frame: SCANLINE interrupts per frame, one per glyph row;
+ * - text_bytes, frame_bytes: SRAM of the text mode against the cframe and dframe it replaces.
+ *
+ * The process exits nonzero on a wrong frame, a short line or when nothing changed.
+ */
+#include "project.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "VgaText.h"
+
+/* -Dmain=... renames the firmware entry point; this file provides the real one. */
+#undef main
+
+#define TEXT_CHECK_FRAMES (120u)
+#define TEXT_CHECK_WARMUP (1u) /**< frames before the ring is on the first line */
+#define TEXT_CHECK_EARLY_LINES (2u * VGA_Y_FACTOR)
+#define TEXT_CHECK_CELLS (VGA_TEXT_ROWS * VGA_TEXT_COLS)
+#define TEXT_CHECK_FRAME_CYCLES                                                                    \
+    ((uint64)PSOC5LPVGA_V_TOTAL * PSOC5LPVGA_H_TOTAL * CYEMU_BUS_CLK_HZ / PSOC5LPVGA_PIXEL_CLK_HZ)
+
+/* main.c */
+int PSoC5LPVGA_main(void);
+
+/*
+ * Character code and attribute of every cell, at the end of the frame before and of this one;
+ * on the heap like the rendered line, the .ram half is the emulated SRAM.
+ */
+static uint8 (*screenBefore)[2];
+static uint8 (*screenNow)[2];
+static uint8 *line;
+static uint32 checkedFrames;
+static uint32 wrongFrames;
+static uint32 wrongLines;
+static uint32 changedCells;
+
+static void TextCheck_Snapshot(uint8 (*screen)[2])
+{
+    uint8 row;
+    uint8 col;
+
+    for (row = 0u; row < VGA_TEXT_ROWS; row++)
+    {
+        for (col = 0u; col < VGA_TEXT_COLS; col++)
+        {
+            screen[row * VGA_TEXT_COLS + col][0] = VgaText_chars[row][col];
+            screen[row * VGA_TEXT_COLS + col][1] = VgaText_GetAttr(col, row);
+        }
+    }
+}
+
+/* Visible line @p k of @p screen, from the EEPROM font. */
+static void TextCheck_Render(uint8 (*screen)[2], uint16 k)
+{
+    uint16 row = (uint16)(k / (VGA_TEXT_GLYPH_ROWS * VGA_Y_FACTOR));
+    uint16 glyphRow = (uint16)((k / VGA_Y_FACTOR) % VGA_TEXT_GLYPH_ROWS);
+    uint8 col;
+
+    memset(line, 0, PSOC5LPVGA_SCANOUT_X_BYTES);
+    if (row >= VGA_TEXT_ROWS)
+        return;
+    for (col = 0u; col < VGA_TEXT_COLS; col++)
+    {
+        const uint8 *cell = screen[row * VGA_TEXT_COLS + col];
+        uint8 bits = CY_GET_REG8(CYDEV_EE_BASE + cell[0] + glyphRow * 256u);
+
+        line[col] = cell[1] ? (uint8)~bits : bits;
+    }
+}
+
+static void TextCheck_Frame(const uint8 *scanout)
+{
+    uint32 i;
+    uint16 k;
+
+    TextCheck_Snapshot(screenNow);
+    if (PSoC5LPVGA_trace.frames > TEXT_CHECK_WARMUP)
+    {
+        uint32 wrong = 0u;
+
+        for (k = 0u; k < VideoCtrl_1_V_RES; k++)
+        {
+            TextCheck_Render((k < TEXT_CHECK_EARLY_LINES) ? screenBefore : screenNow, k);
+            if (memcmp(&scanout[k * PSOC5LPVGA_SCANOUT_X_BYTES], line,
+                       PSOC5LPVGA_SCANOUT_X_BYTES) != 0)
+                wrong++;
+        }
+        checkedFrames++;
+        wrongLines += wrong;
+        if (wrong != 0u)
+            wrongFrames++;
+        for (i = 0u; i < TEXT_CHECK_CELLS; i++)
+            changedCells += (uint32)(memcmp(screenBefore[i], screenNow[i], 2u) != 0);
+    }
+    memcpy(screenBefore, screenNow, TEXT_CHECK_CELLS * 2u);
+}
+
+static void TextCheck_Report(void)
+{
+    const PSoC5LPVGA_Trace *t = &PSoC5LPVGA_trace;
+    uint32 frames = (t->frames != 0u) ? t->frames : 1u;
+    uint8 failed = (uint8)((wrongFrames != 0u) || (t->shortLines != 0u) || (changedCells == 0u) ||
+                           (checkedFrames == 0u));
+
+    printf("frames=%u checked_frames=%u wrong_frames=%u wrong_lines=%u short_lines=%u "
+           "changed_cells=%u scanline_irqs_per_frame=%u text_bytes=%u frame_bytes=%u\n",
+           (unsigned)t->frames, (unsigned)checkedFrames, (unsigned)wrongFrames,
+           (unsigned)wrongLines, (unsigned)t->shortLines, (unsigned)changedCells,
+           (unsigned)(t->scanlineIrqs / frames), (unsigned)VgaText_Size(),
+           (unsigned)(2u * VGA_BUFF_SIZE));
+    exit(failed ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
+int main(int argc, char **argv)
+{
+    uint32 frames = (argc > 1) ? (uint32)strtoul(argv[1], NULL, 0) : TEXT_CHECK_FRAMES;
+
+    line = malloc(PSOC5LPVGA_SCANOUT_X_BYTES);
+    screenBefore = calloc(TEXT_CHECK_CELLS, 2u);
+    screenNow = calloc(TEXT_CHECK_CELLS, 2u);
+    if ((line == NULL) || (screenBefore == NULL) || (screenNow == NULL))
+        return EXIT_FAILURE;
+    CyEmu_Init();
+    /* A little past the last visible line of the last frame */
+    PSoC5LPVGA_Init((uint64)((frames != 0u) ? frames : 1u) * TEXT_CHECK_FRAME_CYCLES +
+                        TEXT_CHECK_FRAME_CYCLES / 2u,
+                    TextCheck_Report);
+    PSoC5LPVGA_SetFrameHook(TextCheck_Frame);
+    return PSoC5LPVGA_main();
+}
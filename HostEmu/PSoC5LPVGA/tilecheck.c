@@ -0,0 +1,345 @@
+/**
+ * @file
+ * @brief Scanout, tile store use and ISR time of the tile mode of
+ *        VideoWorkspace/PSoC5LPVGA.cydsn/main.c.
+ *
+ * main.c built with VGA_TILE_MODE runs unchanged against the emulated VideoCtrl and DMA. Every
+ * visible line is compared with the line the tile map gives it, rendered here through
+ * VgaTile_Get(). main.c changes the screen right after the last line, so a frame must show the
+ * screen as it is at its own end, except lines 0..1, which are expanded on the last lines of the
+ * frame before: line 0 before the frame hook, line 1 after it.
+ *
+ * On top of main.c's character set, sample screens are put into the tile map from the frame
+ * hook a cell at a time, the way an application would: a dialog over a dithered desktop (edges
+ * off the tile grid, body text off the tile rows, a separator drawn pixel by pixel with
+ * VgaTile_Pixel()), a page of text and random noise. One line per sample tells the tiles it
+ * took, the SRAM of the map and those tiles against a 1 bpp frame buffer of every line, the cells
+ * the full store refused and the cells that do not show the sample. Built and run by
+ * HostEmu/Makefile (make -C HostEmu vga_tile):
+ *
+ *     vga_tile [frames]
+ *
+ * The last line is a key=value summary:
+ * - wrong_frames, wrong_lines: frames / lines that did not show the tile map;
+ * - short_lines: visible lines the line DMA missed;
+ * - scanline_irqs_per_frame: SCANLINE interrupts per frame, one per line;
+ * - tile_bytes, frame_bytes: SRAM of the tile mode against a 1 bpp frame buffer of every line;
+ * - isr_cycles_max, line_cycles: longest ScanLine ISR, entry to end (VgaStats.c, 0 without
+ *   VGA_STATS; HostEmu/Makefile builds vga_tile with it) against the line period, in bus clocks.
+ *
+ * The process exits nonzero on a wrong frame, a short line, an ISR longer than a line, or when
+ * the dialog or the text page did not fit in the tile store.
+ */
+#include "project.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "VgaStats.h"
+#include "VgaTile.h"
+
+/* -Dmain=... renames the firmware entry point; this file provides the real one. */
+#undef main
+
+#define TILE_CHECK_FRAMES (120u)
+#define TILE_CHECK_WARMUP (1u)      /**< frames before the ring is on the first line */
+#define TILE_CHECK_EARLY_LINES (2u) /**< lines expanded on the frame before */
+#define TILE_CHECK_SAMPLE_EVERY (30u)
+#define TILE_CHECK_SAMPLES (3u)
+#define TILE_CHECK_BYTES ((uint32)VGA_RES_Y * VGA_X_BYTES)
+#define TILE_CHECK_LINE_CYCLES                                                                     \
+    ((uint32)((uint64)PSOC5LPVGA_H_TOTAL * CYEMU_BUS_CLK_HZ / PSOC5LPVGA_PIXEL_CLK_HZ))
+#define TILE_CHECK_FRAME_CYCLES                                                                    \
+    ((uint64)PSOC5LPVGA_V_TOTAL * PSOC5LPVGA_H_TOTAL * CYEMU_BUS_CLK_HZ / PSOC5LPVGA_PIXEL_CLK_HZ)
+
+/* main.c */
+int PSoC5LPVGA_main(void);
+
+typedef struct
+{
+    const char *name;
+    uint8 mustFit; /**< an application screen, not a worst case */
+    uint8 loaded;
+    uint16 tiles;
+    uint32 refused;
+    uint32 lostCells;
+} TileCheck_Sample;
+
+static TileCheck_Sample samples[TILE_CHECK_SAMPLES] = {
+    {"dialog", 1u, 0u, 0u, 0u, 0u}, {"text", 1u, 0u, 0u, 0u, 0u}, {"noise", 0u, 0u, 0u, 0u, 0u}};
+
+static const char tileCheckText[] =
+    "The tile map holds one byte per 8x8 cell and the store every distinct tile once. ";
+
+/*
+ * The screen at the end of the frame before and of this one, and the sample being put; on the
+ * heap, the .ram half is the emulated SRAM.
+ */
+static uint8 *screenBefore;
+static uint8 *screenNow;
+static uint8 *lineZero; /* line 0 of this frame, expanded before a sample was put */
+static uint8 *sample;
+static uint32 checkedFrames;
+static uint32 wrongFrames;
+static uint32 wrongLines;
+
+static void TileCheck_Snapshot(uint8 *screen)
+{
+    uint8 pixels[VGA_TILE_HEIGHT];
+    uint8 row;
+    uint8 col;
+    uint8 r;
+
+    for (row = 0u; row < VGA_TILE_ROWS; row++)
+    {
+        for (col = 0u; col < VGA_TILE_COLS; col++)
+        {
+            VgaTile_Get(col, row, pixels);
+            for (r = 0u; r < VGA_TILE_HEIGHT; r++)
+                screen[(row * VGA_TILE_HEIGHT + r) * VGA_X_BYTES + col] = pixels[r];
+        }
+    }
+}
+
+static void TileCheck_Set(uint16 x, uint16 y, uint8 on)
+{
+    uint8 *b = &sample[y * VGA_X_BYTES + x / 8u];
+    uint8 mask = (uint8)(0x80u >> (x % 8u));
+
+    *b = on ? (uint8)(*b | mask) : (uint8)(*b & ~mask);
+}
+
+static void TileCheck_Fill(uint16 x0, uint16 y0, uint16 x1, uint16 y1, uint8 on)
+{
+    uint16 x;
+    uint16 y;
+
+    for (y = y0; y < y1; y++)
+    {
+        for (x = x0; x < x1; x++)
+            TileCheck_Set(x, y, on);
+    }
+}
+
+/* Characters of @p s from the EEPROM font at byte column @p col and pixel row @p y. */
+static void TileCheck_Text(uint8 col, uint16 y, const char *s, uint8 invert)
+{
+    uint8 r;
+
+    for (; (*s != '\0') && (col < VGA_X_BYTES); s++, col++)
+    {
+        for (r = 0u; r < VGA_TILE_HEIGHT; r++)
+        {
+            uint8 bits = CY_GET_REG8(CYDEV_EE_BASE + (uint8)*s + r * 256u);
+
+            sample[(y + r) * VGA_X_BYTES + col] = invert ? (uint8)~bits : bits;
+        }
+    }
+}
+
+static void TileCheck_Dialog(void)
+{
+    uint16 y;
+    uint8 k;
+
+    /* Dithered desktop, a window with a shadow, an inverted title bar and two buttons */
+    for (y = 0u; y < VGA_RES_Y; y++)
+        memset(&sample[y * VGA_X_BYTES], (y % 2u) ? 0x55 : 0xAA, VGA_X_BYTES);
+    TileCheck_Fill(171u, 125u, 645u, 459u, 1u);
+    TileCheck_Fill(163u, 117u, 637u, 451u, 1u);
+    TileCheck_Fill(165u, 137u, 635u, 449u, 0u);
+    TileCheck_Text(22u, 124u, " Save changes?", 1u);
+    for (k = 0u; k < 4u; k++)
+        TileCheck_Text(24u, (uint16)(164u + 20u * k), tileCheckText + 20u * k, 0u);
+    for (k = 0u; k < 2u; k++)
+    {
+        uint16 x = (uint16)(300u + 140u * k);
+
+        TileCheck_Fill(x, 400u, (uint16)(x + 90u), 426u, 1u);
+        TileCheck_Fill((uint16)(x + 2u), 402u, (uint16)(x + 88u), 424u, 0u);
+        TileCheck_Text((uint8)((x + 21u) / 8u), 409u, (k == 0u) ? "  OK" : "Cancel", 0u);
+    }
+}
+
+static void TileCheck_Page(void)
+{
+    uint16 row;
+    uint8 col;
+
+    memset(sample, 0, TILE_CHECK_BYTES);
+    for (row = 0u; row < VGA_TILE_ROWS; row++)
+    {
+        for (col = 0u; col < VGA_X_BYTES; col++)
+        {
+            char c[2] = {tileCheckText[(row * 7u + col) % (sizeof(tileCheckText) - 1u)], '\0'};
+
+            TileCheck_Text(col, (uint16)(row * VGA_TILE_HEIGHT), c, 0u);
+        }
+    }
+}
+
+static void TileCheck_Noise(void)
+{
+    uint32 s = 0x12345678u;
+    uint32 i;
+
+    for (i = 0u; i < TILE_CHECK_BYTES; i++)
+    {
+        s ^= s << 13;
+        s ^= s >> 17;
+        s ^= s << 5;
+        sample[i] = (uint8)s;
+    }
+}
+
+/* Puts sample @p k into the tile map cell by cell, then compares the map with it. */
+static void TileCheck_Load(uint8 k)
+{
+    TileCheck_Sample *s = &samples[k];
+    uint32 refused = VgaTile_GetStats()->refused;
+    uint8 pixels[VGA_TILE_HEIGHT];
+    uint8 row;
+    uint8 col;
+    uint8 r;
+    uint16 x;
+
+    if (k == 0u)
+        TileCheck_Dialog();
+    else if (k == 1u)
+        TileCheck_Page();
+    else
+        TileCheck_Noise();
+    VgaTile_Clear();
+    for (row = 0u; row < VGA_TILE_ROWS; row++)
+    {
+        for (col = 0u; col < VGA_TILE_COLS; col++)
+        {
+            for (r = 0u; r < VGA_TILE_HEIGHT; r++)
+                pixels[r] = sample[(row * VGA_TILE_HEIGHT + r) * VGA_X_BYTES + col];
+            (void)VgaTile_Put(col, row, pixels);
+        }
+    }
+    if (k == 0u)
+    {
+        /* A separator over the buttons, copy on write a pixel at a time */
+        for (x = 180u; x < 620u; x++)
+        {
+            TileCheck_Set(x, 390u, 1u);
+            (void)VgaTile_Pixel(x, 390u, 1u);
+        }
+    }
+
+    TileCheck_Snapshot(screenNow);
+    s->loaded = 1u;
+    s->tiles = VgaTile_GetStats()->tiles;
+    s->refused = VgaTile_GetStats()->refused - refused;
+    s->lostCells = 0u;
+    for (row = 0u; row < VGA_TILE_ROWS; row++)
+    {
+        for (col = 0u; col < VGA_TILE_COLS; col++)
+        {
+            for (r = 0u; r < VGA_TILE_HEIGHT; r++)
+            {
+                uint32 i = (row * VGA_TILE_HEIGHT + r) * VGA_X_BYTES + col;
+
+                if (screenNow[i] != sample[i])
+                {
+                    s->lostCells++;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+static void TileCheck_Frame(const uint8 *scanout)
+{
+    uint32 frame = PSoC5LPVGA_trace.frames;
+    uint16 k;
+
+    TileCheck_Snapshot(screenNow);
+    if (frame > TILE_CHECK_WARMUP)
+    {
+        uint32 wrong = 0u;
+
+        for (k = 0u; k < VideoCtrl_1_V_RES; k++)
+        {
+            const uint8 *expected = (k == 0u)                       ? lineZero
+                                    : (k < TILE_CHECK_EARLY_LINES) ? &screenBefore[k * VGA_X_BYTES]
+                                                                   : &screenNow[k * VGA_X_BYTES];
+
+            if (memcmp(&scanout[k * PSOC5LPVGA_SCANOUT_X_BYTES], expected,
+                       PSOC5LPVGA_SCANOUT_X_BYTES) != 0)
+                wrong++;
+        }
+        checkedFrames++;
+        wrongLines += wrong;
+        if (wrong != 0u)
+            wrongFrames++;
+    }
+    /* Line 0 of the next frame is already expanded, line 1 is next and sees the sample */
+    memcpy(lineZero, screenNow, VGA_X_BYTES);
+    if ((frame % TILE_CHECK_SAMPLE_EVERY) == 0u)
+    {
+        uint32 k = frame / TILE_CHECK_SAMPLE_EVERY - 1u;
+
+        if (k < TILE_CHECK_SAMPLES)
+            TileCheck_Load((uint8)k);
+    }
+    memcpy(screenBefore, screenNow, TILE_CHECK_BYTES);
+}
+
+static void TileCheck_Report(void)
+{
+    const PSoC5LPVGA_Trace *t = &PSoC5LPVGA_trace;
+    uint32 frames = (t->frames != 0u) ? t->frames : 1u;
+#if VGA_STATS
+    uint32 isrCycles = VgaStats_Get()->isrCyclesMax;
+#else
+    uint32 isrCycles = 0u;
+#endif
+    uint8 failed = (uint8)((wrongFrames != 0u) || (t->shortLines != 0u) || (checkedFrames == 0u) ||
+                           (isrCycles >= TILE_CHECK_LINE_CYCLES));
+    uint8 k;
+
+    for (k = 0u; k < TILE_CHECK_SAMPLES; k++)
+    {
+        const TileCheck_Sample *s = &samples[k];
+        uint32 bytes = VGA_TILE_ROWS * VGA_TILE_COLS + (uint32)s->tiles * VGA_TILE_HEIGHT;
+
+        if (!s->loaded)
+            continue;
+        if (s->mustFit && ((s->refused != 0u) || (s->lostCells != 0u)))
+            failed = 1u;
+        printf("sample=%s tiles=%u bytes=%u ratio=%.1f refused=%u lost_cells=%u\n", s->name,
+               (unsigned)s->tiles, (unsigned)bytes, (double)TILE_CHECK_BYTES / bytes,
+               (unsigned)s->refused, (unsigned)s->lostCells);
+    }
+    printf("frames=%u checked_frames=%u wrong_frames=%u wrong_lines=%u short_lines=%u "
+           "scanline_irqs_per_frame=%u tile_bytes=%u frame_bytes=%u isr_cycles_max=%u "
+           "line_cycles=%u\n",
+           (unsigned)t->frames, (unsigned)checkedFrames, (unsigned)wrongFrames,
+           (unsigned)wrongLines, (unsigned)t->shortLines, (unsigned)(t->scanlineIrqs / frames),
+           (unsigned)VgaTile_Size(), (unsigned)TILE_CHECK_BYTES, (unsigned)isrCycles,
+           (unsigned)TILE_CHECK_LINE_CYCLES);
+    exit(failed ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
+int main(int argc, char **argv)
+{
+    uint32 frames = (argc > 1) ? (uint32)strtoul(argv[1], NULL, 0) : TILE_CHECK_FRAMES;
+
+    screenBefore = calloc(1u, TILE_CHECK_BYTES);
+    screenNow = calloc(1u, TILE_CHECK_BYTES);
+    lineZero = calloc(1u, VGA_X_BYTES);
+    sample = calloc(1u, TILE_CHECK_BYTES);
+    if ((screenBefore == NULL) || (screenNow == NULL) || (lineZero == NULL) || (sample == NULL))
+        return EXIT_FAILURE;
+    CyEmu_Init();
+    /* A little past the last visible line of the last frame */
+    PSoC5LPVGA_Init((uint64)((frames != 0u) ? frames : 1u) * TILE_CHECK_FRAME_CYCLES +
+                        TILE_CHECK_FRAME_CYCLES / 2u,
+                    TileCheck_Report);
+    PSoC5LPVGA_SetFrameHook(TileCheck_Frame);
+    return PSoC5LPVGA_main();
+}
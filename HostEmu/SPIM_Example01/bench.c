@@ -0,0 +1,69 @@
+/**
+ * @file
+ * @brief Per-chunk latency benchmark of PSOC_SPI_DMA/SPIM_Example01.cydsn/main.c on the host.
+ *
+ * main.c is compiled unchanged against the emulated components and runs until the requested
+ * number of swCopyStart..swCopyEnd windows (one CopyWith*() call each) has been timed. Built and
+ * run by HostEmu/Makefile (make -C HostEmu spim_bench):
+ *
+ *     spim_bench [chunks [chunk_cycles_max]]
+ *
+ * The last line is a single key=value summary; the exit status is nonzero on a data mismatch,
+ * or when a chunk takes more than chunk_cycles_max bus clocks (no budget when 0 or omitted).
+ */
+#include "project.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/* -Dmain=... renames the firmware entry point; this file provides the real one. */
+#undef main
+
+int SPIM_Example01_main(void);
+
+static uint32 budget;
+
+static void SPIM_Example01_Report(void)
+{
+    const SPIM_Example01_Trace *t = &SPIM_Example01_trace;
+    const CyDmaEmu_ChStats *dma = CyDmaEmu_GetStats(DMA_TX__DRQ_NUMBER);
+    uint64 sum = 0u;
+    uint32 worst = 0u;
+    uint32 i;
+
+    printf("chunk  cpu_cycles  cpu_ns  dma_cycles  dma_ns\n");
+    for (i = 0u; i < t->chunks; i++)
+    {
+        printf("%5u  %10u  %6u  %10u  %6u\n", (unsigned)i, (unsigned)t->chunkCycles[i],
+               (unsigned)CyEmu_CyclesToNs(t->chunkCycles[i]), (unsigned)t->dmaCycles[i],
+               (unsigned)CyEmu_CyclesToNs(t->dmaCycles[i]));
+        sum += t->chunkCycles[i];
+        if (t->chunkCycles[i] > worst)
+            worst = t->chunkCycles[i];
+    }
+
+    printf("chunks=%u chunk_cycles_avg=%u chunk_cycles_max=%u chunk_ns_avg=%u "
+           "dma_requests=%u dma_bursts=%u dma_spoke=%u dma_bytes=%u dma_cycles=%u "
+           "dma_dropped=%u dma_finish=%u mismatches=%u\n",
+           (unsigned)t->chunks, (unsigned)(t->chunks ? sum / t->chunks : 0u), (unsigned)worst,
+           (unsigned)CyEmu_CyclesToNs(t->chunks ? sum / t->chunks : 0u),
+           (unsigned)dma->requests, (unsigned)dma->bursts, (unsigned)dma->spokeTransactions,
+           (unsigned)dma->bytes, (unsigned)dma->busCycles, (unsigned)dma->droppedRequests,
+           (unsigned)t->dmaFinish, (unsigned)t->mismatches);
+    if ((budget != 0u) && (worst > budget))
+        fprintf(stderr, "chunk_cycles_max %u is over the budget of %u\n", (unsigned)worst,
+                (unsigned)budget);
+    exit(((t->mismatches == 0u) && ((budget == 0u) || (worst <= budget))) ? EXIT_SUCCESS
+                                                                           : EXIT_FAILURE);
+}
+
+int main(int argc, char **argv)
+{
+    uint32 chunks = (argc > 1) ? (uint32)strtoul(argv[1], NULL, 0) : 16u;
+
+    budget = (argc > 2) ? (uint32)strtoul(argv[2], NULL, 0) : 0u;
+
+    CyEmu_Init();
+    SPIM_Example01_Init((chunks != 0u) ? chunks : 1u, SPIM_Example01_Report);
+    return SPIM_Example01_main();
+}
@@ -0,0 +1,90 @@
+/**
+ * @file
+ * @brief Emulated component instances of PSOC_SPI_DMA/SPIM_Example01.cydsn.
+ */
+#include "project.h"
+
+#include <string.h>
+
+SPIM_Example01_Trace SPIM_Example01_trace;
+
+static uint32 spimExampleChunkLimit;
+static void (*spimExampleOnLimit)(void);
+static uint64 spimExampleWindowStart;
+static uint8 spimExampleInWindow;
+static uint32 spimExampleWindowDma;
+
+/**
+ * @brief dmaFinishIrq pin: counts completions and checks that the TD copied what it described.
+ */
+static void SPIM_Example01_DmaFinish(uint8 chHandle, uint8 tdHandle, uint8 termout)
+{
+    uint16 count;
+    uint8 next;
+    uint8 flags;
+    uint16 src;
+    uint16 dst;
+    const dmac_cfgmem *cfg = &CY_DMA_CFGMEM_STRUCT_PTR[chHandle];
+
+    (void)termout;
+    SPIM_Example01_trace.dmaFinish++;
+
+    (void)CyDmaTdGetConfiguration(tdHandle, &count, &next, &flags);
+    (void)CyDmaTdGetAddress(tdHandle, &src, &dst);
+    if ((flags & (TD_INC_SRC_ADR | TD_INC_DST_ADR)) == (TD_INC_SRC_ADR | TD_INC_DST_ADR))
+    {
+        uint32 srcAddr = CyDmaEmu_Address(CY_GET_REG16(&cfg->CFG1[0]), src);
+        uint32 dstAddr = CyDmaEmu_Address(CY_GET_REG16(&cfg->CFG1[2]), dst);
+
+        if (memcmp(CyEmu_Ptr(srcAddr), CyEmu_Ptr(dstAddr), count) != 0)
+            SPIM_Example01_trace.mismatches++;
+    }
+}
+
+/**
+ * @brief Arms the trace; @p onLimit runs once @p chunkLimit copy windows were timed.
+ */
+void SPIM_Example01_Init(uint32 chunkLimit, void (*onLimit)(void))
+{
+    memset(&SPIM_Example01_trace, 0, sizeof(SPIM_Example01_trace));
+    spimExampleChunkLimit =
+        (chunkLimit > SPIM_EXAMPLE01_MAX_CHUNKS) ? SPIM_EXAMPLE01_MAX_CHUNKS : chunkLimit;
+    spimExampleOnLimit = onLimit;
+    spimExampleInWindow = 0u;
+    CyDmaEmu_Reset();
+    CyDmaEmu_SetTermoutHandler(DMA_TX__DRQ_NUMBER, SPIM_Example01_DmaFinish);
+}
+
+/**
+ * @brief Control register write: DRQ on the rising edge of bit 0, copy window on bits 6/7.
+ */
+void Control_Reg_1_Write(uint8 control)
+{
+    uint8 previous = Control_Reg_1_Control;
+
+    CyEmu_Spend(CYEMU_CPU_CONTROL_REG_WRITE);
+    Control_Reg_1_Control = control;
+
+    if ((control & 0x01u) && ((previous & 0x01u) == 0u))
+        spimExampleWindowDma += CyDmaEmu_Request(DMA_TX__DRQ_NUMBER);
+
+    if ((control & 0x40u) && (spimExampleInWindow == 0u))
+    {
+        spimExampleInWindow = 1u;
+        spimExampleWindowStart = CyEmu_Now();
+        spimExampleWindowDma = 0u;
+    }
+    else if ((control & 0x80u) && spimExampleInWindow)
+    {
+        uint32 n = SPIM_Example01_trace.chunks;
+
+        spimExampleInWindow = 0u;
+        SPIM_Example01_trace.chunkCycles[n] = (uint32)(CyEmu_Now() - spimExampleWindowStart);
+        SPIM_Example01_trace.dmaCycles[n] = spimExampleWindowDma;
+        SPIM_Example01_trace.chunks = n + 1u;
+        if ((SPIM_Example01_trace.chunks >= spimExampleChunkLimit) && (spimExampleOnLimit != NULL))
+            spimExampleOnLimit();
+    }
+}
+
+uint8 Control_Reg_1_Read(void) { return Control_Reg_1_Control; }
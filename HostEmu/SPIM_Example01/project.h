@@ -0,0 +1,47 @@
+/**
+ * @file
+ * @brief Host replacement for the generated project.h of PSOC_SPI_DMA/SPIM_Example01.cydsn.
+ *
+ * Declares the component instances main.c uses, wired as in TopDesign.cysch:
+ * - Control_Reg_1 bit 0 drives the DMA_TX request (rising edge), bit 6 the swCopyStart pin and
+ *   bit 7 the swCopyEnd pin used to time the copies on a scope;
+ * - DMA_TX TERMOUT0 drives the dmaFinishIrq pin.
+ */
+#ifndef PROJECT_H
+#define PROJECT_H
+
+#include "CyDmac.h"
+#include "CyEmu.h"
+#include "CyLib.h"
+#include "cytypes.h"
+
+/* DMA_TX */
+#define DMA_TX__DRQ_NUMBER (0u)
+#define DMA_TX__TD_TERMOUT_EN (TD_TERMOUT0_EN)
+#define DMA_TX_DmaInitialize(BurstCount, ReqestPerBurst, UpperSrcAddress, UpperDestAddress)       \
+    CyDmaEmu_DmaInitialize(DMA_TX__DRQ_NUMBER, (BurstCount), (ReqestPerBurst),                    \
+                           (UpperSrcAddress), (UpperDestAddress))
+
+/* Control_Reg_1 */
+#define Control_Reg_1_Control_PTR ((reg8 *)(uintptr_t)(CYDEV_UDB_BASE + 0x75u))
+#define Control_Reg_1_Control (*Control_Reg_1_Control_PTR)
+void Control_Reg_1_Write(uint8 control);
+uint8 Control_Reg_1_Read(void);
+
+/* Host harness hooks */
+#define SPIM_EXAMPLE01_MAX_CHUNKS (1024u)
+
+typedef struct
+{
+    uint32 chunks;                                /**< completed swCopyStart..swCopyEnd windows */
+    uint32 chunkCycles[SPIM_EXAMPLE01_MAX_CHUNKS]; /**< CPU bus clocks per window */
+    uint32 dmaCycles[SPIM_EXAMPLE01_MAX_CHUNKS];   /**< DMAC bus clocks of the window's request */
+    uint32 dmaFinish;                             /**< dmaFinishIrq pulses */
+    uint32 mismatches;                            /**< TDs whose destination != source */
+} SPIM_Example01_Trace;
+
+extern SPIM_Example01_Trace SPIM_Example01_trace;
+
+void SPIM_Example01_Init(uint32 chunkLimit, void (*onLimit)(void));
+
+#endif /* PROJECT_H */
@@ -0,0 +1,183 @@
+/**
+ * @file
+ * @brief SPIM loopback throughput and latency of the DMA setup in PSOC_SPI_DMA_Original main.c.
+ *
+ * DmaTxConfiguration() and DmaRxConfiguration() run as written against the SPIM FIFO model of
+ * SpimEmu.h (4-byte FIFOs, DMA requests on TX not full / RX not empty, MISO looped back from
+ * MOSI). Each transfer is started the way main() starts it, both channels enabled with
+ * STORE_TD_CFG_ONCMPLT, RX first, and is done when the RX TD has put the last byte into
+ * rxBuffer. The next transfer starts as soon as a poll sees that, so the numbers are those of
+ * the TD layout and not of main()'s 1 ms restart period (which, as written, never re-enables
+ * DMA_RX: past the first transfer the RX FIFO overflows).
+ *
+ * The bit rate is swept at run time. Buffer size and burst sizes are main.c's BUFFER_SIZE,
+ * DMA_TX_BYTES_PER_BURST and DMA_RX_BYTES_PER_BURST, set per build. Built and run by
+ * HostEmu/Makefile (make -C HostEmu check) once per buffer size, spim_loopback_8 to
+ * spim_loopback_4095, with single-byte bursts; other bursts build the same way with
+ * -DDMA_TX_BYTES_PER_BURST / -DDMA_RX_BYTES_PER_BURST:
+ *
+ *     spim_loopback_<size> [transfers]
+ *
+ * One key=value line per bit rate:
+ * - bytes_per_s: buffer bytes moved per second over back-to-back transfers, restart included;
+ * - link_permille: share of that time SCLK was running;
+ * - tx_starved: times the TX FIFO ran dry while DMA_TX still had bytes to send;
+ * - tx_overflows, rx_overflows, rx_underflows: bytes the FIFOs lost or a burst read from an empty
+ *   RX FIFO, i.e. bursts larger than the space or data the request level guarantees;
+ * - latency_ns_*: from the first CyDmaChEnable() to the last byte in rxBuffer;
+ * - stalled: 1 when a transfer never completed (bytes lost on the way), the rate stops there.
+ *
+ * The process exits nonzero when any rate stalled or received data differs from txBuffer.
+ */
+#include "project.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* -Dmain=... renames the firmware entry point; this file provides the real one. */
+#undef main
+
+/* Defaults of main.c, for a build without overrides */
+#ifndef BUFFER_SIZE
+#define BUFFER_SIZE (8u)
+#endif
+#ifndef DMA_TX_BYTES_PER_BURST
+#define DMA_TX_BYTES_PER_BURST (1u)
+#endif
+#ifndef DMA_RX_BYTES_PER_BURST
+#define DMA_RX_BYTES_PER_BURST (1u)
+#endif
+
+#define LOOPBACK_PRESERVE_TDS (1u)   /**< STORE_TD_CFG_ONCMPLT of main.c */
+#define LOOPBACK_POLL_CYCLES (16u)   /**< one completion poll: call, status load, test, estimate */
+#define LOOPBACK_TRANSFERS (16u)
+#define LOOPBACK_TIMEOUT_SLACK (64000u) /**< 1 ms on top of four times the wire time */
+
+/* main.c, built with SPIM_STREAMING 0 */
+extern uint8 txChannel;
+extern uint8 rxChannel;
+extern uint8 txBuffer[BUFFER_SIZE];
+extern uint8 rxBuffer[BUFFER_SIZE];
+void DmaTxConfiguration(void);
+void DmaRxConfiguration(void);
+
+static const uint32 loopbackBitRates[] = {500000u,  1000000u,  2000000u, 4000000u,
+                                          8000000u, 16000000u, 24000000u};
+
+typedef struct
+{
+    uint32 transfers;
+    uint32 stalled;
+    uint32 mismatches;
+    uint64 bytesPerS;
+    uint32 linkPermille;
+    uint64 latencyMin;
+    uint64 latencyMax;
+    uint64 latencySum;
+} Loopback_Result;
+
+/* Runs @p transfers back-to-back transfers at @p bitRate on a fresh emulator. */
+static void Loopback_Run(uint32 bitRate, uint32 transfers, Loopback_Result *r)
+{
+    const SpimEmu_Stats *spi = &SPIM_Example01_spim.stats;
+    const CyDmaEmu_ChStats *rxStats;
+    uint64 timeout;
+    uint64 first;
+    uint32 i;
+
+    memset(r, 0, sizeof(*r));
+    r->latencyMin = CYEMU_NEVER;
+    CyEmu_Init();
+    SPIM_Example01_Init(0u, NULL);
+    SpimEmu_SetBitRate(&SPIM_Example01_spim, bitRate);
+    timeout = 4u * (uint64)BUFFER_SIZE * SPIM_Example01_spim.byteCycles + LOOPBACK_TIMEOUT_SLACK;
+
+    /* Past the eight bytes main.c initialises, a pattern that shows lost or repeated bytes */
+    for (i = 8u; i < BUFFER_SIZE; i++)
+        txBuffer[i] = (uint8)(i * 13u + (i >> 8) + 1u);
+
+    DmaTxConfiguration();
+    DmaRxConfiguration();
+    SPIM_Start();
+    rxStats = CyDmaEmu_GetStats(rxChannel);
+
+    first = CyEmu_Now();
+    for (i = 0u; i < transfers; i++)
+    {
+        uint64 start = CyEmu_Now();
+        uint32 done = rxStats->tdsCompleted;
+        uint64 latency;
+        uint32 k;
+
+        memset(rxBuffer, 0, sizeof(rxBuffer));
+        (void)CyDmaChEnable(rxChannel, LOOPBACK_PRESERVE_TDS);
+        (void)CyDmaChEnable(txChannel, LOOPBACK_PRESERVE_TDS);
+        while ((rxStats->tdsCompleted == done) && (CyEmu_Now() - start < timeout))
+            CyEmu_Spend(LOOPBACK_POLL_CYCLES);
+        if (rxStats->tdsCompleted == done)
+        {
+            r->stalled = 1u;
+            break;
+        }
+
+        latency = rxStats->lastTdDoneAt - start;
+        r->latencySum += latency;
+        if (latency < r->latencyMin)
+            r->latencyMin = latency;
+        if (latency > r->latencyMax)
+            r->latencyMax = latency;
+        for (k = 0u; k < BUFFER_SIZE; k++)
+        {
+            if (rxBuffer[k] != txBuffer[k])
+                r->mismatches++;
+        }
+        r->transfers++;
+    }
+
+    /* A TD that completed early leaves bytes on the wire, they count towards the link time */
+    while (!SpimEmu_IsIdle(&SPIM_Example01_spim) && !r->stalled)
+        CyEmu_Spend(LOOPBACK_POLL_CYCLES);
+    if (r->transfers != 0u)
+    {
+        uint64 span = CyEmu_Now() - first;
+
+        r->bytesPerS = (uint64)r->transfers * BUFFER_SIZE * CYEMU_BUS_CLK_HZ / span;
+        r->linkPermille = (uint32)(spi->busyCycles * 1000u / span);
+    }
+    else
+    {
+        r->latencyMin = 0u;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    uint32 transfers = (argc > 1) ? (uint32)strtoul(argv[1], NULL, 0) : LOOPBACK_TRANSFERS;
+    uint8 failed = 0u;
+    uint8 i;
+
+    if (transfers == 0u)
+        transfers = 1u;
+    for (i = 0u; i < (uint8)(sizeof(loopbackBitRates) / sizeof(loopbackBitRates[0])); i++)
+    {
+        const SpimEmu_Stats *spi = &SPIM_Example01_spim.stats;
+        Loopback_Result r;
+
+        Loopback_Run(loopbackBitRates[i], transfers, &r);
+        if (r.stalled || (r.mismatches != 0u))
+            failed = 1u;
+        printf("bit_rate=%u buffer=%u burst_tx=%u burst_rx=%u transfers=%u bytes_per_s=%u "
+               "link_permille=%u tx_starved=%u tx_overflows=%u rx_overflows=%u rx_underflows=%u "
+               "latency_ns_min=%u latency_ns_avg=%u latency_ns_max=%u stalled=%u mismatches=%u\n",
+               (unsigned)loopbackBitRates[i], (unsigned)BUFFER_SIZE,
+               (unsigned)DMA_TX_BYTES_PER_BURST, (unsigned)DMA_RX_BYTES_PER_BURST,
+               (unsigned)r.transfers, (unsigned)r.bytesPerS, (unsigned)r.linkPermille,
+               (unsigned)spi->txStarved, (unsigned)spi->txOverflows, (unsigned)spi->rxOverflows,
+               (unsigned)spi->rxUnderflows, (unsigned)CyEmu_CyclesToNs(r.latencyMin),
+               (unsigned)CyEmu_CyclesToNs((r.transfers != 0u) ? r.latencySum / r.transfers : 0u),
+               (unsigned)CyEmu_CyclesToNs(r.latencyMax), (unsigned)r.stalled,
+               (unsigned)r.mismatches);
+    }
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
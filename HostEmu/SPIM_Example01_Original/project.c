@@ -0,0 +1,143 @@
+/**
+ * @file
+ * @brief Emulated component instances of PSOC_SPI_DMA_Original/SPIM_Example01.cydsn.
+ */
+#include "project.h"
+
+#include <string.h>
+
+#define SPIM_EXAMPLE01_MOSI_LOG (8192u) /**< > one RX TD plus the bytes in flight */
+
+SPIM_Example01_Trace SPIM_Example01_trace;
+SpimEmu SPIM_Example01_spim;
+
+static cyisraddress isrTxDoneVector;
+static cyisraddress isrRxDoneVector;
+
+static uint8 ssReg = 0xFFu;
+static void (*ssHook)(uint8 control);
+
+static uint8 mosiLog[SPIM_EXAMPLE01_MOSI_LOG];
+static uint32 mosiLogHead;
+static uint32 mosiLogCount;
+
+static uint64 spimExampleDeadline;
+static void (*spimExampleOnLimit)(void);
+
+/** @brief MISO looped back from MOSI; every byte is logged for the RX check. */
+static uint8 SPIM_Example01_Loopback(void *context, uint8 mosi)
+{
+    (void)context;
+    mosiLog[(mosiLogHead + mosiLogCount) % SPIM_EXAMPLE01_MOSI_LOG] = mosi;
+    if (mosiLogCount < SPIM_EXAMPLE01_MOSI_LOG)
+        mosiLogCount++;
+    else
+        mosiLogHead = (mosiLogHead + 1u) % SPIM_EXAMPLE01_MOSI_LOG;
+    return mosi;
+}
+
+/** @brief DMA_TX nrq. */
+static void SPIM_Example01_TxDone(uint8 chHandle, uint8 tdHandle, uint8 termout)
+{
+    (void)chHandle;
+    (void)tdHandle;
+    (void)termout;
+    CyEmu_Interrupt(isrTxDoneVector);
+}
+
+/**
+ * @brief DMA_RX nrq: checks the half the TD wrote against the bytes that went out on MOSI.
+ *
+ * The check only applies to the loopback; with another slave model the nrq is just forwarded.
+ */
+static void SPIM_Example01_RxDone(uint8 chHandle, uint8 tdHandle, uint8 termout)
+{
+    const dmac_cfgmem *cfg = &CY_DMA_CFGMEM_STRUCT_PTR[chHandle];
+    const uint8 *dst;
+    uint16 count;
+    uint16 src;
+    uint16 dstLo;
+    uint16 i;
+
+    (void)termout;
+    (void)CyDmaTdGetConfiguration(tdHandle, &count, NULL, NULL);
+    (void)CyDmaTdGetAddress(tdHandle, &src, &dstLo);
+    dst = (const uint8 *)CyEmu_Ptr(CyDmaEmu_Address(CY_GET_REG16(&cfg->CFG1[2]), dstLo));
+
+    if (SPIM_Example01_spim.exchange != SPIM_Example01_Loopback)
+    {
+        CyEmu_Interrupt(isrRxDoneVector);
+        return;
+    }
+    SPIM_Example01_trace.rxTds++;
+    for (i = 0u; i < count; i++)
+    {
+        if ((mosiLogCount == 0u) || (dst[i] != mosiLog[mosiLogHead]))
+            SPIM_Example01_trace.mismatches++;
+        if (mosiLogCount != 0u)
+        {
+            mosiLogHead = (mosiLogHead + 1u) % SPIM_EXAMPLE01_MOSI_LOG;
+            mosiLogCount--;
+        }
+    }
+    CyEmu_Interrupt(isrRxDoneVector);
+}
+
+/* Ends the run once the emulated time is up. */
+static uint64 SPIM_Example01_Deadline(void *component, uint64 now)
+{
+    (void)component;
+    if (now < spimExampleDeadline)
+        return spimExampleDeadline;
+    if (spimExampleOnLimit != NULL)
+        spimExampleOnLimit();
+    return CYEMU_NEVER;
+}
+
+/**
+ * @brief Wires the components; @p onLimit runs once @p runCycles bus clocks have passed.
+ */
+void SPIM_Example01_Init(uint64 runCycles, void (*onLimit)(void))
+{
+    memset(&SPIM_Example01_trace, 0, sizeof(SPIM_Example01_trace));
+    mosiLogHead = 0u;
+    mosiLogCount = 0u;
+    isrTxDoneVector = NULL;
+    isrRxDoneVector = NULL;
+    spimExampleDeadline = CyEmu_Now() + runCycles;
+    spimExampleOnLimit = onLimit;
+    ssReg = 0xFFu;
+    ssHook = NULL;
+
+    CyDmaEmu_Reset();
+    CyDmaEmu_SetTermoutHandler(DMA_TX__DRQ_NUMBER, SPIM_Example01_TxDone);
+    CyDmaEmu_SetTermoutHandler(DMA_RX__DRQ_NUMBER, SPIM_Example01_RxDone);
+    SpimEmu_Init(&SPIM_Example01_spim, (uint32)SPIM_TXDATA_PTR, (uint32)SPIM_RXDATA_PTR,
+                 DMA_TX__DRQ_NUMBER, DMA_RX__DRQ_NUMBER, SPIM_BIT_RATE);
+    SpimEmu_SetExchange(&SPIM_Example01_spim, SPIM_Example01_Loopback, NULL);
+    CyEmu_Attach(SPIM_Example01_Deadline, NULL);
+}
+
+void SPIM_Start(void) { SpimEmu_Enable(&SPIM_Example01_spim); }
+
+void SPIM_Stop(void) { SpimEmu_Disable(&SPIM_Example01_spim); }
+
+void isr_TxDone_StartEx(cyisraddress address) { isrTxDoneVector = address; }
+
+void isr_TxDone_Stop(void) { isrTxDoneVector = NULL; }
+
+void isr_RxDone_StartEx(cyisraddress address) { isrRxDoneVector = address; }
+
+void isr_RxDone_Stop(void) { isrRxDoneVector = NULL; }
+
+/** @brief Observes every SS_Reg write, e.g. to frame a slave model; NULL for none. */
+void SPIM_Example01_SetSsHook(void (*onWrite)(uint8 control)) { ssHook = onWrite; }
+
+void SS_Reg_Write(uint8 control)
+{
+    ssReg = control;
+    if (ssHook != NULL)
+        ssHook(control);
+}
+
+uint8 SS_Reg_Read(void) { return ssReg; }
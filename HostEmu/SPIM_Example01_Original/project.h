@@ -0,0 +1,65 @@
+/**
+ * @file
+ * @brief Host replacement for the generated project.h of PSOC_SPI_DMA_Original/SPIM_Example01.
+ *
+ * Declares the component instances main.c and SpimStream.c use, wired as in TopDesign.cysch plus
+ * the two isr components SpimStream.h asks for:
+ * - SPIM at 1 Mbps, tx_interrupt on the DMA_TX drq, rx_interrupt on the DMA_RX drq, MISO looped
+ *   back from MOSI;
+ * - DMA_TX nrq on isr_TxDone, DMA_RX nrq on isr_RxDone;
+ * - SS_Reg, the control register SpimQueue.h selects slaves with.
+ */
+#ifndef PROJECT_H
+#define PROJECT_H
+
+#include "CyDmac.h"
+#include "CyEmu.h"
+#include "CyLib.h"
+#include "SpimEmu.h"
+#include "cytypes.h"
+
+/* SPIM */
+#define SPIM_BIT_RATE (1000000u)
+#define SPIM_TXDATA_PTR ((reg8 *)(uintptr_t)(CYDEV_UDB_BASE + 0x40u))
+#define SPIM_RXDATA_PTR ((reg8 *)(uintptr_t)(CYDEV_UDB_BASE + 0x50u))
+void SPIM_Start(void);
+void SPIM_Stop(void);
+
+/* DMA_TX */
+#define DMA_TX__DRQ_NUMBER (0u)
+#define DMA_TX__TD_TERMOUT_EN (TD_TERMOUT0_EN)
+#define DMA_TX_DmaInitialize(BurstCount, ReqestPerBurst, UpperSrcAddress, UpperDestAddress)       \
+    CyDmaEmu_DmaInitialize(DMA_TX__DRQ_NUMBER, (BurstCount), (ReqestPerBurst),                    \
+                           (UpperSrcAddress), (UpperDestAddress))
+
+/* DMA_RX */
+#define DMA_RX__DRQ_NUMBER (1u)
+#define DMA_RX__TD_TERMOUT_EN (TD_TERMOUT0_EN)
+#define DMA_RX_DmaInitialize(BurstCount, ReqestPerBurst, UpperSrcAddress, UpperDestAddress)       \
+    CyDmaEmu_DmaInitialize(DMA_RX__DRQ_NUMBER, (BurstCount), (ReqestPerBurst),                    \
+                           (UpperSrcAddress), (UpperDestAddress))
+
+/* isr_TxDone, isr_RxDone */
+void isr_TxDone_StartEx(cyisraddress address);
+void isr_TxDone_Stop(void);
+void isr_RxDone_StartEx(cyisraddress address);
+void isr_RxDone_Stop(void);
+
+/* SS_Reg */
+void SS_Reg_Write(uint8 control);
+uint8 SS_Reg_Read(void);
+
+/* Host harness hooks */
+typedef struct
+{
+    uint32 rxTds;      /**< completed RX TDs with TERMOUT, checked against MOSI */
+    uint32 mismatches; /**< received bytes that differ from what went out on MOSI */
+} SPIM_Example01_Trace;
+
+extern SPIM_Example01_Trace SPIM_Example01_trace;
+extern SpimEmu SPIM_Example01_spim;
+
+void SPIM_Example01_Init(uint64 runCycles, void (*onLimit)(void));
+void SPIM_Example01_SetSsHook(void (*onWrite)(uint8 control));
+
+#endif /* PROJECT_H */
@@ -0,0 +1,449 @@
+/**
+ * @file
+ * @brief Checks PSOC_SPI_DMA_Original/SPIM_Example01.cydsn/SpimQueue.c against two slave models.
+ *
+ * SpimQueue.c is compiled unchanged against the emulated SPIM, DMAC and SS_Reg. Device 0 is a
+ * register file (command byte: bit 7 read, bits 6..0 address, auto-increment), device 1 an 8 KB
+ * serial memory (0x02 write / 0x03 read, 16-bit big-endian address). Both are framed by their
+ * SS_Reg output. Built and run by HostEmu/Makefile (make -C HostEmu spim_queue):
+ *
+ *     spim_queue
+ *
+ * The last line is a key=value summary; the process exits nonzero when data read back differs
+ * from what was written, a transaction completes out of order or not at all, slave select moves
+ * while the SPIM is busy, the link idles inside a transaction, or TDs leak.
+ */
+#include "project.h"
+
+#include "../../PSOC_SPI_DMA_Original/SPIM_Example01.cydsn/SpimQueue.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define QUEUECHECK_REGFILE (0u)      /**< SS_Reg output of the register file */
+#define QUEUECHECK_MEMORY (1u)       /**< SS_Reg output of the serial memory */
+#define QUEUECHECK_MEMORY_SIZE (8192u)
+#define QUEUECHECK_BIG (5000u)       /**< > SPIM_QUEUE_MAX_TD_LENGTH, takes two TDs */
+#define QUEUECHECK_STRESS_ROUNDS (200u)
+#define QUEUECHECK_MAX_BATCH (6u)
+#define QUEUECHECK_RUN_MS (2000u)
+
+/* Slave models, framed by SS_Reg */
+typedef struct
+{
+    uint8 selected;
+    uint32 index; /* byte within the current selection */
+    uint8 command;
+    uint16 address;
+} QueueCheck_Slave;
+
+static uint8 regFile[128];
+static uint8 memory[QUEUECHECK_MEMORY_SIZE];
+static QueueCheck_Slave slaves[2];
+static uint32 ssViolations;
+static uint32 multiSelects;
+
+/* Application side: transactions, segments and buffers live in SRAM until DONE */
+static SpimQueue_Txn txns[QUEUECHECK_MAX_BATCH];
+static SpimQueue_Segment segments[QUEUECHECK_MAX_BATCH][2];
+static uint8 headers[QUEUECHECK_MAX_BATCH][3];
+static uint8 payloads[QUEUECHECK_MAX_BATCH][64];
+static uint8 bigOut[QUEUECHECK_BIG];
+static uint8 bigIn[QUEUECHECK_BIG];
+static SpimQueue_Segment tooMany[70];
+
+/* Host-side expectations */
+static uint8 regShadow[128];
+static uint8 memShadow[QUEUECHECK_MEMORY_SIZE];
+static uint32 doneOrder[QUEUECHECK_MAX_BATCH];
+static uint32 doneCount;
+static uint32 transactions;
+static uint32 dataErrors;
+static uint32 orderErrors;
+static uint32 failures;
+
+static uint32 rngState = 0x2545F491u;
+
+static uint32 QueueCheck_Random(uint32 range)
+{
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return rngState % range;
+}
+
+/** @brief Register file: command byte, then data to or from consecutive registers. */
+static uint8 QueueCheck_RegFile(QueueCheck_Slave *slave, uint8 mosi)
+{
+    uint8 miso = 0u;
+
+    if (slave->index == 0u)
+    {
+        slave->command = mosi;
+        slave->address = (uint16)(mosi & 0x7Fu);
+    }
+    else
+    {
+        if (slave->command & 0x80u)
+            miso = regFile[slave->address];
+        else
+            regFile[slave->address] = mosi;
+        slave->address = (uint16)((slave->address + 1u) & 0x7Fu);
+    }
+    return miso;
+}
+
+/** @brief Serial memory: opcode, address high, address low, then data. */
+static uint8 QueueCheck_Memory(QueueCheck_Slave *slave, uint8 mosi)
+{
+    uint8 miso = 0xFFu;
+
+    if (slave->index == 0u)
+        slave->command = mosi;
+    else if (slave->index == 1u)
+        slave->address = (uint16)(mosi << 8);
+    else if (slave->index == 2u)
+        slave->address = (uint16)((slave->address | mosi) % QUEUECHECK_MEMORY_SIZE);
+    else
+    {
+        if (slave->command == 0x03u)
+            miso = memory[slave->address];
+        else if (slave->command == 0x02u)
+            memory[slave->address] = mosi;
+        slave->address = (uint16)((slave->address + 1u) % QUEUECHECK_MEMORY_SIZE);
+    }
+    return miso;
+}
+
+/** @brief SpimEmu_ExchangeFn: the selected slave answers, MISO floats high with none. */
+static uint8 QueueCheck_Exchange(void *context, uint8 mosi)
+{
+    uint8 miso = 0xFFu;
+
+    (void)context;
+    if (slaves[QUEUECHECK_REGFILE].selected)
+        miso = QueueCheck_RegFile(&slaves[QUEUECHECK_REGFILE], mosi);
+    else if (slaves[QUEUECHECK_MEMORY].selected)
+        miso = QueueCheck_Memory(&slaves[QUEUECHECK_MEMORY], mosi);
+    slaves[QUEUECHECK_REGFILE].index++;
+    slaves[QUEUECHECK_MEMORY].index++;
+    return miso;
+}
+
+/** @brief SS_Reg hook: slave select must only move between bytes, with the SPIM idle. */
+static void QueueCheck_SsWrite(uint8 control)
+{
+    uint8 i;
+
+    if (!SpimEmu_IsIdle(&SPIM_Example01_spim))
+        ssViolations++;
+    if ((uint8)~control & (uint8)(~control - 1u))
+        multiSelects++;
+    for (i = 0u; i < 2u; i++)
+    {
+        uint8 selected = (uint8)(((control >> i) & 1u) == 0u);
+
+        if (selected && !slaves[i].selected)
+            slaves[i].index = 0u;
+        slaves[i].selected = selected;
+    }
+}
+
+static void QueueCheck_Done(SpimQueue_Txn *txn)
+{
+    uint32 slot = (uint32)(txn - txns);
+
+    if (doneCount < QUEUECHECK_MAX_BATCH)
+        doneOrder[doneCount] = slot;
+    doneCount++;
+}
+
+static void QueueCheck_Timeout(void)
+{
+    printf("timeout: queue not idle after %u ms, completed=%u\n", (unsigned)QUEUECHECK_RUN_MS,
+           (unsigned)SpimQueue_Completed());
+    exit(EXIT_FAILURE);
+}
+
+/* Sleeps until every submitted transaction completed. */
+static void QueueCheck_WaitIdle(void)
+{
+    uint8 intState = CyEnterCriticalSection();
+
+    while (!SpimQueue_Idle())
+    {
+        __WFI();
+        CyExitCriticalSection(intState);
+        intState = CyEnterCriticalSection();
+    }
+    CyExitCriticalSection(intState);
+}
+
+/* Fills slot @p i with a transaction of one header segment and one payload segment. */
+static void QueueCheck_Set(uint8 i, uint8 device, const uint8 *tx, uint8 *rx, uint16 length)
+{
+    segments[i][0].tx = headers[i];
+    segments[i][0].rx = NULL;
+    segments[i][0].length = (uint16)((device == QUEUECHECK_REGFILE) ? 1u : 3u);
+    segments[i][1].tx = tx;
+    segments[i][1].rx = rx;
+    segments[i][1].length = length;
+    txns[i].device = device;
+    txns[i].segments = segments[i];
+    txns[i].segmentCount = 2u;
+    txns[i].onDone = QueueCheck_Done;
+    txns[i].status = SPIM_QUEUE_IDLE;
+}
+
+static void QueueCheck_SetRegFile(uint8 i, uint8 read, uint8 address, uint16 length)
+{
+    headers[i][0] = (uint8)((read ? 0x80u : 0u) | (address & 0x7Fu));
+    QueueCheck_Set(i, QUEUECHECK_REGFILE, read ? NULL : payloads[i], read ? payloads[i] : NULL,
+                   length);
+}
+
+static void QueueCheck_SetMemory(uint8 i, uint8 read, uint16 address, const uint8 *tx, uint8 *rx,
+                                 uint16 length)
+{
+    headers[i][0] = read ? 0x03u : 0x02u;
+    headers[i][1] = HI8(address);
+    headers[i][2] = LO8(address);
+    QueueCheck_Set(i, QUEUECHECK_MEMORY, tx, rx, length);
+}
+
+/* Submits slots 0..count-1 in one batch and waits for all of them. */
+static void QueueCheck_Run(uint8 count)
+{
+    uint8 i;
+
+    doneCount = 0u;
+    if (SpimQueue_Submit(txns, count) != CYRET_SUCCESS)
+    {
+        failures++;
+        return;
+    }
+    transactions += count;
+    QueueCheck_WaitIdle();
+    for (i = 0u; i < count; i++)
+    {
+        if ((txns[i].status != SPIM_QUEUE_DONE) || (doneOrder[i] != i))
+            orderErrors++;
+    }
+    if (doneCount != count)
+        orderErrors++;
+}
+
+static void QueueCheck_Compare(const uint8 *got, const uint8 *expected, uint32 length)
+{
+    uint32 k;
+
+    for (k = 0u; k < length; k++)
+    {
+        if (got[k] != expected[k])
+            dataErrors++;
+    }
+}
+
+/* Register write then read back, in one batch. */
+static void QueueCheck_RegFileRoundTrip(void)
+{
+    uint8 k;
+
+    QueueCheck_SetRegFile(0u, 0u, 0x10u, 16u);
+    for (k = 0u; k < 16u; k++)
+        payloads[0][k] = (uint8)(0xA0u + k);
+    QueueCheck_SetRegFile(1u, 1u, 0x10u, 16u);
+    memset(payloads[1], 0, 16u);
+    QueueCheck_Run(2u);
+    QueueCheck_Compare(payloads[1], payloads[0], 16u);
+    QueueCheck_Compare(&regFile[0x10], payloads[0], 16u);
+}
+
+/* A payload longer than one TD, written and read back. */
+static void QueueCheck_BigRoundTrip(void)
+{
+    uint32 k;
+
+    for (k = 0u; k < QUEUECHECK_BIG; k++)
+        bigOut[k] = (uint8)(k * 7u + (k >> 8));
+    memset(bigIn, 0, sizeof(bigIn));
+    QueueCheck_SetMemory(0u, 0u, 0x0100u, bigOut, NULL, QUEUECHECK_BIG);
+    QueueCheck_SetMemory(1u, 1u, 0x0100u, NULL, bigIn, QUEUECHECK_BIG);
+    QueueCheck_Run(2u);
+    QueueCheck_Compare(bigIn, bigOut, QUEUECHECK_BIG);
+    for (k = 0u; k < QUEUECHECK_BIG; k++)
+        memShadow[(0x0100u + k) % QUEUECHECK_MEMORY_SIZE] = bigOut[k];
+}
+
+/* Batches that fail validation or TD allocation must leave the pool as it was. */
+static void QueueCheck_Rejects(void)
+{
+    uint8 freeTds = CyDmaTdFreeCount();
+    uint8 k;
+
+    QueueCheck_SetRegFile(0u, 0u, 0u, 1u);
+    txns[0].device = SPIM_QUEUE_MAX_DEVICES;
+    if (SpimQueue_Submit(txns, 1u) != CYRET_BAD_PARAM)
+        failures++;
+
+    for (k = 0u; k < (uint8)(sizeof(tooMany) / sizeof(tooMany[0])); k++)
+    {
+        tooMany[k].tx = NULL;
+        tooMany[k].rx = NULL;
+        tooMany[k].length = 1u;
+    }
+    QueueCheck_SetRegFile(0u, 0u, 0u, 1u);
+    txns[1].device = QUEUECHECK_REGFILE;
+    txns[1].segments = tooMany;
+    txns[1].segmentCount = (uint8)(sizeof(tooMany) / sizeof(tooMany[0]));
+    txns[1].onDone = NULL;
+    if (SpimQueue_Submit(txns, 2u) != CYRET_MEMORY)
+        failures++;
+    if ((CyDmaTdFreeCount() != freeTds) || !SpimQueue_Idle())
+        failures++;
+    /* Transaction 0 compiled before 1 ran out of TDs: neither may look queued */
+    if ((txns[0].status != SPIM_QUEUE_IDLE) || (txns[1].status != SPIM_QUEUE_IDLE))
+        failures++;
+}
+
+/*
+ * Random batches over both devices. Every other batch goes in while the previous one is still on
+ * the wire, so Submit() appends to a busy queue; the reads are checked against the shadows once
+ * everything completed.
+ */
+static void QueueCheck_Stress(void)
+{
+    static uint8 expected[QUEUECHECK_MAX_BATCH][64];
+    uint32 round;
+
+    for (round = 0u; round < QUEUECHECK_STRESS_ROUNDS; round++)
+    {
+        uint8 count = (uint8)(1u + QueueCheck_Random(QUEUECHECK_MAX_BATCH));
+        uint8 i;
+
+        for (i = 0u; i < count; i++)
+        {
+            uint8 read = (uint8)QueueCheck_Random(2u);
+            uint16 length = (uint16)(1u + QueueCheck_Random(64u));
+            uint16 k;
+
+            if (QueueCheck_Random(2u) == 0u)
+            {
+                uint8 address = (uint8)QueueCheck_Random(128u);
+
+                QueueCheck_SetRegFile(i, read, address, length);
+                for (k = 0u; k < length; k++)
+                {
+                    uint8 r = (uint8)((address + k) & 0x7Fu);
+
+                    if (read)
+                        expected[i][k] = regShadow[r];
+                    else
+                        regShadow[r] = payloads[i][k] = (uint8)QueueCheck_Random(256u);
+                }
+            }
+            else
+            {
+                uint16 address = (uint16)QueueCheck_Random(QUEUECHECK_MEMORY_SIZE);
+
+                QueueCheck_SetMemory(i, read, address, read ? NULL : payloads[i],
+                                     read ? payloads[i] : NULL, length);
+                for (k = 0u; k < length; k++)
+                {
+                    uint16 m = (uint16)((address + k) % QUEUECHECK_MEMORY_SIZE);
+
+                    if (read)
+                        expected[i][k] = memShadow[m];
+                    else
+                        memShadow[m] = payloads[i][k] = (uint8)QueueCheck_Random(256u);
+                }
+            }
+        }
+
+        doneCount = 0u;
+        if (SpimQueue_Submit(txns, count) != CYRET_SUCCESS)
+        {
+            failures++;
+            continue;
+        }
+        transactions += count;
+        QueueCheck_WaitIdle();
+        for (i = 0u; i < count; i++)
+        {
+            if ((txns[i].status != SPIM_QUEUE_DONE) || (doneOrder[i] != i))
+                orderErrors++;
+            if (txns[i].segments[1].rx != NULL)
+                QueueCheck_Compare(payloads[i], expected[i], txns[i].segments[1].length);
+        }
+    }
+}
+
+/* Two batches, the second submitted while the first is on the wire. */
+static void QueueCheck_Append(void)
+{
+    uint8 k;
+
+    for (k = 0u; k < 4u; k++)
+    {
+        QueueCheck_SetRegFile(k, 0u, (uint8)(0x40u + k * 8u), 8u);
+        memset(payloads[k], 0x11 * (k + 1u), 8u);
+        memset(&regShadow[0x40u + k * 8u], 0x11 * (k + 1u), 8u);
+    }
+    doneCount = 0u;
+    if ((SpimQueue_Submit(&txns[0], 2u) != CYRET_SUCCESS))
+        failures++;
+    CyEmu_Spend(2000u); /* well inside the first transaction */
+    if (SpimQueue_Idle() || (txns[0].status != SPIM_QUEUE_ACTIVE))
+        failures++;
+    if (SpimQueue_Submit(&txns[2], 2u) != CYRET_SUCCESS)
+        failures++;
+    transactions += 4u;
+    QueueCheck_WaitIdle();
+    for (k = 0u; k < 4u; k++)
+    {
+        if ((txns[k].status != SPIM_QUEUE_DONE) || (doneOrder[k] != k))
+            orderErrors++;
+    }
+    QueueCheck_Compare(&regFile[0x40], &regShadow[0x40], 32u);
+}
+
+int main(void)
+{
+    const SpimEmu_Stats *spi = &SPIM_Example01_spim.stats;
+    uint8 freeTds;
+    uint8 failed;
+
+    CyEmu_Init();
+    SPIM_Example01_Init((uint64)QUEUECHECK_RUN_MS * (CYEMU_BUS_CLK_HZ / 1000u), QueueCheck_Timeout);
+    SpimEmu_SetExchange(&SPIM_Example01_spim, QueueCheck_Exchange, NULL);
+    SPIM_Example01_SetSsHook(QueueCheck_SsWrite);
+    SPIM_Start();
+    SpimQueue_Start();
+    freeTds = CyDmaTdFreeCount();
+
+    QueueCheck_RegFileRoundTrip();
+    memcpy(regShadow, regFile, sizeof(regShadow));
+    QueueCheck_BigRoundTrip();
+    QueueCheck_Rejects();
+    QueueCheck_Append();
+    QueueCheck_Stress();
+
+    if (CyDmaTdFreeCount() != freeTds)
+        failures++;
+    if (SpimQueue_Completed() != transactions)
+        orderErrors++;
+
+    /* A transaction boundary is the only place the link may idle */
+    failed = (uint8)((dataErrors != 0u) || (orderErrors != 0u) || (ssViolations != 0u) ||
+                     (multiSelects != 0u) || (failures != 0u) || (spi->rxOverflows != 0u) ||
+                     (spi->txOverflows != 0u) || (spi->gaps != transactions - 1u));
+
+    printf("transactions=%u bytes=%u gaps=%u td_free=%u/%u ss_violations=%u multi_selects=%u "
+           "order_errors=%u data_errors=%u failures=%u\n",
+           (unsigned)transactions, (unsigned)spi->bytes, (unsigned)spi->gaps,
+           (unsigned)CyDmaTdFreeCount(), (unsigned)freeTds, (unsigned)ssViolations,
+           (unsigned)multiSelects, (unsigned)orderErrors, (unsigned)dataErrors,
+           (unsigned)failures);
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,58 @@
+/**
+ * @file
+ * @brief Link throughput of PSOC_SPI_DMA_Original/SPIM_Example01.cydsn/main.c on the host.
+ *
+ * main.c and SpimStream.c are compiled unchanged against the emulated SPIM and DMAC and run for
+ * the given emulated time. Every received RX half is compared with what went out on MOSI.
+ * Built and run by HostEmu/Makefile (make -C HostEmu spim_stream):
+ *
+ *     spim_stream [milliseconds]
+ *
+ * The last line is a key=value summary. The process exits nonzero on corrupted data, on FIFO or
+ * stream over/underruns and, once streaming, on any idle gap on the link.
+ */
+#include "project.h"
+
+#include "../../PSOC_SPI_DMA_Original/SPIM_Example01.cydsn/SpimStream.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/* -Dmain=... renames the firmware entry point; this file provides the real one. */
+#undef main
+
+int SPIM_Example01_main(void);
+
+static void SPIM_Example01_Report(void)
+{
+    const SPIM_Example01_Trace *t = &SPIM_Example01_trace;
+    const SpimEmu_Stats *spi = &SPIM_Example01_spim.stats;
+    const volatile SpimStream_Stats *stream = SpimStream_GetStats();
+    uint64 span = spi->lastByteAt - spi->firstByteAt;
+    uint64 bytesPerS = (span != 0u) ? (uint64)spi->bytes * CYEMU_BUS_CLK_HZ / span : 0u;
+    uint32 linkPermille = (span != 0u) ? (uint32)(spi->busyCycles * 1000u / span) : 0u;
+    uint8 failed;
+
+    failed = (uint8)((t->mismatches != 0u) || (spi->txOverflows != 0u) ||
+                     (spi->rxOverflows != 0u) || (stream->txUnderruns != 0u) ||
+                     (stream->rxOverruns != 0u) || ((stream->rxHalves != 0u) && (spi->gaps != 0u)));
+
+    printf("bytes=%u bytes_per_s=%u link_permille=%u gaps=%u tx_halves=%u rx_halves=%u "
+           "tx_underruns=%u rx_overruns=%u fifo_tx_overflows=%u fifo_rx_overflows=%u "
+           "rx_tds_checked=%u mismatches=%u\n",
+           (unsigned)spi->bytes, (unsigned)bytesPerS, (unsigned)linkPermille, (unsigned)spi->gaps,
+           (unsigned)stream->txHalves, (unsigned)stream->rxHalves, (unsigned)stream->txUnderruns,
+           (unsigned)stream->rxOverruns, (unsigned)spi->txOverflows, (unsigned)spi->rxOverflows,
+           (unsigned)t->rxTds, (unsigned)t->mismatches);
+    exit(failed ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
+int main(int argc, char **argv)
+{
+    uint32 ms = (argc > 1) ? (uint32)strtoul(argv[1], NULL, 0) : 20u;
+
+    CyEmu_Init();
+    SPIM_Example01_Init((uint64)((ms != 0u) ? ms : 1u) * (CYEMU_BUS_CLK_HZ / 1000u),
+                        SPIM_Example01_Report);
+    return SPIM_Example01_main();
+}
@@ -0,0 +1,2 @@
+// Stand-in for PSoC Creator's cypress.v so VideoCtrl_v1_0.v builds outside of it; the component
+// uses none of the primitives it declares.
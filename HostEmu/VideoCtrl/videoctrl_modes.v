@@ -0,0 +1,86 @@
+// VideoCtrl_v1_0 configured for the VESA modes the test bench checks, as the component would be
+// configured in a schematic: one wrapper per mode, picked with verilator --top-module. The
+// porches, sync pulses and polarities are the ones of the VESA DMT tables; videoctrl_tb.cpp
+// checks the outputs against its own copy of those tables, so a typo here shows up as a failure.
+// HorizDMAAdjust is the PSoC5LPVGA value.
+
+module VideoCtrl_640x480 (
+	output  blank_n,
+	output  hsync,
+	output [9:0] line_cnt,
+	output  line_dma,
+	output  vsync,
+	input   clock,
+	input   reset
+);
+	VideoCtrl_v1_0 #(
+		.HorizBackPorch(48),
+		.HorizDMAAdjust(16),
+		.HorizFrontPorch(16),
+		.HorizPulsePositive(0),
+		.HorizSyncPulse(96),
+		.HorizVisibleArea(640),
+		.VertBackPorch(33),
+		.VertFrontPorch(10),
+		.VertPulsePositive(0),
+		.VertSyncPulse(2),
+		.VertVisibleArea(480)
+	) VideoCtrl (
+		.blank_n(blank_n), .hsync(hsync), .line_cnt(line_cnt), .line_dma(line_dma),
+		.vsync(vsync), .clock(clock), .reset(reset)
+	);
+endmodule
+
+module VideoCtrl_800x600 (
+	output  blank_n,
+	output  hsync,
+	output [9:0] line_cnt,
+	output  line_dma,
+	output  vsync,
+	input   clock,
+	input   reset
+);
+	VideoCtrl_v1_0 #(
+		.HorizBackPorch(88),
+		.HorizDMAAdjust(16),
+		.HorizFrontPorch(40),
+		.HorizPulsePositive(1),
+		.HorizSyncPulse(128),
+		.HorizVisibleArea(800),
+		.VertBackPorch(23),
+		.VertFrontPorch(1),
+		.VertPulsePositive(1),
+		.VertSyncPulse(4),
+		.VertVisibleArea(600)
+	) VideoCtrl (
+		.blank_n(blank_n), .hsync(hsync), .line_cnt(line_cnt), .line_dma(line_dma),
+		.vsync(vsync), .clock(clock), .reset(reset)
+	);
+endmodule
+
+module VideoCtrl_1024x768 (
+	output  blank_n,
+	output  hsync,
+	output [9:0] line_cnt,
+	output  line_dma,
+	output  vsync,
+	input   clock,
+	input   reset
+);
+	VideoCtrl_v1_0 #(
+		.HorizBackPorch(160),
+		.HorizDMAAdjust(16),
+		.HorizFrontPorch(24),
+		.HorizPulsePositive(0),
+		.HorizSyncPulse(136),
+		.HorizVisibleArea(1024),
+		.VertBackPorch(29),
+		.VertFrontPorch(3),
+		.VertPulsePositive(0),
+		.VertSyncPulse(6),
+		.VertVisibleArea(768)
+	) VideoCtrl (
+		.blank_n(blank_n), .hsync(hsync), .line_cnt(line_cnt), .line_dma(line_dma),
+		.vsync(vsync), .clock(clock), .reset(reset)
+	);
+endmodule
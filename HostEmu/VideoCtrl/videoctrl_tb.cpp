@@ -0,0 +1,317 @@
+/**
+ * @file
+ * @brief Verilator test bench of the VideoCtrl_v1_0 component: VESA timing, line_cnt and line_dma,
+ *        and how long it takes to lock from an arbitrary power-up state.
+ *
+ * The C emulator (HostEmu/PSoC5LPVGA/project.c) models VideoCtrl from its parameters; this runs
+ * the Verilog itself. videoctrl_modes.v configures it for 640x480, 800x600 and 1024x768 at 60 Hz,
+ * one top module each, and every clock the outputs are compared with the VESA DMT timing of
+ * that mode, kept here independently of the Verilog parameters:
+ * - hsync, vsync: pulse position, width and polarity; vsync may trail the start of its line by
+ *   at most VIDEOCTRL_TB_MAX_SKEW clocks (VideoCtrl moves the vertical state on the clock after
+ *   the end of a line, newline_r);
+ * - blank_n: high exactly on the visible pixels of the visible lines;
+ * - line_dma: one clock on every visible line, HorizDMAAdjust + 1 clocks before its first
+ *   visible pixel, and none during the vertical blanking;
+ * - line_cnt: the visible line, the visible line count on the line after the last one (what the
+ *   ScanLine ISR reads at the end of the frame), 0 on the rest of the vertical blanking.
+ *
+ * VideoCtrl's reset is tied to 0 in the schematic and line_cnt_r has no reset at all, so the
+ * counters start wherever the flip-flops come up. Every seed powers up with random registers
+ * (--x-initial unique) and reset held low; the bench aligns to the first vsync and realigns on
+ * a mismatch. The lock time is the clock of the vsync from which on every clock matched, which
+ * has to hold for VIDEOCTRL_TB_CHECK_FRAMES frames. One more run pulses reset first.
+ *
+ * Built with Verilator and run by HostEmu/Makefile (make -C HostEmu verilog), one binary a mode
+ * (VIDEOCTRL_MODE 0, 1, 2 for 640x480, 800x600, 1024x768):
+ *
+ *     build/verilator/videoctrl_800x600/videoctrl_800x600 [seeds] [vcd]
+ *
+ * With a vcd file name the run with the reset pulse is dumped there, the component's ports from
+ * power-up to the end of the checked frames.
+ *
+ * The last line is a key=value summary:
+ * - mode, h_total, v_total, refresh_mhz: the VESA mode and its refresh rate in mHz;
+ * - line_dma_pixel: line_dma position from the start of the line (front porch), as
+ *   PSOC5LPVGA_LINE_DMA_PIXEL in the C emulator;
+ * - vsync_skew: clocks vsync trails the start of its line;
+ * - seeds, locked: random power-up states run and how many of them locked;
+ * - lock_cycles_max, lock_cycles_avg, lock_frames_max: clocks to the first good vsync;
+ * - reset_lock_cycles: the same after a reset pulse;
+ * - realigns: mismatches over all runs, every one cost a frame of lock time.
+ *
+ * The process exits nonzero when a run does not lock or the skew is out of range.
+ *
+ * Not run yet: Verilator was not available where this was written, so the bench has only been
+ * compiled against a C++ model of VideoCtrl_v1_0.v. The lock times and vsync skew expected
+ * above (lock within VIDEOCTRL_TB_CHECK_FRAMES frames, skew of one clock) are unverified until
+ * make -C HostEmu verilog runs (the verilog job in .github/workflows/hostemu.yml).
+ */
+#include <cstdio>
+#include <cstdlib>
+
+#include "Vtop.h"
+#include "verilated.h"
+#include "verilated_vcd_c.h"
+
+#ifndef VIDEOCTRL_MODE
+#define VIDEOCTRL_MODE 1
+#endif
+
+#define VIDEOCTRL_TB_SEEDS (32u)
+#define VIDEOCTRL_TB_CHECK_FRAMES (3u) /**< good frames after the lock */
+#define VIDEOCTRL_TB_MAX_FRAMES (8u)   /**< before a run counts as not locking */
+#define VIDEOCTRL_TB_MAX_SKEW (1u)
+#define VIDEOCTRL_TB_DMA_ADJUST (16u) /**< HorizDMAAdjust in videoctrl_modes.v */
+
+/** VESA DMT timing; lines and pixels are in the order VideoCtrl runs them. */
+typedef struct
+{
+    const char *name;
+    unsigned pixelClkHz;
+    unsigned hFrontPorch, hSync, hBackPorch, hVisible;
+    unsigned vFrontPorch, vSync, vBackPorch, vVisible;
+    unsigned hSyncPositive, vSyncPositive;
+} VideoCtrlTb_Mode;
+
+static const VideoCtrlTb_Mode videoCtrlTbModes[] = {
+    {"640x480", 25175000u, 16u, 96u, 48u, 640u, 10u, 2u, 33u, 480u, 0u, 0u},
+    {"800x600", 40000000u, 40u, 128u, 88u, 800u, 1u, 4u, 23u, 600u, 1u, 1u},
+    {"1024x768", 65000000u, 24u, 136u, 160u, 1024u, 3u, 6u, 29u, 768u, 0u, 0u},
+};
+
+static const VideoCtrlTb_Mode *const mode = &videoCtrlTbModes[VIDEOCTRL_MODE];
+
+/** Outputs of one clock. */
+typedef struct
+{
+    unsigned hsync, vsync, blankN, lineDma, lineCnt;
+} VideoCtrlTb_Out;
+
+/** Result of one run. */
+typedef struct
+{
+    unsigned locked;
+    unsigned long long lockAt; /**< clock of the vsync the good frames start at */
+    unsigned skew;
+    unsigned realigns;
+} VideoCtrlTb_Run;
+
+static unsigned VideoCtrlTb_HTotal(void)
+{
+    return mode->hFrontPorch + mode->hSync + mode->hBackPorch + mode->hVisible;
+}
+
+static unsigned VideoCtrlTb_VTotal(void)
+{
+    return mode->vFrontPorch + mode->vSync + mode->vBackPorch + mode->vVisible;
+}
+
+static unsigned long long VideoCtrlTb_FrameClocks(void)
+{
+    return (unsigned long long)VideoCtrlTb_HTotal() * VideoCtrlTb_VTotal();
+}
+
+static unsigned VideoCtrlTb_LineDmaPixel(void)
+{
+    return mode->hFrontPorch + mode->hSync + mode->hBackPorch - VIDEOCTRL_TB_DMA_ADJUST - 1u;
+}
+
+/*
+ * Outputs VESA asks for on pixel @p x of line @p y, with the vertical signals trailing the
+ * start of the line by @p skew clocks.
+ */
+static VideoCtrlTb_Out VideoCtrlTb_Expected(unsigned x, unsigned y, unsigned skew)
+{
+    unsigned hVisStart = mode->hFrontPorch + mode->hSync + mode->hBackPorch;
+    unsigned vVisStart = mode->vFrontPorch + mode->vSync + mode->vBackPorch;
+    unsigned yv = (x < skew) ? (y + VideoCtrlTb_VTotal() - 1u) % VideoCtrlTb_VTotal() : y;
+    unsigned vVisible = (yv >= vVisStart);
+    unsigned hSyncOn = (x >= mode->hFrontPorch) && (x < mode->hFrontPorch + mode->hSync);
+    unsigned vSyncOn = (yv >= mode->vFrontPorch) && (yv < mode->vFrontPorch + mode->vSync);
+    VideoCtrlTb_Out e;
+
+    e.hsync = hSyncOn ? mode->hSyncPositive : !mode->hSyncPositive;
+    e.vsync = vSyncOn ? mode->vSyncPositive : !mode->vSyncPositive;
+    e.blankN = vVisible && (x >= hVisStart);
+    e.lineDma = vVisible && (x == VideoCtrlTb_LineDmaPixel());
+    if (vVisible)
+        e.lineCnt = yv - vVisStart;
+    else
+        e.lineCnt = (yv == 0u) ? mode->vVisible : 0u;
+    return e;
+}
+
+static VideoCtrlTb_Out VideoCtrlTb_Sample(const Vtop *top)
+{
+    VideoCtrlTb_Out o;
+
+    o.hsync = top->hsync;
+    o.vsync = top->vsync;
+    o.blankN = top->blank_n;
+    o.lineDma = top->line_dma;
+    o.lineCnt = top->line_cnt;
+    return o;
+}
+
+static unsigned VideoCtrlTb_Same(const VideoCtrlTb_Out *a, const VideoCtrlTb_Out *b)
+{
+    return (a->hsync == b->hsync) && (a->vsync == b->vsync) && (a->blankN == b->blankN) &&
+           (a->lineDma == b->lineDma) && (a->lineCnt == b->lineCnt);
+}
+
+/*
+ * Powers the component up with the registers from @p seed, pulses reset first when @p reset,
+ * and checks until VIDEOCTRL_TB_CHECK_FRAMES good frames or VIDEOCTRL_TB_MAX_FRAMES.
+ */
+static VideoCtrlTb_Run VideoCtrlTb_Run1(unsigned seed, unsigned reset, const char *vcdName)
+{
+    unsigned long long frameClocks = VideoCtrlTb_FrameClocks();
+    unsigned long long end = VIDEOCTRL_TB_MAX_FRAMES * frameClocks;
+    unsigned long long lastHsync = 0u;
+    unsigned long long t;
+    unsigned seenHsync = 0u;
+    unsigned aligned = 0u;
+    unsigned goodFrames = 0u;
+    unsigned x = 0u;
+    unsigned y = 0u;
+    VideoCtrlTb_Out prev;
+    VideoCtrlTb_Run run = {0u, 0u, 0u, 0u};
+    VerilatedContext *ctx = new VerilatedContext;
+    VerilatedVcdC *vcd = NULL;
+    Vtop *top;
+
+    ctx->randReset(2);
+    ctx->randSeed((int)seed + 1);
+    if (vcdName != NULL)
+        ctx->traceEverOn(true);
+    top = new Vtop(ctx);
+    if (vcdName != NULL)
+    {
+        vcd = new VerilatedVcdC;
+        top->trace(vcd, 1);
+        vcd->open(vcdName);
+    }
+
+    top->reset = (reset != 0u);
+    top->clock = 0;
+    top->eval();
+    prev = VideoCtrlTb_Sample(top);
+    for (t = 0u; (t < end) && (goodFrames < VIDEOCTRL_TB_CHECK_FRAMES); t++)
+    {
+        VideoCtrlTb_Out o;
+
+        top->clock = 1;
+        top->eval();
+        if (vcd != NULL)
+            vcd->dump(2u * t);
+        top->clock = 0;
+        top->reset = 0;
+        top->eval();
+        if (vcd != NULL)
+            vcd->dump(2u * t + 1u);
+        o = VideoCtrlTb_Sample(top);
+
+        if ((o.hsync == mode->hSyncPositive) && (prev.hsync != mode->hSyncPositive))
+        {
+            lastHsync = t;
+            seenHsync = 1u;
+        }
+        /* Align the VESA frame on a vsync near the start of a line */
+        if (!aligned && seenHsync && (o.vsync == mode->vSyncPositive) &&
+            (prev.vsync != mode->vSyncPositive))
+        {
+            unsigned skew = (unsigned)((t - lastHsync + mode->hFrontPorch) % VideoCtrlTb_HTotal());
+
+            if (skew <= VIDEOCTRL_TB_MAX_SKEW)
+            {
+                aligned = 1u;
+                goodFrames = 0u;
+                run.lockAt = t;
+                run.skew = skew;
+                x = skew;
+                y = mode->vFrontPorch;
+            }
+        }
+        if (aligned)
+        {
+            VideoCtrlTb_Out e = VideoCtrlTb_Expected(x, y, run.skew);
+
+            if (!VideoCtrlTb_Same(&o, &e))
+            {
+                aligned = 0u;
+                run.realigns++;
+            }
+            else if (++x == VideoCtrlTb_HTotal())
+            {
+                x = 0u;
+                if (++y == VideoCtrlTb_VTotal())
+                    y = 0u;
+            }
+            if (aligned && (x == run.skew) && (y == mode->vFrontPorch))
+                goodFrames++;
+        }
+        prev = o;
+    }
+    run.locked = (goodFrames >= VIDEOCTRL_TB_CHECK_FRAMES);
+
+    top->final();
+    if (vcd != NULL)
+    {
+        vcd->close();
+        delete vcd;
+    }
+    delete top;
+    delete ctx;
+    return run;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned seeds = (argc > 1) ? (unsigned)strtoul(argv[1], NULL, 0) : VIDEOCTRL_TB_SEEDS;
+    const char *vcdName = (argc > 2) ? argv[2] : NULL;
+    unsigned long long frameClocks = VideoCtrlTb_FrameClocks();
+    unsigned long long lockMax = 0u;
+    unsigned long long lockSum = 0u;
+    unsigned locked = 0u;
+    unsigned realigns = 0u;
+    unsigned skew = 0u;
+    unsigned failed = 0u;
+    unsigned s;
+    VideoCtrlTb_Run r;
+
+    for (s = 0u; s < seeds; s++)
+    {
+        r = VideoCtrlTb_Run1(s, 0u, NULL);
+        realigns += r.realigns;
+        if (!r.locked)
+        {
+            fprintf(stderr, "seed %u: no lock in %u frames\n", s, VIDEOCTRL_TB_MAX_FRAMES);
+            failed = 1u;
+            continue;
+        }
+        locked++;
+        lockSum += r.lockAt;
+        if (r.lockAt > lockMax)
+            lockMax = r.lockAt;
+        skew = r.skew;
+    }
+    r = VideoCtrlTb_Run1(seeds, 1u, vcdName);
+    realigns += r.realigns;
+    if (!r.locked)
+    {
+        fprintf(stderr, "reset: no lock in %u frames\n", VIDEOCTRL_TB_MAX_FRAMES);
+        failed = 1u;
+    }
+    else
+        skew = r.skew;
+
+    printf("mode=%s h_total=%u v_total=%u refresh_mhz=%u line_dma_pixel=%u vsync_skew=%u "
+           "seeds=%u locked=%u lock_cycles_max=%llu lock_cycles_avg=%llu lock_frames_max=%u "
+           "reset_lock_cycles=%llu realigns=%u\n",
+           mode->name, VideoCtrlTb_HTotal(), VideoCtrlTb_VTotal(),
+           (unsigned)(mode->pixelClkHz * 1000ull / frameClocks), VideoCtrlTb_LineDmaPixel(), skew,
+           seeds, locked, lockMax, (locked != 0u) ? lockSum / locked : 0ull,
+           (unsigned)((lockMax + frameClocks - 1u) / frameClocks), r.lockAt, realigns);
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,166 @@
+/**
+ * @file
+ * @brief Verilator test bench of the VideoPixel_v1_0 component: the pixel shifter, the fine
+ *        scroll and the palette lookup at 1, 2 and 4 bits per pixel.
+ *
+ * The C emulator (PSoC5LPVGA_PixelColor() in HostEmu/PSoC5LPVGA/project.c) models VideoPixel
+ * from the captured scanout; this runs the Verilog itself, BitsPerPixel set with -G. The bench
+ * drives the inputs the way the schematic does: sel is PIXEL_SELECT, counting pixel clocks mod
+ * 8, and data is the DMA_OUT latch, which takes the next byte on the clock sel wraps from 7 to
+ * 0, in the blanking a random one. Every line has VIDEOPIXEL_TB_BYTES random bytes, a random
+ * palette and the next fine scroll, and on every clock rgbi has to be:
+ * - black in the blanking;
+ * - on pixel clock x of the visible line, pixel clock x - fine of the bytes, pixel value 0 for
+ *   the clocks before the first byte;
+ * - 8 / BitsPerPixel pixels a byte, the leftmost in the high bits, each BitsPerPixel clocks;
+ * - at 1 and 2 bpp the palette entry of the pixel value, 4 bits each, entry 0 in the low
+ *   nibble; at 4 bpp the pixel value itself.
+ * The registers power up random (--x-initial unique); the first blanking has to clear them.
+ *
+ * Built with Verilator and run by HostEmu/Makefile (make -C HostEmu verilog), one binary a
+ * VIDEOPIXEL_BPP:
+ *
+ *     build/verilator/videopixel_2bpp/videopixel_2bpp [lines] [vcd]
+ *
+ * With a vcd file name the whole run is dumped there.
+ *
+ * The last line is a key=value summary: bpp, lines, clocks checked, colors (distinct rgbi on the
+ * visible pixels), fines (fine scrolls run) and mismatches. The process exits nonzero on a
+ * mismatch.
+ *
+ * Not run yet: Verilator was not available where this was written. Nor is VideoPixel on any
+ * schematic (it has no .cysym), so this bench and the C model are all there is of 2 and 4 bpp.
+ */
+#include <cstdio>
+#include <cstdlib>
+
+#include "Vtop.h"
+#include "verilated.h"
+#include "verilated_vcd_c.h"
+
+#ifndef VIDEOPIXEL_BPP
+#define VIDEOPIXEL_BPP 2
+#endif
+
+#define VIDEOPIXEL_TB_LINES (256u)
+#define VIDEOPIXEL_TB_BYTES (50u)     /**< bytes of a visible line, 400 pixel clocks */
+#define VIDEOPIXEL_TB_BLANK (8u * 8u) /**< blanking clocks, whole bytes so a line starts on sel 0 */
+#define VIDEOPIXEL_TB_REPORTS (8u)    /**< mismatches printed */
+
+static unsigned videoPixelTbSeed = 1u;
+
+static unsigned VideoPixelTb_Random(void)
+{
+    videoPixelTbSeed = videoPixelTbSeed * 1103515245u + 12345u;
+    return videoPixelTbSeed >> 8;
+}
+
+/** rgbi VideoPixel has to drive on visible pixel clock @p x of a line. */
+static unsigned VideoPixelTb_Expected(const unsigned char *bytes, unsigned x, unsigned fine,
+                                      unsigned palette)
+{
+    unsigned value = 0u;
+
+    if (x >= fine)
+    {
+        unsigned p = x - fine;
+        unsigned pixel = (p % 8u) / VIDEOPIXEL_BPP;
+
+        value = (bytes[p / 8u] >> (8u - VIDEOPIXEL_BPP * (pixel + 1u))) &
+                ((1u << VIDEOPIXEL_BPP) - 1u);
+    }
+    if (VIDEOPIXEL_BPP == 4)
+        return value;
+    return (palette >> (4u * value)) & 0x0Fu;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned lines = (argc > 1) ? (unsigned)strtoul(argv[1], NULL, 0) : VIDEOPIXEL_TB_LINES;
+    const char *vcdName = (argc > 2) ? argv[2] : NULL;
+    unsigned char bytes[VIDEOPIXEL_TB_BYTES];
+    unsigned long long clocks = 0u;
+    unsigned long long t = 0u;
+    unsigned mismatches = 0u;
+    unsigned colors = 0u;
+    unsigned fines = 0u;
+    unsigned line;
+    unsigned i;
+    VerilatedContext *ctx = new VerilatedContext;
+    VerilatedVcdC *vcd = NULL;
+    Vtop *top;
+
+    ctx->randReset(2);
+    if (vcdName != NULL)
+        ctx->traceEverOn(true);
+    top = new Vtop(ctx);
+    if (vcdName != NULL)
+    {
+        vcd = new VerilatedVcdC;
+        top->trace(vcd, 99);
+        vcd->open(vcdName);
+    }
+    top->clock = 0;
+    top->sel = 0;
+    top->blank_n = 0;
+    top->eval();
+
+    for (line = 0u; line < lines; line++)
+    {
+        unsigned fine = line % 8u;
+        unsigned palette = VideoPixelTb_Random() & 0xFFFFu;
+        unsigned c;
+
+        for (i = 0u; i < VIDEOPIXEL_TB_BYTES; i++)
+            bytes[i] = (unsigned char)VideoPixelTb_Random();
+        fines |= 1u << fine;
+        for (c = 0u; c < VIDEOPIXEL_TB_BLANK + 8u * VIDEOPIXEL_TB_BYTES; c++, t++)
+        {
+            unsigned visible = (c >= VIDEOPIXEL_TB_BLANK);
+            unsigned x = c - VIDEOPIXEL_TB_BLANK;
+            unsigned e;
+
+            /* The clock edge takes the inputs of the clock before */
+            top->clock = 1;
+            top->eval();
+            if (vcd != NULL)
+                vcd->dump(2u * t);
+            top->clock = 0;
+            top->sel = c % 8u;
+            top->blank_n = visible;
+            top->fine = fine;
+            top->palette = palette;
+            if (c % 8u == 0u)
+                top->data = visible ? bytes[x / 8u] : (unsigned char)VideoPixelTb_Random();
+            top->eval();
+            if (vcd != NULL)
+                vcd->dump(2u * t + 1u);
+
+            e = visible ? VideoPixelTb_Expected(bytes, x, fine, palette) : 0u;
+            if (top->rgbi != e)
+            {
+                if (mismatches < VIDEOPIXEL_TB_REPORTS)
+                    fprintf(stderr, "line %u clock %u fine %u: rgbi %u, expected %u\n", line, c,
+                            fine, (unsigned)top->rgbi, e);
+                mismatches++;
+            }
+            if (visible)
+                colors |= 1u << (top->rgbi & 0x0Fu);
+            clocks++;
+        }
+    }
+
+    top->final();
+    if (vcd != NULL)
+    {
+        vcd->close();
+        delete vcd;
+    }
+    delete top;
+    delete ctx;
+
+    printf("bpp=%u lines=%u clocks=%llu colors=%u fines=%u mismatches=%u\n",
+           (unsigned)VIDEOPIXEL_BPP, lines, clocks, (unsigned)__builtin_popcount(colors),
+           (unsigned)__builtin_popcount(fines), mismatches);
+    return (mismatches == 0u) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -1,6 +1,9 @@
 #include <project.h>
 #include <string.h>
 
+#include "../../Common/DmaTdFast.h"
+#include "../../Common/FastCopy.h"
+
 #define INLINE_HOT __attribute__((always_inline, hot)) void
 /**
  * @file
@@ -36,6 +39,24 @@
 #define TOTAL_SIZE                                                                                 \
     (USEFUL_DATA + HEADER_SIZE + 2) /**< Total source buffer size, including header and padding */
 
+/**
+ * 1: one TD per chunk is built up front and chained into a ring, so every chunk costs only the
+ *    hardware request (no CyDmaTdSetAddress per chunk). Opt-in, it has only run on the host
+ *    emulator (make -C HostEmu spim_bench_ring).
+ * 0: a single TD whose source address is rewritten before every chunk.
+ */
+#ifndef DMA_TD_RING
+#define DMA_TD_RING (0u)
+#endif
+#define NUM_CHUNKS (USEFUL_DATA / CHUNK_SIZE) /**< Chunks per pass, one ring TD each */
+
+#if (USEFUL_DATA % CHUNK_SIZE) != 0
+#error "USEFUL_DATA must be a whole number of CHUNK_SIZE chunks"
+#endif
+#if NUM_CHUNKS > 127
+#error "The TD ring needs one of the 127 allocatable TDs per chunk"
+#endif
+
 // To force the placement of a const variable in flash, set its type to const
 
 /* Buffers aligned to meet DMA requirements */
@@ -51,12 +72,17 @@ This tells gcc that we have a section named ram2 starting at 0x20000000 (The upp
 static uint8 bigSource[TOTAL_SIZE] __attribute__((aligned(32), section(".ram2")));
 static uint8 smallDest[CHUNK_SIZE * 3] __attribute__((aligned(32), section(".ram2")));
 
+/* TDs are allocated right after reset, so their handles are known at compile time */
+#define DMA_TD0_SLOT DMA_TD_FAST_SLOT(0) /**< dmaTd0, first TD allocated by DmaSetup() */
+
 /* DMA channel and transfer descriptor variables */
 static uint8 dmaChannel;
 static uint8 dmaTd0;
+static uint8 dmaTdRing[NUM_CHUNKS];
 
 /* Function prototypes */
 void DmaSetup(void);
+void DmaSetupRing(void);
 void TriggerHwDmaRequest(void);
 void TriggerSwDmaRequest(void);
 void FillDebugPattern(void);
@@ -65,8 +91,12 @@ void UpdateDmaTdAddress(uint8 td, uint32 srcAddr);
 void CopyWithDma(const uint8 *src, uint8 *dest, size_t size);
 void CopyWithMemcpy(const uint8 *src, uint8 *dest, size_t size);
 void CopyWithLoop(const uint8 *src, uint8 *dest, size_t size);
+void CopyWithWords(const uint8 *src, uint8 *dest, size_t size);
+void CopyWithLdmStm(const uint8 *src, uint8 *dest, size_t size);
+void CopyWithFastCopy(const uint8 *src, uint8 *dest);
 
 INLINE_HOT CopyWithDma(const uint8 *src, uint8 *dest, size_t size);
+INLINE_HOT CopyWithDmaRing(void);
 INLINE_HOT UpdateDmaTdDstAddress(uint8 td, uint32 dstAddr);
 
 /**
@@ -109,6 +139,7 @@ void DmaSetup(void)
                              HI16(CYDEV_SRAM_BASE)); // Upper 16 bits of destination address
     */
     dmaTd0 = CyDmaTdAllocate();
+    DMA_TD_FAST_ASSERT_SLOT(dmaTd0, DMA_TD0_SLOT);
 
     // Here can be not CHUNK_SIZE but all USEFUL_DATA IF you find out way not to increment DST addr
     // together with src!
@@ -120,27 +151,41 @@ void DmaSetup(void)
     CyDmaChSetInitialTd(dmaChannel, dmaTd0);
     CyDmaChEnable(dmaChannel, 1);
 }
+
+/**
+ * @brief Configures the DMA channel with a ring of pre-built TDs, one per chunk.
+ *
+ * TD i copies CHUNK_SIZE bytes from bigSource + HEADER_SIZE + i * CHUNK_SIZE to smallDest and
+ * chains to TD i + 1, the last one back to the first. With one request per burst and a burst of
+ * CHUNK_SIZE, every hardware request moves exactly one chunk and leaves the channel on the next
+ * TD, so the CPU never writes TD memory after setup.
+ */
+void DmaSetupRing(void)
+{
+    uint8 i;
+
+    dmaChannel =
+        DMA_TX_DmaInitialize(CHUNK_SIZE,             // Bytes per burst
+                             1,                      // 1 means each burst need request!
+                             HI16(CYDEV_SRAM_BASE),  // Upper 16 bits of source address
+                             HI16(CYDEV_SRAM_BASE)); // Upper 16 bits of destination address
+
+    // Allocate all the TDs first, or we can't chain them
+    for (i = 0; i < NUM_CHUNKS; i++)
+        dmaTdRing[i] = CyDmaTdAllocate();
+
+    for (i = 0; i < NUM_CHUNKS; i++)
+    {
+        // DST increment is still needed for >4B bursts, the TD reload resets it for every chunk
+        CyDmaTdSetConfiguration(dmaTdRing[i], CHUNK_SIZE, dmaTdRing[(i + 1) % NUM_CHUNKS],
+                                TD_INC_SRC_ADR | TD_INC_DST_ADR | DMA_TX__TD_TERMOUT_EN);
+        CyDmaTdSetAddress(dmaTdRing[i], LO16((uint32)(bigSource + HEADER_SIZE + i * CHUNK_SIZE)),
+                          LO16((uint32)(smallDest)));
+    }
+    CyDmaChSetInitialTd(dmaChannel, dmaTdRing[0]);
+    CyDmaChEnable(dmaChannel, 1);
+}
 //#pragma GCC optimize("O3")
-#define BIT_BAND_ALIAS_BASE 0x22000000
-/* 'byte' should be an address in the SRAM region (0x20000000 to 0x200FFFFF)
-   'bit' should be a number 0 to 31 */
-#define BIT_BAND_ALIAS_ADDR(byte, bit)                                                             \
-    (BIT_BAND_ALIAS_BASE + 32 * ((uint32_t)(byte)-CYREG_SRAM_DATA_MBASE) + 4 * (uint8_t)(bit))
-
-/* 'a' should be an address (uint32_t *) */
-#define GET_BIT(a, bit) (*(volatile uint32_t *)BIT_BAND_ALIAS_ADDR((uint32_t)(a), bit))
-
-/* 'val' should be 0 or 1 */
-#define SET_BIT(a, bit, val) (GET_BIT(a, bit) = (uint32_t)(val))
-#define TEST_BIT(a, bit) (GET_BIT(a, bit) == (uint32)(val))
-uint32 foo __attribute__((section(".ram2"))) = 0;
-
-struct bb_Data {
-// Bit Band flag bit definitions
-int32 SCAL_REQUEST; // Recalibrate shunt a/d request
-int32 SHUNTDATA; // Shunt data available flag
-int32 SPISETTINGS; // SPI settings available
-} bbdata __attribute__((section (".bitband")));
 
 /**
  * @brief Main function that configures the DMA and manages chunked data transfers.
@@ -149,27 +194,13 @@ int main(void)
 {
     CyGlobalIntEnable;  // Enable global interrupts
     FillDebugPattern(); // Initialize the source buffer with a debug pattern
-    DmaSetup();         // Configure the DMA channel and TD
+#if DMA_TD_RING
+    DmaSetupRing(); // Configure the DMA channel and the TD ring
+#else
+    DmaSetup(); // Configure the DMA channel and TD
 
     uint16 currentAddrOffset = HEADER_SIZE; // Offset within the source buffer
-
-    bbdata.SHUNTDATA=0;
-
-    int32 value = bbdata.SHUNTDATA;
-    
-    bbdata.SHUNTDATA=1;
-    
-    value = bbdata.SHUNTDATA;
-    
-    bbdata.SHUNTDATA=4;
-    
-    value = bbdata.SHUNTDATA;
-    
-    foo = 0;
-    foo |= (1 << 2);
-    
-    SET_BIT(&foo, 5, 1); /* set bit 5 of foo */
-    // if (TEST_BIT(&foo, 5, 1)) { ... } /* test bit 5 */
+#endif
 
     //  for (;;)
     //  {
@@ -180,6 +211,10 @@ int main(void)
         //__ISB(); // Ensures pipeline is synchronized
         //__DSB(); // Ensures memory is synchronized
 
+#if DMA_TD_RING
+        // The ring walks the chunks by itself
+        CopyWithDmaRing();
+#else
         // Limit the offset to avoid accessing out-of-bounds memory
         if (currentAddrOffset >= (HEADER_SIZE + USEFUL_DATA))
             currentAddrOffset = HEADER_SIZE; // Reset to start of useful data
@@ -188,10 +223,17 @@ int main(void)
 
         // CopyWithMemcpy(bigSource + currentAddrOffset, smallDest, CHUNK_SIZE);
 
+        // CopyWithWords(bigSource + currentAddrOffset, smallDest, CHUNK_SIZE);
+
+        // CopyWithLdmStm(bigSource + currentAddrOffset, smallDest, CHUNK_SIZE);
+
+        // CopyWithFastCopy(bigSource + currentAddrOffset, smallDest);
+
         CopyWithDma(bigSource + currentAddrOffset, smallDest, CHUNK_SIZE);
 
         // Move to the next chunk
         currentAddrOffset += CHUNK_SIZE;
+#endif
 
         // Small delay between requests for demonstration purposes
         // CyDelay(100u);
@@ -205,8 +247,8 @@ INLINE_HOT CopyWithDma(const uint8 *src, uint8 *dest, size_t size)
 {
     Control_Reg_1_Write(0x40);
     // Update DMA TD for the next chunk
-    UpdateDmaTdAddress(dmaTd0, (uint32)(src)); // 1500nS
-    // UpdateDmaTdDstAddress(dmaTd0, (uint32)(dest));// Currently not working
+    UpdateDmaTdAddress(DMA_TD0_SLOT, (uint32)(src)); // 500nS
+    // UpdateDmaTdDstAddress(DMA_TD0_SLOT, (uint32)(dest));
 
     Control_Reg_1_Write(0x40);
     // Trigger a DMA request
@@ -216,11 +258,18 @@ INLINE_HOT CopyWithDma(const uint8 *src, uint8 *dest, size_t size)
     Control_Reg_1_Write(0x80);
 }
 
+INLINE_HOT CopyWithDmaRing(void)
+{
+    Control_Reg_1_Write(0x40);
+    // Next TD of the ring already points at the next chunk, only the request is left
+    TriggerHwDmaRequest(); // 750nS
+    Control_Reg_1_Write(0x80);
+}
+
 INLINE_HOT CopyWithLoop(const uint8 *src, uint8 *dest, size_t size)
 {
     Control_Reg_1_Write(0x40);
-    for (size_t i = 0; i < size; i++)
-        dest[i] = src[i];
+    FastCopy_Bytes(dest, src, size);
     Control_Reg_1_Write(0x80);
 }
 
@@ -231,27 +280,58 @@ INLINE_HOT CopyWithMemcpy(const uint8 *src, uint8 *dest, size_t size)
     Control_Reg_1_Write(0x80);
 }
 
+/**
+ * @brief Copies with 32-bit LDR/STR once dest is word aligned, see FastCopy_Words().
+ */
+INLINE_HOT CopyWithWords(const uint8 *src, uint8 *dest, size_t size)
+{
+    Control_Reg_1_Write(0x40);
+    FastCopy_Words(dest, src, size);
+    Control_Reg_1_Write(0x80);
+}
+
+/**
+ * @brief Copies 16-byte LDMIA/STMIA blocks, then words, then bytes, see FastCopy_LdmStm().
+ */
+INLINE_HOT CopyWithLdmStm(const uint8 *src, uint8 *dest, size_t size)
+{
+    Control_Reg_1_Write(0x40);
+    FastCopy_LdmStm(dest, src, size);
+    Control_Reg_1_Write(0x80);
+}
+
+/**
+ * @brief Copies one chunk with FastCopy(); CHUNK_SIZE is a constant, so the strategy is picked
+ * at compile time (unrolled word copies for the 6-byte chunk).
+ */
+INLINE_HOT CopyWithFastCopy(const uint8 *src, uint8 *dest)
+{
+    Control_Reg_1_Write(0x40);
+    FastCopy(dest, src, CHUNK_SIZE);
+    Control_Reg_1_Write(0x80);
+}
+
 /**
  * @brief Updates the DMA TD source and destination addresses for the next chunk.
  *
  * This function allows for dynamic updates of the DMA source address to support multi-chunk
- * transfers.
+ * transfers. Only the source half of TD1 is written, the destination stays smallDest.
  *
- * @param td The transfer descriptor to update.
+ * @param td The transfer descriptor to update, pass a DMA_TD_FAST_SLOT() constant so the TD
+ *           register address is resolved at compile time.
  * @param srcAddr The new source address.
  */
 INLINE_HOT UpdateDmaTdAddress(uint8 td, uint32 srcAddr)
 {
-     CyDmaTdSetAddress(td, LO16(srcAddr), LO16((uint32)(smallDest))); //1500nS
-   // CY_SET_REG16(0x816D, srcAddr); // 500nS - Raw implementation
+    // CyDmaTdSetAddress(td, LO16(srcAddr), LO16((uint32)(smallDest))); //1500nS
+    DmaTdFast_SetSrc(td, LO16(srcAddr)); // 500nS - Raw implementation
 }
 
 // Need some way not to increment dst addr to avoid manual increment src addr if transferCount not
 // only i chunk but all usefull data!
 INLINE_HOT UpdateDmaTdDstAddress(uint8 td, uint32 dstAddr)
 {
-    // TODO
-    //  CyDmaTdSetAddress(td, LO16((uint32)(bigSource + HEADER_SIZE)), LO16((uint32)(dstAddr)));
+    DmaTdFast_SetDst(td, LO16(dstAddr));
 }
 
 /**
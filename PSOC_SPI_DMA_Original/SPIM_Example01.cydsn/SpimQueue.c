@@ -0,0 +1,223 @@
+/**
+ * @file
+ * @brief Scatter-gather SPIM transaction queue, see SpimQueue.h.
+ *
+ * The queue is a singly linked list of submitted transactions; the head is the one on the wire.
+ * Submit appends under a critical section, isr_RxDone pops the head.
+ */
+#include "SpimQueue.h"
+
+#if (SPIM_QUEUE)
+
+#include "../../Common/DmaTdFast.h"
+
+#define SPIM_QUEUE_BYTES_PER_BURST (1u)   /**< one FIFO byte per request */
+#define SPIM_QUEUE_REQUEST_PER_BURST (1u) /**< the FIFO level paces every byte */
+#define SPIM_QUEUE_PRESERVE_TDS (0u)      /**< every chain runs once, then goes back to the pool */
+
+static uint8 queueTxCh = CY_DMA_INVALID_CHANNEL;
+static uint8 queueRxCh = CY_DMA_INVALID_CHANNEL;
+
+static SpimQueue_Txn *queueHead; /* on the wire */
+static SpimQueue_Txn *queueTail;
+static volatile uint32 queueCompleted;
+
+/* DMA source and sink of segments without buffer, in SRAM like the buffers */
+static uint8 queueFill = SPIM_QUEUE_FILL;
+static uint8 queueSink;
+
+/* Returns a chain of TDs, ending at CY_DMA_DISABLE_TD, to the cy_boot pool. */
+static void SpimQueue_FreeChain(uint8 td)
+{
+    while (td < CY_DMA_NUMBEROF_TDS)
+    {
+        uint8 next;
+
+        (void)CyDmaTdGetConfiguration(td, NULL, &next, NULL);
+        CyDmaTdFree(td);
+        td = next;
+    }
+}
+
+/**
+ * @brief Builds the TX and RX chains of one transaction, last TD first so each knows its next.
+ */
+static cystatus SpimQueue_Compile(SpimQueue_Txn *txn)
+{
+    uint8 nextTx = CY_DMA_DISABLE_TD;
+    uint8 nextRx = CY_DMA_DISABLE_TD;
+    uint8 rxDone = DMA_RX__TD_TERMOUT_EN; /* on the last RX TD only */
+    uint8 s = txn->segmentCount;
+
+    while (s-- != 0u)
+    {
+        const SpimQueue_Segment *seg = &txn->segments[s];
+        uint16 chunks = (uint16)((seg->length + SPIM_QUEUE_MAX_TD_LENGTH - 1u) /
+                                 SPIM_QUEUE_MAX_TD_LENGTH);
+
+        while (chunks-- != 0u)
+        {
+            uint16 offset = (uint16)(chunks * SPIM_QUEUE_MAX_TD_LENGTH);
+            uint16 n = (uint16)(seg->length - offset);
+            uint32 src = (seg->tx != NULL) ? ((uint32)seg->tx + offset) : (uint32)&queueFill;
+            uint32 dst = (seg->rx != NULL) ? ((uint32)seg->rx + offset) : (uint32)&queueSink;
+            uint8 txTd = CyDmaTdAllocate();
+            uint8 rxTd = CyDmaTdAllocate();
+
+            if ((txTd == CY_DMA_INVALID_TD) || (rxTd == CY_DMA_INVALID_TD))
+            {
+                if (txTd != CY_DMA_INVALID_TD)
+                    CyDmaTdFree(txTd);
+                if (rxTd != CY_DMA_INVALID_TD)
+                    CyDmaTdFree(rxTd);
+                SpimQueue_FreeChain(nextTx);
+                SpimQueue_FreeChain(nextRx);
+                return CYRET_MEMORY;
+            }
+            if (n > SPIM_QUEUE_MAX_TD_LENGTH)
+                n = SPIM_QUEUE_MAX_TD_LENGTH;
+
+            DmaTdFast_SetConfiguration(txTd, n, nextTx, (seg->tx != NULL) ? TD_INC_SRC_ADR : 0u);
+            DmaTdFast_SetAddress(txTd, LO16(src), LO16((uint32)SPIM_TXDATA_PTR));
+            DmaTdFast_SetConfiguration(rxTd, n, nextRx,
+                                       ((seg->rx != NULL) ? TD_INC_DST_ADR : 0u) | rxDone);
+            DmaTdFast_SetAddress(rxTd, LO16((uint32)SPIM_RXDATA_PTR), LO16(dst));
+            rxDone = 0u;
+            nextTx = txTd;
+            nextRx = rxTd;
+        }
+    }
+    txn->txTd = nextTx;
+    txn->rxTd = nextRx;
+    return CYRET_SUCCESS;
+}
+
+/* Selects the device of @p txn and starts both channels on its chains, RX first. */
+static void SpimQueue_Run(SpimQueue_Txn *txn)
+{
+    txn->status = SPIM_QUEUE_ACTIVE;
+    SS_Reg_Write((uint8) ~(1u << txn->device));
+    (void)CyDmaChSetInitialTd(queueRxCh, txn->rxTd);
+    (void)CyDmaChSetInitialTd(queueTxCh, txn->txTd);
+    (void)CyDmaChEnable(queueRxCh, SPIM_QUEUE_PRESERVE_TDS);
+    (void)CyDmaChEnable(queueTxCh, SPIM_QUEUE_PRESERVE_TDS);
+}
+
+/**
+ * @brief Sets up DMA_TX/DMA_RX for the queue and deselects every device; call after SPIM_Start().
+ */
+void SpimQueue_Start(void)
+{
+    queueTxCh = DMA_TX_DmaInitialize(SPIM_QUEUE_BYTES_PER_BURST, SPIM_QUEUE_REQUEST_PER_BURST,
+                                     HI16(CYDEV_SRAM_BASE), HI16(CYDEV_PERIPH_BASE));
+    queueRxCh = DMA_RX_DmaInitialize(SPIM_QUEUE_BYTES_PER_BURST, SPIM_QUEUE_REQUEST_PER_BURST,
+                                     HI16(CYDEV_PERIPH_BASE), HI16(CYDEV_SRAM_BASE));
+    queueHead = NULL;
+    queueTail = NULL;
+    queueCompleted = 0u;
+    SS_Reg_Write(SPIM_QUEUE_SS_NONE);
+    isr_RxDone_StartEx(SpimQueue_DoneIsr);
+}
+
+/**
+ * @brief Queues @p count transactions that go out back to back, in array order.
+ *
+ * All TDs are built here; when the queue was idle the first transaction starts right away.
+ * Nothing is queued unless every transaction compiled.
+ *
+ * @return CYRET_SUCCESS, CYRET_BAD_PARAM (empty batch or transaction, bad device) or
+ *         CYRET_MEMORY (not enough free TDs); on failure every transaction of the batch is
+ *         SPIM_QUEUE_IDLE.
+ */
+cystatus SpimQueue_Submit(SpimQueue_Txn *txns, uint8 count)
+{
+    uint8 intState;
+    uint8 i;
+
+    if ((txns == NULL) || (count == 0u))
+        return CYRET_BAD_PARAM;
+    for (i = 0u; i < count; i++)
+    {
+        uint32 bytes = 0u;
+        uint8 s;
+
+        if ((txns[i].device >= SPIM_QUEUE_MAX_DEVICES) || (txns[i].segments == NULL))
+            return CYRET_BAD_PARAM;
+        for (s = 0u; s < txns[i].segmentCount; s++)
+            bytes += txns[i].segments[s].length;
+        if (bytes == 0u)
+            return CYRET_BAD_PARAM;
+    }
+
+    for (i = 0u; i < count; i++)
+    {
+        cystatus status = SpimQueue_Compile(&txns[i]);
+
+        if (status != CYRET_SUCCESS)
+        {
+            /* Nothing of the batch is queued, so none of it may stay pending */
+            txns[i].status = SPIM_QUEUE_IDLE;
+            while (i-- != 0u)
+            {
+                SpimQueue_FreeChain(txns[i].txTd);
+                SpimQueue_FreeChain(txns[i].rxTd);
+                txns[i].status = SPIM_QUEUE_IDLE;
+                txns[i].next = NULL;
+            }
+            return status;
+        }
+        txns[i].status = SPIM_QUEUE_PENDING;
+        txns[i].next = (i + 1u < count) ? &txns[i + 1u] : NULL;
+    }
+
+    intState = CyEnterCriticalSection();
+    if (queueTail != NULL)
+    {
+        queueTail->next = &txns[0];
+        queueTail = &txns[count - 1u];
+    }
+    else
+    {
+        queueHead = &txns[0];
+        queueTail = &txns[count - 1u];
+        SpimQueue_Run(queueHead);
+    }
+    CyExitCriticalSection(intState);
+    return CYRET_SUCCESS;
+}
+
+/** @brief 1 when every submitted transaction is done. */
+uint8 SpimQueue_Idle(void) { return (uint8)(queueHead == NULL); }
+
+/** @brief Transactions completed since SpimQueue_Start(). */
+uint32 SpimQueue_Completed(void) { return queueCompleted; }
+
+/**
+ * @brief isr_RxDone (DMA_RX nrq): the head transaction is off the wire.
+ *
+ * The next transaction is selected and started before the finished one is cleaned up and
+ * reported, to keep the link idle time between transactions short.
+ */
+CY_ISR(SpimQueue_DoneIsr)
+{
+    SpimQueue_Txn *txn = queueHead;
+
+    if (txn == NULL)
+        return;
+    SS_Reg_Write(SPIM_QUEUE_SS_NONE);
+    queueHead = txn->next;
+    if (queueHead != NULL)
+        SpimQueue_Run(queueHead);
+    else
+        queueTail = NULL;
+
+    SpimQueue_FreeChain(txn->txTd);
+    SpimQueue_FreeChain(txn->rxTd);
+    txn->next = NULL;
+    queueCompleted++;
+    txn->status = SPIM_QUEUE_DONE;
+    if (txn->onDone != NULL)
+        txn->onDone(txn);
+}
+
+#endif /* (SPIM_QUEUE) */
@@ -0,0 +1,91 @@
+/**
+ * @file
+ * @brief Scatter-gather SPIM transaction queue on chained TX/RX TDs.
+ *
+ * A transaction is one slave select assertion: a device number and a list of segments. Each
+ * segment is a (buffer, length) pair per direction; a NULL TX buffer sends SPIM_QUEUE_FILL bytes,
+ * a NULL RX buffer drops what comes back. A register read is then two segments:
+ * @code
+ *   static const uint8 cmd[] = {0x80u | REG_ADDR};
+ *   static uint8 regs[6];
+ *   static const SpimQueue_Segment readRegs[] = {
+ *       {cmd, NULL, sizeof(cmd)},   // command out, response dropped
+ *       {NULL, regs, sizeof(regs)}, // fill bytes out, payload in
+ *   };
+ *   static SpimQueue_Txn batch[] = {{SENSOR_SS, readRegs, 2u, NULL}, ...};
+ *
+ *   (void)SpimQueue_Submit(batch, 2u);
+ * @endcode
+ *
+ * SpimQueue_Submit() compiles every segment of every transaction into one TX and one RX TD
+ * (longer segments into several), chained per transaction, so a transaction runs from first to
+ * last byte without the CPU. Only the last RX TD raises DMA_RX nrq: the last byte is then off the
+ * wire, and isr_RxDone moves slave select to the next transaction and restarts both channels on
+ * its prebuilt chains. The SPIM hardware SS would stay asserted across transactions, so slave
+ * selects come from SS_Reg, a control register with one active-low output per device.
+ *
+ * Transactions and their segments and buffers must stay untouched until the transaction is
+ * SPIM_QUEUE_DONE. Schematic: as for SpimStream.h (DMA_TX/DMA_RX on the SPIM FIFO requests,
+ * isr_RxDone on DMA_RX nrq), plus SS_Reg.
+ */
+#ifndef SPIM_QUEUE_H
+#define SPIM_QUEUE_H
+
+#include <project.h>
+
+/**
+ * 1 builds SpimQueue.c. The schematic as shipped has neither SS_Reg nor isr_RxDone, so it is 0;
+ * set it to 1 after adding to TopDesign:
+ * - SS_Reg, a control register with one active-low slave select output per device;
+ * - isr_RxDone on the DMA_RX nrq;
+ * - the DMA_TX / DMA_RX drq on the SPIM tx_interrupt / rx_interrupt.
+ */
+#ifndef SPIM_QUEUE
+#define SPIM_QUEUE (0u)
+#endif
+
+#define SPIM_QUEUE_FILL (0xFFu)          /**< sent for segments without TX buffer */
+#define SPIM_QUEUE_MAX_DEVICES (8u)      /**< one SS_Reg output each */
+#define SPIM_QUEUE_SS_NONE (0xFFu)       /**< SS_Reg value with every device deselected */
+#define SPIM_QUEUE_MAX_TD_LENGTH (4095u) /**< 12-bit TD transfer count */
+
+/* Transaction status */
+#define SPIM_QUEUE_IDLE (0u)    /**< not submitted */
+#define SPIM_QUEUE_PENDING (1u) /**< queued behind other transactions */
+#define SPIM_QUEUE_ACTIVE (2u)  /**< selected and on the wire */
+#define SPIM_QUEUE_DONE (3u)    /**< complete, buffers belong to the application again */
+
+typedef struct
+{
+    const uint8 *tx; /**< bytes to send, NULL sends SPIM_QUEUE_FILL */
+    uint8 *rx;       /**< where received bytes go, NULL drops them */
+    uint16 length;
+} SpimQueue_Segment;
+
+typedef struct SpimQueue_Txn SpimQueue_Txn;
+
+/** Completion callback, runs in isr_RxDone. */
+typedef void (*SpimQueue_DoneFn)(SpimQueue_Txn *txn);
+
+struct SpimQueue_Txn
+{
+    uint8 device;                      /**< SS_Reg output, 0..SPIM_QUEUE_MAX_DEVICES - 1 */
+    const SpimQueue_Segment *segments;
+    uint8 segmentCount;
+    SpimQueue_DoneFn onDone;           /**< may be NULL */
+
+    /* Owned by the queue */
+    volatile uint8 status;
+    uint8 txTd;
+    uint8 rxTd;
+    SpimQueue_Txn *next;
+};
+
+void SpimQueue_Start(void);
+cystatus SpimQueue_Submit(SpimQueue_Txn *txns, uint8 count);
+uint8 SpimQueue_Idle(void);
+uint32 SpimQueue_Completed(void);
+
+CY_ISR_PROTO(SpimQueue_DoneIsr);
+
+#endif /* SPIM_QUEUE_H */
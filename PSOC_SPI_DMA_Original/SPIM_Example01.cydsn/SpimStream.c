@@ -0,0 +1,204 @@
+/**
+ * @file
+ * @brief Continuous SPIM streaming with ping-pong TDs, see SpimStream.h.
+ *
+ * Ownership of every half is a byte flag: the ISRs only ever set a flag to 1 and the main loop
+ * only ever clears it, so no read-modify-write is shared between the two.
+ */
+#include "SpimStream.h"
+
+#if (SPIM_STREAMING)
+
+#include <string.h>
+
+#define SPIM_STREAM_BYTES_PER_BURST (1u)   /**< one FIFO byte per request */
+#define SPIM_STREAM_REQUEST_PER_BURST (1u) /**< the FIFO level paces every byte */
+#define SPIM_STREAM_PRESERVE_TDS (1u)      /**< reload count and addresses on every pass */
+
+static uint8 streamTxCh = CY_DMA_INVALID_CHANNEL;
+static uint8 streamRxCh = CY_DMA_INVALID_CHANNEL;
+static uint8 streamTxTd[2] = {CY_DMA_INVALID_TD, CY_DMA_INVALID_TD};
+static uint8 streamRxTd[2] = {CY_DMA_INVALID_TD, CY_DMA_INVALID_TD};
+
+static uint8 *streamTx[2];
+static uint8 *streamRx[2];
+static uint16 streamLength;
+
+static volatile uint8 txAppOwned[2]; /* 1: sent, the application may refill it */
+static volatile uint8 rxAppOwned[2]; /* 1: received, waiting for the application */
+static volatile uint8 txDmaHalf;     /* half the DMAC is sending, ISR only */
+static volatile uint8 rxDmaHalf;     /* half the DMAC is filling, ISR only */
+static uint8 txAppHalf;              /* next half to refill, main loop only */
+static uint8 rxAppHalf;              /* next half to consume, main loop only */
+
+static volatile SpimStream_Stats streamStats;
+
+/* Allocates the four TDs once, they are kept across Stop/Start. */
+static cystatus SpimStream_AllocateTds(void)
+{
+    uint8 i;
+
+    for (i = 0u; i < 2u; i++)
+    {
+        if (streamTxTd[i] == CY_DMA_INVALID_TD)
+            streamTxTd[i] = CyDmaTdAllocate();
+        if (streamRxTd[i] == CY_DMA_INVALID_TD)
+            streamRxTd[i] = CyDmaTdAllocate();
+        if ((streamTxTd[i] == CY_DMA_INVALID_TD) || (streamRxTd[i] == CY_DMA_INVALID_TD))
+            return CYRET_MEMORY;
+    }
+    return CYRET_SUCCESS;
+}
+
+/**
+ * @brief Starts streaming two TX halves out and two RX halves in, forever.
+ *
+ * Both TX halves must already hold data, they go out first. A half must take longer on the wire
+ * than the ISRs and the main loop need to turn it around; the TX TD completes up to the 4-byte
+ * SPIM FIFO ahead of the wire, so halves of a few bytes underrun (1-byte halves do at 1 Mbps).
+ *
+ * @param length Bytes per half, 1..SPIM_STREAM_MAX_LENGTH, the same for all four buffers.
+ * @return CYRET_SUCCESS, CYRET_BAD_PARAM or CYRET_MEMORY (no free TDs).
+ */
+cystatus SpimStream_Start(uint8 *tx0, uint8 *tx1, uint8 *rx0, uint8 *rx1, uint16 length)
+{
+    cystatus status;
+    uint8 i;
+
+    if ((tx0 == NULL) || (tx1 == NULL) || (rx0 == NULL) || (rx1 == NULL) || (length == 0u) ||
+        (length > SPIM_STREAM_MAX_LENGTH))
+        return CYRET_BAD_PARAM;
+    status = SpimStream_AllocateTds();
+    if (status != CYRET_SUCCESS)
+        return status;
+
+    streamTx[0] = tx0;
+    streamTx[1] = tx1;
+    streamRx[0] = rx0;
+    streamRx[1] = rx1;
+    streamLength = length;
+    memset((void *)&streamStats, 0, sizeof(streamStats));
+    for (i = 0u; i < 2u; i++)
+    {
+        txAppOwned[i] = 0u;
+        rxAppOwned[i] = 0u;
+    }
+    txDmaHalf = 0u;
+    rxDmaHalf = 0u;
+    txAppHalf = 0u;
+    rxAppHalf = 0u;
+
+    streamTxCh = DMA_TX_DmaInitialize(SPIM_STREAM_BYTES_PER_BURST, SPIM_STREAM_REQUEST_PER_BURST,
+                                      HI16((uint32)tx0), HI16(CYDEV_PERIPH_BASE));
+    streamRxCh = DMA_RX_DmaInitialize(SPIM_STREAM_BYTES_PER_BURST, SPIM_STREAM_REQUEST_PER_BURST,
+                                      HI16(CYDEV_PERIPH_BASE), HI16((uint32)rx0));
+
+    /* 0 -> 1 -> 0 ... in both directions */
+    for (i = 0u; i < 2u; i++)
+    {
+        (void)CyDmaTdSetConfiguration(streamTxTd[i], length, streamTxTd[i ^ 1u],
+                                      TD_INC_SRC_ADR | DMA_TX__TD_TERMOUT_EN);
+        (void)CyDmaTdSetAddress(streamTxTd[i], LO16((uint32)streamTx[i]),
+                                LO16((uint32)SPIM_TXDATA_PTR));
+        (void)CyDmaTdSetConfiguration(streamRxTd[i], length, streamRxTd[i ^ 1u],
+                                      TD_INC_DST_ADR | DMA_RX__TD_TERMOUT_EN);
+        (void)CyDmaTdSetAddress(streamRxTd[i], LO16((uint32)SPIM_RXDATA_PTR),
+                                LO16((uint32)streamRx[i]));
+    }
+    (void)CyDmaChSetInitialTd(streamRxCh, streamRxTd[0]);
+    (void)CyDmaChSetInitialTd(streamTxCh, streamTxTd[0]);
+
+    isr_TxDone_StartEx(SpimStream_TxDoneIsr);
+    isr_RxDone_StartEx(SpimStream_RxDoneIsr);
+
+    /* RX first, so the first received byte already has somewhere to go */
+    (void)CyDmaChEnable(streamRxCh, SPIM_STREAM_PRESERVE_TDS);
+    (void)CyDmaChEnable(streamTxCh, SPIM_STREAM_PRESERVE_TDS);
+    return CYRET_SUCCESS;
+}
+
+/**
+ * @brief Stops both channels; bytes already in the SPIM FIFOs still go out / stay there.
+ */
+void SpimStream_Stop(void)
+{
+    if (streamTxCh == CY_DMA_INVALID_CHANNEL)
+        return;
+    (void)CyDmaChDisable(streamTxCh);
+    (void)CyDmaChDisable(streamRxCh);
+    isr_TxDone_Stop();
+    isr_RxDone_Stop();
+}
+
+/**
+ * @brief Returns the next sent TX half to refill, or NULL while the DMAC still owns it.
+ *
+ * Fill all SpimStream_Length() bytes, then hand it back with SpimStream_TxCommit().
+ */
+uint8 *SpimStream_TxAcquire(void)
+{
+    return txAppOwned[txAppHalf] ? streamTx[txAppHalf] : NULL;
+}
+
+/** @brief Hands the half returned by SpimStream_TxAcquire() back to the DMAC. */
+void SpimStream_TxCommit(void)
+{
+    txAppOwned[txAppHalf] = 0u;
+    txAppHalf ^= 1u;
+}
+
+/**
+ * @brief Returns the next received RX half, or NULL while it is still being filled.
+ *
+ * The data stays valid until SpimStream_RxRelease(), as long as that comes before the DMAC
+ * finishes the other half.
+ */
+const uint8 *SpimStream_RxAcquire(void)
+{
+    return rxAppOwned[rxAppHalf] ? streamRx[rxAppHalf] : NULL;
+}
+
+/** @brief Hands the half returned by SpimStream_RxAcquire() back to the DMAC. */
+void SpimStream_RxRelease(void)
+{
+    rxAppOwned[rxAppHalf] = 0u;
+    rxAppHalf ^= 1u;
+}
+
+/** @brief Nonzero when a TX half can be refilled or an RX half consumed; for a WFI loop. */
+uint8 SpimStream_Pending(void)
+{
+    return (uint8)(txAppOwned[txAppHalf] | rxAppOwned[rxAppHalf]);
+}
+
+uint16 SpimStream_Length(void) { return streamLength; }
+
+const volatile SpimStream_Stats *SpimStream_GetStats(void) { return &streamStats; }
+
+/** @brief isr_TxDone (DMA_TX nrq): a TX half is in the SPIM FIFO, the DMAC moved on. */
+CY_ISR(SpimStream_TxDoneIsr)
+{
+    uint8 done = txDmaHalf;
+    uint8 next = (uint8)(done ^ 1u);
+
+    txDmaHalf = next;
+    txAppOwned[done] = 1u;
+    streamStats.txHalves++;
+    if (txAppOwned[next])
+        streamStats.txUnderruns++;
+}
+
+/** @brief isr_RxDone (DMA_RX nrq): an RX half is complete in memory, the DMAC moved on. */
+CY_ISR(SpimStream_RxDoneIsr)
+{
+    uint8 done = rxDmaHalf;
+    uint8 next = (uint8)(done ^ 1u);
+
+    rxDmaHalf = next;
+    rxAppOwned[done] = 1u;
+    streamStats.rxHalves++;
+    if (rxAppOwned[next])
+        streamStats.rxOverruns++;
+}
+
+#endif /* (SPIM_STREAMING) */
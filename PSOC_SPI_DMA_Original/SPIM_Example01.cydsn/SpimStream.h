@@ -0,0 +1,63 @@
+/**
+ * @file
+ * @brief Continuous SPIM streaming: ping-pong TX/RX TD pairs, completion interrupts.
+ *
+ * Each direction has two buffer halves of the same length and one TD per half. The TDs point at
+ * each other, so the DMAC walks 0, 1, 0, 1, ... by itself and the SPIM TX FIFO never runs dry:
+ * no CPU work per byte and no restart between buffers. The channels run with preserved TDs, so
+ * every pass reloads the original count and addresses.
+ *
+ * Every TD raises the channel's nrq when its half is done:
+ * - a finished TX half goes back to the application to be refilled (SpimStream_TxAcquire());
+ * - a finished RX half goes to the application to be consumed (SpimStream_RxAcquire()).
+ *
+ * The DMAC does not wait for the application. A TX half that was not committed again by the time
+ * the DMAC gets back to it is sent as it is and counted as an underrun; an RX half the application
+ * still holds when the DMAC gets back to it is overwritten and counted as an overrun.
+ *
+ * Schematic: DMA_TX drq on SPIM tx_interrupt (TX FIFO not full), DMA_RX drq on rx_interrupt
+ * (RX FIFO not empty), and two isr components, isr_TxDone on DMA_TX nrq and isr_RxDone on
+ * DMA_RX nrq.
+ */
+#ifndef SPIM_STREAM_H
+#define SPIM_STREAM_H
+
+#include <project.h>
+
+/**
+ * 1 builds SpimStream.c and has main.c stream through it. The schematic as shipped has neither
+ * of the two isr components, so it is 0; set it to 1 after adding to TopDesign:
+ * - isr_TxDone on the DMA_TX nrq and isr_RxDone on the DMA_RX nrq;
+ * - the DMA_TX / DMA_RX drq on the SPIM tx_interrupt / rx_interrupt, as above.
+ */
+#ifndef SPIM_STREAMING
+#define SPIM_STREAMING (0u)
+#endif
+
+#define SPIM_STREAM_MAX_LENGTH (4095u) /**< 12-bit TD transfer count */
+
+/** Stream counters; read them with the interrupts in mind, they are written by the ISRs. */
+typedef struct
+{
+    uint32 txHalves;    /**< TX halves sent */
+    uint32 rxHalves;    /**< RX halves received */
+    uint32 txUnderruns; /**< TX halves the DMAC started before the application committed them */
+    uint32 rxOverruns;  /**< RX halves the DMAC started while the application still held them */
+} SpimStream_Stats;
+
+cystatus SpimStream_Start(uint8 *tx0, uint8 *tx1, uint8 *rx0, uint8 *rx1, uint16 length);
+void SpimStream_Stop(void);
+
+uint8 *SpimStream_TxAcquire(void);
+void SpimStream_TxCommit(void);
+const uint8 *SpimStream_RxAcquire(void);
+void SpimStream_RxRelease(void);
+uint8 SpimStream_Pending(void);
+
+uint16 SpimStream_Length(void);
+const volatile SpimStream_Stats *SpimStream_GetStats(void);
+
+CY_ISR_PROTO(SpimStream_TxDoneIsr);
+CY_ISR_PROTO(SpimStream_RxDoneIsr);
+
+#endif /* SPIM_STREAM_H */
@@ -16,30 +16,48 @@
 *  SPI communication test using DMA. 8 bytes are transmitted
 *  between SPI Master and SPI Slave.
 *  Received data are displayed on LCD. 
+*
+*  With SPIM_STREAMING set, the link runs continuously instead: SpimStream
+*  keeps two TX and two RX buffer halves going with ping-pong TDs, and the
+*  main loop refills and checks halves as their completion interrupts come.
+*  It is off by default; SpimStream.h lists the isr components it needs on
+*  the schematic.
 
 *******************************************************************************/
 
 #include <project.h>
+#include "SpimStream.h"
 
 void DmaTxConfiguration(void);
 void DmaRxConfiguration(void);
 void DMATxRestart(void);
 
-/* DMA Configuration for DMA_TX */
+/* DMA Configuration for DMA_TX; BUFFER_SIZE and the burst sizes can be
+*  overridden on the command line, the host loopback benchmark sweeps them */
+#ifndef DMA_TX_BYTES_PER_BURST
 #define DMA_TX_BYTES_PER_BURST      (1u)
+#endif
 #define DMA_TX_REQUEST_PER_BURST    (1u)
 #define DMA_TX_SRC_BASE             (CYDEV_SRAM_BASE)
 #define DMA_TX_DST_BASE             (CYDEV_PERIPH_BASE)
 
 /* DMA Configuration for DMA_RX */
+#ifndef DMA_RX_BYTES_PER_BURST
 #define DMA_RX_BYTES_PER_BURST      (1u)
+#endif
 #define DMA_RX_REQUEST_PER_BURST    (1u)
 #define DMA_RX_SRC_BASE             (CYDEV_PERIPH_BASE)
 #define DMA_RX_DST_BASE             (CYDEV_SRAM_BASE)
 
+#ifndef BUFFER_SIZE
 #define BUFFER_SIZE                 (8u)
+#endif
 #define STORE_TD_CFG_ONCMPLT        (1u)
 
+/* SPIM_STREAMING (SpimStream.h) 1: continuous streaming through SpimStream,
+*  0: the 8-byte transfer restarted every millisecond */
+#define STREAM_LENGTH               (64u)
+
 /* Variable declarations for DMA_TX*/
 uint8 txChannel;
 uint8 txTD;
@@ -52,6 +70,18 @@ uint8 rxTD;
 uint8 txBuffer [BUFFER_SIZE] = {0x0u, 0x01u, 0x03u, 0x07u, 0x11u, 0x33u, 0x77u, 0xFFu};
 uint8 rxBuffer[BUFFER_SIZE];
 
+#if (SPIM_STREAMING)
+/* Stream halves; the TX side carries a counting pattern */
+uint8 txStream[2u][STREAM_LENGTH];
+uint8 rxStream[2u][STREAM_LENGTH];
+uint8 txPattern;
+uint8 rxPattern;
+uint32 rxPatternErrors;     /* with MISO wired to MOSI, received bytes off the pattern */
+
+void StreamFill(uint8 *half);
+void StreamCheck(const uint8 *half);
+#endif /* (SPIM_STREAMING) */
+
 /*******************************************************************************
 * Function Name: main
 ********************************************************************************
@@ -64,8 +94,41 @@ uint8 rxBuffer[BUFFER_SIZE];
 *******************************************************************************/
 int main()
 {
-    uint8 i;
-    
+#if (SPIM_STREAMING)
+    uint8 *tx;
+    const uint8 *rx;
+    uint8 intState;
+
+    StreamFill(txStream[0u]);
+    StreamFill(txStream[1u]);
+
+    SPIM_Start();
+    CyGlobalIntEnable;
+    (void)SpimStream_Start(txStream[0u], txStream[1u], rxStream[0u], rxStream[1u], STREAM_LENGTH);
+
+    for(;;)
+    {
+        while((tx = SpimStream_TxAcquire()) != NULL)
+        {
+            StreamFill(tx);
+            SpimStream_TxCommit();
+        }
+        while((rx = SpimStream_RxAcquire()) != NULL)
+        {
+            StreamCheck(rx);
+            SpimStream_RxRelease();
+        }
+
+        /* Sleep until the next half completes; an nrq that comes in between
+        *  stays pending and wakes WFI right away */
+        intState = CyEnterCriticalSection();
+        if(SpimStream_Pending() == 0u)
+        {
+            __WFI();
+        }
+        CyExitCriticalSection(intState);
+    }
+#else
     CyDelay(2000u);
     
     DmaTxConfiguration();
@@ -81,7 +144,47 @@ int main()
         CyDelay(1u);
         DMATxRestart();
     }
+#endif /* (SPIM_STREAMING) */
+}
+
+#if (SPIM_STREAMING)
+/*******************************************************************************
+* Function Name: StreamFill
+********************************************************************************
+* Summary:
+*  Writes the next STREAM_LENGTH bytes of the counting pattern into a TX half.
+*******************************************************************************/
+void StreamFill(uint8 *half)
+{
+    uint16 i;
+
+    for(i = 0u; i < STREAM_LENGTH; i++)
+    {
+        half[i] = txPattern++;
+    }
+}
+
+/*******************************************************************************
+* Function Name: StreamCheck
+********************************************************************************
+* Summary:
+*  Compares a received half with the counting pattern and resynchronises on
+*  the first mismatch.
+*******************************************************************************/
+void StreamCheck(const uint8 *half)
+{
+    uint16 i;
+
+    for(i = 0u; i < STREAM_LENGTH; i++)
+    {
+        if(half[i] != rxPattern)
+        {
+            rxPatternErrors++;
+        }
+        rxPattern = (uint8)(half[i] + 1u);
+    }
 }
+#endif /* (SPIM_STREAMING) */
 
 void DMATxRestart(void)
 {
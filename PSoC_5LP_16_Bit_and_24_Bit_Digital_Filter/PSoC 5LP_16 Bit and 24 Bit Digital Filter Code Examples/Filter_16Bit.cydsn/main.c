@@ -41,6 +41,45 @@ lower and middle Staging Registers of the filter block */
 #define SHIFT_EIGHT             (0x08u)
 #define RESCALING_FACTOR        (0x80u)
 
+/* Called once per pass of the main loop. Nothing on the device; the host emulator
+charges the time a pass takes there, so the components keep running. */
+#ifndef FILTER_POLL_ACCOUNT
+#define FILTER_POLL_ACCOUNT()   ((void)0)
+#endif
+
+/* Output mode. 0: Filter_Done reads every result and writes it to the VDAC. 1: DMA_Out moves
+every result into Filter_Ring, two blocks of FILTER_BLOCK_SAMPLES, and its TERMOUT interrupt
+(isr_Block) hands each block to the main loop as it fills, one interrupt per block instead of
+one per sample; the VDAC then shows the peak of every block. Block mode needs DMA_Out on the
+Filter channel A DMA request and isr_Block on the DMA_Out nrq in place of isr_Filter. HostEmu
+runs it as filter_16bit_block. */
+#ifndef FILTER_OUTPUT_BLOCK
+#define FILTER_OUTPUT_BLOCK     (0u)
+#endif
+#define FILTER_BLOCK_SAMPLES    (64u)   /* up to 2047, a TD moves up to 4095 bytes */
+
+#if (FILTER_OUTPUT_BLOCK != 0u)
+/* Defines for DMA_Out: a 16 bit result per burst, from the holding register to SRAM */
+#define DMA_OUT_BYTES_PER_BURST     (2u)
+#define DMA_OUT_REQUEST_PER_BURST   (1u)
+#define DMA_OUT_SRC_BASE            (CYDEV_PERIPH_BASE)
+#define DMA_OUT_DST_BASE            (CYDEV_SRAM_BASE)
+#define BLOCK_COUNT                 (2u)
+#define SHIFT_SEVEN                 (0x07u)
+#define VDAC8_MAX                   (0xFFu)
+
+/* Filter results, the two blocks DMA_Out fills in turn. Word aligned, so no 2 byte burst
+straddles a word of the SRAM spoke */
+int16 Filter_Ring[BLOCK_COUNT][FILTER_BLOCK_SAMPLES] CY_ALIGN(4);
+
+/* The block filled last, set by Block_Done until the main loop takes it */
+volatile uint8 Block_Ready = 0u;
+volatile uint8 Block_Index = 0u;
+
+/* Blocks filled again before the main loop took them */
+volatile uint32 Block_Overruns = 0u;
+#endif /* FILTER_OUTPUT_BLOCK != 0u */
+
 /* Function Prototypes */
 /* Interrpt service routine to read the filterd data */
 CY_ISR_PROTO(Filter_Done);
@@ -48,6 +87,17 @@ CY_ISR_PROTO(Filter_Done);
 /* Function to configure DMA Channel */
 void DMA_Config(void);
 
+#if (FILTER_OUTPUT_BLOCK != 0u)
+/* Interrupt service routine on each block DMA_Out fills */
+CY_ISR_PROTO(Block_Done);
+
+/* Function to configure DMA_Out */
+void DMA_Out_Config(void);
+
+/* Function to process a block of filtered data */
+void Block_Process(const int16 *block);
+#endif /* FILTER_OUTPUT_BLOCK != 0u */
+
 
 /*******************************************************************************
 * Function Name: main
@@ -74,7 +124,11 @@ int main()
     Filter_Start();
 	VDAC8_Start();
     ADC_DelSig_IRQ_Start();
+#if (FILTER_OUTPUT_BLOCK != 0u)
+    isr_Block_StartEx(Block_Done);
+#else
     isr_Filter_StartEx(Filter_Done);
+#endif /* FILTER_OUTPUT_BLOCK != 0u */
     
     /* For 9-16 bits filter resolution, coherency should be mid, Dalign should be enabled, 
     filter stage pointer will be Filter_STAGEA_PTR */
@@ -83,6 +137,9 @@ int main()
     
     /* User-implemented function to set-up DMA */
     DMA_Config();
+#if (FILTER_OUTPUT_BLOCK != 0u)
+    DMA_Out_Config();
+#endif /* FILTER_OUTPUT_BLOCK != 0u */
     
     /* Start the ADC Conversion */ 
     ADC_DelSig_StartConvert();
@@ -90,6 +147,24 @@ int main()
     for(;;)
     {
         /* Filtered data will be written to VDAC in the filter_done interrupt */ 
+        FILTER_POLL_ACCOUNT();
+#if (FILTER_OUTPUT_BLOCK != 0u)
+        /* or a block at a time here */
+        if(Block_Ready != 0u)
+        {
+            uint8 interruptState;
+            uint8 index;
+
+            /* Take the index and clear the flag together, a Block_Done in between
+            would be lost */
+            interruptState = CyEnterCriticalSection();
+            index = Block_Index;
+            Block_Ready = 0u;
+            CyExitCriticalSection(interruptState);
+
+            Block_Process(Filter_Ring[index]);
+        }
+#endif /* FILTER_OUTPUT_BLOCK != 0u */
     }
 } /* End of main */
 
@@ -121,6 +196,68 @@ CY_ISR(Filter_Done)
 	
 }
 
+#if (FILTER_OUTPUT_BLOCK != 0u)
+/*******************************************************************************
+* Interrupt
+********************************************************************************
+* Interrupt generated on DMA_Out TERMOUT, once a block of the ring is full.
+* Interrupt handle:Block_Done
+*
+* Summary:
+*  Hands the block to the main loop. DMA_Out goes on filling the other block
+*  meanwhile, so the main loop has FILTER_BLOCK_SAMPLES samples of time to take
+*  this one before it is overwritten.
+*
+*******************************************************************************/
+CY_ISR(Block_Done)
+{
+    static uint8 next = 0u;
+
+    if(Block_Ready != 0u)
+    {
+        Block_Overruns++;
+    }
+    Block_Index = next;
+    Block_Ready = 1u;
+    next ^= 1u;
+}
+
+/*******************************************************************************
+* Function Name: Block_Process
+********************************************************************************
+*
+* Summary:
+*  Processes a block of FILTER_BLOCK_SAMPLES filtered samples, the upper 16 bits
+*  of the Filter results: writes the peak magnitude of the block to VDAC.
+*
+* Parameters:
+*  block: the block, in Filter_Ring.
+*
+* Return:
+*  None.
+*
+*******************************************************************************/
+void Block_Process(const int16 *block)
+{
+    uint32 peak = 0u;
+    uint32 magnitude;
+    uint16 i;
+
+    for(i = 0u; i < FILTER_BLOCK_SAMPLES; i++)
+    {
+        magnitude = (block[i] < 0) ? (uint32)(-(int32)block[i]) : (uint32)block[i];
+        if(magnitude > peak)
+        {
+            peak = magnitude;
+        }
+    }
+
+    /* Scale the 15 bit magnitude to the 8 bit VDAC */
+    peak >>= SHIFT_SEVEN;
+    VDAC8_SetValue((peak > VDAC8_MAX) ? VDAC8_MAX : (uint8)peak);
+}
+#endif /* FILTER_OUTPUT_BLOCK != 0u */
+
 /*******************************************************************************
 * Function Name: DMA_Config
 ********************************************************************************
@@ -164,4 +301,50 @@ void DMA_Config(void)
     CyDmaChEnable(channelHandle, 1u);
 }
 
+#if (FILTER_OUTPUT_BLOCK != 0u)
+/*******************************************************************************
+* Function Name: DMA_Out_Config
+********************************************************************************
+*
+* Summary:
+*  Initializes and sets up DMA_Out: on each Filter channel A DMA request, a
+*  burst moves the 16 bit result from the holding register into Filter_Ring.
+*  One TD per block, the two chained in a loop, each raising TERMOUT when its
+*  block is full.
+*
+* Parameters:
+*  None.
+*
+* Return:
+*  None.
+*
+*******************************************************************************/
+void DMA_Out_Config(void)
+{
+    uint8 channelHandle;
+    uint8 td[BLOCK_COUNT];
+    uint8 i;
+
+    channelHandle = DMA_Out_DmaInitialize(DMA_OUT_BYTES_PER_BURST, DMA_OUT_REQUEST_PER_BURST,
+                                          HI16(DMA_OUT_SRC_BASE), HI16(DMA_OUT_DST_BASE));
+
+    for(i = 0u; i < BLOCK_COUNT; i++)
+    {
+        td[i] = CyDmaTdAllocate();
+    }
+
+    for(i = 0u; i < BLOCK_COUNT; i++)
+    {
+        /* The source stays on the aligned holding register, whose middle byte
+        is the coherency key; the destination walks the block */
+        CyDmaTdSetConfiguration(td[i], FILTER_BLOCK_SAMPLES * sizeof(int16),
+                                td[(i + 1u) % BLOCK_COUNT], TD_INC_DST_ADR | DMA_Out__TD_TERMOUT_EN);
+        CyDmaTdSetAddress(td[i], LO16((uint32)Filter_HOLDA_PTR), LO16((uint32)Filter_Ring[i]));
+    }
+
+    CyDmaChSetInitialTd(channelHandle, td[0]);
+    CyDmaChEnable(channelHandle, 1u);
+}
+#endif /* FILTER_OUTPUT_BLOCK != 0u */
+
 /* [] END OF FILE */
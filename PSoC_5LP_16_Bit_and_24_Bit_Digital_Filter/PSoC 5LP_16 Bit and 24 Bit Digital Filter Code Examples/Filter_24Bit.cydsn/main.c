@@ -7,6 +7,18 @@
 * This project demonstrates a 24 Bit Low Pass Filter Operation. For this, we are using
 * ADC configured for 18 bit resolution and DAC configured for 12 bit resolution
 *
+* dfb.v2 is the program the Filter component builds, and the one this project
+* runs. dfb_decim4.v2 is a decimate-by-4 variant of it for a four times faster
+* ADC: the DFB raises a result, and so Filter_Done and the VDAC update, once
+* every four samples. dfb_fold.v2 runs the same 85 taps from half the coefficient
+* RAM (43 words instead of 85), at a cost: 91 DFB cycles a sample against 90 for
+* the same filter unfolded (92 for dfb.v2 as the component built it), because the
+* two samples of a tap pair sit in the same data RAM.
+*
+* The Filter component cannot load either variant, so neither runs on the device
+* as shipped. The host emulator runs them: this main.c against dfb_decim4.v2
+* (make -C HostEmu filter_24bit_decim4), and dfb_fold.v2 on its own (dfbsim_fold).
+*
 * Firmware Dependency:
 * PSoC Creator 3.3 SP1 and above
 *
@@ -42,12 +54,63 @@ all the three Staging Registers. */
 #define MASK_12BIT              (0xFFFu)
 #define SHIFT_THREE             (0x03u)   
 
+/* Called once per pass of the main loop. Nothing on the device; the host emulator
+charges the time a pass takes there, so the components keep running. */
+#ifndef FILTER_POLL_ACCOUNT
+#define FILTER_POLL_ACCOUNT()   ((void)0)
+#endif
+
+/* Output mode. 0: Filter_Done reads every result and writes it to the VDAC. 1: DMA_Out moves
+the upper 16 bits of every result into Filter_Ring, two blocks of FILTER_BLOCK_SAMPLES, and its
+TERMOUT interrupt (isr_Block) hands each block to the main loop as it fills, one interrupt per
+block instead of one per sample; the VDAC then shows the peak of every block. Block mode needs
+DMA_Out on the Filter channel A DMA request and isr_Block on the DMA_Out nrq in place of
+isr_Filter. HostEmu runs it as filter_24bit_block. */
+#ifndef FILTER_OUTPUT_BLOCK
+#define FILTER_OUTPUT_BLOCK     (0u)
+#endif
+#define FILTER_BLOCK_SAMPLES    (64u)   /* up to 2047, a TD moves up to 4095 bytes */
+
+#if (FILTER_OUTPUT_BLOCK != 0u)
+/* Defines for DMA_Out: the upper 16 bits of a result per burst, to SRAM. With the holding
+register aligned its low and middle byte addresses read the middle and high byte, and the
+middle one is then the coherency key; the staging register keeps the high byte key */
+#define FILTER_HOLD_ALIGN           (0x04u)
+#define DMA_OUT_BYTES_PER_BURST     (2u)
+#define DMA_OUT_REQUEST_PER_BURST   (1u)
+#define DMA_OUT_SRC_BASE            (CYDEV_PERIPH_BASE)
+#define DMA_OUT_DST_BASE            (CYDEV_SRAM_BASE)
+#define BLOCK_COUNT                 (2u)
+
+/* Filter results, the two blocks DMA_Out fills in turn. Word aligned, so no 2 byte burst
+straddles a word of the SRAM spoke */
+int16 Filter_Ring[BLOCK_COUNT][FILTER_BLOCK_SAMPLES] CY_ALIGN(4);
+
+/* The block filled last, set by Block_Done until the main loop takes it */
+volatile uint8 Block_Ready = 0u;
+volatile uint8 Block_Index = 0u;
+
+/* Blocks filled again before the main loop took them */
+volatile uint32 Block_Overruns = 0u;
+#endif /* FILTER_OUTPUT_BLOCK != 0u */
+
 /* Function to configure DMA Channel */
 void DMA_Config(void);
 
 /* Interrpt service routine to read the filterd data */
 CY_ISR_PROTO(Filter_Done);
 
+#if (FILTER_OUTPUT_BLOCK != 0u)
+/* Interrupt service routine on each block DMA_Out fills */
+CY_ISR_PROTO(Block_Done);
+
+/* Function to configure DMA_Out */
+void DMA_Out_Config(void);
+
+/* Function to process a block of filtered data */
+void Block_Process(const int16 *block);
+#endif /* FILTER_OUTPUT_BLOCK != 0u */
+
 /* Variable to Hold the Filter Output */
 int32 Filter_Out;
 
@@ -69,26 +132,53 @@ int32 Filter_Out;
 
 int main()
 {
-    /* Start all components used on schematic */
-	ADC_DelSig_Start();
-    ADC_DelSig_StartConvert();
-	ADC_DelSig_IRQ_Start();
+    /* Start the Filter, with the Coherency set to High Byte, and the DMA before the ADC
+       converts, so the DFB only ever takes whole samples and a decimating program counts
+       its inputs from the first conversion */
     VDAC_Start();
 	Filter_Start();
+	Filter_SetCoherency(Filter_CHANNEL_A, Filter_KEY_HIGH);
+#if (FILTER_OUTPUT_BLOCK != 0u)
+    isr_Block_StartEx(Block_Done);
+#else
     isr_Filter_StartEx(Filter_Done);
+#endif /* FILTER_OUTPUT_BLOCK != 0u */
 	
 	/* Configure the DMA */
 	DMA_Config();
+#if (FILTER_OUTPUT_BLOCK != 0u)
+    Filter_DALIGN_REG = Filter_DALIGN_REG | FILTER_HOLD_ALIGN;
+    Filter_SetCoherencyEx(Filter_HOLDA_COHER, Filter_KEY_MID);
+	DMA_Out_Config();
+#endif /* FILTER_OUTPUT_BLOCK != 0u */
 
-	/* Set the Filter Coherency to High Byte */
-	Filter_SetCoherency(Filter_CHANNEL_A, Filter_KEY_HIGH);
+	ADC_DelSig_Start();
+	ADC_DelSig_IRQ_Start();
+    ADC_DelSig_StartConvert();
 	
     /* Enable Global Interrupts */
     CYGlobalIntEnable;
 
     for(;;)
     {	
-		
+        FILTER_POLL_ACCOUNT();
+#if (FILTER_OUTPUT_BLOCK != 0u)
+        /* Process the filtered data a block at a time */
+        if(Block_Ready != 0u)
+        {
+            uint8 interruptState;
+            uint8 index;
+
+            /* Take the index and clear the flag together, a Block_Done in between
+            would be lost */
+            interruptState = CyEnterCriticalSection();
+            index = Block_Index;
+            Block_Ready = 0u;
+            CyExitCriticalSection(interruptState);
+
+            Block_Process(Filter_Ring[index]);
+        }
+#endif /* FILTER_OUTPUT_BLOCK != 0u */
     }
 
 } /* End of main */
@@ -116,6 +206,68 @@ CY_ISR(Filter_Done)
 	/* Write the value to VDAC */
 	VDAC_SetValue(Filter_Out);
 }
+
+#if (FILTER_OUTPUT_BLOCK != 0u)
+/*******************************************************************************
+* Interrupt
+********************************************************************************
+* Interrupt generated on DMA_Out TERMOUT, once a block of the ring is full.
+* Interrupt handle:Block_Done
+*
+* Summary:
+*  Hands the block to the main loop. DMA_Out goes on filling the other block
+*  meanwhile, so the main loop has FILTER_BLOCK_SAMPLES samples of time to take
+*  this one before it is overwritten.
+*
+*******************************************************************************/
+CY_ISR(Block_Done)
+{
+    static uint8 next = 0u;
+
+    if(Block_Ready != 0u)
+    {
+        Block_Overruns++;
+    }
+    Block_Index = next;
+    Block_Ready = 1u;
+    next ^= 1u;
+}
+
+/*******************************************************************************
+* Function Name: Block_Process
+********************************************************************************
+*
+* Summary:
+*  Processes a block of FILTER_BLOCK_SAMPLES filtered samples, the upper 16 bits
+*  of the Filter results: writes the peak magnitude of the block to VDAC.
+*
+* Parameters:
+*  block: the block, in Filter_Ring.
+*
+* Return:
+*  None.
+*
+*******************************************************************************/
+void Block_Process(const int16 *block)
+{
+    uint32 peak = 0u;
+    uint32 magnitude;
+    uint16 i;
+
+    for(i = 0u; i < FILTER_BLOCK_SAMPLES; i++)
+    {
+        magnitude = (block[i] < 0) ? (uint32)(-(int32)block[i]) : (uint32)block[i];
+        if(magnitude > peak)
+        {
+            peak = magnitude;
+        }
+    }
+
+    /* Scale the 15 bit magnitude to the 12 bit VDAC */
+    peak >>= SHIFT_THREE;
+    VDAC_SetValue((peak > VDAC_MAX) ? VDAC_MAX : peak);
+}
+#endif /* FILTER_OUTPUT_BLOCK != 0u */
 /*******************************************************************************
 * Function Name: DMA_Config
 ********************************************************************************
@@ -162,4 +314,50 @@ void DMA_Config(void)
     CyDmaChEnable(channelHandle, 1u);
 }
 
+#if (FILTER_OUTPUT_BLOCK != 0u)
+/*******************************************************************************
+* Function Name: DMA_Out_Config
+********************************************************************************
+*
+* Summary:
+*  Initializes and sets up DMA_Out: on each Filter channel A DMA request, a
+*  burst moves the upper 16 bits of the result from the aligned holding
+*  register, one 16 bit spoke access ending on its middle byte key, into
+*  Filter_Ring. One TD per block, the two chained in a loop, each raising
+*  TERMOUT when its block is full.
+*
+* Parameters:
+*  None.
+*
+* Return:
+*  None.
+*
+*******************************************************************************/
+void DMA_Out_Config(void)
+{
+    uint8 channelHandle;
+    uint8 td[BLOCK_COUNT];
+    uint8 i;
+
+    channelHandle = DMA_Out_DmaInitialize(DMA_OUT_BYTES_PER_BURST, DMA_OUT_REQUEST_PER_BURST,
+                                          HI16(DMA_OUT_SRC_BASE), HI16(DMA_OUT_DST_BASE));
+
+    for(i = 0u; i < BLOCK_COUNT; i++)
+    {
+        td[i] = CyDmaTdAllocate();
+    }
+
+    for(i = 0u; i < BLOCK_COUNT; i++)
+    {
+        /* The source stays on the aligned holding register, the destination walks the block */
+        CyDmaTdSetConfiguration(td[i], FILTER_BLOCK_SAMPLES * sizeof(int16),
+                                td[(i + 1u) % BLOCK_COUNT], TD_INC_DST_ADR | DMA_Out__TD_TERMOUT_EN);
+        CyDmaTdSetAddress(td[i], LO16((uint32)Filter_HOLDA_PTR), LO16((uint32)Filter_Ring[i]));
+    }
+
+    CyDmaChSetInitialTd(channelHandle, td[0]);
+    CyDmaChEnable(channelHandle, 1u);
+}
+#endif /* FILTER_OUTPUT_BLOCK != 0u */
+
 /* [] END OF FILE */
@@ -0,0 +1,168 @@
+/**
+ * @file
+ * @brief Scanline DMA from a ring of line TDs, see VgaChain.h.
+ */
+#include "VgaChain.h"
+
+#include <string.h>
+
+#include "../../../Common/DmaTdFast.h"
+
+#define VGA_CHAIN_PRESERVE_TDS (1u) /* the TDs are rewritten by the CPU only */
+
+static uint8 chainCh = CY_DMA_INVALID_CHANNEL;
+static uint8 chainTd[VGA_CHAIN_TDS];
+static uint8 chainTdCount; /* allocated so far, kept across VgaChain_Start() */
+static const uint8 *chainPage;
+static uint16 chainScroll; /* frame buffer row shown on the top line, see VgaChain_SetScroll() */
+
+/*
+ * The ring holds the lines [chainLine - VGA_CHAIN_TDS, chainLine) in ring order from slot
+ * chainNext on; slot chainNext starts the half that goes out first.
+ */
+static uint8 chainNext;
+static uint16 chainLine;
+static VgaChain_Stats chainStats;
+
+/**
+ * @brief Frame buffer row shown on visible line @p line, as the per-line ScanLine ISR shows it.
+ *
+ * The ISR moves the TD source on the lines that are a multiple of VGA_Y_FACTOR, which only takes
+ * effect on the line after, and leaves it alone on line 0: so line k shows row
+ * (k - 1) / VGA_Y_FACTOR, and lines 0..VGA_Y_FACTOR keep the last row of the frame. The rows
+ * count from chainScroll on, wrapping around the end of the frame buffer.
+ */
+static uint16 VgaChain_Row(uint16 line)
+{
+    uint16 row = (line <= VGA_Y_FACTOR) ? (uint16)(VGA_Y_BYTES - 1u)
+                                        : (uint16)((line - 1u) / VGA_Y_FACTOR);
+
+    row = (uint16)(row + chainScroll);
+    return (row >= VGA_Y_BYTES) ? (uint16)(row - VGA_Y_BYTES) : row;
+}
+
+/* Points @p count ring slots from chainNext on at the lines from chainLine on. */
+static void VgaChain_Fill(uint8 count)
+{
+    while (count--)
+    {
+        DmaTdFast_SetSrc(chainTd[chainNext],
+                         LO16((uint32)(chainPage + VgaChain_Row(chainLine) * VGA_X_BYTES)));
+        chainNext = (uint8)((chainNext + 1u) % VGA_CHAIN_TDS);
+        chainLine = (uint16)((chainLine + 1u) % VGA_RES_Y);
+    }
+}
+
+/* Rewrites the whole ring from the first line of the frame the ring is on. */
+static void VgaChain_Rewrite(void)
+{
+    chainLine = (uint16)((chainLine + VGA_RES_Y - VGA_CHAIN_TDS) % VGA_RES_Y);
+    VgaChain_Fill(VGA_CHAIN_TDS);
+}
+
+/**
+ * @brief Builds the ring for lines 0..VGA_CHAIN_TDS - 1 of @p page and starts it on @p chHandle.
+ *
+ * @p chHandle is the line DMA channel, initialized with the HI16 of the frame buffer and of the
+ * peripherals; @p page is a VGA_BUFF_SIZE frame buffer. The TDs are allocated once and kept.
+ * Started in the middle of a frame the ring shows the wrong rows until the first refill puts it
+ * back on the line being drawn.
+ *
+ * @return CYRET_SUCCESS, CYRET_BAD_PARAM or CYRET_MEMORY (no free TDs).
+ */
+cystatus VgaChain_Start(uint8 chHandle, const uint8 *page)
+{
+    uint8 k;
+
+    if ((chHandle == CY_DMA_INVALID_CHANNEL) || (page == NULL))
+        return CYRET_BAD_PARAM;
+    while (chainTdCount < VGA_CHAIN_TDS)
+    {
+        uint8 td = CyDmaTdAllocate();
+
+        if (td == CY_DMA_INVALID_TD)
+            return CYRET_MEMORY;
+        chainTd[chainTdCount++] = td;
+    }
+
+    /* One line per TD chained into a ring, the last TD of each half raises SCANLINE */
+    for (k = 0u; k < VGA_CHAIN_TDS; k++)
+    {
+        DmaTdFast_SetConfiguration(chainTd[k], VGA_X_BYTES, chainTd[(k + 1u) % VGA_CHAIN_TDS],
+                                   TD_INC_SRC_ADR | ((((k + 1u) % VGA_CHAIN_HALF_LINES) == 0u)
+                                                         ? DMA__TD_TERMOUT_EN
+                                                         : 0u));
+        DmaTdFast_SetDst(chainTd[k], LO16((uint32)DMA_OUT_Control_PTR));
+    }
+    chainCh = chHandle;
+    chainPage = page;
+    chainScroll = 0u;
+    chainNext = 0u;
+    chainLine = 0u;
+    memset(&chainStats, 0, sizeof(chainStats));
+    VgaChain_Fill(VGA_CHAIN_TDS);
+
+    (void)CyDmaChSetInitialTd(chainCh, chainTd[0]);
+    (void)CyDmaChEnable(chainCh, VGA_CHAIN_PRESERVE_TDS);
+    return CYRET_SUCCESS;
+}
+
+/**
+ * @brief Call from the SCANLINE interrupt: points the half of the ring that just went out at
+ *        the lines after the other half.
+ *
+ * The interrupt comes on the last line of the half, LINE_CNT tells which line that is; when it
+ * is not the line the ring expected (the ring was started mid-frame, or lines were missed) the
+ * whole ring is rewritten from the line after it.
+ *
+ * @return 1 when the half ended with the last visible line, the retrace comes next.
+ */
+uint8 VgaChain_Refill(void)
+{
+    uint16 line = (uint16)((LINE_CNT_HI_Status << 8) | LINE_CNT_LO_Status);
+    uint16 expected = (uint16)((chainLine + VGA_RES_Y - VGA_CHAIN_TDS + VGA_CHAIN_HALF_LINES - 1u) %
+                               VGA_RES_Y);
+
+    chainStats.refills++;
+    if ((line == expected) || (line >= VGA_RES_Y))
+    {
+        VgaChain_Fill(VGA_CHAIN_HALF_LINES);
+        return (uint8)(expected + 1u == VGA_RES_Y);
+    }
+
+    /* The other half goes out from the next line on, this one after it */
+    chainStats.resyncs++;
+    chainNext = (uint8)((chainNext + VGA_CHAIN_HALF_LINES) % VGA_CHAIN_TDS);
+    chainLine = (uint16)((line + 1u) % VGA_RES_Y);
+    VgaChain_Fill(VGA_CHAIN_TDS);
+    return (uint8)(line + 1u == VGA_RES_Y);
+}
+
+/**
+ * @brief Shows @p page from now on, rewriting every TD of the ring.
+ *
+ * Call from the SCANLINE interrupt when VgaChain_Refill() returned 1: the whole ring is on lines
+ * of the next frame then, so the page changes exactly between two frames.
+ */
+void VgaChain_SetPage(const uint8 *page)
+{
+    chainPage = page;
+    VgaChain_Rewrite();
+}
+
+/**
+ * @brief Shows frame buffer row @p row on the top line from now on, rewriting every TD of the
+ *        ring.
+ *
+ * The frame buffer is a ring of rows: the lines further down show the rows after @p row and
+ * wrap around to row 0 after the last one, so scrolling by any number of rows is this call
+ * instead of moving the frame buffer. Call it like VgaChain_SetPage(), from the SCANLINE
+ * interrupt when VgaChain_Refill() returned 1.
+ */
+void VgaChain_SetScroll(uint16 row)
+{
+    chainScroll = (uint16)(row % VGA_Y_BYTES);
+    VgaChain_Rewrite();
+}
+
+const VgaChain_Stats *VgaChain_GetStats(void) { return &chainStats; }
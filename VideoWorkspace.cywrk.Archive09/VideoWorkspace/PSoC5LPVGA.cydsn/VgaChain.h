@@ -0,0 +1,64 @@
+/**
+ * @file
+ * @brief Scanline DMA from a ring of line TDs, one SCANLINE interrupt per VGA_CHAIN_HALF_LINES.
+ *
+ * The per-line ScanLine ISR in main.c moves the one line TD to the next frame buffer row on
+ * every visible line, 36000 interrupts a second at 800x600. Here every line has its own TD with
+ * the row address already in it, chained into a ring: line_dma runs one TD per line and the
+ * ring walks through the lines by itself, a row shown on VGA_Y_FACTOR lines simply has that many
+ * TDs pointing at it. Only the last TD of each half of the ring raises SCANLINE; the interrupt
+ * writes the lines one ring further on into the half that just went out, while the other half
+ * is being shown.
+ *
+ * A whole frame needs two TDs per frame buffer row, 600 at 800x600, and the DMAC has 128, so the
+ * ring is the closest to one interrupt per frame the TD memory allows: 15 per frame with
+ * VGA_CHAIN_HALF_LINES 40. Getting to none would take a second channel writing the line TD from
+ * an address table, which needs a schematic change.
+ *
+ * Every line shows the row the per-line ISR would show it, including its first lines showing
+ * the last row, so both modes draw the same picture. A page flip or a hardware scroll rewrites
+ * the whole ring once, between two frames (VgaChain_SetPage(), VgaChain_SetScroll()).
+ *
+ * @code
+ *   dmaCh = DMA_DmaInitialize(1, 0, HI16((uint32) dframe), HI16(CYDEV_PERIPH_BASE));
+ *   VgaChain_Start(dmaCh, &dframe[0][0]);
+ *   SCANLINE_StartEx(ScanLine);
+ *   ...
+ *   CY_ISR(ScanLine)
+ *   {
+ *       if (VgaChain_Refill())
+ *           refresh++;  // that was the last visible line
+ *   }
+ * @endcode
+ *
+ * Schematic: DMA with line_dma on its drq, DMA_OUT as destination and its nrq on SCANLINE, as
+ * for the per-line ISR.
+ */
+#ifndef VGA_CHAIN_H
+#define VGA_CHAIN_H
+
+#include "VgaConfig.h"
+
+/** Lines per half of the ring, one SCANLINE interrupt each; has to divide VGA_RES_Y. */
+#ifndef VGA_CHAIN_HALF_LINES
+#define VGA_CHAIN_HALF_LINES (40u)
+#endif
+#define VGA_CHAIN_TDS (2u * VGA_CHAIN_HALF_LINES)
+
+#if (VGA_RES_Y % VGA_CHAIN_HALF_LINES) != 0
+#error "VGA_CHAIN_HALF_LINES has to divide VGA_RES_Y"
+#endif
+
+typedef struct
+{
+    uint32 refills; /**< SCANLINE interrupts, one per ring half */
+    uint32 resyncs; /**< refills that found the ring on another line than expected */
+} VgaChain_Stats;
+
+cystatus VgaChain_Start(uint8 chHandle, const uint8 *page);
+uint8 VgaChain_Refill(void);
+void VgaChain_SetPage(const uint8 *page);
+void VgaChain_SetScroll(uint16 row);
+const VgaChain_Stats *VgaChain_GetStats(void);
+
+#endif /* VGA_CHAIN_H */
@@ -0,0 +1,91 @@
+/**
+ * @file
+ * @brief Colour modes, see VgaColor.h. Only built with VGA_BPP 2 or 4, the palette registers
+ *        are not in the 1 bpp schematic.
+ */
+#include "VgaColor.h"
+
+#if VGA_BPP > 1
+
+/* Shadow of PALETTE_LO / PALETTE_HI, each register holds two entries */
+static uint8 colorPalette[VGA_COLOR_PALETTE_SIZE] = {VGA_COLOR_BLACK, VGA_COLOR_WHITE,
+                                                     VGA_COLOR_GREEN | VGA_COLOR_BRIGHT,
+                                                     VGA_COLOR_RED | VGA_COLOR_BRIGHT};
+
+#if VGA_BPP == 2
+/* 4 pixels of 2 bpp from a nibble of 1 bpp @p bits, @p fg for a set bit, @p bg for a clear one */
+static uint8 VgaColor_Nibble(uint8 bits, uint8 fg, uint8 bg)
+{
+    uint8 out = 0u;
+    uint8 k;
+
+    for (k = 0u; k < 4u; k++)
+        out = (uint8)((out << 2) | (((bits >> (3u - k)) & 1u) ? fg : bg));
+    return out;
+}
+#endif
+
+/* Entries 2 * @p half and 2 * @p half + 1 into their control register, none at 4 bpp */
+static void VgaColor_Load(uint8 half)
+{
+#if VGA_BPP == 2
+    uint8 value = (uint8)(colorPalette[2u * half] | (colorPalette[2u * half + 1u] << 4));
+
+    if (half == 0u)
+        PALETTE_LO_Write(value);
+    else
+        PALETTE_HI_Write(value);
+#else
+    (void)half;
+#endif
+}
+
+/** @brief Loads the palette into PALETTE_LO and PALETTE_HI: black, white, green and red. */
+void VgaColor_Start(void)
+{
+    VgaColor_Load(0u);
+    VgaColor_Load(1u);
+}
+
+/**
+ * @brief Sets palette entry @p index to the RGBI colour @p rgbi.
+ *
+ * Takes effect on the next pixel, a whole screen of one pixel value changes colour at once.
+ * At 4 bpp the pixel value is the colour and only the shadow changes.
+ */
+void VgaColor_SetPalette(uint8 index, uint8 rgbi)
+{
+    if (index >= VGA_COLOR_PALETTE_SIZE)
+        return;
+    colorPalette[index] = (uint8)(rgbi & 0x0Fu);
+    VgaColor_Load((uint8)(index / 2u));
+}
+
+uint8 VgaColor_GetPalette(uint8 index)
+{
+    return (index < VGA_COLOR_PALETTE_SIZE) ? colorPalette[index] : VGA_COLOR_BLACK;
+}
+
+/**
+ * @brief Expands 8 pixels of 1 bpp @p bits (a font row) into the VGA_GLYPH_BYTES bytes at
+ *        @p dst, pixel value @p fg where a bit is set and @p bg where it is not.
+ */
+void VgaColor_ExpandRow(uint8 *dst, uint8 bits, uint8 fg, uint8 bg)
+{
+#if VGA_BPP == 4
+    uint8 k;
+
+    for (k = 0u; k < 4u; k++)
+    {
+        uint8 left = (uint8)(((bits >> (7u - 2u * k)) & 1u) ? fg : bg);
+        uint8 right = (uint8)(((bits >> (6u - 2u * k)) & 1u) ? fg : bg);
+
+        dst[k] = (uint8)(VGA_PIXEL_LEFT(left) | VGA_PIXEL_RIGHT(right));
+    }
+#else
+    dst[0] = VgaColor_Nibble((uint8)(bits >> 4), fg, bg);
+    dst[1] = VgaColor_Nibble((uint8)(bits & 0x0Fu), fg, bg);
+#endif
+}
+
+#endif /* VGA_BPP > 1 */
@@ -0,0 +1,45 @@
+/**
+ * @file
+ * @brief Colour modes: 2 bpp through the VideoPixel palette, 4 bpp RGBI, see VgaConfig.h.
+ *
+ * VideoPixel (VideoPixel_v1_0.v) replaces the pixel mux after the DMA_OUT latch and drives the
+ * RGBI pins: at 2 bpp the pixel value picks one of 4 palette entries from the PALETTE_LO and
+ * PALETTE_HI control registers, at 4 bpp the pixel value is the colour. The line DMA, the TDs
+ * and the frame buffer sizes are the same as at 1 bpp, only the pixels are packed tighter.
+ *
+ * @code
+ *   VgaColor_Start();                       // default palette
+ *   VgaColor_SetPalette(3, VGA_COLOR_RED);  // 2 bpp: pixel value 3 is red
+ *   VgaColor_ExpandRow(&cframe[y][x * VGA_GLYPH_BYTES], bits, 3, 0);
+ * @endcode
+ *
+ * Schematic: VideoPixel with BitsPerPixel = VGA_BPP between the DMA_OUT latch, PIXEL_SELECT
+ * and the colour pins, PALETTE_LO and PALETTE_HI on its palette bus.
+ *
+ * Host-only for now: VideoPixel_v1_0 has no symbol (.cysym) and none of the above is in
+ * TopDesign, so 2 and 4 bpp only run in the host emulator, which models VideoPixel in C.
+ */
+#ifndef VGA_COLOR_H
+#define VGA_COLOR_H
+
+#include "VgaConfig.h"
+
+/* RGBI, the bits of the colour pins */
+#define VGA_COLOR_BLACK (0x0u)
+#define VGA_COLOR_BLUE (0x1u)
+#define VGA_COLOR_GREEN (0x2u)
+#define VGA_COLOR_CYAN (0x3u)
+#define VGA_COLOR_RED (0x4u)
+#define VGA_COLOR_MAGENTA (0x5u)
+#define VGA_COLOR_YELLOW (0x6u)
+#define VGA_COLOR_WHITE (0x7u)
+#define VGA_COLOR_BRIGHT (0x8u)
+
+#define VGA_COLOR_PALETTE_SIZE (4u)
+
+void VgaColor_Start(void);
+void VgaColor_SetPalette(uint8 index, uint8 rgbi);
+uint8 VgaColor_GetPalette(uint8 index);
+void VgaColor_ExpandRow(uint8 *dst, uint8 bits, uint8 fg, uint8 bg);
+
+#endif /* VGA_COLOR_H */
@@ -0,0 +1,103 @@
+/**
+ * @file
+ * @brief Frame buffer geometry of PSoC5LPVGA, shared by main.c and the Vga* modules.
+ *
+ * The resolution comes from the VideoCtrl_1 instance; the frame buffers hold VGA_BPP bits per
+ * pixel and every frame buffer row is shown on VGA_Y_FACTOR consecutive lines, to fit in SRAM.
+ * The pixel shifter takes a byte every VGA_X_FACTOR pixel clocks whatever the depth, so a
+ * deeper pixel is wider on screen and the buffer sizes and TD counts stay what they are at
+ * 1 bpp: 800x300 pixels at 1 bpp, 400x300 at 2 bpp, 200x300 at 4 bpp.
+ */
+#ifndef VGA_CONFIG_H
+#define VGA_CONFIG_H
+
+#include <project.h>
+
+// Get the resolution from the Video Controller instance.
+#define VGA_RES_X VideoCtrl_1_H_RES
+#define VGA_RES_Y VideoCtrl_1_V_RES
+// Bits per pixel: 1 is the DMA_OUT bit straight to the pins, 2 looks the colour up in the
+// 4 entry palette of VideoPixel and 4 is the RGBI colour itself (see VgaColor.h).
+// Only 1 runs on the device: 2 and 4 are a host-only model for now, VideoPixel has no .cysym
+// and is not in the schematic (make -C HostEmu vga_color, vga_color4).
+#ifndef VGA_BPP
+#define VGA_BPP 1
+#endif
+#if (VGA_BPP != 1) && (VGA_BPP != 2) && (VGA_BPP != 4)
+#error "VGA_BPP has to be 1, 2 or 4"
+#endif
+// The pixel shifter takes one byte every 8 pixel clocks so we only need 1/8th for our
+// horizontal dimension, with 8 / VGA_BPP pixels in the byte, each VGA_BPP clocks wide.
+#define VGA_X_FACTOR 8
+#define VGA_PIXELS_PER_BYTE (8/VGA_BPP)
+#define VGA_PIXEL_CLOCKS (VGA_X_FACTOR/VGA_PIXELS_PER_BYTE)
+// Tile mode: the screen is a map of 8x8 tiles out of a store of distinct ones, expanded line
+// by line (see VgaTile.h) instead of the cframe and dframe frame buffers, which are left out.
+#ifndef VGA_TILE_MODE
+#define VGA_TILE_MODE 0
+#endif
+// We don't have enough memory so we are going to duplicate the vertical lines
+// to save on memory requirements. The tile map is small enough to show every line.
+#if VGA_TILE_MODE
+#define VGA_Y_FACTOR 1
+#else
+#define VGA_Y_FACTOR 2
+#endif
+// This is our final dimmensions for our frame buffers.
+#define VGA_X_BYTES ((VGA_RES_X)/VGA_X_FACTOR)
+#define VGA_Y_BYTES (VGA_RES_Y/VGA_Y_FACTOR)
+#define VGA_BUFF_SIZE (VGA_X_BYTES*VGA_Y_BYTES)
+// Pixels of a frame buffer row, and bytes of an 8 pixel wide character.
+#define VGA_PIXELS_X (VGA_X_BYTES*VGA_PIXELS_PER_BYTE)
+#define VGA_GLYPH_BYTES VGA_BPP
+#define VGA_X_GLYPHS (VGA_X_BYTES/VGA_GLYPH_BYTES)
+// Pixel values a pixel can have, and the leftmost / rightmost pixel of a byte set to value v.
+#define VGA_PIXEL_VALUES (1u << VGA_BPP)
+#define VGA_PIXEL_LEFT(v) ((uint8)((v) << (8 - VGA_BPP)))
+#define VGA_PIXEL_RIGHT(v) ((uint8)((v) & (VGA_PIXEL_VALUES - 1u)))
+// cframe and dframe each have one half of the SRAM (.ram and .ram2).
+#if (VGA_BUFF_SIZE > 32768) && !VGA_TILE_MODE
+#error "A frame buffer has to fit in one half of the SRAM"
+#endif
+
+// Text mode: the screen is a character buffer that gets expanded from the font line by line
+// (see VgaText.h) instead of the cframe and dframe frame buffers, which are left out.
+#ifndef VGA_TEXT_MODE
+#define VGA_TEXT_MODE 0
+#endif
+#if VGA_TEXT_MODE && (VGA_BPP != 1)
+#error "The text mode expands the 1 bpp font, build it with VGA_BPP 1"
+#endif
+
+// Fine horizontal scroll: VideoPixel shows the picture FINE_SCROLL pixel clocks (0-7) later,
+// moving it right; needs VideoPixel and the FINE_SCROLL control register in the schematic.
+#ifndef VGA_FINE_SCROLL
+#define VGA_FINE_SCROLL 0
+#endif
+#if VGA_FINE_SCROLL && VGA_TEXT_MODE
+#error "The fine scroll is latched with the frame buffer scroll, text mode has none"
+#endif
+
+// Sprites: 1 bpp bitmaps composited over the frame buffer row by row into line buffers by the
+// per-line ScanLine interrupt (see VgaSprite.h), so they need it and the 1 bpp row layout.
+#ifndef VGA_SPRITES
+#define VGA_SPRITES 0
+#endif
+#if VGA_SPRITES && (VGA_TEXT_MODE || VGA_TILE_MODE || (VGA_BPP != 1))
+#error "Sprites are composited over the 1 bpp frame buffer, build them with VGA_BPP 1"
+#endif
+
+// The tile mode is a mode of its own, with the 1 bpp rows of the line buffers.
+#if VGA_TILE_MODE && (VGA_TEXT_MODE || VGA_FINE_SCROLL || (VGA_BPP != 1))
+#error "The tile mode expands 1 bpp tiles, build it with VGA_BPP 1 and no text mode or fine scroll"
+#endif
+
+/**
+ * Called once per pass of every loop that waits on an ISR flag. Nothing on the device; the host
+ * emulator charges the time a pass takes there, so the components keep running.
+ */
+#ifndef VGA_POLL_ACCOUNT
+#define VGA_POLL_ACCOUNT() ((void)0)
+#endif
+
+#endif /* VGA_CONFIG_H */
@@ -0,0 +1,255 @@
+/**
+ * @file
+ * @brief Dirty-band tracking for the cframe to dframe retrace copy, see VgaDirty.h.
+ */
+#include "VgaDirty.h"
+
+#include <string.h>
+
+#include "../../../Common/DmaTdFast.h"
+
+#define VGA_DIRTY_BYTES_PER_BURST (64u)   /**< a multiple of the 4-byte SRAM spoke */
+#define VGA_DIRTY_REQUEST_PER_BURST (0u)  /**< one CPU request runs a whole TD */
+#define VGA_DIRTY_PRESERVE_TDS (1u)
+#define VGA_DIRTY_TD_FLAGS (TD_INC_SRC_ADR | TD_INC_DST_ADR)
+
+static uint8 dirtyCh = CY_DMA_INVALID_CHANNEL;
+static uint8 dirtyTd[VGA_DIRTY_TDS];
+static uint8 dirtyTdCount; /* allocated so far, kept across VgaDirty_Start() */
+static uint8 *dirtySrc;
+static uint8 *dirtyDst;
+
+static uint8 dirtyBand[VGA_DIRTY_BANDS]; /* 1: written since its last copy */
+static volatile uint8 dirtyBusy;
+static VgaDirty_Stats dirtyStats;
+
+/* Byte offset of a band in the frame; VGA_DIRTY_BANDS gives the frame size. */
+static uint32 VgaDirty_Offset(uint16 band)
+{
+    uint32 offset = (uint32)band * VGA_DIRTY_BAND_BYTES;
+
+    return (offset < VGA_BUFF_SIZE) ? offset : VGA_BUFF_SIZE;
+}
+
+/**
+ * @brief Finds the next run of dirty bands at or after @p *band.
+ *
+ * @return 1 with the run in [*first, *end) and @p *band past it, 0 when there is none left.
+ */
+static uint8 VgaDirty_NextSpan(uint16 *band, uint16 *first, uint16 *end)
+{
+    uint16 b = *band;
+
+    while ((b < VGA_DIRTY_BANDS) && !dirtyBand[b])
+        b++;
+    if (b == VGA_DIRTY_BANDS)
+        return 0u;
+    *first = b;
+    while ((b < VGA_DIRTY_BANDS) && dirtyBand[b])
+        b++;
+    *end = b;
+    *band = b;
+    return 1u;
+}
+
+/* TDs needed for the bands [first, end). */
+static uint8 VgaDirty_TdsFor(uint16 first, uint16 end)
+{
+    uint32 bytes = VgaDirty_Offset(end) - VgaDirty_Offset(first);
+
+    return (uint8)((bytes + VGA_DIRTY_MAX_TD_LENGTH - 1u) / VGA_DIRTY_MAX_TD_LENGTH);
+}
+
+/**
+ * @brief Writes the TDs of the bands [first, end) from pool slot @p k on, clearing the bands.
+ *
+ * Every TD but the last of the chain (slot @p total - 1) auto-executes into the next one.
+ *
+ * @return Pool slot after the last one written.
+ */
+static uint8 VgaDirty_Chain(uint16 first, uint16 end, uint8 k, uint8 total)
+{
+    uint32 offset = VgaDirty_Offset(first);
+    uint32 stop = VgaDirty_Offset(end);
+
+    memset(&dirtyBand[first], 0, (size_t)(end - first));
+    while (offset < stop)
+    {
+        uint16 n = (uint16)(((stop - offset) > VGA_DIRTY_MAX_TD_LENGTH) ? VGA_DIRTY_MAX_TD_LENGTH
+                                                                       : (stop - offset));
+        uint8 last = (uint8)(k + 1u == total);
+
+        DmaTdFast_SetConfiguration(dirtyTd[k], n, last ? CY_DMA_DISABLE_TD : dirtyTd[k + 1u],
+                                   VGA_DIRTY_TD_FLAGS |
+                                       (last ? DMA_MEM__TD_TERMOUT_EN : TD_AUTO_EXEC_NEXT));
+        DmaTdFast_SetAddress(dirtyTd[k], LO16((uint32)dirtySrc + offset),
+                             LO16((uint32)dirtyDst + offset));
+        offset += n;
+        k++;
+    }
+    return k;
+}
+
+/**
+ * @brief Sets up DMA_MEM from @p cpuFrame to @p dmaFrame and marks the whole frame dirty.
+ *
+ * Both frames are VGA_BUFF_SIZE bytes, each within one 64 KB region. The TDs are allocated
+ * once and kept.
+ *
+ * @return CYRET_SUCCESS, CYRET_BAD_PARAM or CYRET_MEMORY (no free TDs).
+ */
+cystatus VgaDirty_Start(uint8 *cpuFrame, uint8 *dmaFrame)
+{
+    if ((cpuFrame == NULL) || (dmaFrame == NULL))
+        return CYRET_BAD_PARAM;
+    while (dirtyTdCount < VGA_DIRTY_TDS)
+    {
+        uint8 td = CyDmaTdAllocate();
+
+        if (td == CY_DMA_INVALID_TD)
+            return CYRET_MEMORY;
+        dirtyTd[dirtyTdCount++] = td;
+    }
+
+    dirtySrc = cpuFrame;
+    dirtyDst = dmaFrame;
+    dirtyBusy = 0u;
+    memset(&dirtyStats, 0, sizeof(dirtyStats));
+    VgaDirty_MarkAll();
+    dirtyCh = DMA_MEM_DmaInitialize(VGA_DIRTY_BYTES_PER_BURST, VGA_DIRTY_REQUEST_PER_BURST,
+                                    HI16((uint32)cpuFrame), HI16((uint32)dmaFrame));
+    FRAME_RDY_StartEx(VgaDirty_DoneIsr);
+    return CYRET_SUCCESS;
+}
+
+/** @brief Marks @p count frame buffer rows from @p row on as written. */
+void VgaDirty_MarkRows(uint16 row, uint16 count)
+{
+    uint16 band;
+    uint16 end;
+
+    if ((count == 0u) || (row >= VGA_Y_BYTES))
+        return;
+    end = (uint16)((row + count < VGA_Y_BYTES) ? (row + count) : VGA_Y_BYTES);
+    for (band = (uint16)(row / VGA_DIRTY_BAND_ROWS); band * VGA_DIRTY_BAND_ROWS < end; band++)
+        dirtyBand[band] = 1u;
+}
+
+/** @brief Marks the whole frame as written, e.g. after redrawing it. */
+void VgaDirty_MarkAll(void) { memset(dirtyBand, 1, sizeof(dirtyBand)); }
+
+/**
+ * @brief Copies the whole frame with memcpy() right away and clears every band.
+ *
+ * For the first picture, outside the retrace, so no sync starts with the whole frame dirty.
+ * Not while a VgaDirty_Sync() copy runs.
+ */
+void VgaDirty_CopyAll(void)
+{
+    memcpy(dirtyDst, dirtySrc, VGA_BUFF_SIZE);
+    memset(dirtyBand, 0, sizeof(dirtyBand));
+    dirtyStats.bytes += VGA_BUFF_SIZE;
+}
+
+/** @brief 1 when some band waits for the next sync. */
+uint8 VgaDirty_Pending(void)
+{
+    uint16 band = 0u;
+    uint16 first;
+    uint16 end;
+
+    return VgaDirty_NextSpan(&band, &first, &end);
+}
+
+/**
+ * @brief Starts the DMA_MEM copy of every dirty band; call on the retrace, with no copy running.
+ *
+ * When the spans need more TDs than the pool holds, everything from the first to the last dirty
+ * band goes in one span instead.
+ *
+ * @return Bytes being copied; 0 when nothing was dirty and no copy was started.
+ */
+uint16 VgaDirty_Sync(void)
+{
+    uint16 band = 0u;
+    uint16 first;
+    uint16 end;
+    uint16 lowest = VGA_DIRTY_BANDS;
+    uint16 highest = 0u;
+    uint32 total = 0u;
+    uint32 bytes = 0u;
+    uint8 k = 0u;
+
+    if (dirtyBusy)
+        return 0u;
+    while (VgaDirty_NextSpan(&band, &first, &end))
+    {
+        if (lowest == VGA_DIRTY_BANDS)
+            lowest = first;
+        highest = end;
+        total += VgaDirty_TdsFor(first, end);
+        bytes += VgaDirty_Offset(end) - VgaDirty_Offset(first);
+    }
+    if (total == 0u)
+        return 0u;
+
+    if (total > VGA_DIRTY_TDS)
+    {
+        total = VgaDirty_TdsFor(lowest, highest);
+        bytes = VgaDirty_Offset(highest) - VgaDirty_Offset(lowest);
+        (void)VgaDirty_Chain(lowest, highest, 0u, (uint8)total);
+        dirtyStats.merged++;
+    }
+    else
+    {
+        band = 0u;
+        while (VgaDirty_NextSpan(&band, &first, &end))
+            k = VgaDirty_Chain(first, end, k, (uint8)total);
+    }
+
+    dirtyStats.syncs++;
+    dirtyStats.bytes += bytes;
+    dirtyStats.tds += total;
+    dirtyBusy = 1u;
+    (void)CyDmaChSetInitialTd(dirtyCh, dirtyTd[0]);
+    (void)CyDmaChEnable(dirtyCh, VGA_DIRTY_PRESERVE_TDS);
+    (void)CyDmaChSetRequest(dirtyCh, CPU_REQ);
+    return (uint16)bytes;
+}
+
+/** @brief 1 while the copy VgaDirty_Sync() started is running. */
+uint8 VgaDirty_Busy(void) { return dirtyBusy; }
+
+/**
+ * @brief Copies every dirty band with memcpy(), for builds without the DMA_MEM copy.
+ *
+ * @return Bytes copied.
+ */
+uint16 VgaDirty_SyncCpu(void)
+{
+    uint16 band = 0u;
+    uint16 first;
+    uint16 end;
+    uint32 bytes = 0u;
+
+    while (VgaDirty_NextSpan(&band, &first, &end))
+    {
+        uint32 offset = VgaDirty_Offset(first);
+        uint32 n = VgaDirty_Offset(end) - offset;
+
+        memcpy(dirtyDst + offset, dirtySrc + offset, n);
+        memset(&dirtyBand[first], 0, (size_t)(end - first));
+        bytes += n;
+    }
+    if (bytes != 0u)
+    {
+        dirtyStats.syncs++;
+        dirtyStats.bytes += bytes;
+    }
+    return (uint16)bytes;
+}
+
+const VgaDirty_Stats *VgaDirty_GetStats(void) { return &dirtyStats; }
+
+/** @brief FRAME_RDY (DMA_MEM nrq): the last TD of the chain is done, dframe is up to date. */
+CY_ISR(VgaDirty_DoneIsr) { dirtyBusy = 0u; }
@@ -0,0 +1,65 @@
+/**
+ * @file
+ * @brief Dirty-band tracking for the cframe to dframe retrace copy.
+ *
+ * The frame buffer is split into bands of VGA_DIRTY_BAND_ROWS rows, one character row of the
+ * EEPROM font. Code that writes cframe marks the rows it touched; on the retrace
+ * VgaDirty_Sync() builds a DMA_MEM chain over just the dirty bands, neighbouring bands merged
+ * into one span, and starts it with a single CPU request. The TDs auto-execute into each other
+ * and only the last raises DMA_MEM nrq, so FRAME_RDY runs once per retrace instead of once per
+ * TD. Flipping one character then copies 800 bytes instead of the 30 KB frame, and lands on
+ * the next frame.
+ *
+ * @code
+ *   VgaDirty_Start(&cframe[0][0], &dframe[0][0]);
+ *   ...
+ *   cframe[y + n][x] = ...;
+ *   VgaDirty_MarkRows(y, 8);
+ *   ...
+ *   // retrace
+ *   if (VgaDirty_Sync() != 0u)
+ *       while (VgaDirty_Busy());
+ * @endcode
+ *
+ * After drawing the first picture, VgaDirty_CopyAll() copies it before the retraces take over:
+ * a whole frame does not fit in one retrace with memcpy, and with DMA it takes half of it.
+ *
+ * Marking and syncing belong to the main loop. A band marked while its copy runs is copied
+ * again on the next sync, so nothing written is lost. Schematic: DMA_MEM with its nrq on
+ * FRAME_RDY, as for the full-frame copy in main.c.
+ */
+#ifndef VGA_DIRTY_H
+#define VGA_DIRTY_H
+
+#include "VgaConfig.h"
+
+#define VGA_DIRTY_BAND_ROWS (8u) /**< frame buffer rows per band, one font character */
+#define VGA_DIRTY_BANDS ((VGA_Y_BYTES + VGA_DIRTY_BAND_ROWS - 1u) / VGA_DIRTY_BAND_ROWS)
+#define VGA_DIRTY_BAND_BYTES (VGA_DIRTY_BAND_ROWS * VGA_X_BYTES)
+#define VGA_DIRTY_MAX_TD_LENGTH (4092u) /**< 12-bit TD count, kept a multiple of the SRAM spoke */
+#define VGA_DIRTY_FRAME_TDS                                                                        \
+    ((VGA_BUFF_SIZE + VGA_DIRTY_MAX_TD_LENGTH - 1u) / VGA_DIRTY_MAX_TD_LENGTH)
+/** TD pool: a whole frame plus a few spans split at a TD boundary; more spans are merged. */
+#define VGA_DIRTY_TDS (VGA_DIRTY_FRAME_TDS + 4u)
+
+typedef struct
+{
+    uint32 syncs;  /**< chains started or CPU copies done */
+    uint32 bytes;  /**< bytes copied */
+    uint32 tds;    /**< TDs run */
+    uint32 merged; /**< syncs that needed more TDs than the pool, copied first to last band */
+} VgaDirty_Stats;
+
+cystatus VgaDirty_Start(uint8 *cpuFrame, uint8 *dmaFrame);
+void VgaDirty_MarkRows(uint16 row, uint16 count);
+void VgaDirty_MarkAll(void);
+void VgaDirty_CopyAll(void);
+uint8 VgaDirty_Pending(void);
+uint16 VgaDirty_Sync(void);
+uint8 VgaDirty_Busy(void);
+uint16 VgaDirty_SyncCpu(void);
+const VgaDirty_Stats *VgaDirty_GetStats(void);
+
+CY_ISR_PROTO(VgaDirty_DoneIsr);
+
+#endif /* VGA_DIRTY_H */
@@ -0,0 +1,369 @@
+/**
+ * @file
+ * @brief 1 bpp drawing, see VgaGfx.h. Only built with VGA_BPP 1.
+ */
+#include "VgaGfx.h"
+
+#include "../../../Common/FastCopy.h"
+
+#if VGA_BPP == 1
+
+#if (VGA_X_BYTES % 4) != 0
+#error "VgaGfx draws whole words, VGA_X_BYTES has to be a multiple of 4"
+#endif
+
+#define VGA_GFX_WIDTH ((int32)VGA_PIXELS_X)
+#define VGA_GFX_HEIGHT ((int32)VGA_Y_BYTES)
+#define VGA_GFX_REV(w) __builtin_bswap32(w) /* REV: screen order mask to little endian word */
+
+static uint8 *gfxFrame;
+static void (*gfxDrawHook)(uint16 row, uint16 count);
+static uint8 gfxDmaCh = CY_DMA_INVALID_CHANNEL;
+static uint8 gfxDmaTd = CY_DMA_INVALID_TD; /* allocated once, kept across VgaGfx_Start() */
+static VgaGfx_Stats gfxStats;
+
+static void VgaGfx_Drawn(int32 row, int32 count)
+{
+    if ((gfxDrawHook != NULL) && (count > 0))
+        gfxDrawHook((uint16)row, (uint16)count);
+}
+
+static void VgaGfx_ApplyWord(FastCopy_Word *w, uint32 mask, uint8 op)
+{
+    if (op == VGA_GFX_CLEAR)
+        *w &= ~mask;
+    else if (op == VGA_GFX_SET)
+        *w |= mask;
+    else
+        *w ^= mask;
+}
+
+static void VgaGfx_ApplyByte(uint8 *b, uint8 mask, uint8 op)
+{
+    if (op == VGA_GFX_CLEAR)
+        *b &= (uint8)~mask;
+    else if (op == VGA_GFX_SET)
+        *b |= mask;
+    else
+        *b ^= mask;
+}
+
+/* Pixels [@p x0, @p x1) of row @p y, already clipped: edge masks and whole words between. */
+static void VgaGfx_Span(int32 y, int32 x0, int32 x1, uint8 op)
+{
+    FastCopy_Word *w = (FastCopy_Word *)(void *)(gfxFrame + y * VGA_X_BYTES) + x0 / 32;
+    uint32 n = (uint32)((x1 - 1) / 32 - x0 / 32); /* words after the first one */
+    uint32 left = 0xFFFFFFFFu >> (x0 & 31);
+    uint32 right = 0xFFFFFFFFu << (31 - ((x1 - 1) & 31));
+
+    VGA_GFX_ACCOUNT(VGA_GFX_COST_WORD, n + 1u);
+    if (n == 0u)
+    {
+        VgaGfx_ApplyWord(w, VGA_GFX_REV(left & right), op);
+        return;
+    }
+    VgaGfx_ApplyWord(w++, VGA_GFX_REV(left), op);
+    /* The inner words need no mask and no read for CLEAR and SET */
+    if (op == VGA_GFX_CLEAR)
+    {
+        for (; n > 1u; n--)
+            *w++ = 0u;
+    }
+    else if (op == VGA_GFX_SET)
+    {
+        for (; n > 1u; n--)
+            *w++ = 0xFFFFFFFFu;
+    }
+    else
+    {
+        for (; n > 1u; n--, w++)
+            *w = ~*w;
+    }
+    VgaGfx_ApplyWord(w, VGA_GFX_REV(right), op);
+}
+
+/* VGA_GFX_COPY is VGA_GFX_SET for everything but glyphs */
+static uint8 VgaGfx_SpanOp(uint8 op)
+{
+    return (op == VGA_GFX_COPY) ? VGA_GFX_SET : op;
+}
+
+/* Copies @p count rows from @p src to @p dst, the two ranges must not overlap. */
+static void VgaGfx_MoveRows(int32 dst, int32 src, int32 count)
+{
+    uint8 *d = gfxFrame + dst * VGA_X_BYTES;
+    const uint8 *s = gfxFrame + src * VGA_X_BYTES;
+    uint32 bytes = (uint32)count * VGA_X_BYTES;
+
+    if ((gfxDmaCh != CY_DMA_INVALID_CHANNEL) && (bytes >= FAST_COPY_DMA_MIN))
+    {
+        FastCopy_Dma(d, s, bytes);
+        gfxStats.dmaCopies++;
+    }
+    else
+    {
+        FastCopy_LdmStm(d, s, bytes);
+        VGA_GFX_ACCOUNT(VGA_GFX_COST_COPY, (bytes + 15u) / 16u);
+        gfxStats.cpuCopies++;
+    }
+}
+
+/**
+ * @brief Draws into @p frame from now on; scrolls copy with DMA on @p dmaCh.
+ *
+ * @p dmaCh is a channel set up for SRAM to SRAM copies with one burst per request, such as
+ * DMA_MEM, or CY_DMA_INVALID_CHANNEL to scroll with the CPU alone. It may be shared with the
+ * retrace copy, every scroll takes it over again; its TD is allocated once and kept.
+ *
+ * @return CYRET_SUCCESS, CYRET_BAD_PARAM or CYRET_MEMORY (no free TD).
+ */
+cystatus VgaGfx_Start(uint8 *frame, uint8 dmaCh)
+{
+    if (frame == NULL)
+        return CYRET_BAD_PARAM;
+    if ((dmaCh != CY_DMA_INVALID_CHANNEL) && (gfxDmaTd == CY_DMA_INVALID_TD))
+    {
+        gfxDmaTd = CyDmaTdAllocate();
+        if (gfxDmaTd == CY_DMA_INVALID_TD)
+            return CYRET_MEMORY;
+    }
+    gfxFrame = frame;
+    gfxDmaCh = dmaCh;
+    return CYRET_SUCCESS;
+}
+
+/** @brief Draws into @p frame from now on, e.g. the back page after a page flip. */
+void VgaGfx_SetTarget(uint8 *frame) { gfxFrame = frame; }
+
+/** @brief Calls @p onDraw with the rows every primitive changed; NULL for none. */
+void VgaGfx_SetDrawHook(void (*onDraw)(uint16 row, uint16 count)) { gfxDrawHook = onDraw; }
+
+void VgaGfx_Pixel(int16 x, int16 y, uint8 op)
+{
+    if ((x < 0) || (x >= VGA_GFX_WIDTH) || (y < 0) || (y >= VGA_GFX_HEIGHT))
+        return;
+    VgaGfx_ApplyByte(gfxFrame + y * VGA_X_BYTES + x / 8, (uint8)(0x80u >> (x & 7)),
+                     VgaGfx_SpanOp(op));
+    VGA_GFX_ACCOUNT(VGA_GFX_COST_BYTE, 1u);
+    VgaGfx_Drawn(y, 1);
+}
+
+/** @brief 1 when the pixel at @p x, @p y is on, 0 when it is off or outside the frame. */
+uint8 VgaGfx_GetPixel(int16 x, int16 y)
+{
+    if ((x < 0) || (x >= VGA_GFX_WIDTH) || (y < 0) || (y >= VGA_GFX_HEIGHT))
+        return 0u;
+    return (uint8)((gfxFrame[y * VGA_X_BYTES + x / 8] >> (7 - (x & 7))) & 1u);
+}
+
+/** @brief @p w pixels to the right of @p x, @p y. */
+void VgaGfx_HLine(int16 x, int16 y, int16 w, uint8 op)
+{
+    VgaGfx_FillRect(x, y, w, 1, op);
+}
+
+/** @brief @p h pixels down from @p x, @p y, one byte per row. */
+void VgaGfx_VLine(int16 x, int16 y, int16 h, uint8 op)
+{
+    int32 y0 = (y < 0) ? 0 : y;
+    int32 y1 = ((int32)y + h > VGA_GFX_HEIGHT) ? VGA_GFX_HEIGHT : (int32)y + h;
+    uint8 mask = (uint8)(0x80u >> (x & 7));
+    uint8 *b;
+    int32 k;
+
+    if ((x < 0) || (x >= VGA_GFX_WIDTH) || (y0 >= y1))
+        return;
+    op = VgaGfx_SpanOp(op);
+    b = gfxFrame + y0 * VGA_X_BYTES + x / 8;
+    for (k = y0; k < y1; k++, b += VGA_X_BYTES)
+        VgaGfx_ApplyByte(b, mask, op);
+    VGA_GFX_ACCOUNT(VGA_GFX_COST_BYTE, y1 - y0);
+    VgaGfx_Drawn(y0, y1 - y0);
+}
+
+/** @brief Fills, clears or inverts the @p w x @p h rectangle at @p x, @p y, a span per row. */
+void VgaGfx_FillRect(int16 x, int16 y, int16 w, int16 h, uint8 op)
+{
+    int32 x0 = (x < 0) ? 0 : x;
+    int32 x1 = ((int32)x + w > VGA_GFX_WIDTH) ? VGA_GFX_WIDTH : (int32)x + w;
+    int32 y0 = (y < 0) ? 0 : y;
+    int32 y1 = ((int32)y + h > VGA_GFX_HEIGHT) ? VGA_GFX_HEIGHT : (int32)y + h;
+    int32 k;
+
+    if ((x0 >= x1) || (y0 >= y1))
+        return;
+    op = VgaGfx_SpanOp(op);
+    for (k = y0; k < y1; k++)
+        VgaGfx_Span(k, x0, x1, op);
+    VgaGfx_Drawn(y0, y1 - y0);
+}
+
+/** @brief Outline of the @p w x @p h rectangle at @p x, @p y, every pixel drawn once. */
+void VgaGfx_Rect(int16 x, int16 y, int16 w, int16 h, uint8 op)
+{
+    if ((w <= 0) || (h <= 0))
+        return;
+    VgaGfx_HLine(x, y, w, op);
+    if (h > 1)
+        VgaGfx_HLine(x, (int16)(y + h - 1), w, op);
+    if (h > 2)
+    {
+        VgaGfx_VLine(x, (int16)(y + 1), (int16)(h - 2), op);
+        if (w > 1)
+            VgaGfx_VLine((int16)(x + w - 1), (int16)(y + 1), (int16)(h - 2), op);
+    }
+}
+
+/**
+ * @brief Line from @p x0, @p y0 to @p x1, @p y1, both ends included (Bresenham).
+ *
+ * A line closer to horizontal goes out as one span per row it crosses, a steeper one pixel by
+ * pixel; either way every pixel is drawn once, so VGA_GFX_INVERT twice restores the frame.
+ */
+void VgaGfx_Line(int16 x0, int16 y0, int16 x1, int16 y1, uint8 op)
+{
+    int32 dx = (x1 > x0) ? x1 - x0 : x0 - x1;
+    int32 dy = (y1 > y0) ? y1 - y0 : y0 - y1;
+    int32 sx = (x1 > x0) ? 1 : -1;
+    int32 sy = (y1 > y0) ? 1 : -1;
+    int32 x = x0;
+    int32 y = y0;
+    int32 err;
+    int32 k;
+
+    if (dx >= dy)
+    {
+        int32 run = x0; /* first pixel of the run on row y */
+
+        err = 2 * dy - dx;
+        for (k = 0; k < dx; k++)
+        {
+            if (err > 0)
+            {
+                VgaGfx_HLine((int16)((sx > 0) ? run : x), (int16)y,
+                             (int16)(((sx > 0) ? x - run : run - x) + 1), op);
+                y += sy;
+                run = x + sx;
+                err -= 2 * dx;
+            }
+            err += 2 * dy;
+            x += sx;
+        }
+        VGA_GFX_ACCOUNT(VGA_GFX_COST_STEP, dx);
+        VgaGfx_HLine((int16)((sx > 0) ? run : x), (int16)y,
+                     (int16)(((sx > 0) ? x - run : run - x) + 1), op);
+    }
+    else
+    {
+        err = 2 * dx - dy;
+        for (k = 0; k <= dy; k++)
+        {
+            VgaGfx_Pixel((int16)x, (int16)y, op);
+            if (err > 0)
+            {
+                x += sx;
+                err -= 2 * dy;
+            }
+            err += 2 * dx;
+            y += sy;
+        }
+        VGA_GFX_ACCOUNT(VGA_GFX_COST_STEP, dy);
+    }
+}
+
+/**
+ * @brief Character @p c of the EEPROM font with its top left pixel at @p x, @p y.
+ *
+ * Any @p x works: a glyph row lands in two bytes, shifted by x % 8. VGA_GFX_COPY also clears
+ * the unset pixels of the 8x8 cell, the other operations only touch the set ones.
+ */
+void VgaGfx_Glyph(int16 x, int16 y, uint8 c, uint8 op)
+{
+    int32 bx = (x >= 0) ? x / 8 : (x - 7) / 8; /* byte of the left half, rounded down */
+    uint8 shift = (uint8)(x & 7);
+    int32 y0 = (y < 0) ? 0 : y;
+    int32 y1 = ((int32)y + 8 > VGA_GFX_HEIGHT) ? VGA_GFX_HEIGHT : (int32)y + 8;
+    int32 k;
+
+    if ((x <= -8) || (x >= VGA_GFX_WIDTH) || (y0 >= y1))
+        return;
+    for (k = y0; k < y1; k++)
+    {
+        uint8 *row = gfxFrame + k * VGA_X_BYTES;
+        uint16 bits = (uint16)(CY_GET_REG8(CYDEV_EE_BASE + c + (k - y) * 256u) << 8) >> shift;
+        uint16 cell = (uint16)(0xFF00u >> shift);
+        uint8 half;
+
+        for (half = 0u; half < 2u; half++)
+        {
+            int32 b = bx + half;
+            uint8 on = (uint8)((half == 0u) ? (bits >> 8) : bits);
+            uint8 mask = (uint8)((half == 0u) ? (cell >> 8) : cell);
+
+            if ((b < 0) || (b >= VGA_X_BYTES) || (mask == 0u))
+                continue;
+            if (op == VGA_GFX_COPY)
+                row[b] = (uint8)((row[b] & ~mask) | on);
+            else
+                VgaGfx_ApplyByte(&row[b], on, op);
+        }
+    }
+    VGA_GFX_ACCOUNT(VGA_GFX_COST_BYTE, 2 * (y1 - y0));
+    VgaGfx_Drawn(y0, y1 - y0);
+}
+
+/** @brief Glyphs of the string @p s, 8 pixels apart. */
+void VgaGfx_Text(int16 x, int16 y, const char *s, uint8 op)
+{
+    for (; *s != '\0'; s++, x = (int16)(x + 8))
+        VgaGfx_Glyph(x, y, (uint8)*s, op);
+}
+
+/**
+ * @brief Scrolls the frame up by @p rows (down when negative), the rows that come in are
+ *        cleared.
+ *
+ * The rows move in chunks of at most @p rows rows, so no chunk overlaps itself: a scroll by a
+ * few rows copies 100 bytes at a time with LDM/STM, a larger one hands its chunks to DMA.
+ */
+void VgaGfx_Scroll(int16 rows)
+{
+    int32 n = (rows < 0) ? -rows : rows;
+    int32 end;
+
+    if (n == 0)
+        return;
+    if (n >= VGA_GFX_HEIGHT)
+    {
+        VgaGfx_FillRect(0, 0, VGA_GFX_WIDTH, VGA_GFX_HEIGHT, VGA_GFX_CLEAR);
+        return;
+    }
+    if (gfxDmaCh != CY_DMA_INVALID_CHANNEL)
+        FastCopy_DmaInit(gfxDmaCh, gfxDmaTd); /* the retrace copy may have had the channel */
+
+    if (rows > 0)
+    {
+        for (end = 0; end < VGA_GFX_HEIGHT - n; end += n)
+        {
+            int32 count = (VGA_GFX_HEIGHT - n - end < n) ? VGA_GFX_HEIGHT - n - end : n;
+
+            VgaGfx_MoveRows(end, end + n, count);
+        }
+        VgaGfx_FillRect(0, (int16)(VGA_GFX_HEIGHT - n), VGA_GFX_WIDTH, (int16)n, VGA_GFX_CLEAR);
+    }
+    else
+    {
+        for (end = VGA_GFX_HEIGHT; end > n; end -= n)
+        {
+            int32 count = (end - n < n) ? end - n : n;
+
+            VgaGfx_MoveRows(end - count, end - count - n, count);
+        }
+        VgaGfx_FillRect(0, 0, VGA_GFX_WIDTH, (int16)n, VGA_GFX_CLEAR);
+    }
+    VgaGfx_Drawn(0, VGA_GFX_HEIGHT);
+}
+
+const VgaGfx_Stats *VgaGfx_GetStats(void) { return &gfxStats; }
+
+#endif /* VGA_BPP == 1 */
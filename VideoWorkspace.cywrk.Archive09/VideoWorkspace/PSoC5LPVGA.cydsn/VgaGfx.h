@@ -0,0 +1,72 @@
+/**
+ * @file
+ * @brief 1 bpp drawing into a frame buffer: spans, rectangles, lines, font glyphs and scroll.
+ *
+ * The frame buffer is VGA_Y_BYTES rows of VGA_X_BYTES bytes, 8 pixels a byte with the leftmost
+ * one in bit 7, as main.c's cframe. Rows are whole words, so a horizontal run of pixels is
+ * drawn a 32-bit word at a time: an edge mask for the first and the last word and plain words
+ * in between, 25 word writes for a full 800 pixel row instead of 800 pixel writes. Words are
+ * little endian, the mask of screen order pixels is byte reversed (REV) to match. Lines are
+ * drawn with Bresenham and every run of pixels on one row of a flat line goes out as a span.
+ * Glyphs come from the EEPROM font at any pixel position, two byte writes per glyph row.
+ *
+ * Scrolling moves the rows in chunks that do not overlap themselves; with a DMA channel a chunk
+ * of at least FAST_COPY_DMA_MIN bytes is copied by DMA, smaller ones with LDM/STM
+ * (Common/FastCopy.h). The frame buffer main.c shows can also scroll without moving anything,
+ * through its scrollRequest; the rows then count from the scroll row.
+ *
+ * Everything is clipped to the frame. After drawing, the draw hook gets the rows that changed,
+ * e.g. VgaDirty_MarkRows() so the retrace copy picks them up.
+ *
+ * @code
+ *   VgaGfx_Start(&cframe[0][0], dmaMemCh);
+ *   VgaGfx_SetDrawHook(VgaDirty_MarkRows);
+ *   VgaGfx_Rect(0, 0, VGA_PIXELS_X, VGA_Y_BYTES, VGA_GFX_SET);
+ *   VgaGfx_Text(16, 16, "Hello", VGA_GFX_COPY);
+ *   VgaGfx_Scroll(8);
+ * @endcode
+ */
+#ifndef VGA_GFX_H
+#define VGA_GFX_H
+
+#include "VgaConfig.h"
+
+/* Raster operations, applied to the pixels a primitive covers */
+#define VGA_GFX_CLEAR (0u)  /**< pixels off */
+#define VGA_GFX_SET (1u)    /**< pixels on */
+#define VGA_GFX_INVERT (2u) /**< pixels flipped */
+#define VGA_GFX_COPY (3u)   /**< glyphs only: glyph pixels on, the rest of the cell off */
+
+/* What the drawing loops do n times, for VGA_GFX_ACCOUNT() */
+#define VGA_GFX_COST_WORD (0u) /**< word read-modify-write of a span */
+#define VGA_GFX_COST_BYTE (1u) /**< byte read-modify-write: a pixel, half a glyph row */
+#define VGA_GFX_COST_STEP (2u) /**< Bresenham step without a memory access */
+#define VGA_GFX_COST_COPY (3u) /**< 16 bytes of a scroll copied with LDM/STM */
+
+/* The host emulator charges the Cortex-M3 time of the drawing loops, the device needs nothing */
+#ifndef VGA_GFX_ACCOUNT
+#define VGA_GFX_ACCOUNT(kind, n) ((void)0)
+#endif
+
+typedef struct
+{
+    uint32 dmaCopies; /**< scroll chunks copied by DMA */
+    uint32 cpuCopies; /**< scroll chunks copied by the CPU */
+} VgaGfx_Stats;
+
+cystatus VgaGfx_Start(uint8 *frame, uint8 dmaCh);
+void VgaGfx_SetTarget(uint8 *frame);
+void VgaGfx_SetDrawHook(void (*onDraw)(uint16 row, uint16 count));
+void VgaGfx_Pixel(int16 x, int16 y, uint8 op);
+uint8 VgaGfx_GetPixel(int16 x, int16 y);
+void VgaGfx_HLine(int16 x, int16 y, int16 w, uint8 op);
+void VgaGfx_VLine(int16 x, int16 y, int16 h, uint8 op);
+void VgaGfx_FillRect(int16 x, int16 y, int16 w, int16 h, uint8 op);
+void VgaGfx_Rect(int16 x, int16 y, int16 w, int16 h, uint8 op);
+void VgaGfx_Line(int16 x0, int16 y0, int16 x1, int16 y1, uint8 op);
+void VgaGfx_Glyph(int16 x, int16 y, uint8 c, uint8 op);
+void VgaGfx_Text(int16 x, int16 y, const char *s, uint8 op);
+void VgaGfx_Scroll(int16 rows);
+const VgaGfx_Stats *VgaGfx_GetStats(void);
+
+#endif /* VGA_GFX_H */
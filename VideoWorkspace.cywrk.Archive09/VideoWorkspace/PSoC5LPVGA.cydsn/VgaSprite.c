@@ -0,0 +1,127 @@
+/**
+ * @file
+ * @brief Sprites composited into line buffers, see VgaSprite.h. Only built with VGA_SPRITES.
+ */
+#include "VgaSprite.h"
+
+#include <string.h>
+
+#include "../../../Common/FastCopy.h"
+
+#if VGA_SPRITES
+
+#if (VGA_X_BYTES % 4) != 0
+#error "VgaSprite copies whole words, VGA_X_BYTES has to be a multiple of 4"
+#endif
+
+static VgaSprite spriteSet[VGA_SPRITE_COUNT];  /* as written by the main loop */
+static VgaSprite spriteShown[VGA_SPRITE_COUNT]; /* as taken over on the last line */
+static uint8 spriteLine[2][VGA_X_BYTES] __attribute__((aligned(4)));
+static uint8 spriteNext; /* line buffer filled next */
+static VgaSprite_Stats spriteStats;
+
+/* Combines row @p pixels of sprite @p s into line buffer @p line, clipped to its bytes. */
+static void VgaSprite_Combine(uint8 *line, const VgaSprite *s, uint16 pixels)
+{
+    int32 col = (s->x >= 0) ? (s->x / 8) : -((7 - s->x) / 8); /* byte of the left edge */
+    uint32 bits = ((uint32)(pixels & ((s->width == 8u) ? 0xFF00u : 0xFFFFu)) << 8) >>
+                  (s->x - col * 8);
+    uint8 b;
+
+    VGA_SPRITE_ACCOUNT(VGA_SPRITE_COST_ROW, 1u);
+    for (b = 0u; b < 3u; b++, col++)
+    {
+        uint8 mask = (uint8)(bits >> (16u - 8u * b));
+
+        if ((mask == 0u) || (col < 0) || (col >= (int32)VGA_X_BYTES))
+            continue;
+        if (s->op == VGA_SPRITE_OR)
+            line[col] |= mask;
+        else
+            line[col] ^= mask;
+    }
+}
+
+/** @brief Hides every sprite; call before the ScanLine interrupt is enabled. */
+void VgaSprite_Start(void)
+{
+    memset(spriteSet, 0, sizeof(spriteSet));
+    memset(spriteShown, 0, sizeof(spriteShown));
+    memset(&spriteStats, 0, sizeof(spriteStats));
+    spriteNext = 0u;
+}
+
+/**
+ * @brief Gives sprite @p id the @p height rows of @p bitmap, @p width 8 or 16 pixels wide,
+ *        combined with @p op; it keeps its position. Shown from the next frame on.
+ *
+ * @p bitmap is not copied and has to stay valid while it is shown.
+ *
+ * @return CYRET_SUCCESS or CYRET_BAD_PARAM.
+ */
+cystatus VgaSprite_Set(uint8 id, const uint16 *bitmap, uint8 width, uint8 height, uint8 op)
+{
+    if ((id >= VGA_SPRITE_COUNT) || ((width != 8u) && (width != 16u)) || (op > VGA_SPRITE_XOR) ||
+        ((bitmap == NULL) && (op != VGA_SPRITE_OFF)))
+        return CYRET_BAD_PARAM;
+    spriteSet[id].bitmap = bitmap;
+    spriteSet[id].width = width;
+    spriteSet[id].height = height;
+    spriteSet[id].op = op;
+    return CYRET_SUCCESS;
+}
+
+/** @brief Puts the top left pixel of sprite @p id at column @p x of screen row @p y. */
+void VgaSprite_Move(uint8 id, int16 x, int16 y)
+{
+    if (id >= VGA_SPRITE_COUNT)
+        return;
+    spriteSet[id].x = x;
+    spriteSet[id].y = y;
+}
+
+/** @brief Sprite @p id as written so far, shown from the next frame on; NULL for a bad @p id. */
+const VgaSprite *VgaSprite_Get(uint8 id)
+{
+    return (id < VGA_SPRITE_COUNT) ? &spriteSet[id] : NULL;
+}
+
+/** @brief Call from the SCANLINE interrupt on the last visible line: shows the sprites as set. */
+void VgaSprite_Latch(void) { memcpy(spriteShown, spriteSet, sizeof(spriteShown)); }
+
+/**
+ * @brief Call from the SCANLINE interrupt for every frame buffer @p row it points the line TD
+ *        at, shown on screen row @p screenRow.
+ *
+ * @return @p row when no sprite is on @p screenRow, else a line buffer with @p row and the
+ *         sprites on it; valid until the call after the next one.
+ */
+const uint8 *VgaSprite_Row(uint16 screenRow, const uint8 *row)
+{
+    uint8 *line = NULL;
+    uint8 k;
+
+    for (k = 0u; k < VGA_SPRITE_COUNT; k++)
+    {
+        const VgaSprite *s = &spriteShown[k];
+        int32 r = (int32)screenRow - s->y;
+
+        if ((s->op == VGA_SPRITE_OFF) || (r < 0) || (r >= (int32)s->height))
+            continue;
+        if (line == NULL)
+        {
+            line = spriteLine[spriteNext];
+            spriteNext ^= 1u;
+            FastCopy_LdmStm(line, row, VGA_X_BYTES);
+            VGA_SPRITE_ACCOUNT(VGA_SPRITE_COST_COPY, (VGA_X_BYTES + 15u) / 16u);
+            spriteStats.rows++;
+        }
+        VgaSprite_Combine(line, s, s->bitmap[r]);
+        spriteStats.spriteRows++;
+    }
+    return (line != NULL) ? line : row;
+}
+
+const VgaSprite_Stats *VgaSprite_GetStats(void) { return &spriteStats; }
+
+#endif /* VGA_SPRITES */
@@ -0,0 +1,89 @@
+/**
+ * @file
+ * @brief Sprites: small 1 bpp bitmaps ORed or XORed over the frame buffer as it goes out, without
+ *        touching it.
+ *
+ * Up to VGA_SPRITE_COUNT sprites, 8 or 16 pixels wide and up to 255 rows high, each at a pixel
+ * column and a screen row of its own; a sprite may hang over any edge of the screen. The
+ * per-line ScanLine ISR hands every frame buffer row it points the line TD at through
+ * VgaSprite_Row(): a row no sprite covers goes out from the frame buffer as it is, a row with a
+ * sprite on it is copied into one of two line buffers with LDM/STM, the sprites are combined into
+ * it (three byte writes per sprite row) and the line TD shows the line buffer instead. The line
+ * buffers take turns, one is shown while the other one is filled.
+ *
+ * Moving a sprite is VgaSprite_Move(): it only writes the position, nothing is redrawn or copied.
+ * Sprites are positioned on the screen, not in the frame buffer, so they stay put when the frame
+ * buffer scrolls. The ScanLine ISR takes every sprite written so far over on the last line
+ * (VgaSprite_Latch()), so a frame never shows a sprite at two positions; set and move them from
+ * the main loop between two refreshes.
+ *
+ * @code
+ *   static const uint16 arrow[16] = {0x8000u, 0xC000u, ...};
+ *
+ *   VgaSprite_Start();
+ *   VgaSprite_Set(0u, arrow, 16u, 16u, VGA_SPRITE_OR);
+ *   ...
+ *   CY_ISR(ScanLine)
+ *   {
+ *       ...
+ *       DmaTdFast_SetSrc(DMA_LINE_TD, LO16((uint32)VgaSprite_Row(line / VGA_Y_FACTOR,
+ *                                                                 dframe[row])));
+ *       ...
+ *       if ((line + 1) == VGA_RES_Y)
+ *           VgaSprite_Latch();
+ *   }
+ *   ...
+ *   VgaSprite_Move(0u, x, y);
+ * @endcode
+ *
+ * Schematic: none, the line buffers go out through the line DMA as frame buffer rows do.
+ */
+#ifndef VGA_SPRITE_H
+#define VGA_SPRITE_H
+
+#include "VgaConfig.h"
+
+/** Sprites there are, all of them are looked at on every frame buffer row. */
+#ifndef VGA_SPRITE_COUNT
+#define VGA_SPRITE_COUNT (4u)
+#endif
+
+/* How a sprite is combined with the frame buffer */
+#define VGA_SPRITE_OFF (0u) /**< not shown */
+#define VGA_SPRITE_OR (1u)  /**< sprite pixels on */
+#define VGA_SPRITE_XOR (2u) /**< sprite pixels flipped */
+
+/* What the compositor does n times, for VGA_SPRITE_ACCOUNT() */
+#define VGA_SPRITE_COST_COPY (0u) /**< 16 bytes of a frame buffer row copied with LDM/STM */
+#define VGA_SPRITE_COST_ROW (1u)  /**< sprite row shifted into place, three byte writes */
+
+/* The host emulator charges the Cortex-M3 time of the compositor, the device needs nothing */
+#ifndef VGA_SPRITE_ACCOUNT
+#define VGA_SPRITE_ACCOUNT(kind, n) ((void)0)
+#endif
+
+typedef struct
+{
+    const uint16 *bitmap; /**< height rows, leftmost pixel in bit 15; 8 wide uses bits 15..8 */
+    int16 x;              /**< pixel column of the left edge */
+    int16 y;              /**< screen row (frame buffer row counted from the top line) of the top */
+    uint8 width;          /**< 8 or 16 */
+    uint8 height;         /**< rows */
+    uint8 op;             /**< VGA_SPRITE_OFF, VGA_SPRITE_OR or VGA_SPRITE_XOR */
+} VgaSprite;
+
+typedef struct
+{
+    uint32 rows;       /**< frame buffer rows composited into a line buffer */
+    uint32 spriteRows; /**< sprite rows combined into them */
+} VgaSprite_Stats;
+
+void VgaSprite_Start(void);
+cystatus VgaSprite_Set(uint8 id, const uint16 *bitmap, uint8 width, uint8 height, uint8 op);
+void VgaSprite_Move(uint8 id, int16 x, int16 y);
+const VgaSprite *VgaSprite_Get(uint8 id);
+void VgaSprite_Latch(void);
+const uint8 *VgaSprite_Row(uint16 screenRow, const uint8 *row);
+const VgaSprite_Stats *VgaSprite_GetStats(void);
+
+#endif /* VGA_SPRITE_H */
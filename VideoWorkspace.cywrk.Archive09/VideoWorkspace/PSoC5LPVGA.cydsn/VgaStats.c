@@ -0,0 +1,151 @@
+/**
+ * @file
+ * @brief Frame timing counters, see VgaStats.h.
+ */
+#include "VgaStats.h"
+
+#include <string.h>
+
+#if VGA_STATS
+static VgaStats_Counters stats;
+
+/* Taken by VgaStats_IsrStart(), for the VgaStats_IsrEnd() of the same interrupt */
+static uint32 isrEntry;
+static uint16 isrLine;
+
+/* First interrupt of the frame being drawn and the last one of the frame before */
+static uint8 frameStarted;
+static uint32 frameFirstAt;
+static uint16 frameFirstLine;
+static uint16 frameIrqs;
+static uint32 lastLineAt;
+static uint8 lastLineSeen;
+
+/** @brief Starts the cycle counter and clears the counters, before SCANLINE is enabled. */
+void VgaStats_Start(void)
+{
+    VGA_STATS_TIMER_START();
+    memset(&stats, 0, sizeof(stats));
+    frameStarted = 0u;
+    frameIrqs = 0u;
+    lastLineSeen = 0u;
+}
+
+/** @brief First thing in the ScanLine interrupt: its entry time and the line it came on. */
+void VgaStats_IsrStart(void)
+{
+    isrEntry = VGA_STATS_NOW();
+    isrLine = (uint16)((LINE_CNT_HI_Status << 8) | LINE_CNT_LO_Status);
+}
+
+/**
+ * @brief Last thing in the ScanLine interrupt, after its TD writes; @p lastLine is 1 on the
+ *        interrupt of the last visible line.
+ */
+void VgaStats_IsrEnd(uint8 lastLine)
+{
+    uint32 isrCycles = VGA_STATS_NOW() - isrEntry;
+
+    stats.irqs++;
+    frameIrqs++;
+    if (isrCycles > stats.isrCyclesMax)
+        stats.isrCyclesMax = isrCycles;
+
+    if (!frameStarted)
+    {
+        frameStarted = 1u;
+        frameFirstAt = isrEntry;
+        frameFirstLine = isrLine;
+        /* From the last line of the frame before, less the lines of this one up to here */
+        if (lastLineSeen && (isrLine < VGA_RES_Y) && (stats.lineCycles != 0u))
+            stats.vblankCycles = isrEntry - lastLineAt - isrLine * stats.lineCycles;
+    }
+    if (lastLine)
+    {
+        if (isrLine > frameFirstLine)
+            stats.lineCycles = (isrEntry - frameFirstAt) / (uint32)(isrLine - frameFirstLine);
+        stats.frames++;
+        stats.frameIrqs = frameIrqs;
+        if (frameIrqs > stats.frameIrqsMax)
+            stats.frameIrqsMax = frameIrqs;
+        frameIrqs = 0u;
+        frameStarted = 0u;
+        lastLineAt = isrEntry;
+        lastLineSeen = 1u;
+    }
+}
+
+/** @brief The main loop saw @p pending refreshes at once, all but one of them were missed. */
+void VgaStats_Refresh(int pending)
+{
+    if (pending > 1)
+        stats.dropped += (uint32)(pending - 1);
+}
+
+/** @brief The retrace copy is done: how long after the last line, and whether it overran. */
+void VgaStats_CopyDone(void)
+{
+    stats.copyCycles = VGA_STATS_NOW() - lastLineAt;
+    if (stats.copyCycles > stats.copyCyclesMax)
+        stats.copyCyclesMax = stats.copyCycles;
+    if ((stats.vblankCycles != 0u) && (stats.copyCycles > stats.vblankCycles))
+        stats.overruns++;
+}
+
+const VgaStats_Counters *VgaStats_Get(void) { return &stats; }
+
+/* Appends "name=value " to @p buf at @p *len, as far as it fits below @p size. */
+static void VgaStats_Put(char *buf, uint16 size, uint16 *len, const char *name, uint32 value)
+{
+    char digits[10];
+    uint8 n = 0u;
+
+    while ((*name != '\0') && (*len + 1u < size))
+        buf[(*len)++] = *name++;
+    if (*len + 1u < size)
+        buf[(*len)++] = '=';
+    do
+    {
+        digits[n++] = (char)('0' + value % 10u);
+        value /= 10u;
+    } while (value != 0u);
+    while ((n != 0u) && (*len + 1u < size))
+        buf[(*len)++] = digits[--n];
+    if (*len + 1u < size)
+        buf[(*len)++] = ' ';
+}
+
+/**
+ * @brief Writes the counters into @p buf as one key=value line ending in CR LF, cut to fit
+ *        @p size (VGA_STATS_LINE_MAX holds it all); no printf, it runs on the device.
+ *
+ * @return Characters written, without the terminating 0.
+ */
+uint16 VgaStats_Format(char *buf, uint16 size)
+{
+    uint16 len = 0u;
+
+    if (size == 0u)
+        return 0u;
+    VgaStats_Put(buf, size, &len, "frames", stats.frames);
+    VgaStats_Put(buf, size, &len, "irqs_per_frame", stats.frameIrqs);
+    VgaStats_Put(buf, size, &len, "irqs_per_frame_max", stats.frameIrqsMax);
+    VgaStats_Put(buf, size, &len, "isr_cycles_max", stats.isrCyclesMax);
+    VgaStats_Put(buf, size, &len, "line_cycles", stats.lineCycles);
+    VgaStats_Put(buf, size, &len, "vblank_cycles", stats.vblankCycles);
+    VgaStats_Put(buf, size, &len, "copy_cycles", stats.copyCycles);
+    VgaStats_Put(buf, size, &len, "copy_cycles_max", stats.copyCyclesMax);
+    VgaStats_Put(buf, size, &len, "overruns", stats.overruns);
+    VgaStats_Put(buf, size, &len, "dropped", stats.dropped);
+    if ((len != 0u) && (buf[len - 1u] == ' '))
+        len--;
+    if (len + 2u < size)
+    {
+        buf[len++] = '\r';
+        buf[len++] = '\n';
+    }
+    buf[len] = '\0';
+    return len;
+}
+
+#endif /* VGA_STATS */
@@ -0,0 +1,114 @@
+/**
+ * @file
+ * @brief Frame timing counters: ScanLine interrupts, how long they run, the retrace copy against
+ *        the vertical blanking it has to fit in, overruns and dropped refreshes.
+ *
+ * Every time is a DWT cycle counter (CYCCNT) reading, CPU clocks. The ScanLine interrupt stamps
+ * its entry and the line LINE_CNT shows, and its end after the last TD write; the main loop
+ * stamps the end of the retrace copy. Nothing else is needed to get the budget: the line
+ * period comes from the interrupts of one frame, and the vertical blanking from the last
+ * interrupt of a frame to the first one of the next, less the visible lines in between. A copy
+ * that ends later than that after the last line is an overrun, the first lines of the next
+ * frame went out before it was done.
+ *
+ * The ISR time counts from the interrupt entry, not from the line_dma that raised it: the device
+ * has no timestamp for line_dma, and the host emulator counts the same way so the two agree.
+ *
+ * VgaStats_Format() writes the counters as one key=value line for a debug UART; the host checks
+ * print the same line. The hooks add a call and a LINE_CNT read to every ScanLine interrupt, so
+ * they are off unless the build sets VGA_STATS 1; with VGA_STATS 0 they compile to nothing.
+ *
+ * @code
+ *   VgaStats_Start();
+ *   ...
+ *   CY_ISR(ScanLine)
+ *   {
+ *       VGA_STATS_ISR_START();
+ *       ...  // TD writes
+ *       VGA_STATS_ISR_END(lastLine);
+ *   }
+ *   ...
+ *   if (refresh)
+ *   {
+ *       VGA_STATS_REFRESH(refresh);
+ *       ...  // retrace copy
+ *       VGA_STATS_COPY_DONE();
+ *   }
+ * @endcode
+ */
+#ifndef VGA_STATS_H
+#define VGA_STATS_H
+
+#include "VgaConfig.h"
+
+#ifndef VGA_STATS
+#define VGA_STATS 0
+#endif
+/** main.c sends VgaStats_Format() out of UART once a second; needs a UART with a TX buffer of
+ *  VGA_STATS_LINE_MAX bytes in the schematic. */
+#ifndef VGA_STATS_UART
+#define VGA_STATS_UART 0
+#endif
+#if VGA_STATS_UART && !VGA_STATS
+#error "VGA_STATS_UART sends the counters, build it with VGA_STATS 1"
+#endif
+
+/* clang-format off */
+#define VGA_STATS_DEMCR         (0xE000EDFCu) /**< Debug Exception and Monitor Control */
+#define VGA_STATS_DEMCR_TRCENA  (0x01000000u) /**< enables the DWT */
+#define VGA_STATS_DWT_CTRL      (0xE0001000u)
+#define VGA_STATS_DWT_CYCCNTENA (0x00000001u)
+#define VGA_STATS_DWT_CYCCNT    (0xE0001004u)
+#define VGA_STATS_LINE_MAX      (256u)        /**< VgaStats_Format() line, with the CR LF */
+/* clang-format on */
+
+/* The host emulator has no DWT and reads its own clock, the device the cycle counter. */
+#ifndef VGA_STATS_TIMER_START
+#define VGA_STATS_TIMER_START()                                                                    \
+    do                                                                                             \
+    {                                                                                              \
+        CY_SET_REG32(VGA_STATS_DEMCR, CY_GET_REG32(VGA_STATS_DEMCR) | VGA_STATS_DEMCR_TRCENA);     \
+        CY_SET_REG32(VGA_STATS_DWT_CTRL,                                                           \
+                     CY_GET_REG32(VGA_STATS_DWT_CTRL) | VGA_STATS_DWT_CYCCNTENA);                  \
+    } while (0)
+#endif
+#ifndef VGA_STATS_NOW
+#define VGA_STATS_NOW() CY_GET_REG32(VGA_STATS_DWT_CYCCNT)
+#endif
+
+typedef struct
+{
+    uint32 frames;          /**< frames whose last line interrupted */
+    uint32 irqs;            /**< ScanLine interrupts */
+    uint16 frameIrqs;       /**< ScanLine interrupts of the last frame */
+    uint16 frameIrqsMax;    /**< most ScanLine interrupts in one frame */
+    uint32 isrCyclesMax;    /**< longest ScanLine ISR, interrupt entry to its end */
+    uint32 lineCycles;      /**< line period of the last frame */
+    uint32 vblankCycles;    /**< last line_dma of a frame to the first one of the next */
+    uint32 copyCycles;      /**< last line_dma of the frame to the end of the last retrace copy */
+    uint32 copyCyclesMax;   /**< longest retrace copy, against vblankCycles */
+    uint32 overruns;        /**< retrace copies that ended after the next frame started */
+    uint32 dropped;         /**< refreshes the main loop missed, it saw refresh above 1 */
+} VgaStats_Counters;
+
+void VgaStats_Start(void);
+void VgaStats_IsrStart(void);
+void VgaStats_IsrEnd(uint8 lastLine);
+void VgaStats_Refresh(int pending);
+void VgaStats_CopyDone(void);
+const VgaStats_Counters *VgaStats_Get(void);
+uint16 VgaStats_Format(char *buf, uint16 size);
+
+#if VGA_STATS
+#define VGA_STATS_ISR_START() VgaStats_IsrStart()
+#define VGA_STATS_ISR_END(lastLine) VgaStats_IsrEnd(lastLine)
+#define VGA_STATS_REFRESH(pending) VgaStats_Refresh(pending)
+#define VGA_STATS_COPY_DONE() VgaStats_CopyDone()
+#else
+#define VGA_STATS_ISR_START() ((void)0)
+#define VGA_STATS_ISR_END(lastLine) ((void)0)
+#define VGA_STATS_REFRESH(pending) ((void)0)
+#define VGA_STATS_COPY_DONE() ((void)0)
+#endif
+
+#endif /* VGA_STATS_H */
@@ -0,0 +1,185 @@
+/**
+ * @file
+ * @brief Text mode, see VgaText.h. Only built with VGA_TEXT_MODE, its buffers would not fit
+ *        next to the frame buffers.
+ */
+#include "VgaText.h"
+
+#include <string.h>
+
+#include "../../../Common/DmaTdFast.h"
+
+#if VGA_TEXT_MODE
+
+#define VGA_TEXT_PRESERVE_TDS (1u) /* the TDs never change */
+
+#if (VGA_RES_Y % VGA_TEXT_LINE_TDS) != 0
+#error "VGA_RES_Y has to be a multiple of the text line TD ring"
+#endif
+
+uint8 VgaText_chars[VGA_TEXT_ROWS][VGA_TEXT_COLS];
+
+static uint8 textAttr[VGA_TEXT_ROWS][VGA_TEXT_ATTR_BYTES]; /* bit col % 8: inverse */
+static uint8 textFont[VGA_TEXT_GLYPH_ROWS][256];           /* EEPROM font, glyph row major */
+static uint8 textLine[2][VGA_X_BYTES];
+
+static uint8 textCh = CY_DMA_INVALID_CHANNEL;
+static uint8 textTd[VGA_TEXT_LINE_TDS];
+static uint8 textTdCount; /* allocated so far, kept across VgaText_Start() */
+
+/* Expands the glyph row visible line @p line shows into @p dst. */
+static void VgaText_Expand(uint8 *dst, uint16 line)
+{
+    uint16 row = (uint16)(line / (VGA_TEXT_GLYPH_ROWS * VGA_Y_FACTOR));
+    const uint8 *glyph;
+    const uint8 *chars;
+    const uint8 *attr;
+    uint8 col;
+
+    if (row >= VGA_TEXT_ROWS)
+    {
+        memset(dst, 0, VGA_X_BYTES);
+        return;
+    }
+    glyph = textFont[(line / VGA_Y_FACTOR) % VGA_TEXT_GLYPH_ROWS];
+    chars = VgaText_chars[row];
+    attr = textAttr[row];
+    for (col = 0u; col < VGA_TEXT_COLS; col++)
+    {
+        uint8 inverse = (uint8)((attr[col >> 3] >> (col & 7u)) & 1u);
+
+        dst[col] = (uint8)(glyph[chars[col]] ^ (uint8)(0u - inverse));
+    }
+}
+
+/**
+ * @brief Copies the font out of the EEPROM, clears the screen and starts the line TD ring on
+ *        @p chHandle.
+ *
+ * @p chHandle is the line DMA channel, initialized with the HI16 of the SRAM and of the
+ * peripherals; EEPROM_Start() has to have run. The TDs are allocated once and kept.
+ *
+ * @return CYRET_SUCCESS, CYRET_BAD_PARAM or CYRET_MEMORY (no free TDs).
+ */
+cystatus VgaText_Start(uint8 chHandle)
+{
+    uint16 c;
+    uint8 k;
+
+    if (chHandle == CY_DMA_INVALID_CHANNEL)
+        return CYRET_BAD_PARAM;
+    while (textTdCount < VGA_TEXT_LINE_TDS)
+    {
+        uint8 td = CyDmaTdAllocate();
+
+        if (td == CY_DMA_INVALID_TD)
+            return CYRET_MEMORY;
+        textTd[textTdCount++] = td;
+    }
+
+    for (k = 0u; k < VGA_TEXT_GLYPH_ROWS; k++)
+    {
+        for (c = 0u; c < 256u; c++)
+            textFont[k][c] = CY_GET_REG8(CYDEV_EE_BASE + c + k * 256u);
+    }
+    VgaText_Clear();
+    VgaText_Expand(textLine[0], 0u);
+    VgaText_Expand(textLine[1], VGA_Y_FACTOR);
+
+    /* VGA_Y_FACTOR TDs per line buffer, the last one of each raises SCANLINE */
+    for (k = 0u; k < VGA_TEXT_LINE_TDS; k++)
+    {
+        DmaTdFast_SetConfiguration(textTd[k], VGA_X_BYTES, textTd[(k + 1u) % VGA_TEXT_LINE_TDS],
+                                   TD_INC_SRC_ADR | ((((k + 1u) % VGA_Y_FACTOR) == 0u)
+                                                         ? DMA__TD_TERMOUT_EN
+                                                         : 0u));
+        DmaTdFast_SetAddress(textTd[k], LO16((uint32)textLine[k / VGA_Y_FACTOR]),
+                             LO16((uint32)DMA_OUT_Control_PTR));
+    }
+    textCh = chHandle;
+    (void)CyDmaChSetInitialTd(textCh, textTd[0]);
+    (void)CyDmaChEnable(textCh, VGA_TEXT_PRESERVE_TDS);
+    return CYRET_SUCCESS;
+}
+
+/**
+ * @brief Call from the SCANLINE interrupt: expands the next glyph row into the line buffer that
+ *        just went out.
+ *
+ * The interrupt comes on the last line of a line buffer, LINE_CNT tells which line that is.
+ * When the ring is not on a glyph row boundary (it was started in the middle of a frame) the
+ * line buffer that went out takes the next line right away, from the TD that puts the ring back
+ * on the boundary.
+ *
+ * @return 1 when that was the last visible line, the retrace comes next.
+ */
+uint8 VgaText_LineDone(void)
+{
+    uint16 line = (uint16)((LINE_CNT_HI_Status << 8) | LINE_CNT_LO_Status);
+    uint8 current = CY_DMA_INVALID_TD;
+    uint8 k = 0u;
+    uint8 done;
+
+    if (line >= VGA_RES_Y)
+        line = VGA_RES_Y - 1u;
+    (void)CyDmaChStatus(textCh, &current, NULL);
+    while ((k < VGA_TEXT_LINE_TDS) && (textTd[k] != current))
+        k++;
+    done = (uint8)(((k + VGA_TEXT_LINE_TDS - 1u) % VGA_TEXT_LINE_TDS) / VGA_Y_FACTOR);
+
+    if (((line + 1u) % VGA_Y_FACTOR) == 0u)
+    {
+        /* The other line buffer has the next VGA_Y_FACTOR lines */
+        VgaText_Expand(textLine[done], (uint16)((line + 1u + VGA_Y_FACTOR) % VGA_RES_Y));
+    }
+    else
+    {
+        (void)CyDmaChDisable(textCh);
+        VgaText_Expand(textLine[done], (uint16)((line + 1u) % VGA_RES_Y));
+        (void)CyDmaChSetInitialTd(textCh,
+                                  textTd[done * VGA_Y_FACTOR + (line + 1u) % VGA_Y_FACTOR]);
+        (void)CyDmaChEnable(textCh, VGA_TEXT_PRESERVE_TDS);
+    }
+    return (uint8)(line + 1u == VGA_RES_Y);
+}
+
+/** @brief Blanks the screen: spaces, normal video. */
+void VgaText_Clear(void)
+{
+    memset(VgaText_chars, ' ', sizeof(VgaText_chars));
+    memset(textAttr, 0, sizeof(textAttr));
+}
+
+/** @brief Sets the attribute (VGA_TEXT_NORMAL, VGA_TEXT_INVERSE) of a character. */
+void VgaText_SetAttr(uint8 col, uint8 row, uint8 attr)
+{
+    if ((col >= VGA_TEXT_COLS) || (row >= VGA_TEXT_ROWS))
+        return;
+    if (attr == VGA_TEXT_INVERSE)
+        textAttr[row][col >> 3] |= (uint8)(1u << (col & 7u));
+    else
+        textAttr[row][col >> 3] &= (uint8)~(1u << (col & 7u));
+}
+
+uint8 VgaText_GetAttr(uint8 col, uint8 row)
+{
+    if ((col >= VGA_TEXT_COLS) || (row >= VGA_TEXT_ROWS))
+        return VGA_TEXT_NORMAL;
+    return (uint8)((textAttr[row][col >> 3] >> (col & 7u)) & 1u);
+}
+
+/** @brief Swaps normal and inverse video of a character, a one bit write. */
+void VgaText_ToggleAttr(uint8 col, uint8 row)
+{
+    if ((col < VGA_TEXT_COLS) && (row < VGA_TEXT_ROWS))
+        textAttr[row][col >> 3] ^= (uint8)(1u << (col & 7u));
+}
+
+/** @brief SRAM the text mode uses: characters, attributes, the font copy and the line buffers. */
+uint32 VgaText_Size(void)
+{
+    return (uint32)(sizeof(VgaText_chars) + sizeof(textAttr) + sizeof(textFont) +
+                    sizeof(textLine));
+}
+
+#endif /* VGA_TEXT_MODE */
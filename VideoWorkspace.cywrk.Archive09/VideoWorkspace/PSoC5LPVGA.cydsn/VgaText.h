@@ -0,0 +1,62 @@
+/**
+ * @file
+ * @brief Text mode: the screen is a character buffer, scanlines are expanded from the font as
+ *        they are needed.
+ *
+ * Instead of the 30 KB cframe and dframe the screen is VGA_TEXT_COLS x VGA_TEXT_ROWS characters
+ * of the EEPROM font (3.7 KB at 800x600) with one inverse-video attribute bit each. The line DMA
+ * runs a ring of four TDs over two line buffers, every line buffer shown on the VGA_Y_FACTOR
+ * lines of one glyph row. The last TD of each line buffer raises SCANLINE, and the interrupt
+ * expands the glyph row shown after the other line buffer into the one that just went out: one
+ * font lookup per column every VGA_Y_FACTOR lines, from a copy of the font in SRAM as the
+ * EEPROM is slow to read.
+ *
+ * Changing a character is one byte written to VgaText_chars; it shows from the next glyph row
+ * expanded for it on, within VGA_Y_FACTOR * 2 lines. The lines below the last full character
+ * row stay blank.
+ *
+ * @code
+ *   EEPROM_Start();
+ *   dmaCh = DMA_DmaInitialize(1, 0, HI16(CYDEV_SRAM_BASE), HI16(CYDEV_PERIPH_BASE));
+ *   VgaText_Start(dmaCh);
+ *   SCANLINE_StartEx(ScanLine);
+ *   ...
+ *   CY_ISR(ScanLine)
+ *   {
+ *       if (VgaText_LineDone())
+ *           refresh++;  // that was the last visible line
+ *   }
+ *   ...
+ *   VgaText_chars[row][col] = 'A';
+ * @endcode
+ *
+ * Schematic: DMA with line_dma on its drq, DMA_OUT as destination and its nrq on SCANLINE, as
+ * for the per-line ISR in main.c.
+ */
+#ifndef VGA_TEXT_H
+#define VGA_TEXT_H
+
+#include "VgaConfig.h"
+
+/* Plain ints like the geometry in VgaConfig.h, main.c loops over them with int */
+#define VGA_TEXT_GLYPH_ROWS 8 /**< rows of an EEPROM font character */
+#define VGA_TEXT_COLS (VGA_X_BYTES)
+#define VGA_TEXT_ROWS (VGA_RES_Y / (VGA_TEXT_GLYPH_ROWS * VGA_Y_FACTOR))
+#define VGA_TEXT_ATTR_BYTES ((VGA_TEXT_COLS + 7) / 8) /**< attribute bits of a character row */
+#define VGA_TEXT_LINE_TDS (2 * VGA_Y_FACTOR)          /**< two line buffers, each on its lines */
+
+#define VGA_TEXT_NORMAL (0u)
+#define VGA_TEXT_INVERSE (1u)
+
+/** Character codes, row by row; write them directly. */
+extern uint8 VgaText_chars[VGA_TEXT_ROWS][VGA_TEXT_COLS];
+
+cystatus VgaText_Start(uint8 chHandle);
+uint8 VgaText_LineDone(void);
+void VgaText_Clear(void);
+void VgaText_SetAttr(uint8 col, uint8 row, uint8 attr);
+uint8 VgaText_GetAttr(uint8 col, uint8 row);
+void VgaText_ToggleAttr(uint8 col, uint8 row);
+uint32 VgaText_Size(void);
+
+#endif /* VGA_TEXT_H */
@@ -0,0 +1,276 @@
+/**
+ * @file
+ * @brief Tile mode, see VgaTile.h. Only built with VGA_TILE_MODE, its buffers would not fit
+ *        next to the frame buffers.
+ */
+#include "VgaTile.h"
+
+#include <string.h>
+
+#include "../../../Common/DmaTdFast.h"
+#include "../../../Common/FastCopy.h"
+
+#if VGA_TILE_MODE
+
+#define VGA_TILE_PRESERVE_TDS (1u) /* the TDs never change */
+#define VGA_TILE_LINE_TDS (2u)     /* one per line buffer */
+#define VGA_TILE_HASH (64u)        /* hash buckets, a power of 2 */
+#define VGA_TILE_END (0u)          /* end of a hash chain, the blank tile is in none */
+
+#if (VGA_RES_Y % VGA_TILE_HEIGHT) != 0
+#error "VGA_RES_Y has to be a multiple of the tile height"
+#endif
+#if (VGA_X_BYTES % 4) != 0
+#error "Lines are expanded a word at a time, VGA_X_BYTES has to be a multiple of 4"
+#endif
+
+uint8 VgaTile_map[VGA_TILE_ROWS][VGA_TILE_COLS] __attribute__((aligned(4)));
+
+static uint8 tileRows[VGA_TILE_HEIGHT][VGA_TILE_COUNT]; /* tile row major, a table per line */
+static uint16 tileRefs[VGA_TILE_COUNT];                 /* cells on a tile, 0 is a free tile */
+static uint8 tileHashHead[VGA_TILE_HASH];
+static uint8 tileHashNext[VGA_TILE_COUNT];
+static uint8 tileLine[VGA_TILE_LINE_TDS][VGA_X_BYTES] __attribute__((aligned(4)));
+static VgaTile_Stats tileStats;
+
+static uint8 tileCh = CY_DMA_INVALID_CHANNEL;
+static uint8 tileTd[VGA_TILE_LINE_TDS];
+static uint8 tileTdCount; /* allocated so far, kept across VgaTile_Start() */
+
+/* Expands visible line @p line into @p dst, four tiles a word. */
+static void VgaTile_Expand(uint8 *dst, uint16 line)
+{
+    const FastCopy_Word *cells =
+        (const FastCopy_Word *)(const void *)VgaTile_map[line / VGA_TILE_HEIGHT];
+    const uint8 *rows = tileRows[line % VGA_TILE_HEIGHT];
+    FastCopy_Word *d = (FastCopy_Word *)(void *)dst;
+    uint8 w;
+
+    VGA_TILE_ACCOUNT(VGA_X_BYTES / 4u);
+    for (w = 0u; w < VGA_X_BYTES / 4u; w++)
+    {
+        uint32 c = cells[w];
+
+        d[w] = (uint32)rows[c & 0xFFu] | ((uint32)rows[(c >> 8) & 0xFFu] << 8) |
+               ((uint32)rows[(c >> 16) & 0xFFu] << 16) | ((uint32)rows[c >> 24] << 24);
+    }
+}
+
+static uint8 VgaTile_Hash(const uint8 *pixels)
+{
+    uint8 h = 0u;
+    uint8 r;
+
+    for (r = 0u; r < VGA_TILE_HEIGHT; r++)
+        h = (uint8)(((h << 1) | (h >> 7)) ^ pixels[r]);
+    return (uint8)(h & (VGA_TILE_HASH - 1u));
+}
+
+static uint8 VgaTile_Equal(uint8 tile, const uint8 *pixels)
+{
+    uint8 r;
+
+    for (r = 0u; r < VGA_TILE_HEIGHT; r++)
+    {
+        if (tileRows[r][tile] != pixels[r])
+            return 0u;
+    }
+    return 1u;
+}
+
+/* Looks @p pixels up in the store, or takes a free tile for them; CYRET_MEMORY when full. */
+static cystatus VgaTile_Find(const uint8 *pixels, uint8 *tile)
+{
+    uint16 k;
+    uint8 h;
+    uint8 r;
+
+    for (r = 0u; (r < VGA_TILE_HEIGHT) && (pixels[r] == 0u); r++)
+        ;
+    if (r == VGA_TILE_HEIGHT)
+    {
+        *tile = VGA_TILE_BLANK;
+        return CYRET_SUCCESS;
+    }
+    h = VgaTile_Hash(pixels);
+    for (k = tileHashHead[h]; k != VGA_TILE_END; k = tileHashNext[k])
+    {
+        if (VgaTile_Equal((uint8)k, pixels))
+        {
+            *tile = (uint8)k;
+            return CYRET_SUCCESS;
+        }
+    }
+
+    for (k = 1u; (k < VGA_TILE_COUNT) && (tileRefs[k] != 0u); k++)
+        ;
+    if (k == VGA_TILE_COUNT)
+        return CYRET_MEMORY;
+    for (r = 0u; r < VGA_TILE_HEIGHT; r++)
+        tileRows[r][k] = pixels[r];
+    tileHashNext[k] = tileHashHead[h];
+    tileHashHead[h] = (uint8)k;
+    tileStats.tiles++;
+    *tile = (uint8)k;
+    return CYRET_SUCCESS;
+}
+
+/* One cell less on @p tile, it goes back to the store with the last one. */
+static void VgaTile_Release(uint8 tile)
+{
+    uint8 pixels[VGA_TILE_HEIGHT];
+    uint8 *link;
+    uint8 r;
+
+    if ((tile == VGA_TILE_BLANK) || (--tileRefs[tile] != 0u))
+        return;
+    for (r = 0u; r < VGA_TILE_HEIGHT; r++)
+        pixels[r] = tileRows[r][tile];
+    for (link = &tileHashHead[VgaTile_Hash(pixels)]; *link != tile; link = &tileHashNext[*link])
+        ;
+    *link = tileHashNext[tile];
+    tileStats.tiles--;
+}
+
+/**
+ * @brief Blanks the screen and starts the line TD ring on @p chHandle.
+ *
+ * @p chHandle is the line DMA channel, initialized with the HI16 of the SRAM and of the
+ * peripherals. The TDs are allocated once and kept.
+ *
+ * @return CYRET_SUCCESS, CYRET_BAD_PARAM or CYRET_MEMORY (no free TDs).
+ */
+cystatus VgaTile_Start(uint8 chHandle)
+{
+    uint8 k;
+
+    if (chHandle == CY_DMA_INVALID_CHANNEL)
+        return CYRET_BAD_PARAM;
+    while (tileTdCount < VGA_TILE_LINE_TDS)
+    {
+        uint8 td = CyDmaTdAllocate();
+
+        if (td == CY_DMA_INVALID_TD)
+            return CYRET_MEMORY;
+        tileTd[tileTdCount++] = td;
+    }
+
+    memset(&tileStats, 0, sizeof(tileStats));
+    VgaTile_Clear();
+    VgaTile_Expand(tileLine[0], 0u);
+    VgaTile_Expand(tileLine[1], 1u);
+
+    /* One line per line buffer, each of them raises SCANLINE */
+    for (k = 0u; k < VGA_TILE_LINE_TDS; k++)
+    {
+        DmaTdFast_SetConfiguration(tileTd[k], VGA_X_BYTES, tileTd[(k + 1u) % VGA_TILE_LINE_TDS],
+                                   TD_INC_SRC_ADR | DMA__TD_TERMOUT_EN);
+        DmaTdFast_SetAddress(tileTd[k], LO16((uint32)tileLine[k]),
+                             LO16((uint32)DMA_OUT_Control_PTR));
+    }
+    tileCh = chHandle;
+    (void)CyDmaChSetInitialTd(tileCh, tileTd[0]);
+    (void)CyDmaChEnable(tileCh, VGA_TILE_PRESERVE_TDS);
+    return CYRET_SUCCESS;
+}
+
+/**
+ * @brief Call from the SCANLINE interrupt: expands the line after the next one into the line
+ *        buffer that just went out.
+ *
+ * The interrupt comes on every line, LINE_CNT tells which one that is; the line buffer that
+ * went out is the one the channel is not on.
+ *
+ * @return 1 when that was the last visible line, the retrace comes next.
+ */
+uint8 VgaTile_LineDone(void)
+{
+    uint16 line = (uint16)((LINE_CNT_HI_Status << 8) | LINE_CNT_LO_Status);
+    uint8 current = CY_DMA_INVALID_TD;
+
+    if (line >= VGA_RES_Y)
+        line = VGA_RES_Y - 1u;
+    (void)CyDmaChStatus(tileCh, &current, NULL);
+    VgaTile_Expand(tileLine[(current == tileTd[0]) ? 1u : 0u],
+                   (uint16)((line + VGA_TILE_LINE_TDS) % VGA_RES_Y));
+    return (uint8)(line + 1u == VGA_RES_Y);
+}
+
+/** @brief Blanks the screen and empties the store but for the blank tile. */
+void VgaTile_Clear(void)
+{
+    memset(VgaTile_map, VGA_TILE_BLANK, sizeof(VgaTile_map));
+    memset(tileRows, 0, sizeof(tileRows));
+    memset(tileRefs, 0, sizeof(tileRefs));
+    memset(tileHashHead, VGA_TILE_END, sizeof(tileHashHead));
+    tileStats.tiles = 1u;
+}
+
+/**
+ * @brief Shows the VGA_TILE_HEIGHT rows of @p pixels (leftmost pixel in bit 7) on the cell at
+ *        @p col, @p row.
+ *
+ * @return CYRET_SUCCESS, CYRET_BAD_PARAM, or CYRET_MEMORY when it is a new tile and the store
+ *         is full; the cell is left as it was then.
+ */
+cystatus VgaTile_Put(uint8 col, uint8 row, const uint8 *pixels)
+{
+    uint8 old;
+    uint8 tile;
+
+    if ((col >= VGA_TILE_COLS) || (row >= VGA_TILE_ROWS) || (pixels == NULL))
+        return CYRET_BAD_PARAM;
+    if (VgaTile_Find(pixels, &tile) != CYRET_SUCCESS)
+    {
+        tileStats.refused++;
+        return CYRET_MEMORY;
+    }
+    old = VgaTile_map[row][col];
+    if (tile == old)
+        return CYRET_SUCCESS;
+    if (tile != VGA_TILE_BLANK)
+        tileRefs[tile]++;
+    VgaTile_map[row][col] = tile;
+    VgaTile_Release(old);
+    return CYRET_SUCCESS;
+}
+
+/** @brief The VGA_TILE_HEIGHT rows of pixels on the cell at @p col, @p row, into @p pixels. */
+void VgaTile_Get(uint8 col, uint8 row, uint8 *pixels)
+{
+    uint8 tile = ((col < VGA_TILE_COLS) && (row < VGA_TILE_ROWS)) ? VgaTile_map[row][col]
+                                                                    : (uint8)VGA_TILE_BLANK;
+    uint8 r;
+
+    for (r = 0u; r < VGA_TILE_HEIGHT; r++)
+        pixels[r] = tileRows[r][tile];
+}
+
+/** @brief Sets (@p on 1) or clears the pixel at @p x, @p y; returns as VgaTile_Put(). */
+cystatus VgaTile_Pixel(uint16 x, uint16 y, uint8 on)
+{
+    uint8 col = (uint8)(x / VGA_TILE_WIDTH);
+    uint8 row = (uint8)(y / VGA_TILE_HEIGHT);
+    uint8 mask = (uint8)(0x80u >> (x % VGA_TILE_WIDTH));
+    uint8 pixels[VGA_TILE_HEIGHT];
+
+    if ((x >= VGA_TILE_COLS * VGA_TILE_WIDTH) || (y >= VGA_TILE_ROWS * VGA_TILE_HEIGHT))
+        return CYRET_BAD_PARAM;
+    VgaTile_Get(col, row, pixels);
+    if (on)
+        pixels[y % VGA_TILE_HEIGHT] |= mask;
+    else
+        pixels[y % VGA_TILE_HEIGHT] &= (uint8)~mask;
+    return VgaTile_Put(col, row, pixels);
+}
+
+const VgaTile_Stats *VgaTile_GetStats(void) { return &tileStats; }
+
+/** @brief SRAM the tile mode uses: map, store, its counts and hash, and the line buffers. */
+uint32 VgaTile_Size(void)
+{
+    return (uint32)(sizeof(VgaTile_map) + sizeof(tileRows) + sizeof(tileRefs) +
+                    sizeof(tileHashHead) + sizeof(tileHashNext) + sizeof(tileLine));
+}
+
+#endif /* VGA_TILE_MODE */
@@ -0,0 +1,80 @@
+/**
+ * @file
+ * @brief Tile mode: the screen is a map of 8x8 pixel tiles out of a store of distinct ones,
+ *        scanlines are expanded from the tiles as they are needed, at the full resolution.
+ *
+ * A 1 bpp frame buffer of every line is 60 KB at 800x600 and 96 KB at 1024x768, which is why the
+ * frame buffers show every row on VGA_Y_FACTOR lines. A screen of windows, text and lines is
+ * mostly the same few tiles over and over though: here it is a map of VGA_TILE_COLS x
+ * VGA_TILE_ROWS tile numbers (7.5 KB at 800x600, 12 KB at 1024x768) and a store of up to
+ * VGA_TILE_COUNT distinct tiles of 8 bytes, with every line shown (VGA_Y_FACTOR 1).
+ *
+ * Tiles are deduplicated when they are put: VgaTile_Put() looks the 8 rows up in a hash of the
+ * store and only takes a new tile when there is none like it yet; every tile counts the cells
+ * it is on and goes back to the store when the last one changes. Tile 0 is blank and always
+ * there. VgaTile_Pixel() changes a pixel the same way, copy on write: the cell gets the tile it
+ * had with that pixel changed. A put that needs a new tile when the store is full leaves the cell
+ * as it was and returns CYRET_MEMORY.
+ *
+ * The line DMA runs a ring of two TDs over two line buffers. Every TD raises SCANLINE, and the
+ * interrupt expands the line after the next one into the line buffer that just went out: one
+ * tile map and four tile store lookups per word of the line, the same for every line whatever
+ * is on it.
+ *
+ * Call VgaTile_Put() and VgaTile_Pixel() from the main loop only; a cell changes with one byte
+ * write, between two lines.
+ *
+ * @code
+ *   dmaCh = DMA_DmaInitialize(1, 0, HI16(CYDEV_SRAM_BASE), HI16(CYDEV_PERIPH_BASE));
+ *   VgaTile_Start(dmaCh);
+ *   SCANLINE_StartEx(ScanLine);
+ *   ...
+ *   CY_ISR(ScanLine)
+ *   {
+ *       if (VgaTile_LineDone())
+ *           refresh++;  // that was the last visible line
+ *   }
+ *   ...
+ *   VgaTile_Put(col, row, glyph);
+ * @endcode
+ *
+ * Schematic: DMA with line_dma on its drq, DMA_OUT as destination and its nrq on SCANLINE, as
+ * for the per-line ISR in main.c.
+ */
+#ifndef VGA_TILE_H
+#define VGA_TILE_H
+
+#include "VgaConfig.h"
+
+/* Plain ints like the geometry in VgaConfig.h, main.c loops over them with int */
+#define VGA_TILE_WIDTH 8  /**< pixels, one byte of a line */
+#define VGA_TILE_HEIGHT 8 /**< lines */
+#define VGA_TILE_COLS (VGA_X_BYTES)
+#define VGA_TILE_ROWS (VGA_RES_Y / VGA_TILE_HEIGHT)
+#define VGA_TILE_COUNT 256 /**< tiles the store holds, a tile number is a byte */
+#define VGA_TILE_BLANK 0   /**< the tile with no pixels set */
+
+/* The host emulator charges the Cortex-M3 time of the line expansion, the device needs nothing */
+#ifndef VGA_TILE_ACCOUNT
+#define VGA_TILE_ACCOUNT(words) ((void)0)
+#endif
+
+typedef struct
+{
+    uint16 tiles;   /**< tiles in the store, the blank one included */
+    uint32 refused; /**< puts and pixels that found the store full */
+} VgaTile_Stats;
+
+/** Tile numbers, row by row; VgaTile_Put() keeps the tile counts, do not write them directly. */
+extern uint8 VgaTile_map[VGA_TILE_ROWS][VGA_TILE_COLS];
+
+cystatus VgaTile_Start(uint8 chHandle);
+uint8 VgaTile_LineDone(void);
+void VgaTile_Clear(void);
+cystatus VgaTile_Put(uint8 col, uint8 row, const uint8 *pixels);
+void VgaTile_Get(uint8 col, uint8 row, uint8 *pixels);
+cystatus VgaTile_Pixel(uint16 x, uint16 y, uint8 on);
+const VgaTile_Stats *VgaTile_GetStats(void);
+uint32 VgaTile_Size(void);
+
+#endif /* VGA_TILE_H */
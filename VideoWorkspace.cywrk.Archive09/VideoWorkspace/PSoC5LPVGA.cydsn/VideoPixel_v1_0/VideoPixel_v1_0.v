@@ -0,0 +1,90 @@
+//`#start header` -- edit after this line, do not edit this line
+// ========================================
+//
+// Copyright YOUR COMPANY, THE YEAR
+// All Rights Reserved
+// UNPUBLISHED, LICENSED SOFTWARE.
+//
+// CONFIDENTIAL AND PROPRIETARY INFORMATION
+// WHICH IS THE PROPERTY OF your company.
+//
+// ========================================
+`include "cypress.v"
+//`#end` -- edit above this line, do not edit this line
+// Component: VideoPixel_v1_0
+//
+// Takes the place of the 8 to 1 pixel mux after the DMA_OUT latch: the latched byte still
+// comes every 8 pixel clocks and PIXEL_SELECT still counts those clocks, but the byte holds
+// 8/BitsPerPixel pixels of BitsPerPixel bits, leftmost pixel in the high bits, each shown for
+// BitsPerPixel clocks. The pixel picks its RGBI colour from palette (two control registers,
+// 4 bits per entry, entry 0 in the low nibble) at 1 and 2 bpp; at 4 bpp it is the colour.
+// At 1 bpp without palette registers tie palette to 16'h0070 for white on black.
+//
+// fine (FINE_SCROLL control register, tie to 0 when unused) delays the picture by 0-7 pixel
+// clocks for a fine horizontal scroll: the first fine clocks of a byte still show the end of
+// the byte before, kept in prev, and the first ones of a line show pixel value 0. The latch
+// loads the next byte on the clock sel wraps from 7 to 0, prev takes the old one on that clock.
+//
+// Not in the schematic yet: there is no VideoPixel_v1_0.cysym to place it with, so 2 and 4 bpp
+// are host-only (HostEmu models this in C). HostEmu/VideoPixel/videopixel_tb.cpp checks every
+// clock of rgbi under Verilator; it has not been run yet.
+module VideoPixel_v1_0 (
+	output [3:0] rgbi,
+	input   blank_n,
+	input   clock,
+	input  [7:0] data,
+	input  [2:0] fine,
+	input  [15:0] palette,
+	input  [2:0] sel
+);
+	parameter BitsPerPixel = 2;
+//`#start body` -- edit after this line, do not edit this line
+
+    // The byte shown before data, cleared in the blanking so a line starts on pixel value 0.
+    reg [7:0] prev;
+
+    always @(posedge clock)
+    begin
+        if (blank_n == 1'b0)
+            prev <= 8'h00;
+        else if (sel == 3'd7)
+            prev <= data;
+    end
+
+    // Clock of {prev, data} shown now, 8 and up is in data: fine clocks back from sel.
+    wire [3:0] pos = {1'b1, sel} - {1'b0, fine};
+    wire [7:0] shown = pos[3] ? data : prev;
+
+    // Pixel value of the current pixel clock.
+    reg [3:0] index;
+
+    always @(*)
+    begin
+        case (BitsPerPixel)
+            4:
+                // Two pixels per byte, four clocks each.
+                index = pos[2] ? shown[3:0] : shown[7:4];
+            2:
+            begin
+                // Four pixels per byte, two clocks each.
+                case (pos[2:1])
+                    2'd0: index = {2'b00, shown[7:6]};
+                    2'd1: index = {2'b00, shown[5:4]};
+                    2'd2: index = {2'b00, shown[3:2]};
+                    default: index = {2'b00, shown[1:0]};
+                endcase
+            end
+            default:
+                // Eight pixels per byte, one clock each, like the pixel mux.
+                index = {3'b000, shown[~pos[2:0]]};
+        endcase
+    end
+
+    // Blanking forces black, the monitor measures its black level there.
+    assign rgbi = (blank_n == 1'b0) ? 4'b0000 :
+                  (BitsPerPixel == 4) ? index : palette[{index[1:0], 2'b00} +: 4];
+
+//`#end` -- edit above this line, do not edit this line
+endmodule
+//`#start footer` -- edit after this line, do not edit this line
+//`#end` -- edit above this line, do not edit this line
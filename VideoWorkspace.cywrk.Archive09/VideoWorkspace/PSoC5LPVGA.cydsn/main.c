@@ -10,22 +10,85 @@
  * ========================================
 */
 #include <project.h>
+#include "../../../Common/DmaTdFast.h"
+// Frame buffer geometry (VGA_RES_X, VGA_X_BYTES, VGA_BUFF_SIZE...)
+#include "VgaConfig.h"
+#if VGA_BPP > 1
+// Colour palette and packing of the 2 and 4 bits per pixel modes.
+#include "VgaColor.h"
+#endif
+// Frame timing counters of the ScanLine interrupt and the retrace copy.
+#include "VgaStats.h"
 
-// Get the resolution from the Video Controller instance.
-#define VGA_RES_X VideoCtrl_1_H_RES
-#define VGA_RES_Y VideoCtrl_1_V_RES
-// Our buffer will be one bit per pixel so we only need 1/8th for our horizontal dimension.
-#define VGA_X_FACTOR 8
-// We don't have enough memory so we are going to duplicate the vertical lines
-// to save on memory requirements.
-#define VGA_Y_FACTOR 2
-// This is our final dimmensions for our frame buffers.
-#define VGA_X_BYTES ((VGA_RES_X)/VGA_X_FACTOR)
-#define VGA_Y_BYTES (VGA_RES_Y/VGA_Y_FACTOR)
-#define VGA_BUFF_SIZE (VGA_X_BYTES*VGA_Y_BYTES)
-
+// VGA_LINE_CHAIN, VGA_PAGE_FLIP, DMA_MEM_CPY and VGA_DIRTY_SYNC can be overridden from the
+// command line, the host frame check builds every variant.
+#if VGA_TEXT_MODE
+// Text mode has no frame buffers to show, flip or copy (see VgaConfig.h and VgaText.h).
+#include "VgaText.h"
+#undef VGA_LINE_CHAIN
+#define VGA_LINE_CHAIN 0
+#undef VGA_PAGE_FLIP
+#define VGA_PAGE_FLIP 0
+#undef DMA_MEM_CPY
+#define DMA_MEM_CPY 0
+#undef VGA_DIRTY_SYNC
+#define VGA_DIRTY_SYNC 0
+#endif
+#if VGA_TILE_MODE
+// Tile mode has no frame buffers either, the lines come from the tile map (see VgaTile.h).
+#include "VgaTile.h"
+#undef VGA_LINE_CHAIN
+#define VGA_LINE_CHAIN 0
+#undef VGA_PAGE_FLIP
+#define VGA_PAGE_FLIP 0
+#undef DMA_MEM_CPY
+#define DMA_MEM_CPY 0
+#undef VGA_DIRTY_SYNC
+#define VGA_DIRTY_SYNC 0
+#endif
+#if VGA_SPRITES
+// The sprites are composited into a line buffer row by row, which takes the per-line ScanLine
+// interrupt (see VgaConfig.h and VgaSprite.h).
+#include "VgaSprite.h"
+#undef VGA_LINE_CHAIN
+#define VGA_LINE_CHAIN 0
+#endif
+// 1: run the line DMA from a ring of TDs with every line's source address already set (see
+// VgaChain.h), the ScanLine interrupt only comes every VGA_CHAIN_HALF_LINES lines. That is 15
+// interrupts a frame at 800x600 (host emulator, scanline_irqs_per_frame=15), short of one a
+// frame: the TD memory does not hold a TD for every line.
+// 0 (default until the ring has run on silicon): move the line TD on every line from the
+// ScanLine interrupt, one a line (602 a frame in the emulator).
+#ifndef VGA_LINE_CHAIN
+#define VGA_LINE_CHAIN 0
+#endif
+#if VGA_LINE_CHAIN
+#include "VgaChain.h"
+#endif
+// Page flipping: the line DMA shows one frame buffer while the CPU draws into the other one,
+// and the ScanLine interrupt swaps them on the last line when asked to. Nothing is copied
+// on the retrace so DMA_MEM_CPY and VGA_DIRTY_SYNC don't apply.
+#ifndef VGA_PAGE_FLIP
+#define VGA_PAGE_FLIP 0
+#endif
+#ifndef DMA_MEM_CPY
 #define DMA_MEM_CPY 1
-#if DMA_MEM_CPY
+#endif
+// 1: only copy the 8 line bands of cframe that changed since the last retrace (see
+// VgaDirty.h), with DMA or memcpy depending on DMA_MEM_CPY.
+// 0 (default until it has run on silicon): copy the whole frame with DMA or 1/10th of it with
+// memcpy on every retrace.
+#ifndef VGA_DIRTY_SYNC
+#define VGA_DIRTY_SYNC 0
+#endif
+#if VGA_PAGE_FLIP
+#undef DMA_MEM_CPY
+#define DMA_MEM_CPY 0
+#undef VGA_DIRTY_SYNC
+#define VGA_DIRTY_SYNC 0
+#elif VGA_DIRTY_SYNC
+#include "VgaDirty.h"
+#elif DMA_MEM_CPY
 // Define how many bytes we are going to copy per transfer count
 // 0-4095, since we want to do 4 bytes at a time use something divisable by 4.
 #define MEM_TRANSFER_COUNT  4092
@@ -50,10 +113,14 @@ volatile uint8 flag_FrameRdyone = 0;
 
 // Declare our DMA channel and our DMA Transaction Descriptor.
 uint8 dmaCh, dmaTd;
+// Without VGA_LINE_CHAIN the line TD is the first one we allocate so we know its handle at
+// compile time, that lets the ScanLine interrupt write TD memory at a constant address.
+#define DMA_LINE_TD DMA_TD_FAST_SLOT(0)
 
 // Set up a refresh signal so the CPU can refresh the DMA buffer.
 volatile int refresh = 0;
 
+#if !VGA_TEXT_MODE && !VGA_TILE_MODE
 //
 // Define our frame buffers making sure the X dimension is continuous in memory.
 //
@@ -62,13 +129,133 @@ uint8 cframe[VGA_Y_BYTES][VGA_X_BYTES] __attribute__((aligned()));
 // DMA frame, Declare the DMA video frame  to go in our new section .ram2 located at 0x2000000
 uint8 dframe[VGA_Y_BYTES][VGA_X_BYTES] __attribute__ ((aligned(),section(".ram2")));
 
+#if VGA_PAGE_FLIP
+// The page the line DMA shows and the one the CPU draws into, they start as dframe and cframe
+// and the ScanLine interrupt swaps them when flipRequest is set.
+// Both halves of the SRAM are fine as the front page: the SRAM spoke only decodes the low 16
+// bits of the address, .ram (0x1FFF8000) has them at 0x8000-0xFFFF and .ram2 (0x20000000) at
+// 0x0000-0x7FFF, so the line TD picks the page with its LO16 source address alone and the
+// channel keeps the HI16 it was initialized with.
+uint8 (*volatile frontPage)[VGA_X_BYTES] = dframe;
+uint8 (*volatile backPage)[VGA_X_BYTES] = cframe;
+// Set by the CPU when the back page is ready to be shown, cleared by the ScanLine interrupt
+// when it swaps the pages.
+volatile uint8 flipRequest = 0;
+#define VGA_SCAN_PAGE frontPage
+#define VGA_DRAW_PAGE backPage
+#else
+#define VGA_SCAN_PAGE dframe
+#define VGA_DRAW_PAGE cframe
+#endif
+#if VGA_SPRITES
+// The line TD shows frame buffer row r on screen row s from a line buffer when a sprite is on it.
+#define VGA_LINE_SRC(s, r) VgaSprite_Row((s), VGA_SCAN_PAGE[r])
+#else
+#define VGA_LINE_SRC(s, r) VGA_SCAN_PAGE[r]
+#endif
+
+#if VGA_SPRITES
+// A 16x16 arrow cursor, XORed so it shows on the grid and on flipped characters alike.
+static const uint16 cursor[16] = {
+    0x8000, 0xC000, 0xE000, 0xF000, 0xF800, 0xFC00, 0xFE00, 0xFF00,
+    0xFF80, 0xFC00, 0xEC00, 0xC600, 0x8600, 0x0300, 0x0300, 0x0000
+};
+#endif
+
+// Hardware scroll: the frame buffers are rings of rows and the top line shows row scrollRow,
+// the lines below it the rows after it, wrapping around to row 0 after the last one.
+// Scrolling a log up by a character is drawing the new text into the 8 rows at the top of the
+// ring (they are not shown any more once scrolled) and adding 8 to scrollRequest, nothing is
+// moved. The CPU writes scrollRequest (0 to VGA_Y_BYTES-1) whenever it likes, the ScanLine
+// interrupt takes it over on the last line so a frame never shows two offsets, and the retrace
+// copy of the new rows lands in the same frame.
+volatile uint16 scrollRequest = 0;
+static uint16 scrollRow = 0;
+#if VGA_FINE_SCROLL
+// Fine horizontal scroll in pixel clocks (0-7), taken over with scrollRequest (see VgaConfig.h).
+volatile uint8 fineRequest = 0;
+#endif
+#endif
+
 
 // ScanLine Interrupt
 //
 // This gets called everytime our DMA transfer is done, so we can setup the next line
 // or if we are on the last line we will refresh the dma frame with the current cpu frame.
+#if VGA_TEXT_MODE
+// In text mode it gets called on the last line of each glyph row, to expand the glyph row after
+// the next one.
 CY_ISR(ScanLine)
 {
+    uint8 lastLine;
+
+    VGA_STATS_ISR_START();
+    lastLine = VgaText_LineDone();
+    if (lastLine)
+    {
+        // On the last line since we are going to enter vertical sync
+        // Indicate the CPU that it's ok to change the screen.
+        refresh++;
+    }
+    VGA_STATS_ISR_END(lastLine);
+}
+#elif VGA_TILE_MODE
+// In tile mode it gets called on every line, to expand the line after the next one.
+CY_ISR(ScanLine)
+{
+    uint8 lastLine;
+
+    VGA_STATS_ISR_START();
+    lastLine = VgaTile_LineDone();
+    if (lastLine)
+    {
+        // On the last line since we are going to enter vertical sync
+        // Indicate the CPU that it's ok to change the screen.
+        refresh++;
+    }
+    VGA_STATS_ISR_END(lastLine);
+}
+#elif VGA_LINE_CHAIN
+// With the TD ring it only gets called on the last line of each half of the ring, and that
+// half gets the lines after the other one.
+CY_ISR(ScanLine)
+{
+    uint8 lastLine;
+
+    VGA_STATS_ISR_START();
+    lastLine = VgaChain_Refill();
+    if (lastLine)
+    {
+        // On the last line since we are going to enter vertical sync
+        // Indicate the CPU that it's ok to refresh the screen.
+#if VGA_PAGE_FLIP
+        // The whole ring is on lines of the next frame now, so move it to the other page.
+        if (flipRequest)
+        {
+            uint8 (*page)[VGA_X_BYTES] = frontPage;
+            frontPage = backPage;
+            backPage = page;
+            VgaChain_SetPage(&frontPage[0][0]);
+            flipRequest = 0;
+        }
+#endif
+        // Same for a new scroll offset, the ring is only rewritten when it changed.
+        if ((scrollRequest % VGA_Y_BYTES) != scrollRow)
+        {
+            scrollRow = scrollRequest % VGA_Y_BYTES;
+            VgaChain_SetScroll(scrollRow);
+        }
+#if VGA_FINE_SCROLL
+        FINE_SCROLL_Write(fineRequest & 7);
+#endif
+        refresh++;
+    }
+    VGA_STATS_ISR_END(lastLine);
+}
+#else
+CY_ISR(ScanLine)
+{
+    VGA_STATS_ISR_START();
     // Get our line count from both status registers
     // LINE_CNT_HI holds the upper 2 bits
     // LINE_CNT_LO holds the lower 8 bits
@@ -84,7 +271,13 @@ CY_ISR(ScanLine)
             // adusting the line by the Y skip factor.
             if ((line % VGA_Y_FACTOR) == 0)
             {
-                CY_SET_REG16(CY_DMA_TDMEM_STRUCT_PTR[dmaTd].TD1, LO16((uint32) dframe[line / VGA_Y_FACTOR]));                    
+                // Counting from the scroll row, the ring wraps around after the last row.
+                uint16 row = line / VGA_Y_FACTOR + scrollRow;
+                if (row >= VGA_Y_BYTES)
+                {
+                    row -= VGA_Y_BYTES;
+                }
+                DmaTdFast_SetSrc(DMA_LINE_TD, LO16((uint32) VGA_LINE_SRC(line / VGA_Y_FACTOR, row)));
             }
         }
         if ((line+1) == VGA_RES_Y)
@@ -92,12 +285,36 @@ CY_ISR(ScanLine)
             // On the last line since we are going to enter vertical sync
             // Indicate the CPU that it's ok to refresh the screen.
             // this is implemented as a counter in case we want to wait more than one frame.
+#if VGA_PAGE_FLIP
+            // This line was the last one of the front page, so this is where we can swap.
+            if (flipRequest)
+            {
+                uint8 (*page)[VGA_X_BYTES] = frontPage;
+                frontPage = backPage;
+                backPage = page;
+                flipRequest = 0;
+            }
+#endif
+            // And where the scroll offset changes. The TD source already points at the last row
+            // for the first lines of the next frame, move it over to the last row of the new
+            // front page and scroll offset.
+            scrollRow = scrollRequest % VGA_Y_BYTES;
+#if VGA_SPRITES
+            // The sprites move between two frames as well.
+            VgaSprite_Latch();
+#endif
+            DmaTdFast_SetSrc(DMA_LINE_TD, LO16((uint32) VGA_LINE_SRC(VGA_Y_BYTES - 1, (scrollRow + VGA_Y_BYTES - 1) % VGA_Y_BYTES)));
+#if VGA_FINE_SCROLL
+            FINE_SCROLL_Write(fineRequest & 7);
+#endif
             refresh++;
         }
     }
+    VGA_STATS_ISR_END((line+1) == VGA_RES_Y);
 }
+#endif
 
-#if DMA_MEM_CPY
+#if DMA_MEM_CPY && !VGA_DIRTY_SYNC
 CY_ISR(FrameRdy)
 {
 	// Set the flag to indicate that the current DMA memory to memory tranfer is complete
@@ -110,8 +327,22 @@ int main()
     //
     // DMA setup
     //
+#if VGA_TEXT_MODE || VGA_TILE_MODE
+    // Initialize the DMA channel to transfer from the SRAM to the control base address, the
+    // text and tile line buffers can be in either half of it.
+    dmaCh = DMA_DmaInitialize(1, 0, HI16(CYDEV_SRAM_BASE), HI16(CYDEV_PERIPH_BASE));
+    // The line TDs are started after the EEPROM, the text mode needs the font.
+#elif VGA_LINE_CHAIN
+    // Initialize the DMA channel to transfer from the dframe base address to the control base
+    // address. This indicates the high 16 bit address that will apply to the low addresses set
+    // on the TDs.
+    dmaCh = DMA_DmaInitialize(1, 0, HI16((uint32) dframe), HI16(CYDEV_PERIPH_BASE));
+    // Build the TD ring, one TD per line, and start it.
+    VgaChain_Start(dmaCh, &VGA_SCAN_PAGE[0][0]);
+#else
     // Alocate a transaction descriptor.
     dmaTd = CyDmaTdAllocate();
+    DMA_TD_FAST_ASSERT_SLOT(dmaTd, DMA_LINE_TD);
     // Initialize the DMA channel to transfer from the dframe base address to the control base address.
     // This indicates the high 16 bit address that will apply to the low addresses set on the TD.
     dmaCh = DMA_DmaInitialize(1, 0, HI16((uint32) dframe), HI16(CYDEV_PERIPH_BASE));
@@ -126,6 +357,16 @@ int main()
     // Finally enable the DMA channel.
     // This will start the first transfer and call the interrupt after every line.
     CyDmaChEnable(dmaCh, 1);
+#endif
+
+#if VGA_STATS
+    // Start counting before the first ScanLine interrupt.
+    VgaStats_Start();
+#endif
+#if VGA_STATS_UART
+    // The counters go out of the debug UART once a second.
+    UART_Start();
+#endif
 
     //
     // Interrup Setup.
@@ -142,8 +383,32 @@ int main()
     //      index   Is the sprite to be displayed from 0 to 255.
     //      y       Is the current frame buffer line.
     EEPROM_Start();
+#if VGA_TEXT_MODE
+    // Copy the font and start the line TDs over the two text line buffers.
+    VgaText_Start(dmaCh);
+#endif
+#if VGA_TILE_MODE
+    // Start the line TDs over the two tile line buffers with a blank screen.
+    VgaTile_Start(dmaCh);
+#endif
+#if VGA_BPP > 1
+    // Load the colour palette the pixel values are shown with.
+    VgaColor_Start();
+#endif
+#if VGA_SPRITES
+    // Hide every sprite and give the first one the cursor, the main loop moves it around.
+    VgaSprite_Start();
+    VgaSprite_Set(0, cursor, 16, 16, VGA_SPRITE_XOR);
+#endif
 
-#if DMA_MEM_CPY
+#if VGA_DIRTY_SYNC
+    //
+    // DMA memory to memory setup
+    //
+    // The dirty band copy builds its TD chain on every retrace, from the bands the CPU wrote.
+    // It also takes over the FRAME_RDY interrupt.
+    VgaDirty_Start(&cframe[0][0], &dframe[0][0]);
+#elif DMA_MEM_CPY
     //
     // DMA memory to memory setup
     //
@@ -199,14 +464,64 @@ int main()
     // The first test takes priority if the rest are defined.
 #define TEST_CHAR_SET 1
 #define TEST_BORDER 1
-#if TEST_CHAR_SET
+#if VGA_TEXT_MODE
+    // The same character set test, one byte per character instead of 8 rows of pixels.
+    int x = 0, y = 0;
+    for (y = 0; y < VGA_TEXT_ROWS; y++)
+    {
+        for (x = 0; x < VGA_TEXT_COLS; x++)
+        {
+            int index = ((y/2)*(VGA_TEXT_COLS/2)+x/2)%256;
+            if ((y%2) == 0)
+            {
+                // Separators in cross spaces '+' and between vertical characters '-'
+                index = ((x%2) == 1) ? 0xc5 : 0xc4;
+            }
+            else if ((x%2) == 1)
+            {
+                // Separator between horizontal characters '|'
+                index = 0xb3;
+            }
+            VgaText_chars[y][x] = index;
+        }
+    }
+#elif VGA_TILE_MODE
+    // The same character set test, every character a tile of its glyph. The characters are the
+    // 96 printable ones so they fit in the tile store twice, once flipped.
+    int x = 0, y = 0;
+    uint8 glyph[VGA_TILE_HEIGHT];
+    int n;
+    for (y = 0; y < VGA_TILE_ROWS; y++)
+    {
+        for (x = 0; x < VGA_TILE_COLS; x++)
+        {
+            int index = 32+((y/2)*(VGA_TILE_COLS/2)+x/2)%96;
+            if ((y%2) == 0)
+            {
+                // Separators in cross spaces '+' and between vertical characters '-'
+                index = ((x%2) == 1) ? 0xc5 : 0xc4;
+            }
+            else if ((x%2) == 1)
+            {
+                // Separator between horizontal characters '|'
+                index = 0xb3;
+            }
+            for (n = 0; n < VGA_TILE_HEIGHT; n++)
+            {
+                glyph[n] = CY_GET_REG8(CYDEV_EE_BASE + index + n*256);
+            }
+            VgaTile_Put(x, y, glyph);
+        }
+    }
+#elif TEST_CHAR_SET
     int x = 0, y = 0;
     for (y = 0; y < VGA_Y_BYTES; y++)
     {
-        for (x = 0; x < VGA_X_BYTES; x++)
+        // One character is VGA_GLYPH_BYTES bytes wide, a single byte at 1 bpp.
+        for (x = 0; x < VGA_X_GLYPHS; x++)
         {
             // Leave blanks in between characters to place graphical characters separators
-            int index = ((y/16)*(VGA_X_BYTES/2)+x/2)%256;
+            int index = ((y/16)*(VGA_X_GLYPHS/2)+x/2)%256;
             //
             // On our current mode of 800x600 we have half a line
             // we don't want to use those last 4 pixels.
@@ -237,12 +552,28 @@ int main()
             }
             // Fill the current frame buffer with the selected character
             // row of pixels.
+#if VGA_BPP > 1
+            // Each row of characters in the next pixel value, on pixel value 0.
+            VgaColor_ExpandRow(&cframe[y][x*VGA_GLYPH_BYTES], CY_GET_REG8(CYDEV_EE_BASE + index + (y%8)*256),
+                               1 + (y/16)%(VGA_PIXEL_VALUES-1), 0);
+#else
             cframe[y][x] = CY_GET_REG8(CYDEV_EE_BASE + index + (y%8)*256);
+#endif
         }
     }
+#if VGA_PAGE_FLIP
+    // Start both pages with the same picture, from here on every change goes into both.
+    memcpy(dframe, cframe, VGA_BUFF_SIZE);
+#else
     // Clear the DMA frame buffer, not that it needs it but just in case someone has very fast eyes.
     // and sees the first frame with random pixels.
     memset(dframe, 0, VGA_BUFF_SIZE);
+#endif
+#if VGA_DIRTY_SYNC
+    // The whole frame is new: copy it now, the retraces only have time for the bands that
+    // change from here on.
+    VgaDirty_CopyAll();
+#endif
 #elif TEST_BORDER
     int x = 0, y = 0;
     for (y = 0; y < VGA_Y_BYTES; y++)
@@ -259,13 +590,13 @@ int main()
                 // On the rest of the lines.
                 if (x == 0)
                 {
-                    // Set the highest nibble for the left border.
-                    cframe[y][x] = 0x80;
+                    // Set the leftmost pixel for the left border.
+                    cframe[y][x] = VGA_PIXEL_LEFT(1);
                 }
                 else if (x == (VGA_X_BYTES-1))
                 {
-                    // Set the lowest nibble for the right border.
-                    cframe[y][x] = 0x01;
+                    // Set the rightmost pixel for the right border.
+                    cframe[y][x] = VGA_PIXEL_RIGHT(1);
                 }
                 else
                 {
@@ -275,28 +606,76 @@ int main()
             }                
         }
     }
+#if VGA_PAGE_FLIP
+    // Start both pages with the same picture, from here on every change goes into both.
+    memcpy(dframe, cframe, VGA_BUFF_SIZE);
+#endif
+#if VGA_DIRTY_SYNC
+    // The whole frame is new: copy it now, the retraces only have time for the bands that
+    // change from here on.
+    VgaDirty_CopyAll();
+#endif
 #endif
 
     // We could update the CPU frame buffer (cframe) within the for loop.
     // like for example implement a Pong game.
     // The DMA interrupt and hardware will take care to update the DMA frame buffer.
-#if !DMA_MEM_CPY
+#if !DMA_MEM_CPY && !VGA_DIRTY_SYNC && !VGA_PAGE_FLIP && !VGA_TEXT_MODE && !VGA_TILE_MODE
     volatile int count = 0;
 #endif
     // Set initial x and y values for changing the cframe contents
     x = 0, y = 8;
-    // Declaration for the current character line counter.
-    int n;
+#if !VGA_TEXT_MODE && !VGA_TILE_MODE
+    // Declaration for the current character line and byte counters.
+    int n, b;
+#endif
     // This is a frame counter that we can use to only process things at a certain frame.
     int frame = 0;
+#if VGA_STATS_UART
+    // The frame count the counters were last sent at, and the line they are sent as.
+    uint32 statsSentAt = 0;
+    static char statsLine[VGA_STATS_LINE_MAX];
+#endif
+#if VGA_PAGE_FLIP
+    // The character flipped into the other page last time, -1 when there is none yet.
+    int lastX = -1, lastY = 0;
+#endif
+#if VGA_SPRITES
+    // Cursor position and the way it is going, in pixels and frame buffer rows.
+    int cursorX = 0, cursorY = 0, cursorDx = 3, cursorDy = 1;
+#endif
     for(;;)
     {
+        VGA_POLL_ACCOUNT();
         // Refresh the screen when the interrupt sets the refresh bit on.
         if (refresh)
         {
+            // More than 1 means the main loop missed a retrace.
+            VGA_STATS_REFRESH(refresh);
+#if VGA_PAGE_FLIP || VGA_TEXT_MODE || VGA_TILE_MODE
+            // Nothing to copy, the ScanLine interrupt already swapped the pages if we asked it to
+            // (or there are no pages in text and tile mode) and the line DMA keeps running.
+            frame++;
+            refresh = 0;
+        }
+#else
             // Disable the per line DMA channel
             CyDmaChDisable(dmaCh);
-#if DMA_MEM_CPY
+#if VGA_DIRTY_SYNC && DMA_MEM_CPY
+            // Copy the bands of the CPU frame buffer that changed into the DMA frame buffer.
+            // One CPU request runs the whole chain, FRAME_RDY comes after its last TD.
+            if (VgaDirty_Sync())
+            {
+                while (VgaDirty_Busy())
+                {
+                    VGA_POLL_ACCOUNT();
+                }
+            }
+#elif VGA_DIRTY_SYNC
+            // Copy the bands of the CPU frame buffer that changed, a flipped character is 800 bytes
+            // so it fits in the retrace.
+            VgaDirty_SyncCpu();
+#elif DMA_MEM_CPY
             // Copy the CPU frame buffer into the DMA frame buffer
             // Since this is a software driven DMA we need to trigger each TD
             // but we only  need to set the first transaction descriptor
@@ -310,7 +689,10 @@ int main()
             	CyDmaChSetRequest(damMemCh, CPU_REQ);
                 // Wait for it to be done.
                 // FrameRdy Interrupt code will set this to 1 when it's done.
-            	while(flag_FrameRdyone == 0);
+            	while(flag_FrameRdyone == 0)
+                {
+                    VGA_POLL_ACCOUNT();
+                }
                 // Clear flag for next time.
                 flag_FrameRdyone = 0;
             }
@@ -329,16 +711,28 @@ int main()
                 count = 0;
             }
 #endif
+            // The copy has to be done before the first visible line of the next frame.
+            VGA_STATS_COPY_DONE();
             frame++;
             // Enable the per line DMA channel
             CyDmaChEnable(dmaCh, 1);
             // We are done refreshing so reset refresh to 0
             refresh = 0;
         }
+#endif
         else
         {
             // Here we can put code that modifies the CPU frame when we are not busy updating
             // the DMA buffer.
+#if VGA_STATS_UART
+            // Send the frame timing counters once a second at 60Hz.
+            if ((VgaStats_Get()->frames - statsSentAt) >= 60)
+            {
+                statsSentAt = VgaStats_Get()->frames;
+                VgaStats_Format(statsLine, sizeof(statsLine));
+                UART_PutString(statsLine);
+            }
+#endif
 
             // For fun lets flip a character of the frame buffer
             // while we are idle at 2fps (every 30 frames), 
@@ -347,15 +741,71 @@ int main()
             {
                 // Reset the frame counter.
                 frame = 0;
-                // Flip the current character 8x8 bits
+#if VGA_SPRITES
+                // Move the cursor on, bouncing off the edges of the screen. That's only its
+                // position, the ScanLine interrupt draws it there from the next frame on.
+                if ((cursorX + cursorDx < 0) || (cursorX + cursorDx > VGA_PIXELS_X - 16))
+                {
+                    cursorDx = -cursorDx;
+                }
+                if ((cursorY + cursorDy < 0) || (cursorY + cursorDy > VGA_Y_BYTES - 16))
+                {
+                    cursorDy = -cursorDy;
+                }
+                cursorX += cursorDx;
+                cursorY += cursorDy;
+                VgaSprite_Move(0, cursorX, cursorY);
+#endif
+#if VGA_PAGE_FLIP
+                // The back page is the page we showed before the last flip so it is missing the
+                // character we flipped into the other page, catch up with it first.
+                if (lastX >= 0)
+                {
+                    for (n=0; n<8; n++)
+                    {
+                        for (b=0; b<VGA_GLYPH_BYTES; b++)
+                        {
+                            backPage[lastY+n][lastX*VGA_GLYPH_BYTES+b] = ~backPage[lastY+n][lastX*VGA_GLYPH_BYTES+b];
+                        }
+                    }
+                }
+                lastX = x;
+                lastY = y;
+#endif
+#if VGA_TEXT_MODE
+                // Flip the current character, that's one attribute bit.
+                VgaText_ToggleAttr(x, y/8);
+#elif VGA_TILE_MODE
+                // Flip the current character, that's its cell moved to the flipped tile.
+                VgaTile_Get(x, y/8, glyph);
+                for (n=0; n<VGA_TILE_HEIGHT; n++)
+                {
+                    glyph[n] = ~glyph[n];
+                }
+                VgaTile_Put(x, y/8, glyph);
+#else
+                // Flip the current character 8x8 pixels, every pixel value v becomes its
+                // complement so a colour character swaps its colour with the background.
                 for (n=0; n<8; n++)
                 {
-                    cframe[y+n][x] = ~cframe[y+n][x];
+                    for (b=0; b<VGA_GLYPH_BYTES; b++)
+                    {
+                        VGA_DRAW_PAGE[y+n][x*VGA_GLYPH_BYTES+b] = ~VGA_DRAW_PAGE[y+n][x*VGA_GLYPH_BYTES+b];
+                    }
                 }
+#endif
+#if VGA_PAGE_FLIP
+                // Show it from the next frame on.
+                flipRequest = 1;
+#endif
+#if VGA_DIRTY_SYNC
+                // Copy those 8 lines on the next retrace.
+                VgaDirty_MarkRows(y, 8);
+#endif
                 // Update our x and y values for the next loop
                 // Only do the characters not the grid so skip every other character.
                 x = x+2;
-                if (x >= VGA_X_BYTES)
+                if (x >= VGA_X_GLYPHS)
                 {
                     // We reached the end of the line so reset the column to 0
                     x = 0;